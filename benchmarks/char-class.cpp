@@ -0,0 +1,114 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "../tests/random.hpp"
+
+#include <chrono>
+#include <ctype.h>
+#include <strings.h>
+
+using namespace ok;
+
+static constexpr UZ COUNT = 1 << 20;
+
+static double now_ns() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void report(const char* name, double elapsed, UZ checksum) {
+    printf("%-28s %8.2f ns/header (checksum %zu)\n", name, elapsed / (double)COUNT, (size_t)checksum);
+}
+
+static const char* NAMES[] = {"Content-Type", "Accept-Encoding", "User-Agent", "X-Forwarded-For", "Cache-Control",
+                              "Authorization", "Content-Length", "If-None-Match"};
+
+int main() {
+    ArenaAllocator arena{};
+
+    // Header values with some padding around them, like they arrive after the colon.
+    StringView* values = arena.alloc<StringView>(COUNT);
+    char** copies = arena.alloc<char*>(COUNT);
+    for (UZ i = 0; i < COUNT; i++) {
+        UZ length = 4 + next_random() % 60;
+        char* buf = arena.alloc<char>(length + 4);
+        UZ n = 0;
+        for (UZ pad = next_random() % 3; pad > 0; pad--) buf[n++] = ' ';
+        for (UZ k = 0; k < length; k++) buf[n++] = (char)(' ' + 1 + next_random() % 94);
+        buf[n++] = '\r';
+        values[i] = StringView{buf, n};
+        copies[i] = arena.alloc<char>(n);
+    }
+
+    UZ checksum = 0;
+    double start = now_ns();
+    for (UZ i = 0; i < COUNT; i++) {
+        const char* p = values[i].data;
+        const char* end = p + values[i].count;
+        while (p < end && isspace((unsigned char)*p)) p++;
+        while (end > p && isspace((unsigned char)end[-1])) end--;
+        checksum += (UZ)(end - p);
+    }
+    report("isspace trim", now_ns() - start, checksum);
+
+    checksum = 0;
+    start = now_ns();
+    for (UZ i = 0; i < COUNT; i++) checksum += values[i].trim().count;
+    report("trim", now_ns() - start, checksum);
+
+    checksum = 0;
+    start = now_ns();
+    for (UZ i = 0; i < COUNT; i++) {
+        for (UZ k = 0; k < values[i].count; k++) copies[i][k] = (char)tolower((unsigned char)values[i].data[k]);
+        checksum += (U8)copies[i][0];
+    }
+    report("tolower loop", now_ns() - start, checksum);
+
+    checksum = 0;
+    start = now_ns();
+    for (UZ i = 0; i < COUNT; i++) {
+        memcpy(copies[i], values[i].data, values[i].count);
+        ascii_to_lower(copies[i], values[i].count);
+        checksum += (U8)copies[i][0];
+    }
+    report("ascii_to_lower", now_ns() - start, checksum);
+
+    // Looking up the name of a header, case doesn't matter.
+    StringView* names = arena.alloc<StringView>(COUNT);
+    for (UZ i = 0; i < COUNT; i++) {
+        const char* name = NAMES[next_random() % OK_ARR_LEN(NAMES)];
+        UZ length = strlen(name);
+        char* buf = arena.alloc<char>(length);
+        memcpy(buf, name, length);
+        if (next_random() % 2 == 0) ascii_to_lower(buf, length);
+        names[i] = StringView{buf, length};
+    }
+
+    checksum = 0;
+    start = now_ns();
+    for (UZ i = 0; i < COUNT; i++) {
+        for (UZ k = 0; k < OK_ARR_LEN(NAMES); k++) {
+            if (strncasecmp(names[i].data, NAMES[k], names[i].count) == 0 && NAMES[k][names[i].count] == '\0') {
+                checksum += k;
+                break;
+            }
+        }
+    }
+    report("strncasecmp", now_ns() - start, checksum);
+
+    StringView name_views[OK_ARR_LEN(NAMES)];
+    for (UZ k = 0; k < OK_ARR_LEN(NAMES); k++) name_views[k] = StringView{NAMES[k]};
+
+    checksum = 0;
+    start = now_ns();
+    for (UZ i = 0; i < COUNT; i++) {
+        for (UZ k = 0; k < OK_ARR_LEN(NAMES); k++) {
+            if (names[i].eq_ignore_case(name_views[k])) {
+                checksum += k;
+                break;
+            }
+        }
+    }
+    report("eq_ignore_case", now_ns() - start, checksum);
+
+    arena.free();
+    return 0;
+}
@@ -0,0 +1,68 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "../tests/random.hpp"
+
+#include <chrono>
+
+using namespace ok;
+
+static constexpr UZ COUNT = 1 << 20;
+
+static double now_ns() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void report(const char* name, double elapsed) {
+    printf("%-28s %8.2f ns/value\n", name, elapsed / (double)COUNT);
+}
+
+int main() {
+    ArenaAllocator arena{};
+
+    // Values with all sorts of magnitudes and digit counts, like metrics tend to have.
+    F64* values = arena.alloc<F64>(COUNT);
+    for (UZ i = 0; i < COUNT; i++) {
+        F64 mantissa = (F64)(next_random() % 1000000000) / (F64)(1 + next_random() % 100000);
+        S32 exponent = (S32)(next_random() % 40) - 20;
+        values[i] = mantissa;
+        for (S32 e = 0; e < exponent; e++) values[i] *= 10.0;
+        for (S32 e = 0; e > exponent; e--) values[i] /= 10.0;
+    }
+
+    char buf[64];
+    UZ checksum = 0;
+
+    double start = now_ns();
+    for (UZ i = 0; i < COUNT; i++) checksum += snprintf(buf, sizeof(buf), "%.17g", values[i]);
+    report("snprintf %.17g", now_ns() - start);
+
+    start = now_ns();
+    for (UZ i = 0; i < COUNT; i++) checksum += format_f64(buf, values[i]);
+    report("format_f64", now_ns() - start);
+
+    // The shortest forms, as the parsers would see them in a CSV.
+    char* text = arena.alloc<char>(COUNT * MAX_FLOAT_CHARS);
+    UZ* lengths = arena.alloc<UZ>(COUNT);
+    for (UZ i = 0; i < COUNT; i++) {
+        lengths[i] = format_f64(text + i * MAX_FLOAT_CHARS, values[i]);
+        text[i * MAX_FLOAT_CHARS + lengths[i]] = '\0';
+    }
+
+    F64 sum = 0;
+    start = now_ns();
+    for (UZ i = 0; i < COUNT; i++) sum += strtod(text + i * MAX_FLOAT_CHARS, nullptr);
+    report("strtod", now_ns() - start);
+
+    start = now_ns();
+    for (UZ i = 0; i < COUNT; i++) {
+        F64 value = 0;
+        parse_f64(StringView{text + i * MAX_FLOAT_CHARS, lengths[i]}, &value);
+        sum += value;
+    }
+    report("parse_f64", now_ns() - start);
+
+    printf("(checksum %zu %g)\n", (size_t)checksum, sum);
+
+    arena.free();
+    return 0;
+}
@@ -0,0 +1,112 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "../tests/random.hpp"
+
+#include <chrono>
+
+using namespace ok;
+
+static constexpr UZ RECORDS = 100000;
+static constexpr int ROUNDS = 10;
+
+static double now_ns() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void report(const char* name, UZ bytes, double elapsed) {
+    printf("%-28s %8.2f GB/s\n", name, (double)bytes / elapsed);
+}
+
+int main() {
+    ArenaAllocator arena{};
+
+    // Records like an API would return, pretty printed the way they often are on disk.
+    String text = String::alloc(&arena);
+    FormatWriter w = format_writer_for(&text);
+    JsonWriter json = JsonWriter::to(&w);
+    const char* names[] = {"alpha", "beta", "gamma \"quoted\"", "delta", "caf\xc3\xa9", "line\nbreak"};
+    json.begin_array();
+    for (UZ i = 0; i < RECORDS; i++) {
+        w.write("\n  "_sv);
+        json.begin_object();
+        json.key("id"_sv);
+        json.value_int(i);
+        json.key("name"_sv);
+        json.value_string(StringView{names[next_random() % OK_ARR_LEN(names)]});
+        json.key("score"_sv);
+        json.value_f64((F64)(next_random() % 1000000) / 1000.0);
+        json.key("active"_sv);
+        json.value_bool(next_random() % 2 == 0);
+        json.key("tags"_sv);
+        json.begin_array();
+        for (UZ t = next_random() % 4; t > 0; t--) json.value_string("some tag"_sv);
+        json.end_array();
+        json.key("parent"_sv);
+        json.value_null();
+        json.end_object();
+    }
+    json.end_array();
+    w.finish();
+
+    printf("%zu bytes\n", (size_t)text.count());
+
+    UZ checksum = 0;
+    JsonDocument doc;
+
+    // Reused between documents, like a server would.
+    ArenaAllocator parse_arena{};
+
+    double start = now_ns();
+    for (int round = 0; round < ROUNDS; round++) {
+        parse_arena.reset();
+        OK_ASSERT(!JsonDocument::parse(&doc, &parse_arena, text.view()).has_value());
+        checksum += doc.structural_count;
+    }
+    report("parse", text.count() * ROUNDS, now_ns() - start);
+
+    // Walking every record on top of the parse.
+    start = now_ns();
+    F64 total = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        parse_arena.reset();
+        OK_ASSERT(!JsonDocument::parse(&doc, &parse_arena, text.view()).has_value());
+        for (JsonArrayIterator it = doc.root().iter_array(); it.valid(); it.next()) {
+            for (JsonObjectIterator field = it.value().iter_object(); field.valid(); field.next()) {
+                F64 score;
+                StringView name;
+                if (field.value().get_f64(&score)) total += score;
+                if (field.value().get_string(&name)) checksum += name.count;
+            }
+        }
+    }
+    report("parse and read everything", text.count() * ROUNDS, now_ns() - start);
+
+    UZ written = 0;
+    start = now_ns();
+    for (int round = 0; round < ROUNDS; round++) {
+        String out = String::alloc(&arena, text.count());
+        w = format_writer_for(&out);
+        json = JsonWriter::to(&w);
+        json.begin_array();
+        for (UZ i = 0; i < RECORDS; i++) {
+            json.begin_object();
+            json.key("id"_sv);
+            json.value_int(i);
+            json.key("name"_sv);
+            json.value_string(StringView{names[i % OK_ARR_LEN(names)]});
+            json.key("score"_sv);
+            json.value_f64((F64)i / 8.0);
+            json.end_object();
+        }
+        json.end_array();
+        w.finish();
+        written += out.count();
+    }
+    report("write", written, now_ns() - start);
+
+    printf("(checksum %zu %g)\n", (size_t)(checksum + written), total);
+
+    parse_arena.free();
+    arena.free();
+    return 0;
+}
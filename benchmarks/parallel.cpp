@@ -0,0 +1,64 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace ok;
+
+static constexpr UZ N = 1 << 24;
+
+template <typename F>
+static double time_ms(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static void bench(UZ thread_count, const std::vector<U64>& input) {
+    ArenaAllocator arena{};
+    ThreadPool pool = ThreadPool::alloc(&arena, thread_count);
+    std::vector<U64> items = input;
+
+    U64 sum = 0;
+    double reduce_ms = time_ms([&] {
+        sum = parallel_reduce(&pool, Slice<U64>{items.data(), items.size()}, (U64)0, [](U64 a, U64 b) { return a + b; });
+    });
+
+    double transform_ms = time_ms([&] {
+        parallel_transform(&pool, Slice<U64>{items.data(), items.size()}, Slice<U64>{items.data(), items.size()},
+                           [](U64 x) { return x ^ (x >> 17); });
+    });
+
+    double prefix_sum_ms = time_ms([&] {
+        parallel_prefix_sum(&pool, Slice<U64>{items.data(), items.size()}, &arena);
+    });
+
+    items = input;
+    double sort_ms = time_ms([&] {
+        parallel_sort(&pool, Slice<U64>{items.data(), items.size()}, &arena);
+    });
+
+    for (UZ i = 1; i < items.size(); i++) OK_ASSERT(items[i - 1] <= items[i]);
+    OK_UNUSED(sum);
+
+    printf("%3zu threads   reduce %8.2fms   transform %8.2fms   prefix_sum %8.2fms   sort %8.2fms\n",
+           (size_t)thread_count, reduce_ms, transform_ms, prefix_sum_ms, sort_ms);
+
+    pool.dealloc();
+    arena.free();
+}
+
+int main() {
+    std::mt19937_64 rng(42);
+    std::vector<U64> input(N);
+    for (U64& x : input) x = rng();
+
+    UZ hardware = hardware_thread_count();
+    for (UZ threads = 1; threads < hardware; threads *= 2) bench(threads, input);
+    bench(hardware, input);
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "../tests/random.hpp"
+
+#include <chrono>
+
+using namespace ok;
+
+static constexpr UZ COUNT = 1 << 21;
+
+static double now_ns() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main() {
+    ArenaAllocator arena{};
+
+    // A CSV-like column of numbers of every length, separated by commas.
+    StringBuilder builder = StringBuilder::alloc(&arena);
+    for (UZ i = 0; i < COUNT; i++) {
+        S64 value = (S64)(next_random() >> (next_random() % 64));
+        if (next_random() % 4 == 0) value = -value;
+        format_to(&builder, "{},", value);
+    }
+    String text = builder.finish(&arena);
+
+    S64 sum = 0;
+    double start = now_ns();
+    for (const char* p = text.cstr(); *p != '\0';) {
+        char* next;
+        sum += strtoll(p, &next, 10);
+        p = next + 1;
+    }
+    double elapsed = now_ns() - start;
+    printf("strtoll      %8.2f ns/value\n", elapsed / (double)COUNT);
+
+    S64 check = 0;
+    start = now_ns();
+    StringView rest = text.view();
+    while (rest.count > 0) {
+        S64 value = 0;
+        UZ consumed = 0;
+        OK_ASSERT(parse_int(rest, &value, &consumed));
+        check += value;
+        rest = StringView{rest.data + consumed + 1, rest.count - consumed - 1};
+    }
+    elapsed = now_ns() - start;
+    printf("parse_int    %8.2f ns/value\n", elapsed / (double)COUNT);
+
+    OK_ASSERT(sum == check);
+
+    builder.dealloc();
+    arena.free();
+    return 0;
+}
@@ -0,0 +1,189 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+#include <chrono>
+
+using namespace ok;
+
+static constexpr U64 THROUGHPUT_ITEMS = 1 << 24;
+static constexpr U64 ROUND_TRIPS = 1 << 18;
+static constexpr UZ BATCH = 64;
+
+static double now_ns() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Spins for a while and then starts giving the core away, so the numbers stay sane when
+// there are fewer cores than threads.
+static inline void backoff(UZ* spins) {
+    if (++*spins < 1024) {
+        cpu_relax();
+    } else {
+        yield_thread();
+    }
+}
+
+struct SpscBench {
+    SpscQueue<U64>* queue;
+    SpscQueue<U64>* reply;
+    bool batched;
+};
+
+static void spsc_consume(void* arg) {
+    SpscBench* bench = (SpscBench*)arg;
+    U64 items[BATCH];
+    U64 received = 0;
+    UZ spins = 0;
+
+    while (received < THROUGHPUT_ITEMS) {
+        UZ count = bench->batched ? bench->queue->pop_many(items, BATCH) : bench->queue->pop(items);
+        if (count == 0) {
+            backoff(&spins);
+        } else {
+            spins = 0;
+        }
+        received += count;
+    }
+}
+
+static void spsc_echo(void* arg) {
+    SpscBench* bench = (SpscBench*)arg;
+    UZ spins = 0;
+
+    for (U64 i = 0; i < ROUND_TRIPS; i++) {
+        U64 item;
+        while (!bench->queue->pop(&item)) backoff(&spins);
+        while (!bench->reply->push(item)) backoff(&spins);
+    }
+}
+
+static void bench_spsc(bool batched) {
+    ArenaAllocator arena{};
+    SpscQueue<U64> queue = SpscQueue<U64>::alloc(&arena, 4096);
+    SpscBench bench{&queue, nullptr, batched};
+
+    Thread consumer{};
+    double start = now_ns();
+    consumer.start(spsc_consume, &bench);
+
+    U64 items[BATCH];
+    U64 sent = 0;
+    UZ spins = 0;
+    while (sent < THROUGHPUT_ITEMS) {
+        UZ count;
+        if (batched) {
+            for (UZ i = 0; i < BATCH; i++) items[i] = sent + i;
+            count = queue.push_many(items, BATCH);
+        } else {
+            count = queue.push(sent);
+        }
+
+        if (count == 0) {
+            backoff(&spins);
+        } else {
+            spins = 0;
+        }
+        sent += count;
+    }
+
+    consumer.join();
+    double elapsed = now_ns() - start;
+
+    printf("spsc %-8s throughput %8.2f Mitems/s   %6.2f ns/item\n", batched ? "batched" : "single",
+           (double)THROUGHPUT_ITEMS / elapsed * 1000.0, elapsed / (double)THROUGHPUT_ITEMS);
+
+    queue.dealloc();
+    arena.free();
+}
+
+static void bench_spsc_latency() {
+    ArenaAllocator arena{};
+    SpscQueue<U64> queue = SpscQueue<U64>::alloc(&arena, 64);
+    SpscQueue<U64> reply = SpscQueue<U64>::alloc(&arena, 64);
+    SpscBench bench{&queue, &reply, false};
+
+    Thread echo{};
+    echo.start(spsc_echo, &bench);
+
+    double start = now_ns();
+    UZ spins = 0;
+    for (U64 i = 0; i < ROUND_TRIPS; i++) {
+        while (!queue.push(i)) backoff(&spins);
+        U64 item;
+        while (!reply.pop(&item)) backoff(&spins);
+    }
+    double elapsed = now_ns() - start;
+
+    echo.join();
+
+    // A round trip is two handoffs.
+    printf("spsc handoff latency   %8.2f ns\n", elapsed / (double)ROUND_TRIPS / 2.0);
+
+    queue.dealloc();
+    reply.dealloc();
+    arena.free();
+}
+
+struct MpmcBench {
+    MpmcQueue<U64>* queue;
+    U64 items_per_thread;
+};
+
+static void mpmc_produce(void* arg) {
+    MpmcBench* bench = (MpmcBench*)arg;
+    UZ spins = 0;
+
+    for (U64 i = 0; i < bench->items_per_thread; i++) {
+        while (!bench->queue->push(i)) backoff(&spins);
+        spins = 0;
+    }
+}
+
+static void mpmc_consume(void* arg) {
+    MpmcBench* bench = (MpmcBench*)arg;
+    UZ spins = 0;
+
+    for (U64 i = 0; i < bench->items_per_thread; i++) {
+        U64 item;
+        while (!bench->queue->pop(&item)) backoff(&spins);
+        spins = 0;
+    }
+}
+
+static void bench_mpmc(UZ pairs) {
+    ArenaAllocator arena{};
+    MpmcQueue<U64> queue = MpmcQueue<U64>::alloc(&arena, 4096);
+    MpmcBench bench{&queue, THROUGHPUT_ITEMS / 4 / pairs};
+
+    Thread* producers = arena.alloc<Thread>(pairs);
+    Thread* consumers = arena.alloc<Thread>(pairs);
+
+    double start = now_ns();
+    for (UZ i = 0; i < pairs; i++) {
+        producers[i].start(mpmc_produce, &bench);
+        consumers[i].start(mpmc_consume, &bench);
+    }
+    for (UZ i = 0; i < pairs; i++) {
+        producers[i].join();
+        consumers[i].join();
+    }
+    double elapsed = now_ns() - start;
+
+    U64 total = bench.items_per_thread * pairs;
+    printf("mpmc %zux%-6zu throughput %8.2f Mitems/s   %6.2f ns/item\n", (size_t)pairs, (size_t)pairs,
+           (double)total / elapsed * 1000.0, elapsed / (double)total);
+
+    queue.dealloc();
+    arena.free();
+}
+
+int main() {
+    bench_spsc(false);
+    bench_spsc(true);
+    bench_spsc_latency();
+
+    UZ hardware = hardware_thread_count();
+    for (UZ pairs = 1; pairs * 2 <= max(hardware, (UZ)2); pairs *= 2) bench_mpmc(pairs);
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace ok;
+
+static constexpr UZ N = 1 << 22;
+static constexpr int RUNS = 5;
+
+template <typename F>
+static double best_ms(const std::vector<U64>& input, F f) {
+    double best = 1e30;
+
+    for (int run = 0; run < RUNS; run++) {
+        std::vector<U64> items = input;
+
+        auto start = std::chrono::steady_clock::now();
+        f(items);
+        auto end = std::chrono::steady_clock::now();
+
+        OK_ASSERT(std::is_sorted(items.begin(), items.end()));
+        best = min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    return best;
+}
+
+static void bench(const char* name, const std::vector<U64>& input) {
+    ArenaAllocator arena{};
+
+    double std_sort = best_ms(input, [](std::vector<U64>& items) {
+        std::sort(items.begin(), items.end());
+    });
+    double pdq = best_ms(input, [](std::vector<U64>& items) {
+        sort(Slice<U64>{items.data(), items.size()});
+    });
+    double stable = best_ms(input, [&](std::vector<U64>& items) {
+        stable_sort(Slice<U64>{items.data(), items.size()}, &arena);
+    });
+    double radix = best_ms(input, [&](std::vector<U64>& items) {
+        radix_sort(Slice<U64>{items.data(), items.size()}, &arena);
+    });
+
+    printf("%-12s std::sort %8.2fms   sort %8.2fms   stable_sort %8.2fms   radix_sort %8.2fms\n",
+           name, std_sort, pdq, stable, radix);
+
+    arena.free();
+}
+
+int main() {
+    std::mt19937_64 rng(42);
+    std::vector<U64> input(N);
+
+    for (U64& x : input) x = rng();
+    bench("random", input);
+
+    for (UZ i = 0; i < N; i++) input[i] = i;
+    bench("sorted", input);
+
+    for (UZ i = 0; i < N; i++) input[i] = N - i;
+    bench("reversed", input);
+
+    for (U64& x : input) x = rng() % 16;
+    bench("duplicates", input);
+
+    return 0;
+}
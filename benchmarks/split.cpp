@@ -0,0 +1,69 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "../tests/random.hpp"
+
+#include <chrono>
+
+using namespace ok;
+
+static constexpr UZ SIZE = 64 << 20;
+
+static double now_ns() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void report(const char* name, double elapsed, UZ checksum) {
+    printf("%-28s %8.2f GB/s (checksum %zu)\n", name, (double)SIZE / elapsed, (size_t)checksum);
+}
+
+// Fields of 1 to `max_field` chars, separated by commas, in lines of 8 fields.
+static StringView make_csv(char* buf, UZ max_field) {
+    UZ count = 0;
+    while (count + max_field + 2 < SIZE) {
+        for (int field = 0; field < 8 && count + max_field + 2 < SIZE; field++) {
+            for (UZ n = 1 + next_random() % max_field; n > 0; n--) buf[count++] = 'a' + (char)(next_random() % 26);
+            buf[count++] = field == 7 ? '\n' : ',';
+        }
+    }
+    return StringView{buf, count};
+}
+
+static void run(const char* name, StringView text) {
+    printf("%s:\n", name);
+
+    UZ checksum = 0;
+    double start = now_ns();
+    for (const char* p = text.data; ;) {
+        const char* hit = (const char*)memchr(p, ',', (UZ)(text.data + text.count - p));
+        if (hit == nullptr) break;
+        checksum += (UZ)(hit - p);
+        p = hit + 1;
+    }
+    report("  memchr loop", now_ns() - start, checksum);
+
+    checksum = 0;
+    start = now_ns();
+    for (CharSplitter it = text.split(','); it.valid(); it.next()) checksum += it.part().count;
+    report("  split(',')", now_ns() - start, checksum);
+
+    checksum = 0;
+    start = now_ns();
+    for (LineSplitter it = text.lines(); it.valid(); it.next()) checksum += it.part().count;
+    report("  lines()", now_ns() - start, checksum);
+
+    checksum = 0;
+    start = now_ns();
+    for (StringSplitter it = text.split(",a"_sv); it.valid(); it.next()) checksum += it.part().count;
+    report("  split(\",a\")", now_ns() - start, checksum);
+}
+
+int main() {
+    ArenaAllocator arena{};
+    char* buf = arena.alloc<char>(SIZE);
+
+    run("Short fields", make_csv(buf, 8));
+    run("Long fields", make_csv(buf, 200));
+
+    arena.free();
+    return 0;
+}
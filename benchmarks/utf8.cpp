@@ -0,0 +1,63 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "../tests/random.hpp"
+
+#include <chrono>
+
+using namespace ok;
+
+static constexpr UZ SIZE = 16 << 20;
+static constexpr int ROUNDS = 10;
+
+static double now_ns() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Every round starts one byte later, or the compiler would only call the pure functions once.
+static void report(const char* name, double elapsed) {
+    printf("%-28s %8.2f GB/s\n", name, (double)SIZE * ROUNDS / elapsed);
+}
+
+// Text where about one codepoint in `one_in` isn't ASCII.
+static StringView make_text(char* buf, U64 one_in) {
+    UZ count = 0;
+    while (count + 4 < SIZE) {
+        U32 codepoint = 'a' + (U32)(next_random() % 26);
+        if (next_random() % one_in == 0) codepoint = 0xa0 + (U32)(next_random() % 0x3000);
+        count += utf8_encode(codepoint, buf + count);
+    }
+    return StringView{buf, count};
+}
+
+static void run(const char* name, StringView text, U16* units) {
+    printf("%s:\n", name);
+
+    UZ checksum = 0;
+    double start = now_ns();
+    for (int i = 0; i < ROUNDS; i++) checksum += is_valid_utf8(text.view(i));
+    report("  is_valid_utf8", now_ns() - start);
+
+    Utf8View view = Utf8View::from_valid(text);
+    start = now_ns();
+    for (int i = 0; i < ROUNDS; i++) checksum += utf8_count_codepoints(text.view(i));
+    report("  utf8_count_codepoints", now_ns() - start);
+
+    start = now_ns();
+    for (int i = 0; i < ROUNDS; i++) checksum += utf8_to_utf16(view, units);
+    report("  utf8_to_utf16", now_ns() - start);
+
+    printf("  (checksum %zu)\n", (size_t)checksum);
+}
+
+int main() {
+    ArenaAllocator arena{};
+    char* buf = arena.alloc<char>(SIZE);
+    U16* units = arena.alloc<U16>(SIZE);
+
+    run("ASCII", make_text(buf, ~(U64)0), units);
+    run("Mostly ASCII", make_text(buf, 20), units);
+    run("Mostly non-ASCII", make_text(buf, 1), units);
+
+    arena.free();
+    return 0;
+}
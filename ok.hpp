@@ -139,6 +139,8 @@
 #include <sys/wait.h>
 #include <unistd.h>
 #include <spawn.h>
+#include <pthread.h>
+#include <sched.h>
 
 // @Customization
 #define OK_ALLOC_PAGE(sz) (mmap(NULL, (sz), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0))
@@ -193,6 +195,31 @@
 #  error "Could not determine word size"
 #endif // word size check
 
+// @Customization
+#ifndef OK_CACHE_LINE_SIZE
+#define OK_CACHE_LINE_SIZE 64
+#endif // OK_CACHE_LINE_SIZE
+
+// @Customization: Define `OK_NO_SIMD` to only use the scalar code paths.
+#ifndef OK_NO_SIMD
+#  if defined(__SSE2__) || defined(_M_X64)
+#    define OK_SIMD_SSE2 1
+#    include <emmintrin.h>
+#  endif
+#  if defined(__SSSE3__)
+#    define OK_SIMD_SSSE3 1
+#    include <tmmintrin.h>
+#  endif
+#  if defined(__AVX2__)
+#    define OK_SIMD_AVX2 1
+#    include <immintrin.h>
+#  endif
+#  if defined(__aarch64__) && defined(__ARM_NEON)
+#    define OK_SIMD_NEON 1
+#    include <arm_neon.h>
+#  endif
+#endif // OK_NO_SIMD
+
 using U8 = uint8_t;
 using U16 = uint16_t;
 using U32 = uint32_t;
@@ -222,9 +249,21 @@ using F64 = double;
 #define OK_ATTRIBUTE_PRINTF(fmt, args)
 #endif // __GNUC__
 
+// Placement new without pulling in <new>.
+struct OkPlacementNewTag {};
+
+inline void* operator new(decltype(sizeof(0)), OkPlacementNewTag, void* ptr) noexcept {
+    return ptr;
+}
+
+inline void operator delete(void*, OkPlacementNewTag, void*) noexcept {}
+
+#define OK_PLACEMENT_NEW(ptr) new (OkPlacementNewTag{}, (ptr))
+
 namespace ok {
 #ifdef OK_NO_STDLIB
     void *memcpy(void *, const void *, UZ);
+    void *memmove(void *, const void *, UZ);
     void *memset(void *, U8, UZ);
 
     UZ strlen(const char *);
@@ -281,6 +320,131 @@ constexpr T min(T x, Rest... xs) {
     return x < xs_min ? x : xs_min;
 }
 
+// type utilities
+template <typename T> struct RemoveReference      { using Type = T; };
+template <typename T> struct RemoveReference<T&>  { using Type = T; };
+template <typename T> struct RemoveReference<T&&> { using Type = T; };
+
+template <typename T> struct RemoveConst          { using Type = T; };
+template <typename T> struct RemoveConst<const T> { using Type = T; };
+
+template <typename T>
+using RemoveCVRef = typename RemoveConst<typename RemoveReference<T>::Type>::Type;
+
+template <typename A, typename B> constexpr bool is_same = false;
+template <typename A>             constexpr bool is_same<A, A> = true;
+
+template <typename T> struct TypeIdentityImpl { using Type = T; };
+
+// Keeps `T` out of template argument deduction.
+template <typename T>
+using TypeIdentity = typename TypeIdentityImpl<T>::Type;
+
+template <typename T> constexpr bool is_pointer     = false;
+template <typename T> constexpr bool is_pointer<T*> = true;
+
+template <typename T>
+constexpr bool is_trivially_copyable = __is_trivially_copyable(T);
+
+// NOTE: Clang deprecates `__has_trivial_destructor`, GCC before 14 only has that one.
+#if defined(__has_builtin)
+#if __has_builtin(__is_trivially_destructible)
+#define OK_IS_TRIVIALLY_DESTRUCTIBLE(T) __is_trivially_destructible(T)
+#endif
+#endif
+
+#ifndef OK_IS_TRIVIALLY_DESTRUCTIBLE
+#define OK_IS_TRIVIALLY_DESTRUCTIBLE(T) __has_trivial_destructor(T)
+#endif
+
+template <typename T>
+constexpr bool is_trivially_destructible = OK_IS_TRIVIALLY_DESTRUCTIBLE(T);
+
+template <typename T> constexpr bool is_integer                     = false;
+template <>           constexpr bool is_integer<char>               = true;
+template <>           constexpr bool is_integer<signed char>        = true;
+template <>           constexpr bool is_integer<unsigned char>      = true;
+template <>           constexpr bool is_integer<short>              = true;
+template <>           constexpr bool is_integer<unsigned short>     = true;
+template <>           constexpr bool is_integer<int>                = true;
+template <>           constexpr bool is_integer<unsigned int>       = true;
+template <>           constexpr bool is_integer<long>               = true;
+template <>           constexpr bool is_integer<unsigned long>      = true;
+template <>           constexpr bool is_integer<long long>          = true;
+template <>           constexpr bool is_integer<unsigned long long> = true;
+
+template <typename T>
+constexpr bool is_signed = (T)-1 < (T)0;
+
+template <UZ Size> struct UnsignedOfSize;
+template <> struct UnsignedOfSize<1> { using Type = U8; };
+template <> struct UnsignedOfSize<2> { using Type = U16; };
+template <> struct UnsignedOfSize<4> { using Type = U32; };
+template <> struct UnsignedOfSize<8> { using Type = U64; };
+
+template <typename T>
+constexpr typename RemoveReference<T>::Type&& move(T&& value) {
+    return static_cast<typename RemoveReference<T>::Type&&>(value);
+}
+
+template <typename T>
+inline void swap(T& a, T& b) {
+    T tmp = move(a);
+    a = move(b);
+    b = move(tmp);
+}
+
+template <typename T>
+constexpr T&& forward(typename RemoveReference<T>::Type& value) {
+    return static_cast<T&&>(value);
+}
+
+template <typename T>
+constexpr T&& forward(typename RemoveReference<T>::Type&& value) {
+    return static_cast<T&&>(value);
+}
+
+// Copy-constructs `count` elements from `src` into uninitialized memory at `dst`.
+template <typename T>
+inline void copy_items(T* dst, const T* src, UZ count) {
+    if constexpr (is_trivially_copyable<T>) {
+        memcpy((void*)dst, (const void*)src, count * sizeof(T));
+    } else {
+        for (UZ i = 0; i < count; ++i) OK_PLACEMENT_NEW(dst + i) T(src[i]);
+    }
+}
+
+// Moves `count` elements from `src` into uninitialized memory at `dst`, leaving `src`
+// uninitialized. The ranges are allowed to overlap.
+template <typename T>
+inline void relocate_items(T* dst, T* src, UZ count) {
+    if (dst == src || count == 0) return;
+
+    if constexpr (is_trivially_copyable<T>) {
+        memmove((void*)dst, (const void*)src, count * sizeof(T));
+    } else if (dst < src) {
+        for (UZ i = 0; i < count; ++i) {
+            OK_PLACEMENT_NEW(dst + i) T(move(src[i]));
+            src[i].~T();
+        }
+    } else {
+        for (UZ i = count; i > 0; --i) {
+            OK_PLACEMENT_NEW(dst + i - 1) T(move(src[i - 1]));
+            src[i - 1].~T();
+        }
+    }
+}
+
+template <typename T>
+inline void destroy_items(T* items, UZ count) {
+    if constexpr (!is_trivially_destructible<T>) {
+        for (UZ i = 0; i < count; ++i) items[i].~T();
+    } else {
+        OK_UNUSED(items);
+        OK_UNUSED(count);
+    }
+}
+
 template <typename T>
 struct Slice;
 
@@ -310,10 +474,25 @@ struct Allocator {
 
     template <typename T>
     inline T* resize(T* ptr, UZ old_size, UZ new_size) {
-        T* new_ptr = alloc<T>(new_size);
-        memcpy((void*)new_ptr, ptr, old_size * sizeof(T));
-        dealloc<T>(ptr, old_size);
-        return new_ptr;
+        return resize<T>(ptr, old_size, new_size, old_size);
+    }
+
+    // Only the first `live_count` elements are carried over, the remaining old slots are
+    // assumed to be uninitialized. Trivially copyable types go through `raw_resize`, so
+    // allocators get a chance to grow in place, everything else is moved over one by one.
+    template <typename T>
+    inline T* resize(T* ptr, UZ old_size, UZ new_size, UZ live_count) {
+        OK_ASSERT(live_count <= old_size);
+
+        if constexpr (is_trivially_copyable<T>) {
+            OK_UNUSED(live_count);
+            return (T*)raw_resize((void*)ptr, old_size * sizeof(T), new_size * sizeof(T));
+        } else {
+            T* new_ptr = alloc<T>(new_size);
+            relocate_items(new_ptr, ptr, live_count);
+            dealloc<T>(ptr, old_size);
+            return new_ptr;
+        }
     }
 
     inline char* strdup(const char* cstr) {
@@ -350,6 +529,25 @@ static inline uintptr_t align_down(uintptr_t size, uintptr_t align) {
     return size - (size & (align - 1));
 }
 
+static inline UZ next_power_of_two(UZ x) {
+    UZ result = 1;
+    while (result < x) result <<= 1;
+    return result;
+}
+
+// Both are undefined for zero.
+static inline U32 count_trailing_zeros(U64 x) {
+    return (U32)__builtin_ctzll(x);
+}
+
+static inline U32 count_leading_zeros(U64 x) {
+    return (U32)__builtin_clzll(x);
+}
+
+static inline U32 popcount(U64 x) {
+    return (U32)__builtin_popcountll(x);
+}
+
 struct ArenaAllocator : public Allocator {
     struct Region {
         UZ avail() const {
@@ -406,6 +604,71 @@ struct ArenaAllocator : public Allocator {
     void* last_alloc_ptr;
 };
 
+// Hands out blocks of a single size, carved out of bigger chunks taken from `backing`.
+// Freed blocks go on a free list and are handed out again first, which makes it a good
+// fit for node-based containers.
+struct PoolAllocator : public Allocator {
+    static constexpr UZ DEFAULT_BLOCKS_PER_CHUNK = 64;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Chunk {
+        Chunk* next;
+        UZ size;
+    };
+
+    PoolAllocator() = default;
+    PoolAllocator(Allocator* backing, UZ block_size, UZ blocks_per_chunk = DEFAULT_BLOCKS_PER_CHUNK)
+        : backing{backing},
+          block_size{align_up(max(block_size, sizeof(FreeBlock)), sizeof(void*))},
+          blocks_per_chunk{blocks_per_chunk} {}
+
+    void* raw_alloc(UZ size) override;
+    void raw_dealloc(void* ptr, UZ size) override;
+
+    // Returns all of the chunks to the backing allocator.
+    void free();
+
+    Allocator* backing = nullptr;
+    UZ block_size = 0;
+    UZ blocks_per_chunk = 0;
+    FreeBlock* free_list = nullptr;
+    Chunk* chunks = nullptr;
+    U8* chunk_cursor = nullptr;
+    U8* chunk_end = nullptr;
+};
+
+// Vectorized search and comparison, using AVX2, SSE2 or NEON when they are available and
+// plain loops otherwise. The find functions return `(UZ)-1` when there is no match.
+UZ simd_find(const U8* items, UZ count, U8 value);
+UZ simd_find(const U16* items, UZ count, U16 value);
+UZ simd_find(const U32* items, UZ count, U32 value);
+UZ simd_find(const U64* items, UZ count, U64 value);
+
+UZ simd_count(const U8* items, UZ count, U8 value);
+UZ simd_count(const U16* items, UZ count, U16 value);
+UZ simd_count(const U32* items, UZ count, U32 value);
+UZ simd_count(const U64* items, UZ count, U64 value);
+
+bool simd_equal(const void* a, const void* b, UZ size);
+
+// Compares the bytes as unsigned, same as `memcmp`.
+int simd_compare(const void* a, const void* b, UZ size);
+
+// Substring search. Candidates are filtered by matching the first and the last byte of
+// the needle a whole vector at a time, and only those get compared in full.
+UZ simd_find_bytes(const U8* haystack, UZ haystack_size, const U8* needle, UZ needle_size);
+UZ simd_rfind_bytes(const U8* haystack, UZ haystack_size, const U8* needle, UZ needle_size);
+
+// Bulk operations over bit words, `dst = dst op src`.
+void bits_and(U64* dst, const U64* src, UZ word_count);
+void bits_or(U64* dst, const U64* src, UZ word_count);
+void bits_xor(U64* dst, const U64* src, UZ word_count);
+void bits_andnot(U64* dst, const U64* src, UZ word_count);
+UZ bits_popcount(const U64* words, UZ word_count);
+
 // templates
 template <typename Self, typename T>
 struct ArrayBase {
@@ -421,6 +684,11 @@ struct ArrayBase {
         UZ count = self->get_count();
         const T* items = self->get_items();
 
+        if constexpr (is_integer<typename RemoveConst<T>::Type>) {
+            using Bits = typename UnsignedOfSize<sizeof(T)>::Type;
+            return simd_find((const Bits*)items, count, (Bits)elem);
+        }
+
         for (UZ i = 0; i < count; i++) {
             if (items[i] == elem) {
                 return i;
@@ -430,6 +698,26 @@ struct ArrayBase {
         return (UZ)-1;
     }
 
+    // NOTE: Not called `count`, since that's the name of the field in most containers.
+    UZ count_of(const T& elem) const {
+        auto* self = self_cast();
+        UZ count = self->get_count();
+        const T* items = self->get_items();
+
+        if constexpr (is_integer<typename RemoveConst<T>::Type>) {
+            using Bits = typename UnsignedOfSize<sizeof(T)>::Type;
+            return simd_count((const Bits*)items, count, (Bits)elem);
+        }
+
+        UZ result = 0;
+        for (UZ i = 0; i < count; i++) result += items[i] == elem;
+        return result;
+    }
+
+    inline bool contains(const T& elem) const {
+        return find_index(elem) != (UZ)-1;
+    }
+
     template <typename F>
     UZ find_index(F pred) const {
         auto* self = self_cast();
@@ -492,9 +780,27 @@ struct List : public ArrayBase<List<T>, T> {
     static constexpr UZ DEFAULT_CAP = 7;
 
     void push(const T& item);
+    void push(T&& item);
+
+    template <typename... Args>
+    T& emplace(Args&&... args);
+
     void extend(List<T> other);
     void remove_at(UZ idx);
 
+    // Bulk operations. These move whole ranges at once (a single `memmove` for trivially
+    // copyable types) instead of going through `push` and `remove_at` per element.
+    void append_slice(Slice<const T> other);
+    void insert_slice(UZ idx, Slice<const T> other);
+    void remove_range(UZ start, UZ end);
+
+    // Moves the last element into `idx`. O(1), but does not preserve order.
+    void swap_remove(UZ idx);
+
+    // Keeps only the elements for which `pred` returns true, preserving their order.
+    template <typename F>
+    void retain(F pred);
+
     List<T> copy(Allocator* a, UZ start, UZ end) const;
 
     inline List<T> copy(Allocator* a, UZ start) const {
@@ -547,11 +853,71 @@ struct List : public ArrayBase<List<T>, T> {
     Allocator* allocator;
 };
 
+// A list that keeps up to `N` elements inline and only goes to the allocator once it
+// outgrows them. There is no `items` pointer on purpose, so the struct can still be
+// copied around by value like the rest of the containers.
+template <typename T, UZ N>
+struct SmallList : public ArrayBase<SmallList<T, N>, T> {
+    static_assert(N > 0, "SmallList needs at least one inline element");
+
+    static SmallList<T, N> alloc(Allocator* a);
+
+    static constexpr UZ INLINE_CAP = N;
+
+    void push(const T& item);
+    void remove_at(UZ idx);
+    void reserve(UZ new_cap);
+
+    inline bool is_inline() const {
+        return capacity <= N;
+    }
+
+    inline UZ get_capacity() const {
+        return is_inline() ? N : capacity;
+    }
+
+    UZ get_count() const {
+        return count;
+    }
+
+    T* get_items() {
+        return is_inline() ? reinterpret_cast<T*>(inline_items) : heap_items;
+    }
+
+    const T* get_items() const {
+        return is_inline() ? reinterpret_cast<const T*>(inline_items) : heap_items;
+    }
+
+    inline T& pop() {
+        OK_ASSERT(count > 0);
+        return get_items()[--count];
+    }
+
+    void dealloc() {
+        if (!is_inline()) allocator->dealloc<T>(heap_items, capacity);
+        count = 0;
+        capacity = N;
+    }
+
+    union {
+        T* heap_items;
+        alignas(T) U8 inline_items[sizeof(T) * N];
+    };
+    UZ count;
+    UZ capacity;
+    Allocator* allocator;
+};
+
 template <typename T>
 struct Slice : public ArrayBase<Slice<T>, T> {
     Slice() = default;
     Slice(T* items, UZ count) : items{items}, count{count} {}
 
+    // Lets a `Slice<T>` be passed where a `Slice<const T>` is expected.
+    template <typename U>
+    requires is_same<const U, T>
+    Slice(Slice<U> other) : items{other.items}, count{other.count} {}
+
     UZ get_count() const {
         return count;
     }
@@ -596,104 +962,141 @@ Slice<T> Allocator::alloc_slice(UZ count) {
     return Slice<T>{ptr, count};
 }
 
-// NOTE(oleh): Just remove this. It's a mess.
-template <typename T>
-struct MultiListBase {
-    T *items;
+template <UZ I, typename T, typename... Rest>
+struct TypeAt {
+    using Type = typename TypeAt<I - 1, Rest...>::Type;
 };
 
-template <typename T = void, typename... Rest>
-struct MultiListMethods {
-    static void grow(Allocator *allocator, UZ old_size, UZ new_size, void *untyped_list, UZ base_offset) {
-        MultiListBase<T> *list = reinterpret_cast<MultiListBase<T> *>((U8 *)untyped_list + base_offset);
-        list->items = allocator->resize(list->items, old_size, new_size);
-        // This is very, very bad. I am sorry.
-        UZ next_base_offset = base_offset + sizeof(void *);
-        MultiListMethods<Rest...>::grow(allocator, old_size, new_size, untyped_list, next_base_offset);
-    }
+template <typename T, typename... Rest>
+struct TypeAt<0, T, Rest...> {
+    using Type = T;
+};
 
-    static void init(Allocator *allocator, UZ capacity, void *untyped_list, UZ base_offset) {
-        MultiListBase<T> *list = reinterpret_cast<MultiListBase<T> *>((U8 *)untyped_list + base_offset);
-        list->items = allocator->alloc<T>(capacity);
-        UZ next_base_offset = base_offset + sizeof(void *);
-        MultiListMethods<Rest...>::init(allocator, capacity, untyped_list, next_base_offset);
+template <typename T, typename... Types>
+constexpr UZ type_index() {
+    constexpr bool matches[] = {is_same<T, Types>...};
+    for (UZ i = 0; i < sizeof...(Types); ++i) {
+        if (matches[i]) return i;
     }
-};
+    return (UZ)-1;
+}
 
-template <>
-struct MultiListMethods<void> {
-    static void grow(Allocator *allocator, UZ old_size, UZ new_size, void *list, UZ base_offset) {
-        OK_UNUSED(allocator);
-        OK_UNUSED(old_size);
-        OK_UNUSED(new_size);
-        OK_UNUSED(list);
-        OK_UNUSED(base_offset);
+// Struct-of-arrays list. Every column lives in the same allocation and starts on its own
+// cache line, so a loop over one column never drags the others into cache. Columns are
+// addressed by index (an unscoped enum works nicely for naming them), or by type when
+// that type appears only once.
+template <typename... Types>
+struct MultiList {
+    static_assert(sizeof...(Types) > 0, "MultiList needs at least one column");
+
+    template <UZ I>
+    using Column = typename TypeAt<I, Types...>::Type;
+
+    static constexpr UZ COLUMN_COUNT = sizeof...(Types);
+    static constexpr UZ COLUMN_ALIGN = OK_CACHE_LINE_SIZE;
+    static constexpr UZ DEFAULT_CAP = 7;
+
+    static MultiList<Types...> alloc(Allocator* allocator, UZ capacity = DEFAULT_CAP);
+
+    void push(const Types&... values);
+
+    // Appends a whole batch of rows, one slice per column. All slices must have the same count.
+    void push_slices(Slice<const Types>... columns);
+
+    // Moves the last row into `idx`. O(1), but does not preserve order.
+    void swap_remove(UZ idx);
+
+    void reserve(UZ new_cap);
+
+    template <UZ I>
+    inline Column<I>* items() {
+        return static_cast<Column<I>*>(columns[I]);
     }
 
-    static void init(Allocator *allocator, UZ capacity, void *untyped_list, UZ base_offset) {
-        OK_UNUSED(allocator);
-        OK_UNUSED(capacity);
-        OK_UNUSED(untyped_list);
-        OK_UNUSED(base_offset);
+    template <UZ I>
+    inline const Column<I>* items() const {
+        return static_cast<const Column<I>*>(columns[I]);
     }
-};
 
-template <typename... Types>
-struct MultiList : public ArrayBase<MultiList<Types...>, Types>..., public MultiListBase<Types>... {
-    static MultiList<Types...> alloc(Allocator *allocator, UZ capacity = 7) {
-        MultiList<Types...> list{};
-        list.allocator = allocator;
-        list.capacity = capacity;
-        MultiListMethods<Types...>::init(allocator, capacity, &list, 0);
-        list.count = 0;
-        return list;
+    template <UZ I>
+    inline Slice<Column<I>> column() {
+        return Slice<Column<I>>{items<I>(), count};
     }
 
-    void push(Types... args) {
-        if (count >= capacity) {
-            UZ new_cap = capacity * 2;
-            MultiListMethods<Types...>::grow(allocator, capacity, new_cap, this, 0);
-            capacity = new_cap;
-        }
-        _push_impl(count, args...);
-        ++count;
+    template <UZ I>
+    inline Slice<const Column<I>> column() const {
+        return Slice<const Column<I>>{items<I>(), count};
     }
 
-    void _push_impl(UZ idx) {
-        OK_UNUSED(idx);
+    template <UZ I>
+    inline Column<I>& at(UZ idx) {
+        OK_ASSERT(idx < count);
+        return items<I>()[idx];
     }
 
-    template <typename X, typename... Xs>
-    void _push_impl(UZ idx, const X &x, Xs... xs) {
-        this->MultiListBase<X>::items[idx] = x;
-        _push_impl(idx, xs...);
+    template <UZ I>
+    inline const Column<I>& at(UZ idx) const {
+        OK_ASSERT(idx < count);
+        return items<I>()[idx];
     }
 
     template <typename T>
-    T *get_items() {
-        return static_cast<MultiListBase<T> *>(this)->items;
+    inline T* get_items() {
+        static_assert((is_same<T, Types> + ...) == 1, "column type must be unique, use `items<I>()`");
+        return items<type_index<T, Types...>()>();
     }
 
     template <typename T>
-    const T *get_items() const {
-        return static_cast<const MultiListBase<T> *>(this)->items;
+    inline const T* get_items() const {
+        static_assert((is_same<T, Types> + ...) == 1, "column type must be unique, use `items<I>()`");
+        return items<type_index<T, Types...>()>();
     }
 
     template <typename T>
-    T &at(UZ idx) {
+    inline T& at(UZ idx) {
         OK_ASSERT(idx < count);
-        return this->MultiListBase<T>::items[idx];
+        return get_items<T>()[idx];
     }
 
     template <typename T>
-    const T &at(UZ idx) const {
+    inline const T& at(UZ idx) const {
         OK_ASSERT(idx < count);
-        return this->MultiListBase<T>::items[idx];
+        return get_items<T>()[idx];
     }
 
-    Allocator *allocator;
-    UZ capacity;
+    // Calls `f` with the elements of the columns `Is...` for every row, leaving the other
+    // columns untouched.
+    template <UZ... Is, typename F>
+    inline void for_each(F f) {
+        for (UZ i = 0; i < count; i++) f(items<Is>()[i]...);
+    }
+
+    void dealloc();
+
+    // Computes the column offsets for `capacity` rows and returns the total block size.
+    static UZ layout(UZ capacity, UZ* offsets);
+
+    template <UZ I, typename X, typename... Xs>
+    void _push_impl(const X& x, const Xs&... xs);
+
+    template <UZ I, typename X, typename... Xs>
+    void _push_slices_impl(Slice<const X> x, Slice<const Xs>... xs);
+
+    template <UZ I>
+    void _relocate_columns(void** new_columns);
+
+    template <UZ I>
+    void _swap_remove_impl(UZ idx);
+
+    template <UZ I>
+    void _destroy_columns();
+
+    void* columns[COLUMN_COUNT];
+    void* data;
+    UZ data_size;
     UZ count;
+    UZ capacity;
+    Allocator* allocator;
 };
 
 template <typename T>
@@ -710,23 +1113,33 @@ struct LinkedList {
         return list;
     }
 
+    // NOTE: Popped nodes go into `free_nodes` and get reused by the next insertion, so
+    // the returned node (and its value) is only valid until then.
     Node* pop_front() {
         if (head == nullptr) return nullptr;
 
         Node *node = head;
-        if (head == tail) {
-            head = nullptr;
-            tail = nullptr;
-            return node;
-        }
+        unlink(node);
+        release_node(node);
+        return node;
+    }
+
+    Node* pop_back() {
+        if (tail == nullptr) return nullptr;
 
-        head = head->next;
+        Node *node = tail;
+        unlink(node);
+        release_node(node);
         return node;
     }
 
+    void remove(Node *node) {
+        unlink(node);
+        release_node(node);
+    }
+
     void prepend(const T& value) {
-        Node *node = allocator->alloc<Node>();
-        node->value = value;
+        Node *node = acquire_node(value);
 
         if (head == nullptr) {
             OK_ASSERT(tail == nullptr);
@@ -741,8 +1154,7 @@ struct LinkedList {
     }
 
     void append(const T& value) {
-        Node *node = allocator->alloc<Node>();
-        node->value = value;
+        Node *node = acquire_node(value);
 
         if (tail == nullptr) {
             OK_ASSERT(head == nullptr);
@@ -756,2049 +1168,11423 @@ struct LinkedList {
         tail = node;
     }
 
+    void unlink(Node *node) {
+        if (node->prev != nullptr) node->prev->next = node->next;
+        else head = node->next;
+
+        if (node->next != nullptr) node->next->prev = node->prev;
+        else tail = node->prev;
+
+        node->prev = nullptr;
+        node->next = nullptr;
+    }
+
+    // NOTE: Values of cached nodes are kept alive until the node is reused, which is
+    // what keeps the result of `pop_front`/`pop_back` readable. That value can be the one
+    // being inserted, so it's copied out before the old one is destroyed.
+    void release_node(Node *node) {
+        node->next = free_nodes;
+        free_nodes = node;
+    }
+
+    Node* acquire_node(const T& value) {
+        Node *node = free_nodes;
+
+        if (node != nullptr) {
+            free_nodes = node->next;
+
+            T copy(value);
+            destroy_items(&node->value, 1);
+            OK_PLACEMENT_NEW(&node->value) T(ok::move(copy));
+        } else {
+            node = allocator->alloc<Node>();
+            OK_PLACEMENT_NEW(&node->value) T(value);
+        }
+
+        node->prev = nullptr;
+        node->next = nullptr;
+        return node;
+    }
+
     Allocator *allocator;
     Node *head;
     Node *tail;
+    Node *free_nodes;
 };
 
-// char predicates
-bool is_whitespace(char);
-bool is_digit(char);
-bool is_alpha(char);
+template <typename T>
+struct IntrusiveLink {
+    T* prev;
+    T* next;
+};
 
-struct String;
+// A doubly linked list whose links live inside the elements themselves, so inserting and
+// removing never allocates. An element can be in as many lists as it has links.
+//
+//     struct Timer {
+//         IntrusiveLink<Timer> link;
+//         U64 deadline;
+//     };
+//
+//     IntrusiveList<Timer, &Timer::link> timers{};
+template <typename T, IntrusiveLink<T> T::*Link>
+struct IntrusiveList {
+    static inline IntrusiveLink<T>& link(T* item) {
+        return item->*Link;
+    }
 
-#define OK_SV_FMT "%.*s"
-#define OK_SV_ARG(sv) (int)(sv).count, reinterpret_cast<const char*>((sv).data)
+    inline bool is_empty() const {
+        return head == nullptr;
+    }
 
-// NOTE(oleh): This needs more methods.
-template <typename Self, typename Char>
-struct StringBase : public ArrayBase<Self, Char> {
-    inline bool starts_with(const char* prefix) const {
-        const Self *self = this->self_cast();
-        UZ prefix_count = strlen(prefix);
-        UZ count = self->get_count();
-        if (prefix_count > count) return false;
+    void prepend(T* item) {
+        IntrusiveLink<T>& l = link(item);
+        l.prev = nullptr;
+        l.next = head;
 
-        for (UZ i = 0; i < prefix_count; ++i) {
-            if ((*self)[i] != prefix[i]) return false;
-        }
+        if (head != nullptr) link(head).prev = item;
+        else tail = item;
 
-        return true;
+        head = item;
+        count++;
     }
 
-    inline bool ends_with(const char* suffix) const {
-        const Self *self = this->self_cast();
-        UZ suffix_count = strlen(suffix);
-        UZ count = self->get_count();
-        if (suffix_count > count) return false;
+    void append(T* item) {
+        IntrusiveLink<T>& l = link(item);
+        l.prev = tail;
+        l.next = nullptr;
 
-        UZ suffix_diff = count - suffix_count;
+        if (tail != nullptr) link(tail).next = item;
+        else head = item;
 
-        for (UZ i = suffix_diff; i < count; ++i) {
-            UZ suffix_idx = i - suffix_diff;
-            if ((*self)[i] != suffix[suffix_idx]) return false;
-        }
+        tail = item;
+        count++;
+    }
 
-        return true;
+    void insert_after(T* pos, T* item) {
+        if (pos == tail) return append(item);
+
+        IntrusiveLink<T>& l = link(item);
+        T* next = link(pos).next;
+        l.prev = pos;
+        l.next = next;
+        link(pos).next = item;
+        link(next).prev = item;
+        count++;
     }
 
-    template <typename Other, typename OtherChar>
-    inline constexpr auto operator <=>(const StringBase<Other, OtherChar>& other) const {
-        const Self *self = this->self_cast();
-        UZ self_count = self->get_count();
-        UZ other_count = other.self_cast()->get_count();
+    void remove(T* item) {
+        IntrusiveLink<T>& l = link(item);
 
-        if (self_count < other_count)      return -1;
-        else if (other_count > self_count) return 1;
+        if (l.prev != nullptr) link(l.prev).next = l.next;
+        else head = l.next;
 
-        for (UZ i = 0; i < self_count; ++i) {
-            if ((*self)[i] < other[i]) return -1;
-            if ((*self)[i] > other[i]) return 1;
-        }
+        if (l.next != nullptr) link(l.next).prev = l.prev;
+        else tail = l.prev;
 
-        return 0;
+        l.prev = nullptr;
+        l.next = nullptr;
+        count--;
     }
 
-    template <typename Other, typename OtherChar>
-    inline constexpr bool operator ==(const StringBase<Other, OtherChar>& other) const {
-        const Self *self = this->self_cast();
-        UZ self_count = self->get_count();
-        UZ other_count = other.self_cast()->get_count();
+    T* pop_front() {
+        T* item = head;
+        if (item != nullptr) remove(item);
+        return item;
+    }
 
-        if (self_count != other_count) return false;
+    T* pop_back() {
+        T* item = tail;
+        if (item != nullptr) remove(item);
+        return item;
+    }
 
-        for (UZ i = 0; i < self_count; ++i) {
-            if ((*self)[i] != other[i]) return false;
-        }
+    inline void move_to_front(T* item) {
+        if (item == head) return;
+        remove(item);
+        prepend(item);
+    }
 
-        return true;
+    inline void move_to_back(T* item) {
+        if (item == tail) return;
+        remove(item);
+        append(item);
     }
+
+    T* head;
+    T* tail;
+    UZ count;
 };
 
-struct StringView : public StringBase<StringView, const char> {
-    StringView() = default;
+// Growable ring buffer. The capacity is always a power of two, so wrapping around is a
+// single mask. Indexing is relative to the front.
+template <typename T>
+struct Deque {
+    static Deque<T> alloc(Allocator* a, UZ cap = Deque::DEFAULT_CAP);
 
-    constexpr StringView(const char* data, UZ count) : data{data}, count{count} {}
-    explicit StringView(const char* cstr) : StringView{cstr, strlen(cstr)} {}
+    static constexpr UZ DEFAULT_CAP = 8;
 
-    String to_string(Allocator* a) const;
+    void push_back(const T& item);
+    void push_back(T&& item);
+    void push_front(const T& item);
+    void push_front(T&& item);
 
-    inline StringView view(UZ start, UZ end) const {
-        OK_ASSERT(end >= start);
-        return StringView{data + start, end - start};
+    template <typename... Args>
+    T& emplace_back(Args&&... args);
+
+    template <typename... Args>
+    T& emplace_front(Args&&... args);
+
+    T pop_front();
+    T pop_back();
+
+    void reserve(UZ new_cap);
+
+    // The elements in order, as at most two contiguous runs. `second` is empty unless the
+    // elements wrap around the end of the buffer.
+    void slices(Slice<T>* first, Slice<T>* second);
+    void slices(Slice<const T>* first, Slice<const T>* second) const;
+
+    // The searches of `ArrayBase`, run over both halves. The elements aren't contiguous, so
+    // there is no `slice`, use `slices` instead.
+    UZ find_index(const T& elem) const;
+    UZ count_of(const T& elem) const;
+
+    template <typename F>
+    UZ find_index(F pred) const;
+
+    inline bool contains(const T& elem) const {
+        return find_index(elem) != (UZ)-1;
     }
 
-    inline StringView view(UZ start) const {
-        return view(start, count);
+    inline UZ mask() const {
+        return capacity - 1;
     }
 
     inline UZ get_count() const {
         return count;
     }
 
-    inline const char* get_items() const {
-        return data;
+    inline T& operator [](UZ idx) {
+        OK_ASSERT(idx < count);
+        return items[(head + idx) & mask()];
     }
 
-    const char* data;
-    UZ count;
-};
+    inline const T& operator [](UZ idx) const {
+        OK_ASSERT(idx < count);
+        return items[(head + idx) & mask()];
+    }
 
-inline namespace literals {
-constexpr StringView operator ""_sv(const char* cstr, unsigned long len) {
-    return StringView{cstr, len};
-}
-};
+    inline T& front() {
+        return (*this)[0];
+    }
 
-struct String : public StringBase<String, char> {
-    static constexpr char NULL_CHAR = '\0';
-    static constexpr UZ DEFAULT_CAPACITY = 7;
+    inline T& back() {
+        return (*this)[count - 1];
+    }
 
-    static String alloc(Allocator* a, UZ capacity = DEFAULT_CAPACITY);
+    void clear() {
+        for (UZ i = 0; i < count; i++) destroy_items(&(*this)[i], 1);
+        head = 0;
+        count = 0;
+    }
 
-    static String alloc(Allocator* a, const char* data, UZ data_len);
-    static String alloc(Allocator* a, const char* data);
+    void dealloc() {
+        if (allocator == nullptr) return;
 
-    static String from(List<U8>);
-    static String from(List<char>);
-    static String from_cstr_set_allocator(Allocator*, char*, UZ);
+        clear();
+        allocator->dealloc<T>(items, capacity);
+        memset((void*)this, 0, sizeof(*this));
+    }
 
-    static String format(Allocator* a, const char* fmt, ...) OK_ATTRIBUTE_PRINTF(2, 3);
+    T* items;
+    UZ head;
+    UZ count;
+    UZ capacity;
+    Allocator* allocator;
+};
 
-    void append(StringView);
-    void append(String);
+template <typename T>
+struct Less {
+    static bool less(const T& a, const T& b) {
+        return a < b;
+    }
+};
 
-    void format_append(const char*, ...) OK_ATTRIBUTE_PRINTF(2, 3);
+// Min-heap ordered by `Cmp::less`. It's 4-ary rather than binary: the tree is half as deep
+// and the children of a node sit next to each other, usually in the same cache line.
+template <typename T, typename Cmp = Less<T>>
+struct PriorityQueue {
+    static constexpr UZ ARITY = 4;
 
-    inline const char* cstr() const {
-        return reinterpret_cast<const char*>(data.items);
-    }
+    static PriorityQueue<T, Cmp> alloc(Allocator* a, UZ cap = List<T>::DEFAULT_CAP);
 
-    inline StringView view(UZ start, UZ end) const {
-        UZ c = count();
-        if (c == 0) {
-            return StringView{"", 0};
-        }
+    // Copies `items` and heapifies them in O(n).
+    static PriorityQueue<T, Cmp> from(Allocator* a, Slice<const T> items);
 
-        OK_ASSERT(start < c);
-        OK_ASSERT(end >= start);
+    void push(const T& item);
+    void push(T&& item);
 
-        return StringView{data.items + start, end - start};
-    }
+    T pop();
 
-    inline StringView view(UZ start) const {
-        return view(start, count());
+    inline T& peek() {
+        OK_ASSERT(heap.count > 0);
+        return heap.items[0];
     }
 
-    inline StringView view() const {
-        return view(0, count());
+    inline const T& peek() const {
+        OK_ASSERT(heap.count > 0);
+        return heap.items[0];
     }
 
-    inline String copy(Allocator* a) const {
-        String s;
-        s.data = data.copy(a);
-        return s;
+    inline UZ get_count() const {
+        return heap.count;
     }
 
-    inline void push(char character) {
-        data[data.count - 1] = character;
-        data.push(NULL_CHAR);
+    void sift_up(UZ idx);
+    void sift_down(UZ idx);
+
+    void dealloc() {
+        heap.dealloc();
     }
 
-    inline void reserve(UZ chars) {
-        UZ available_size = count();
+    List<T> heap;
+};
+
+// Priority queue over dense `U32` ids, which lets priorities be changed after insertion.
+// `positions` maps each id to its slot in `heap`.
+template <typename T, typename Cmp = Less<T>>
+struct IndexedPriorityQueue {
+    static constexpr UZ ARITY = 4;
+    static constexpr U32 NOT_QUEUED = (U32)-1;
+
+    static IndexedPriorityQueue<T, Cmp> alloc(Allocator* a, UZ id_capacity = List<T>::DEFAULT_CAP);
+
+    void push(U32 id, const T& priority);
+
+    // Moves `id` towards the top of the heap. `priority` must not be greater than the current one.
+    void decrease_key(U32 id, const T& priority);
+
+    // Changes the priority of `id` in either direction.
+    void update(U32 id, const T& priority);
+
+    void remove(U32 id);
 
-        if (available_size >= chars) return;
+    U32 pop();
 
-        data.reserve(chars + 1);
+    inline U32 peek() const {
+        OK_ASSERT(heap.count > 0);
+        return heap.items[0];
     }
 
-    inline UZ count() const {
-        OK_ASSERT(data.count != 0);
-        return data.count - 1;
+    inline bool contains(U32 id) const {
+        return id < positions.count && positions.items[id] != NOT_QUEUED;
+    }
+
+    inline const T& priority(U32 id) const {
+        OK_ASSERT(contains(id));
+        return priorities.items[id];
     }
 
     inline UZ get_count() const {
-        OK_ASSERT(data.count != 0);
-        return data.count - 1;
+        return heap.count;
     }
 
-    inline char* get_items() const {
-        return data.items;
+    inline bool less(U32 a, U32 b) const {
+        return Cmp::less(priorities.items[a], priorities.items[b]);
     }
 
-    void dealloc() {
-        data.dealloc();
+    inline void place(UZ idx, U32 id) {
+        heap.items[idx] = id;
+        positions.items[id] = (U32)idx;
     }
 
-    List<char> data;
-};
+    void sift_up(UZ idx);
+    void sift_down(UZ idx);
 
-template <template <typename> class Self, typename T>
-struct OptionalBase {
-    static Self<T> empty() {
-        U8 buf[sizeof(Self<T>)] = {};
-        Self<T> *opt = reinterpret_cast<Self<T> *>(buf);
-        return *opt;
+    void dealloc() {
+        heap.dealloc();
+        priorities.dealloc();
+        positions.dealloc();
     }
 
-    const T& or_else(const T& other) const {
-        auto* self = self_cast();
+    List<U32> heap;
+    List<T> priorities;
+    List<U32> positions;
+};
 
-        if (self->has_value()) return self->get_unchecked();
-        return other;
+// Operations shared by `FixedBitSet` and `BitSet`. The bits past `get_bit_count()` in the
+// last word are always kept zero, so that counting and searching can work a whole word
+// at a time.
+template <typename Self>
+struct BitSetBase {
+    static constexpr UZ WORD_BITS = 64;
+
+    static constexpr UZ words_for(UZ bit_count) {
+        return (bit_count + WORD_BITS - 1) / WORD_BITS;
     }
 
-    T& or_else(T& other) {
-        auto* self = self_cast();
+    inline bool get(UZ idx) const {
+        OK_ASSERT(idx < self_cast()->get_bit_count());
+        return (self_cast()->get_words()[idx / WORD_BITS] >> (idx % WORD_BITS)) & 1;
+    }
 
-        if (self->has_value(this)) return self->get_unchecked();
-        return other;
+    inline void set(UZ idx) {
+        OK_ASSERT(idx < self_cast()->get_bit_count());
+        self_cast()->get_words()[idx / WORD_BITS] |= (U64)1 << (idx % WORD_BITS);
     }
 
-    Self<T>* self_cast() {
-        return static_cast<Self<T>*>(this);
+    inline void reset(UZ idx) {
+        OK_ASSERT(idx < self_cast()->get_bit_count());
+        self_cast()->get_words()[idx / WORD_BITS] &= ~((U64)1 << (idx % WORD_BITS));
     }
 
-    const Self<T>* self_cast() const {
-        return static_cast<const Self<T>*>(this);
+    inline void flip(UZ idx) {
+        OK_ASSERT(idx < self_cast()->get_bit_count());
+        self_cast()->get_words()[idx / WORD_BITS] ^= (U64)1 << (idx % WORD_BITS);
     }
 
-    template <typename O>
-    bool operator ==(const OptionalBase<Self, O>& other) const {
-        auto* lhs = self_cast();
-        auto* rhs = other.self_cast();
-        if (!lhs->has_value() && !rhs->has_value()) return true;
+    inline void assign(UZ idx, bool value) {
+        if (value) set(idx);
+        else reset(idx);
+    }
 
-        return lhs->has_value() && rhs->has_value() && lhs->get_unchecked() == rhs->get_unchecked();
+    // Sets the bit and returns its previous value, handy for visited flags.
+    inline bool test_and_set(UZ idx) {
+        bool was_set = get(idx);
+        set(idx);
+        return was_set;
     }
 
-    explicit operator bool() const {
-        return self_cast()->has_value();
+    inline void clear() {
+        UZ word_count = words_for(self_cast()->get_bit_count());
+        if (word_count > 0) memset(self_cast()->get_words(), 0, word_count * sizeof(U64));
     }
-};
 
-template <typename T>
-struct Optional : public OptionalBase<Optional, T> {
-    using ValueType = T;
+    void fill();
 
-    Optional() : _has_value{false} {}
+    UZ count_ones() const;
 
-    Optional(ValueType value) : _has_value{true}, value{value} {}
+    inline bool any() const {
+        return find_next_set(0) != (UZ)-1;
+    }
 
-    inline bool has_value() const {
-        return _has_value;
+    // Index of the first set (or clear) bit at or after `from`, or `(UZ)-1`.
+    UZ find_next_set(UZ from) const;
+    UZ find_next_clear(UZ from) const;
+
+    // Calls `f(idx)` for every set bit, in order.
+    template <typename F>
+    void for_each_set(F f) const;
+
+    template <typename Other>
+    void and_with(const BitSetBase<Other>& other);
+    template <typename Other>
+    void or_with(const BitSetBase<Other>& other);
+    template <typename Other>
+    void xor_with(const BitSetBase<Other>& other);
+    // Clears every bit that is set in `other`.
+    template <typename Other>
+    void andnot_with(const BitSetBase<Other>& other);
+
+    Self* self_cast() {
+        return static_cast<Self*>(this);
     }
 
-    inline ValueType& get_unchecked() {
-        return value;
+    const Self* self_cast() const {
+        return static_cast<const Self*>(this);
     }
+};
 
-    inline ValueType& get() {
-        OK_ASSERT(has_value());
-        return get_unchecked();
+template <UZ N>
+struct FixedBitSet : public BitSetBase<FixedBitSet<N>> {
+    static constexpr UZ WORD_COUNT = BitSetBase<FixedBitSet<N>>::words_for(N);
+
+    inline U64* get_words() {
+        return words;
     }
 
-    inline const ValueType& get_unchecked() const {
-        return value;
+    inline const U64* get_words() const {
+        return words;
     }
 
-    inline const ValueType& get() const {
-        OK_ASSERT(has_value());
-        return get_unchecked();
+    inline UZ get_bit_count() const {
+        return N;
     }
 
-    bool _has_value;
-    ValueType value;
+    U64 words[WORD_COUNT];
 };
 
-template <typename T>
-struct Optional<T*> : public OptionalBase<Optional, T*> {
-    using ValueType = T*;
-
-    Optional() : value{nullptr} {}
-
-    Optional(ValueType value) : value{value} {}
+struct BitSet : public BitSetBase<BitSet> {
+    // All of the bits start out cleared.
+    static BitSet alloc(Allocator* a, UZ bit_count = 0);
 
-    inline bool has_value() const {
-        return value != nullptr;
-    }
+    // New bits are cleared.
+    void resize(UZ new_bit_count);
 
-    inline ValueType& get_unchecked() {
-        return value;
+    inline void push(bool value) {
+        resize(bit_count + 1);
+        if (value) set(bit_count - 1);
     }
 
-    inline ValueType& get() {
-        OK_ASSERT(has_value());
-        return get_unchecked();
+    inline U64* get_words() {
+        return words;
     }
 
-    inline const ValueType& get_unchecked() const {
-        return value;
+    inline const U64* get_words() const {
+        return words;
     }
 
-    inline const ValueType& get() const {
-        OK_ASSERT(has_value());
-        return get_unchecked();
+    inline UZ get_bit_count() const {
+        return bit_count;
     }
 
-    template <typename Base>
-    inline Optional<Base*> upcast() {
-        return Optional<Base*>{static_cast<Base*>(value)};
-    }
+    void dealloc() {
+        if (allocator == nullptr) return;
 
-    template <typename Base>
-    inline Optional<const Base*> upcast() const {
-        return Optional<const Base*>{static_cast<const Base*>(value)};
+        allocator->dealloc<U64>(words, word_capacity);
+        memset((void*)this, 0, sizeof(*this));
     }
 
-    ValueType value;
+    U64* words;
+    UZ bit_count;
+    UZ word_capacity;
+    Allocator* allocator;
 };
 
-static_assert(sizeof(Optional<int*>) == sizeof(int*));
+// Immutable bit vector with an index for constant time rank and logarithmic select. The
+// index is laid out like Vigna's rank9: two words per 512-bit block, the number of ones
+// before the block and seven 9-bit counts for the words inside it, 25% on top of the bits.
+struct BitVector {
+    static constexpr UZ BLOCK_WORDS = 8;
 
-template <typename A, typename B>
-struct Pair {
-    A a;
-    B b;
-};
+    static BitVector from(Allocator* a, const U64* words, UZ bit_count);
 
-// NOTE(oleh): We need more hash implementations, or at least a better default.
-namespace hash {
-U64 fnv1(StringView);
-};
+    template <typename Self>
+    static inline BitVector from(Allocator* a, const BitSetBase<Self>& bits) {
+        return from(a, bits.self_cast()->get_words(), bits.self_cast()->get_bit_count());
+    }
 
-template <typename T>
-struct Hash {
-    static U64 hash(const T& value) {
-        // NOTE(oleh): Just make this a function, not a method.
-        return value.ok_hash_value();
+    inline bool get(UZ idx) const {
+        OK_ASSERT(idx < bit_count);
+        return (words[idx / 64] >> (idx % 64)) & 1;
     }
-};
 
-template <typename T>
-struct HashPtr {
-    HashPtr(const T* v) : value{v} {}
-    // @Dead
-    HashPtr(T* v) : value{v} {}
+    // Number of ones in `[0, idx)`.
+    UZ rank1(UZ idx) const;
 
-    inline bool operator ==(const T* ptr) const {
-        return *value == *ptr;
+    // Number of zeros in `[0, idx)`.
+    inline UZ rank0(UZ idx) const {
+        return idx - rank1(idx);
     }
 
-    const T* value;
-};
-
-// NOTE(oleh): Remove these all in favor of `ok_hash_value`.
+    // Position of the one with the given rank (zero-based), or `(UZ)-1`.
+    UZ select1(UZ rank) const;
 
-// Default hash implementations
-// NOTE(oleh): Is this even needed?
-template <typename T>
-struct Hash<HashPtr<T>> {
-    static U64 hash(const HashPtr<T>& ptr) {
-        return Hash<T>::hash(*ptr.value);
+    inline UZ count_ones() const {
+        return ones;
     }
-};
 
-template <typename T>
-struct Hash<T*> {
-    static U64 hash(const T* ptr) {
-        return reinterpret_cast<U64>(ptr);
+    void dealloc() {
+        if (allocator == nullptr) return;
+
+        allocator->dealloc<U64>(words, word_count);
+        allocator->dealloc<U64>(index, index_count);
+        memset((void*)this, 0, sizeof(*this));
     }
+
+    U64* words;
+    UZ word_count;
+    UZ bit_count;
+    U64* index;
+    UZ index_count;
+    UZ ones;
+    Allocator* allocator;
 };
 
+// sorting
+// Pattern-defeating quicksort: insertion sort for small ranges, heap sort fallback when
+// the pivots keep coming out bad, and a branchless block partition for trivially
+// copyable types. Not stable.
+template <typename T, typename Cmp = Less<T>>
+void sort(Slice<T> items);
+
+// Top-down merge sort. Takes a buffer of `items.count / 2` elements from `scratch`.
+template <typename T, typename Cmp = Less<T>>
+void stable_sort(Slice<T> items, Allocator* scratch);
+
+// LSD radix sort on 8-bit digits. Stable. Takes a buffer of `items.count` elements from
+// `scratch`, and skips the passes for digits that are the same across all of the items.
 template <typename T>
-struct Hash<const T*> {
-    static U64 hash(const T* ptr) {
-        return reinterpret_cast<U64>(ptr);
-    }
-};
+requires is_integer<T>
+void radix_sort(Slice<T> items, Allocator* scratch);
 
-template <>
-struct Hash<U32> {
-    static U64 hash(const U32& val) {
-        return val;
-    }
+// Same as `radix_sort`, ordering the items by the integer returned from `key(item)`.
+template <typename T, typename F>
+void radix_sort_by_key(Slice<T> items, Allocator* scratch, F key);
+
+// char predicates
+// Classes of ASCII chars, as bits that combine with `|`. Bytes past 0x7f are in none of them.
+using CharClass = U8;
+
+static constexpr CharClass CHAR_WHITESPACE = 1 << 0;
+static constexpr CharClass CHAR_DIGIT = 1 << 1;
+static constexpr CharClass CHAR_LOWER = 1 << 2;
+static constexpr CharClass CHAR_UPPER = 1 << 3;
+static constexpr CharClass CHAR_HEX_DIGIT = 1 << 4;
+static constexpr CharClass CHAR_PUNCT = 1 << 5;
+static constexpr CharClass CHAR_CONTROL = 1 << 6;
+
+static constexpr CharClass CHAR_ALPHA = CHAR_LOWER | CHAR_UPPER;
+static constexpr CharClass CHAR_ALNUM = CHAR_ALPHA | CHAR_DIGIT;
+
+struct CharRange {
+    U8 first;
+    U8 last;
+    CharClass classes;
 };
 
-template <>
-struct Hash<U64> {
-    static U64 hash(const U64& val) {
-        return val;
-    }
+// Every class as ranges of chars, which is also how the vector code tests for them.
+static constexpr CharRange CHAR_CLASS_RANGES[] = {
+    {'\t', '\v', CHAR_WHITESPACE},
+    {'\r', '\r', CHAR_WHITESPACE},
+    {' ', ' ', CHAR_WHITESPACE},
+    {'0', '9', CHAR_DIGIT | CHAR_HEX_DIGIT},
+    {'a', 'f', CHAR_LOWER | CHAR_HEX_DIGIT},
+    {'g', 'z', CHAR_LOWER},
+    {'A', 'F', CHAR_UPPER | CHAR_HEX_DIGIT},
+    {'G', 'Z', CHAR_UPPER},
+    {'!', '/', CHAR_PUNCT},
+    {':', '@', CHAR_PUNCT},
+    {'[', '`', CHAR_PUNCT},
+    {'{', '~', CHAR_PUNCT},
+    {0x00, 0x1f, CHAR_CONTROL},
+    {0x7f, 0x7f, CHAR_CONTROL},
 };
 
-template <>
-struct Hash<StringView> {
-    static U64 hash(StringView sv) {
-        return ::ok::hash::fnv1(sv);
-    }
+struct CharClassTable {
+    CharClass classes[256];
 };
 
-template <>
-struct Hash<String> {
-    static U64 hash(String string) {
-        return ::ok::hash::fnv1(string.view());
+constexpr CharClassTable make_char_class_table() {
+    CharClassTable table{};
+    for (const CharRange& range : CHAR_CLASS_RANGES) {
+        for (U32 c = range.first; c <= range.last; c++) table.classes[c] |= range.classes;
     }
-};
+    return table;
+}
 
-template <typename T>
-bool operator ==(const HashPtr<T>& lhs, const HashPtr<T>& rhs);
+inline constexpr CharClassTable CHAR_CLASSES = make_char_class_table();
 
-#define OK_TAB_META_OCCUPIED 0x01
-#define OK_TAB_IS_OCCUPIED(meta) ((meta) & OK_TAB_META_OCCUPIED)
-#define OK_TAB_IS_FREE(meta) (!OK_TAB_IS_OCCUPIED((meta)))
+inline bool is_char_class(char c, CharClass classes) {
+    return (CHAR_CLASSES.classes[(U8)c] & classes) != 0;
+}
 
-#define OK_TABLE_GROWTH_FACTOR(x) (((x) + 1) * 3)
+// NOTE: Form feed isn't whitespace here.
+inline bool is_whitespace(char c) {
+    return is_char_class(c, CHAR_WHITESPACE);
+}
 
-#define OK_TABLE_FOREACH(tab, key, value, code) do { \
-    for (UZ _tab_i = 0; _tab_i < (tab).capacity; _tab_i++) {\
-    if (OK_TAB_IS_FREE((tab).meta[_tab_i])) continue; \
-    auto key = (tab).keys[_tab_i]; \
-    auto value = (tab).values[_tab_i]; \
-    code; \
-    }\
-    } while (0)
+inline bool is_digit(char c) {
+    return is_char_class(c, CHAR_DIGIT);
+}
 
-template <typename TKey, typename TValue>
-struct Table {
-    using Meta = U8;
+inline bool is_alpha(char c) {
+    return is_char_class(c, CHAR_ALPHA);
+}
 
-    static Table<TKey, TValue> alloc(Allocator* a, UZ capacity = Table::DEFAULT_CAPACITY);
+inline char to_lower(char c) {
+    return (U8)(c - 'A') < 26 ? (char)(c | 0x20) : c;
+}
 
-    void put(const TKey& key, const TValue& value);
+inline char to_upper(char c) {
+    return (U8)(c - 'a') < 26 ? (char)(c & ~0x20) : c;
+}
 
-    // NOTE(oleh): Not sure if we need the `get_ref` methods.
-    // Also not sure if we shouldn't just keep the template overloads?
-    Optional<TValue> get(const TKey& key) const;
+// Bulk versions of the above, a vector at a time. Only ASCII letters change case, other bytes
+// are left alone, so UTF-8 stays intact.
+void ascii_to_lower(char* chars, UZ count);
+void ascii_to_upper(char* chars, UZ count);
+bool ascii_eq_ignore_case(const char* a, const char* b, UZ count);
 
-    template <typename K>
-    Optional<TValue> get(const K& key) const;
+// Index of the first char that is, or isn't, in one of `classes`, or `(UZ)-1`.
+UZ find_first_of_class(const char* chars, UZ count, CharClass classes);
+UZ find_first_not_of_class(const char* chars, UZ count, CharClass classes);
+// Index of the last char that isn't in one of `classes`, or `(UZ)-1`.
+UZ find_last_not_of_class(const char* chars, UZ count, CharClass classes);
 
-    Optional<TValue&> get_ref(const TKey& key);
-    Optional<const TValue&> get_ref(const TKey& key) const;
+struct String;
 
-    template <typename K>
-    Optional<TValue&> get_ref(const K& key);
-    template <typename K>
-    Optional<const TValue&> get_ref(const K& key) const;
+#define OK_SV_FMT "%.*s"
+#define OK_SV_ARG(sv) (int)(sv).count, reinterpret_cast<const char*>((sv).data)
 
-    bool has(const TKey& key) const;
-    template <typename K>
-    bool has(const K& key) const;
+// NOTE(oleh): This needs more methods.
+template <typename Self, typename Char>
+struct StringBase : public ArrayBase<Self, Char> {
+    inline bool starts_with(const char* prefix) const {
+        const Self *self = this->self_cast();
+        UZ prefix_count = strlen(prefix);
+        UZ count = self->get_count();
+        if (prefix_count > count) return false;
 
-    bool remove(const TKey&);
+        return simd_equal(self->get_items(), prefix, prefix_count);
+    }
 
-    static constexpr UZ DEFAULT_CAPACITY = 47;
+    inline bool ends_with(const char* suffix) const {
+        const Self *self = this->self_cast();
+        UZ suffix_count = strlen(suffix);
+        UZ count = self->get_count();
+        if (suffix_count > count) return false;
 
-    inline void clear() {
-        count = 0;
-        memset(meta, 0, sizeof(Meta) * capacity);
+        return simd_equal(self->get_items() + count - suffix_count, suffix, suffix_count);
     }
 
-    inline Table<TKey, TValue> copy(Allocator* copy_allocator) {
-        UZ new_table_capacity = OK_TABLE_GROWTH_FACTOR(capacity);
-        Table<TKey, TValue> new_table = Table<TKey, TValue>::alloc(copy_allocator, new_table_capacity);
+    // Index of the first occurrence of `needle` at or after `start`, or `(UZ)-1`.
+    template <typename Other, typename OtherChar>
+    inline UZ find(const StringBase<Other, OtherChar>& needle, UZ start = 0) const {
+        const Self *self = this->self_cast();
+        UZ count = self->get_count();
+        if (start > count) return (UZ)-1;
 
-        for (UZ i = 0; i < capacity; i++) {
-            if (OK_TAB_IS_OCCUPIED(meta[i])) {
-                new_table.put(keys[i], values[i]);
-            }
-        }
+        const Other *other = needle.self_cast();
+        UZ idx = simd_find_bytes((const U8*)self->get_items() + start, count - start,
+                                 (const U8*)other->get_items(), other->get_count());
+        return idx == (UZ)-1 ? idx : idx + start;
+    }
 
-        return new_table;
+    // Index of the last occurrence of `needle`, or `(UZ)-1`.
+    template <typename Other, typename OtherChar>
+    inline UZ rfind(const StringBase<Other, OtherChar>& needle) const {
+        const Self *self = this->self_cast();
+        const Other *other = needle.self_cast();
+        return simd_rfind_bytes((const U8*)self->get_items(), self->get_count(),
+                                (const U8*)other->get_items(), other->get_count());
     }
 
-    inline U8 load_percentage() const {
-        return (U8)((double)(count * 100) / (double)capacity);
+    // Index of the first char at or after `start` that is in one of `classes`, or `(UZ)-1`.
+    inline UZ find_first_of(CharClass classes, UZ start = 0) const {
+        const Self *self = this->self_cast();
+        UZ count = self->get_count();
+        if (start >= count) return (UZ)-1;
+
+        UZ idx = find_first_of_class(self->get_items() + start, count - start, classes);
+        return idx == (UZ)-1 ? idx : idx + start;
     }
 
-    void dealloc() {
-        if (allocator == nullptr) return;
+    inline UZ find_first_not_of(CharClass classes, UZ start = 0) const {
+        const Self *self = this->self_cast();
+        UZ count = self->get_count();
+        if (start >= count) return (UZ)-1;
 
-        allocator->dealloc(meta, capacity);
-        allocator->dealloc(keys, capacity);
-        allocator->dealloc(values, capacity);
+        UZ idx = find_first_not_of_class(self->get_items() + start, count - start, classes);
+        return idx == (UZ)-1 ? idx : idx + start;
+    }
 
-        memset(this, 0, sizeof(*this));
+    inline UZ find_last_not_of(CharClass classes) const {
+        const Self *self = this->self_cast();
+        return find_last_not_of_class(self->get_items(), self->get_count(), classes);
     }
 
-    TKey* keys;
-    TValue* values;
-    U8* meta;
-    UZ count;
-    UZ capacity;
-    Allocator* allocator;
+    // ASCII letters compare without case, every other byte has to match exactly.
+    template <typename Other, typename OtherChar>
+    inline bool eq_ignore_case(const StringBase<Other, OtherChar>& other) const {
+        const Self *self = this->self_cast();
+        UZ count = self->get_count();
+        if (count != other.self_cast()->get_count()) return false;
+
+        return ascii_eq_ignore_case(self->get_items(), other.self_cast()->get_items(), count);
+    }
+
+    // Lexicographic, bytes compare as unsigned.
+    template <typename Other, typename OtherChar>
+    inline int operator <=>(const StringBase<Other, OtherChar>& other) const {
+        const Self *self = this->self_cast();
+        UZ self_count = self->get_count();
+        UZ other_count = other.self_cast()->get_count();
+
+        int result = simd_compare(self->get_items(), other.self_cast()->get_items(), min(self_count, other_count));
+        if (result != 0) return result;
+
+        if (self_count < other_count) return -1;
+        if (self_count > other_count) return 1;
+        return 0;
+    }
+
+    template <typename Other, typename OtherChar>
+    inline bool operator ==(const StringBase<Other, OtherChar>& other) const {
+        const Self *self = this->self_cast();
+        UZ self_count = self->get_count();
+        UZ other_count = other.self_cast()->get_count();
+
+        if (self_count != other_count) return false;
+
+        return simd_equal(self->get_items(), other.self_cast()->get_items(), self_count);
+    }
 };
 
-#define OK_SET_GROWTH_FACTOR OK_TABLE_GROWTH_FACTOR
+struct CharSplitter;
+struct StringSplitter;
+struct LineSplitter;
+template <typename F>
+struct PredicateSplitter;
 
-template <typename T>
-struct Set {
-    using Meta = U8;
+struct StringView : public StringBase<StringView, const char> {
+    StringView() = default;
 
-    static constexpr UZ DEFAULT_CAPACITY = 47;
+    constexpr StringView(const char* data, UZ count) : data{data}, count{count} {}
+    explicit StringView(const char* cstr) : StringView{cstr, strlen(cstr)} {}
 
-    static Set<T> alloc(Allocator* a, UZ capacity = DEFAULT_CAPACITY);
+    String to_string(Allocator* a) const;
 
-    void put(const T& elem);
-    bool has(const T& elem) const;
+    inline StringView view(UZ start, UZ end) const {
+        OK_ASSERT(end >= start);
+        return StringView{data + start, end - start};
+    }
 
-    inline U8 load_percentage() const {
-        return (U8)(100.0 * (double)count / (double)capacity);
+    inline StringView view(UZ start) const {
+        return view(start, count);
     }
 
-    Allocator* allocator;
-    UZ capacity;
+    // Without whitespace, as in `is_whitespace`, at the start, the end or both.
+    inline StringView trim_start() const {
+        UZ start = find_first_not_of(CHAR_WHITESPACE);
+        return start == (UZ)-1 ? StringView{data + count, 0} : view(start);
+    }
+
+    inline StringView trim_end() const {
+        UZ last = find_last_not_of(CHAR_WHITESPACE);
+        return last == (UZ)-1 ? StringView{data, 0} : view(0, last + 1);
+    }
+
+    inline StringView trim() const {
+        return trim_start().trim_end();
+    }
+
+    // Splitting without copying, the parts are views into this one. See the splitters below.
+    CharSplitter split(char delimiter) const;
+    StringSplitter split(StringView delimiter) const;
+    LineSplitter lines() const;
+
+    template <typename F>
+    PredicateSplitter<F> split_by(F is_separator) const;
+
+    PredicateSplitter<bool (*)(char)> split_whitespace() const;
+
+    inline UZ get_count() const {
+        return count;
+    }
+
+    inline const char* get_items() const {
+        return data;
+    }
+
+    const char* data;
     UZ count;
-    T* values;
-    U8* meta;
 };
 
-// SUBPROCESS API
-struct Command {
-    enum class ExecError {
-        TOO_BIG,
-        ACCESS_DENIED,
-        PROCESS_LIMIT_EXCEEDED,
-        INVALID_EXECUTABLE,
-        IO,
-        LOOP,
-        TOO_MANY_FILES,
-        EXECUTABLE_NOT_FOUND,
-        KERNEL_OUT_OF_MEMORY,
-        INVALID_PATH,
-        BUSY,
-        TERMINATED_BY_SIGNAL,
-        STOPPED,
-        PROCESS_OPEN_FILE_LIMIT_REACHED,
-        SYSTEM_OPEN_FILE_LIMIT_REACHED,
-        OUT_OF_SPACE,
-    };
+inline namespace literals {
+constexpr StringView operator ""_sv(const char* cstr, unsigned long len) {
+    return StringView{cstr, len};
+}
+};
 
-    static Command alloc(Allocator* allocator, const char* name) {
-        Command cmd;
-        cmd.allocator = allocator;
-        cmd.name = name;
-        cmd.args = List<char*>::alloc(allocator);
-        cmd.envs = List<char*>::alloc(allocator);
+// Splits around every `delimiter`, so `n` delimiters make `n + 1` parts, and empty ones are
+// kept: "a,,b" has three and "" has one.
+//
+//     for (CharSplitter it = line.split(','); it.valid(); it.next()) use(it.part());
+struct CharSplitter {
+    static CharSplitter from(StringView source, char delimiter);
 
-        char* name_copy = allocator->strdup(name);
-        cmd.args.push(name_copy);
+    inline bool valid() const {
+        return has_part;
+    }
 
-        return cmd;
+    inline StringView part() const {
+        return current;
     }
 
-    Command& arg(const char* arg) {
-        if (arg != nullptr) {
-            char* arg_copy = allocator->strdup(arg);
-            args.push(arg_copy);
-        } else {
-            args.push(nullptr);
-        }
+    void next();
 
-        return *this;
+    StringView source;
+    StringView current;
+    // Where the part after `current` starts.
+    UZ position;
+    // The delimiters in a window of bytes starting at `window`, already found with a few vector
+    // compares, so short parts don't scan the same bytes over and over.
+    UZ window;
+    U64 mask;
+    char delimiter;
+    bool has_part;
+    // `current` is the last part.
+    bool finished;
+};
+
+// The same, with a delimiter of any length.
+struct StringSplitter {
+    inline bool valid() const {
+        return has_part;
     }
 
-    Command& env(const char* env) {
-        if (env != nullptr) {
-            char* env_copy = allocator->strdup(env);
-            envs.push(env_copy);
+    inline StringView part() const {
+        return current;
+    }
+
+    inline void next() {
+        if (finished) {
+            has_part = false;
+            return;
+        }
+
+        UZ idx = source.find(delimiter, position);
+        if (idx == (UZ)-1) {
+            current = source.view(position);
+            finished = true;
         } else {
-            envs.push(nullptr);
+            current = source.view(position, idx);
+            position = idx + delimiter.count;
         }
+    }
 
-        return *this;
+    StringView source;
+    StringView delimiter;
+    StringView current;
+    UZ position;
+    bool has_part;
+    bool finished;
+};
+
+// Runs of chars for which `is_separator` is false. Separators at the ends and repeated ones
+// don't make empty parts, so this tokenizes: "  a  b " has two.
+template <typename F>
+struct PredicateSplitter {
+    inline bool valid() const {
+        return has_part;
     }
 
-    Command& set_stdin(StringView data) {
-        Slice<U8> data_as_slice{(U8*)data.data, data.count};
-        stdin_data = data_as_slice.copy(allocator);
-        return *this;
+    inline StringView part() const {
+        return current;
     }
 
-    Command& set_stdin(Slice<U8> data) {
-        stdin_data = data.copy(allocator);
-        return *this;
+    inline void next() {
+        UZ i = position;
+        while (i < source.count && is_separator(source.data[i])) i++;
+        if (i == source.count) {
+            has_part = false;
+            return;
+        }
+
+        UZ start = i;
+        while (i < source.count && !is_separator(source.data[i])) i++;
+        current = source.view(start, i);
+        position = i;
     }
 
-    Optional<ExecError> exec();
+    StringView source;
+    StringView current;
+    UZ position;
+    F is_separator;
+    bool has_part;
+};
 
-    Allocator* allocator;
-    const char* name;
-    List<char*> args;
-    List<char*> envs;
+// Lines ending with "\n" or "\r\n", which isn't part of them. A newline at the very end doesn't
+// start another, empty line, and empty text has no lines at all.
+struct LineSplitter {
+    inline bool valid() const {
+        return lines.valid() && !(lines.finished && lines.current.count == 0);
+    }
 
-    int exit_code;
-    int term_signal_num;
-    int stop_signal_num;
+    inline StringView part() const {
+        StringView line = lines.part();
+        if (!lines.finished && line.count > 0 && line.data[line.count - 1] == '\r') line.count--;
+        return line;
+    }
 
-    Slice<U8> stdin_data{};
+    inline void next() {
+        lines.next();
+    }
+
+    CharSplitter lines;
 };
 
-// HASH IMPLEMENTATION
-template <typename T>
-bool operator ==(const HashPtr<T>& lhs, const HashPtr<T>& rhs) {
-    return *lhs.value == *rhs.value;
+inline CharSplitter StringView::split(char delimiter) const {
+    return CharSplitter::from(*this, delimiter);
 }
 
-// ARRAY BASE IMPLEMENTATION
-template <typename Self, typename T>
-Slice<T> ArrayBase<Self, T>::slice(UZ start, UZ end) {
-    auto* self = self_cast();
-    UZ count = self->get_count();
-
-    OK_ASSERT(start <= count);
-    OK_ASSERT(end >= start);
-    OK_ASSERT(end <= count);
+inline StringSplitter StringView::split(StringView delimiter) const {
+    OK_ASSERT(delimiter.count > 0);
+
+    StringSplitter splitter;
+    splitter.source = *this;
+    splitter.delimiter = delimiter;
+    splitter.position = 0;
+    splitter.has_part = true;
+    splitter.finished = false;
+    splitter.next();
+    return splitter;
+}
 
-    return Slice<T>{self->get_items() + start, end - start};
+inline LineSplitter StringView::lines() const {
+    return LineSplitter{CharSplitter::from(*this, '\n')};
 }
 
-template <typename Self, typename T>
-Slice<T> ArrayBase<Self, T>::slice(UZ start) {
-    auto* self = self_cast();
-    return slice(start, self->get_count());
+template <typename F>
+inline PredicateSplitter<F> StringView::split_by(F is_separator) const {
+    PredicateSplitter<F> splitter{*this, StringView{}, 0, is_separator, true};
+    splitter.next();
+    return splitter;
 }
 
-template <typename Self, typename T>
-Slice<T> ArrayBase<Self, T>::slice() {
-    auto* self = self_cast();
-    return slice(0, self->get_count());
+inline PredicateSplitter<bool (*)(char)> StringView::split_whitespace() const {
+    return split_by(is_whitespace);
 }
 
-template <typename Self, typename T>
-Slice<const T> ArrayBase<Self, T>::slice(UZ start, UZ end) const {
-    auto* self = self_cast();
-    UZ count = self->get_count();
+// Strings of up to `SMALL_CAPACITY` chars are stored inline, in place of the pointer,
+// count and capacity of the heap representation, and don't allocate at all. The last byte
+// of that space tells the two apart: it holds the count of a small string and has its high
+// bit set for a heap one.
+//
+// NOTE: `cstr()`, `view()` and `get_items()` of a small string point into the `String`
+// itself, so they are only valid for as long as that particular `String` is.
+struct String : public StringBase<String, char> {
+    static constexpr char NULL_CHAR = '\0';
+    static constexpr UZ DEFAULT_CAPACITY = 7;
 
-    OK_ASSERT(start <= count);
-    OK_ASSERT(end >= start);
-    OK_ASSERT(end <= count);
+    struct HeapRep {
+        char* items;
+        UZ count;
+        // See `HEAP_TAG`.
+        UZ tagged_capacity;
+    };
 
-    return Slice<const T>{self->get_items() + start, end - start};
-}
+    static constexpr UZ TAG_INDEX = sizeof(HeapRep) - 1;
+    static constexpr UZ SMALL_CAPACITY = sizeof(HeapRep) - 2;
 
-template <typename Self, typename T>
-Slice<const T> ArrayBase<Self, T>::slice(UZ start) const {
-    auto* self = self_cast();
-    return slice(start, self->get_count());
-}
+    // Sets the high bit of both the first and the last byte of `tagged_capacity`, so the tag
+    // byte is marked whatever the byte order. The capacity itself is kept above those bits.
+    static constexpr UZ HEAP_TAG_HIGH = (UZ)1 << (sizeof(UZ) * 8 - 1);
+    static constexpr UZ HEAP_TAG = HEAP_TAG_HIGH | 0x80;
 
-template <typename Self, typename T>
-Slice<const T> ArrayBase<Self, T>::slice() const {
-    auto* self = self_cast();
-    return slice(0, self->get_count());
-}
+    static String alloc(Allocator* a, UZ capacity = DEFAULT_CAPACITY);
 
-// LIST IMPLEMENTATION
-template <typename T>
-List<T> List<T>::alloc(Allocator* a, UZ cap) {
-    List<T> list{};
-    list.items = a->alloc<T>(cap);
-    list.count = 0;
-    list.capacity = cap;
-    list.allocator = a;
+    static String alloc(Allocator* a, const char* data, UZ data_len);
+    static String alloc(Allocator* a, const char* data);
 
-    return list;
-}
+    static String from(List<U8>);
+    static String from(List<char>);
+    static String from_cstr_set_allocator(Allocator*, char*, UZ);
 
-template <typename T>
-void List<T>::push(const T& item) {
-    if (count >= capacity) {
-        UZ new_capacity = OK_LIST_GROW_FACTOR(capacity);
-        items = allocator->resize<T>(items, capacity, new_capacity);
-        capacity = new_capacity;
-    }
+    static String format(Allocator* a, const char* fmt, ...) OK_ATTRIBUTE_PRINTF(2, 3);
 
-    items[count++] = item;
-}
+    void append(const char* chars, UZ chars_count);
+    void append(StringView);
+    void append(String);
 
-template <typename T>
-inline void List<T>::remove_at(UZ idx) {
-    OK_ASSERT(idx < count);
+    void format_append(const char*, ...) OK_ATTRIBUTE_PRINTF(2, 3);
 
-    for (UZ i = idx; i < count - 1; i++) {
-        items[i] = items[i + 1];
+    inline bool is_small() const {
+        return ((U8)small[TAG_INDEX] & 0x80) == 0;
     }
 
-    count--;
-}
+    inline const char* cstr() const {
+        return get_items();
+    }
 
-template <typename T>
-inline List<T> List<T>::copy(Allocator* a, UZ start, UZ end) const {
-    OK_ASSERT(end >= start);
+    inline StringView view(UZ start, UZ end) const {
+        UZ c = count();
+        if (c == 0) {
+            return StringView{"", 0};
+        }
 
-    auto res = List<T>::alloc(a, end - start);
-    for (UZ i = start; i < end; i++) {
-        res.push(items[i]);
+        OK_ASSERT(start < c);
+        OK_ASSERT(end >= start);
+
+        return StringView{get_items() + start, end - start};
     }
-    return res;
-}
 
-template <typename T>
-inline void List<T>::extend(List<T> other) {
-    reserve(capacity + other.capacity);
+    inline StringView view(UZ start) const {
+        return view(start, count());
+    }
 
-    for (UZ i = 0; i < other.count; i++) {
-        push(other.items[i]);
+    inline StringView view() const {
+        return view(0, count());
     }
-}
 
-template <typename T>
-inline void List<T>::reserve(UZ new_cap) {
-    if (new_cap <= capacity) {
-        return;
+    inline String copy(Allocator* a) const {
+        return String::alloc(a, get_items(), count());
     }
 
-    items = allocator->resize<T>(items, capacity, new_cap);
-    capacity = new_cap;
-}
+    // In place, see `ascii_to_lower`.
+    inline void to_lower() {
+        ascii_to_lower(get_items(), count());
+    }
 
-// TABLE IMPLEMENTATION
-template <typename K, typename V>
-Table<K, V> Table<K, V>::alloc(Allocator* a, UZ capacity) {
-    Table<K, V> tab{};
+    inline void to_upper() {
+        ascii_to_upper(get_items(), count());
+    }
 
-    tab.keys = a->alloc<K>(capacity);
-    tab.values = a->alloc<V>(capacity);
-    tab.meta = a->alloc<Meta>(capacity);
-    tab.count = 0;
-    tab.capacity = capacity;
-    tab.allocator = a;
+    inline void push(char character) {
+        UZ c = count();
+        if (c == get_capacity()) reserve(max(c + 1, OK_LIST_GROW_FACTOR(c)));
 
-    return tab;
-}
+        char* items = get_items();
+        items[c] = character;
+        items[c + 1] = NULL_CHAR;
+        set_count(c + 1);
+    }
 
-template <typename K, typename V>
-void Table<K, V>::put(const K& key, const V& value) {
-    if (load_percentage() >= 70) {
-        auto copied = copy(allocator);
-        this->dealloc();
-        *this = copied;
+    // Makes room for `chars` chars, not counting the null terminator.
+    void reserve(UZ chars);
+
+    // Makes room for `extra` more chars, growing geometrically so that repeated appends
+    // stay amortized O(1).
+    inline void reserve_extra(UZ extra) {
+        UZ needed = count() + extra;
+        UZ capacity = get_capacity();
+        if (needed > capacity) reserve(max(needed, OK_LIST_GROW_FACTOR(capacity)));
     }
 
-    U64 idx = Hash<K>::hash(key) % capacity;
+    // Only updates the count, the chars up to `new_count` have to be filled in already.
+    inline void set_count(UZ new_count) {
+        OK_ASSERT(new_count <= get_capacity());
 
-    while (true) {
-        if (OK_TAB_IS_FREE(meta[idx])) {
-            meta[idx] |= OK_TAB_META_OCCUPIED;
-            values[idx] = value;
-            keys[idx] = key;
-            count++;
-            return;
+        if (is_small()) {
+            small[TAG_INDEX] = (char)new_count;
+        } else {
+            heap.count = new_count;
         }
+        get_items()[new_count] = NULL_CHAR;
+    }
 
-        if (keys[idx] == key) {
-            values[idx] = value;
-            keys[idx] = key;
-            return;
-        }
+    inline UZ get_capacity() const {
+        return is_small() ? SMALL_CAPACITY : (heap.tagged_capacity & ~HEAP_TAG_HIGH) >> 8;
+    }
 
-        idx = (idx + 1) % capacity;
+    inline void set_heap(char* items, UZ count, UZ capacity) {
+        heap.items = items;
+        heap.count = count;
+        heap.tagged_capacity = (capacity << 8) | HEAP_TAG;
     }
-}
 
-template <typename K, typename V>
-Optional<V> Table<K, V>::get(const K& key) const {
-    U64 idx = Hash<K>::hash(key) % capacity;
-    U64 initial_idx = idx;
+    inline UZ count() const {
+        return is_small() ? (UZ)(U8)small[TAG_INDEX] : heap.count;
+    }
 
-    do {
-        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
-            return values[idx];
-        }
+    inline UZ get_count() const {
+        return count();
+    }
 
-        idx = (idx + 1) % capacity;
-    } while (idx != initial_idx);
+    inline char* get_items() const {
+        return is_small() ? const_cast<char*>(small) : heap.items;
+    }
 
-    return Optional<V>::empty();
-}
+    void dealloc() {
+        if (!is_small() && allocator != nullptr) allocator->dealloc<char>(heap.items, get_capacity() + 1);
+        memset((void*)small, 0, sizeof(small));
+    }
 
-template <typename TKey, typename TValue>
-template <typename K>
-Optional<TValue> Table<TKey, TValue>::get(const K& key) const {
-    U64 idx = Hash<K>::hash(key) % capacity;
-    U64 initial_idx = idx;
+    union {
+        HeapRep heap;
+        char small[sizeof(HeapRep)];
+    };
+    Allocator* allocator;
+};
 
-    do {
-        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
-            return values[idx];
+// Collects text in chunks taken from `allocator`, so appending never moves what has
+// already been written, and `finish` copies all of it into a single `String` at the end.
+// Chunks start at `chunk_size` bytes and double up to `MAX_CHUNK_SIZE`.
+struct StringBuilder {
+    static constexpr UZ DEFAULT_CHUNK_SIZE = 4096;
+    static constexpr UZ MAX_CHUNK_SIZE = 1024 * 1024;
+
+    struct Chunk {
+        inline char* chars() {
+            return reinterpret_cast<char*>(this + 1);
         }
 
-        idx = (idx + 1) % capacity;
-    } while (idx != initial_idx);
+        Chunk* next;
+        UZ size;
+        UZ used;
+    };
 
-    return Optional<TValue>::empty();
-}
+    static StringBuilder alloc(Allocator* a, UZ chunk_size = DEFAULT_CHUNK_SIZE);
 
-template <typename K, typename V>
-Optional<V&> Table<K, V>::get_ref(const K& key) {
-    U64 idx = Hash<K>::hash(key) % capacity;
-    U64 initial_idx = idx;
+    void append(const char* chars, UZ chars_count);
 
-    do {
-        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
-            return values[idx];
+    inline void append(StringView sv) {
+        append(sv.data, sv.count);
+    }
+
+    inline void append(const String& string) {
+        append(string.get_items(), string.count());
+    }
+
+    inline void push(char c) {
+        if (tail != nullptr && tail->used < tail->size) {
+            tail->chars()[tail->used++] = c;
+            count++;
+        } else {
+            append(&c, 1);
         }
+    }
 
-        idx = (idx + 1) % capacity;
-    } while (idx != initial_idx);
+    void format_append(const char*, ...) OK_ATTRIBUTE_PRINTF(2, 3);
 
-    return Optional<V&>::empty();
-}
+    // Returns room for at least `max_count` contiguous chars. Follow up with `commit` and
+    // the number of chars actually written.
+    char* begin_write(UZ max_count);
 
-template <typename K, typename V>
-Optional<const V&> Table<K, V>::get_ref(const K& key) const {
-    U64 idx = Hash<K>::hash(key) % capacity;
-    U64 initial_idx = idx;
+    inline void commit(UZ written) {
+        OK_ASSERT(tail != nullptr && tail->used + written <= tail->size);
+        tail->used += written;
+        count += written;
+    }
 
-    do {
-        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
-            return values[idx];
+    // Calls `f(StringView)` for the contents of every chunk, in order.
+    template <typename F>
+    void for_each_chunk(F f) const {
+        for (Chunk* chunk = head; chunk != nullptr; chunk = chunk->next) {
+            if (chunk->used > 0) f(StringView{chunk->chars(), chunk->used});
         }
+    }
 
-        idx = (idx + 1) % capacity;
-    } while (idx != initial_idx);
+    inline UZ get_count() const {
+        return count;
+    }
 
-    return Optional<const V&>::empty();
-}
+    // Copies everything written so far into a `String` taken from `a`.
+    String finish(Allocator* a) const;
 
-template <typename TKey, typename TValue>
-template <typename K>
-Optional<TValue&> Table<TKey, TValue>::get_ref(const K& key) {
-    U64 idx = Hash<K>::hash(key) % capacity;
-    U64 initial_idx = idx;
+    // Keeps the chunks around for reuse.
+    void clear();
 
-    do {
-        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
-            return values[idx];
-        }
+    Chunk* new_chunk(UZ min_size);
 
-        idx = (idx + 1) % capacity;
-    } while (idx != initial_idx);
+    void dealloc();
 
-    return Optional<TValue&>::empty();
-}
+    Chunk* head;
+    Chunk* tail;
+    UZ next_chunk_size;
+    UZ count;
+    Allocator* allocator;
+};
 
-template <typename TKey, typename TValue>
-template <typename K>
-Optional<const TValue&> Table<TKey, TValue>::get_ref(const K& key) const {
-    U64 idx = Hash<K>::hash(key) % capacity;
-    U64 initial_idx = idx;
+template <template <typename> class Self, typename T>
+struct OptionalBase {
+    static Self<T> empty() {
+        U8 buf[sizeof(Self<T>)] = {};
+        Self<T> *opt = reinterpret_cast<Self<T> *>(buf);
+        return *opt;
+    }
 
-    do {
-        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
-            return values[idx];
-        }
+    const T& or_else(const T& other) const {
+        auto* self = self_cast();
 
-        idx = (idx + 1) % capacity;
-    } while (idx != initial_idx);
+        if (self->has_value()) return self->get_unchecked();
+        return other;
+    }
 
-    return Optional<const TValue&>::empty();
-}
+    T& or_else(T& other) {
+        auto* self = self_cast();
 
-template <typename K, typename V>
-bool Table<K, V>::has(const K& key) const {
+        if (self->has_value(this)) return self->get_unchecked();
+        return other;
+    }
+
+    Self<T>* self_cast() {
+        return static_cast<Self<T>*>(this);
+    }
+
+    const Self<T>* self_cast() const {
+        return static_cast<const Self<T>*>(this);
+    }
+
+    template <typename O>
+    bool operator ==(const OptionalBase<Self, O>& other) const {
+        auto* lhs = self_cast();
+        auto* rhs = other.self_cast();
+        if (!lhs->has_value() && !rhs->has_value()) return true;
+
+        return lhs->has_value() && rhs->has_value() && lhs->get_unchecked() == rhs->get_unchecked();
+    }
+
+    explicit operator bool() const {
+        return self_cast()->has_value();
+    }
+};
+
+template <typename T>
+struct Optional : public OptionalBase<Optional, T> {
+    using ValueType = T;
+
+    Optional() : _has_value{false} {}
+
+    Optional(ValueType value) : _has_value{true}, value{value} {}
+
+    inline bool has_value() const {
+        return _has_value;
+    }
+
+    inline ValueType& get_unchecked() {
+        return value;
+    }
+
+    inline ValueType& get() {
+        OK_ASSERT(has_value());
+        return get_unchecked();
+    }
+
+    inline const ValueType& get_unchecked() const {
+        return value;
+    }
+
+    inline const ValueType& get() const {
+        OK_ASSERT(has_value());
+        return get_unchecked();
+    }
+
+    bool _has_value;
+    ValueType value;
+};
+
+template <typename T>
+struct Optional<T*> : public OptionalBase<Optional, T*> {
+    using ValueType = T*;
+
+    Optional() : value{nullptr} {}
+
+    Optional(ValueType value) : value{value} {}
+
+    inline bool has_value() const {
+        return value != nullptr;
+    }
+
+    inline ValueType& get_unchecked() {
+        return value;
+    }
+
+    inline ValueType& get() {
+        OK_ASSERT(has_value());
+        return get_unchecked();
+    }
+
+    inline const ValueType& get_unchecked() const {
+        return value;
+    }
+
+    inline const ValueType& get() const {
+        OK_ASSERT(has_value());
+        return get_unchecked();
+    }
+
+    template <typename Base>
+    inline Optional<Base*> upcast() {
+        return Optional<Base*>{static_cast<Base*>(value)};
+    }
+
+    template <typename Base>
+    inline Optional<const Base*> upcast() const {
+        return Optional<const Base*>{static_cast<const Base*>(value)};
+    }
+
+    ValueType value;
+};
+
+static_assert(sizeof(Optional<int*>) == sizeof(int*));
+
+template <typename A, typename B>
+struct Pair {
+    A a;
+    B b;
+};
+
+// NOTE(oleh): We need more hash implementations, or at least a better default.
+namespace hash {
+U64 fnv1(StringView);
+// MurmurHash64A, eight bytes per step.
+U64 murmur64(StringView, U64 seed = 0);
+};
+
+template <typename T>
+struct Hash {
+    static U64 hash(const T& value) {
+        // NOTE(oleh): Just make this a function, not a method.
+        return value.ok_hash_value();
+    }
+};
+
+template <typename T>
+struct HashPtr {
+    HashPtr(const T* v) : value{v} {}
+    // @Dead
+    HashPtr(T* v) : value{v} {}
+
+    inline bool operator ==(const T* ptr) const {
+        return *value == *ptr;
+    }
+
+    const T* value;
+};
+
+// NOTE(oleh): Remove these all in favor of `ok_hash_value`.
+
+// Default hash implementations
+// NOTE(oleh): Is this even needed?
+template <typename T>
+struct Hash<HashPtr<T>> {
+    static U64 hash(const HashPtr<T>& ptr) {
+        return Hash<T>::hash(*ptr.value);
+    }
+};
+
+template <typename T>
+struct Hash<T*> {
+    static U64 hash(const T* ptr) {
+        return reinterpret_cast<U64>(ptr);
+    }
+};
+
+template <typename T>
+struct Hash<const T*> {
+    static U64 hash(const T* ptr) {
+        return reinterpret_cast<U64>(ptr);
+    }
+};
+
+template <>
+struct Hash<U32> {
+    static U64 hash(const U32& val) {
+        return val;
+    }
+};
+
+template <>
+struct Hash<U64> {
+    static U64 hash(const U64& val) {
+        return val;
+    }
+};
+
+template <>
+struct Hash<StringView> {
+    static U64 hash(StringView sv) {
+        return ::ok::hash::fnv1(sv);
+    }
+};
+
+template <>
+struct Hash<String> {
+    static U64 hash(String string) {
+        return ::ok::hash::fnv1(string.view());
+    }
+};
+
+template <typename T>
+bool operator ==(const HashPtr<T>& lhs, const HashPtr<T>& rhs);
+
+#define OK_TAB_META_OCCUPIED 0x01
+#define OK_TAB_IS_OCCUPIED(meta) ((meta) & OK_TAB_META_OCCUPIED)
+#define OK_TAB_IS_FREE(meta) (!OK_TAB_IS_OCCUPIED((meta)))
+
+#define OK_TABLE_GROWTH_FACTOR(x) (((x) + 1) * 3)
+
+#define OK_TABLE_FOREACH(tab, key, value, code) do { \
+    for (UZ _tab_i = 0; _tab_i < (tab).capacity; _tab_i++) {\
+    if (OK_TAB_IS_FREE((tab).meta[_tab_i])) continue; \
+    auto key = (tab).keys[_tab_i]; \
+    auto value = (tab).values[_tab_i]; \
+    code; \
+    }\
+    } while (0)
+
+template <typename TKey, typename TValue>
+struct Table {
+    using Meta = U8;
+
+    static Table<TKey, TValue> alloc(Allocator* a, UZ capacity = Table::DEFAULT_CAPACITY);
+
+    void put(const TKey& key, const TValue& value);
+
+    // Moves the key and/or value into the table when they are passed as rvalues.
+    template <typename K, typename V>
+    requires is_same<RemoveCVRef<K>, TKey> && is_same<RemoveCVRef<V>, TValue>
+    void put(K&& key, V&& value);
+
+    // NOTE(oleh): Not sure if we need the `get_ref` methods.
+    // Also not sure if we shouldn't just keep the template overloads?
+    Optional<TValue> get(const TKey& key) const;
+
+    template <typename K>
+    Optional<TValue> get(const K& key) const;
+
+    Optional<TValue&> get_ref(const TKey& key);
+    Optional<const TValue&> get_ref(const TKey& key) const;
+
+    template <typename K>
+    Optional<TValue&> get_ref(const K& key);
+    template <typename K>
+    Optional<const TValue&> get_ref(const K& key) const;
+
+    bool has(const TKey& key) const;
+    template <typename K>
+    bool has(const K& key) const;
+
+    bool remove(const TKey&);
+
+    static constexpr UZ DEFAULT_CAPACITY = 47;
+
+    inline void clear() {
+        count = 0;
+        memset(meta, 0, sizeof(Meta) * capacity);
+    }
+
+    inline Table<TKey, TValue> copy(Allocator* copy_allocator) {
+        UZ new_table_capacity = OK_TABLE_GROWTH_FACTOR(capacity);
+        Table<TKey, TValue> new_table = Table<TKey, TValue>::alloc(copy_allocator, new_table_capacity);
+
+        for (UZ i = 0; i < capacity; i++) {
+            if (OK_TAB_IS_OCCUPIED(meta[i])) {
+                new_table.put(keys[i], values[i]);
+            }
+        }
+
+        return new_table;
+    }
+
+    inline U8 load_percentage() const {
+        return (U8)((double)(count * 100) / (double)capacity);
+    }
+
+    void grow();
+
+    void dealloc() {
+        if (allocator == nullptr) return;
+
+        allocator->dealloc(meta, capacity);
+        allocator->dealloc(keys, capacity);
+        allocator->dealloc(values, capacity);
+
+        memset(this, 0, sizeof(*this));
+    }
+
+    TKey* keys;
+    TValue* values;
+    U8* meta;
+    UZ count;
+    UZ capacity;
+    Allocator* allocator;
+};
+
+#define OK_SET_GROWTH_FACTOR OK_TABLE_GROWTH_FACTOR
+
+template <typename T>
+struct Set {
+    using Meta = U8;
+
+    static constexpr UZ DEFAULT_CAPACITY = 47;
+
+    static Set<T> alloc(Allocator* a, UZ capacity = DEFAULT_CAPACITY);
+
+    void put(const T& elem);
+    bool has(const T& elem) const;
+
+    inline U8 load_percentage() const {
+        return (U8)(100.0 * (double)count / (double)capacity);
+    }
+
+    Allocator* allocator;
+    UZ capacity;
+    UZ count;
+    T* values;
+    U8* meta;
+};
+
+// Ordered map as a B+ tree. Nodes are a few cache lines wide, so a lookup touches only a
+// handful of lines per level. All of the entries live in the leaves, which are linked
+// together for in-order iteration. Every node takes exactly `NODE_SIZE` bytes, so a
+// `PoolAllocator` with that block size is a good fit for `allocator`.
+template <typename K, typename V, typename Cmp = Less<K>>
+struct BTreeMap {
+    static constexpr UZ NODE_BYTES = 4 * OK_CACHE_LINE_SIZE;
+    static constexpr UZ LEAF_CAP = max((UZ)4, (NODE_BYTES - 2 * sizeof(void*)) / (sizeof(K) + sizeof(V)));
+    static constexpr UZ INNER_CAP = max((UZ)4, (NODE_BYTES - 2 * sizeof(void*)) / (sizeof(K) + sizeof(void*)));
+    static constexpr UZ LEAF_MIN = LEAF_CAP / 2;
+    static constexpr UZ INNER_MIN = (INNER_CAP - 1) / 2;
+
+    struct Node {
+        U16 count;
+        bool is_leaf;
+    };
+
+    struct Leaf : Node {
+        Leaf* next;
+        alignas(K) U8 key_storage[sizeof(K) * LEAF_CAP];
+        alignas(V) U8 value_storage[sizeof(V) * LEAF_CAP];
+
+        inline K* keys() {
+            return (K*)key_storage;
+        }
+
+        inline V* values() {
+            return (V*)value_storage;
+        }
+    };
+
+    // `children[i]` holds the keys below `keys[i]`, `children[count]` the rest.
+    struct Inner : Node {
+        alignas(K) U8 key_storage[sizeof(K) * INNER_CAP];
+        Node* children[INNER_CAP + 1];
+
+        inline K* keys() {
+            return (K*)key_storage;
+        }
+    };
+
+    static constexpr UZ NODE_SIZE = max(sizeof(Leaf), sizeof(Inner));
+
+    // `Value` is `V` for `Iterator` and `const V` for `ConstIterator`, which is what the
+    // const members hand out.
+    template <typename Value>
+    struct IteratorOf {
+        inline bool valid() const {
+            return leaf != nullptr;
+        }
+
+        inline const K& key() const {
+            return leaf->keys()[idx];
+        }
+
+        inline const V& value() const {
+            return leaf->values()[idx];
+        }
+
+        inline Value& value() {
+            return leaf->values()[idx];
+        }
+
+        inline void next() {
+            if (++idx == leaf->count) {
+                leaf = leaf->next;
+                idx = 0;
+            }
+        }
+
+        Leaf* leaf;
+        UZ idx;
+    };
+
+    using Iterator = IteratorOf<V>;
+    using ConstIterator = IteratorOf<const V>;
+
+    static BTreeMap<K, V, Cmp> alloc(Allocator* a);
+
+    // Builds the tree bottom-up in O(n). `keys` must be sorted and free of duplicates.
+    static BTreeMap<K, V, Cmp> from_sorted(Allocator* a, Slice<const K> keys, Slice<const V> values);
+
+    void put(const K& key, const V& value);
+
+    template <typename KK, typename VV>
+    requires is_same<RemoveCVRef<KK>, K> && is_same<RemoveCVRef<VV>, V>
+    void put(KK&& key, VV&& value);
+
+    Optional<V> get(const K& key) const;
+    Optional<V&> get_ref(const K& key);
+    bool has(const K& key) const;
+
+    bool remove(const K& key);
+
+    ConstIterator begin() const;
+
+    inline Iterator begin() {
+        return to_mutable(static_cast<const BTreeMap*>(this)->begin());
+    }
+
+    // The first entry whose key is not less than `key`.
+    ConstIterator lower_bound(const K& key) const;
+
+    inline Iterator lower_bound(const K& key) {
+        return to_mutable(static_cast<const BTreeMap*>(this)->lower_bound(key));
+    }
+
+    // The first entry whose key is greater than `key`.
+    ConstIterator upper_bound(const K& key) const;
+
+    inline Iterator upper_bound(const K& key) {
+        return to_mutable(static_cast<const BTreeMap*>(this)->upper_bound(key));
+    }
+
+    // Calls `f(key, value)` for every entry with `lo <= key < hi`, in order.
+    template <typename F>
+    void for_each_in_range(const K& lo, const K& hi, F f) const;
+
+    template <typename F>
+    void for_each_in_range(const K& lo, const K& hi, F f);
+
+    inline UZ get_count() const {
+        return count;
+    }
+
+    void dealloc();
+
+    static inline bool equal(const K& a, const K& b) {
+        return !Cmp::less(a, b) && !Cmp::less(b, a);
+    }
+
+    static UZ lower_bound_in(const K* keys, UZ n, const K& key);
+    static UZ upper_bound_in(const K* keys, UZ n, const K& key);
+
+    Leaf* new_leaf();
+    Inner* new_inner();
+    void free_node(Node* node);
+    void destroy_subtree(Node* node);
+
+    inline bool is_full(Node* node) const {
+        return node->count == (node->is_leaf ? LEAF_CAP : INNER_CAP);
+    }
+
+    inline bool is_underfull(Node* node) const {
+        return node->count < (node->is_leaf ? LEAF_MIN : INNER_MIN);
+    }
+
+    static inline Iterator to_mutable(ConstIterator it) {
+        return Iterator{it.leaf, it.idx};
+    }
+
+    Leaf* find_leaf(const K& key) const;
+    void split_child(Inner* parent, UZ idx);
+    bool remove_from(Node* node, const K& key);
+    void rebalance(Inner* parent, UZ idx);
+    void merge_children(Inner* parent, UZ idx);
+
+    Node* build_level(Slice<const K> keys, Slice<const V> values, const UZ* level_counts, UZ level, UZ idx, Leaf** prev_leaf);
+
+    Node* root;
+    UZ count;
+    Allocator* allocator;
+};
+
+// Generational reference into a `SlotMap`. The low 32 bits are the slot index and the high
+// 32 the generation of that slot when the value was inserted. Live generations are always
+// odd, so a zeroed handle never refers to anything.
+struct SlotHandle {
+    inline U32 index() const {
+        return (U32)bits;
+    }
+
+    inline U32 generation() const {
+        return (U32)(bits >> 32);
+    }
+
+    inline bool operator==(const SlotHandle& other) const {
+        return bits == other.bits;
+    }
+
+    U64 bits;
+};
+
+template <>
+struct Hash<SlotHandle> {
+    static U64 hash(const SlotHandle& handle) {
+        return Hash<U64>::hash(handle.bits);
+    }
+};
+
+// Values are packed densely, so iterating is a linear scan over `values`, and the slots
+// map handles to positions in it. Removing swaps the last value into the hole, so
+// positions change but handles stay valid until their own value is removed. Freed slots
+// are reused, with a bumped generation so that stale handles are rejected.
+template <typename T>
+struct SlotMap {
+    static constexpr U32 NO_SLOT = (U32)-1;
+
+    struct Slot {
+        U32 generation;
+        // Position in `values` while occupied, the next free slot otherwise.
+        U32 dense_or_next_free;
+    };
+
+    static SlotMap<T> alloc(Allocator* a, UZ capacity = List<T>::DEFAULT_CAP);
+
+    SlotHandle insert(const T& value);
+    SlotHandle insert(T&& value);
+
+    // Returns false if the handle is stale.
+    bool remove(SlotHandle handle);
+
+    inline bool has(SlotHandle handle) const {
+        UZ idx = handle.index();
+        return idx < slots.count && slots.items[idx].generation == handle.generation() && (handle.generation() & 1);
+    }
+
+    Optional<T> get(SlotHandle handle) const;
+    Optional<T&> get_ref(SlotHandle handle);
+
+    // Handle of the value at position `dense_idx` in `values`.
+    inline SlotHandle handle_at(UZ dense_idx) const {
+        OK_ASSERT(dense_idx < values.count);
+        U32 slot = dense_to_slot.items[dense_idx];
+        return SlotHandle{((U64)slots.items[slot].generation << 32) | slot};
+    }
+
+    inline UZ get_count() const {
+        return values.count;
+    }
+
+    void clear();
+
+    SlotHandle claim_slot();
+
+    void dealloc() {
+        values.dealloc();
+        dense_to_slot.dealloc();
+        slots.dealloc();
+    }
+
+    List<T> values;
+    List<U32> dense_to_slot;
+    List<Slot> slots;
+    U32 free_head;
+};
+
+// SUBPROCESS API
+struct Command {
+    enum class ExecError {
+        TOO_BIG,
+        ACCESS_DENIED,
+        PROCESS_LIMIT_EXCEEDED,
+        INVALID_EXECUTABLE,
+        IO,
+        LOOP,
+        TOO_MANY_FILES,
+        EXECUTABLE_NOT_FOUND,
+        KERNEL_OUT_OF_MEMORY,
+        INVALID_PATH,
+        BUSY,
+        TERMINATED_BY_SIGNAL,
+        STOPPED,
+        PROCESS_OPEN_FILE_LIMIT_REACHED,
+        SYSTEM_OPEN_FILE_LIMIT_REACHED,
+        OUT_OF_SPACE,
+    };
+
+    // Most commands get a handful of arguments and no environment at all (the list
+    // only holds the terminating null), so keep those inline.
+    static constexpr UZ INLINE_ARGS = 6;
+    static constexpr UZ INLINE_ENVS = 2;
+
+    static Command alloc(Allocator* allocator, const char* name) {
+        Command cmd;
+        cmd.allocator = allocator;
+        cmd.name = name;
+        cmd.args = SmallList<char*, INLINE_ARGS>::alloc(allocator);
+        cmd.envs = SmallList<char*, INLINE_ENVS>::alloc(allocator);
+
+        char* name_copy = allocator->strdup(name);
+        cmd.args.push(name_copy);
+
+        return cmd;
+    }
+
+    Command& arg(const char* arg) {
+        if (arg != nullptr) {
+            char* arg_copy = allocator->strdup(arg);
+            args.push(arg_copy);
+        } else {
+            args.push(nullptr);
+        }
+
+        return *this;
+    }
+
+    Command& env(const char* env) {
+        if (env != nullptr) {
+            char* env_copy = allocator->strdup(env);
+            envs.push(env_copy);
+        } else {
+            envs.push(nullptr);
+        }
+
+        return *this;
+    }
+
+    Command& set_stdin(StringView data) {
+        Slice<U8> data_as_slice{(U8*)data.data, data.count};
+        stdin_data = data_as_slice.copy(allocator);
+        return *this;
+    }
+
+    Command& set_stdin(Slice<U8> data) {
+        stdin_data = data.copy(allocator);
+        return *this;
+    }
+
+    Optional<ExecError> exec();
+
+    Allocator* allocator;
+    const char* name;
+    SmallList<char*, INLINE_ARGS> args;
+    SmallList<char*, INLINE_ENVS> envs;
+
+    int exit_code;
+    int term_signal_num;
+    int stop_signal_num;
+
+    Slice<U8> stdin_data{};
+};
+
+// HASH IMPLEMENTATION
+template <typename T>
+bool operator ==(const HashPtr<T>& lhs, const HashPtr<T>& rhs) {
+    return *lhs.value == *rhs.value;
+}
+
+// ARRAY BASE IMPLEMENTATION
+template <typename Self, typename T>
+Slice<T> ArrayBase<Self, T>::slice(UZ start, UZ end) {
+    auto* self = self_cast();
+    UZ count = self->get_count();
+
+    OK_ASSERT(start <= count);
+    OK_ASSERT(end >= start);
+    OK_ASSERT(end <= count);
+
+    return Slice<T>{self->get_items() + start, end - start};
+}
+
+template <typename Self, typename T>
+Slice<T> ArrayBase<Self, T>::slice(UZ start) {
+    auto* self = self_cast();
+    return slice(start, self->get_count());
+}
+
+template <typename Self, typename T>
+Slice<T> ArrayBase<Self, T>::slice() {
+    auto* self = self_cast();
+    return slice(0, self->get_count());
+}
+
+template <typename Self, typename T>
+Slice<const T> ArrayBase<Self, T>::slice(UZ start, UZ end) const {
+    auto* self = self_cast();
+    UZ count = self->get_count();
+
+    OK_ASSERT(start <= count);
+    OK_ASSERT(end >= start);
+    OK_ASSERT(end <= count);
+
+    return Slice<const T>{self->get_items() + start, end - start};
+}
+
+template <typename Self, typename T>
+Slice<const T> ArrayBase<Self, T>::slice(UZ start) const {
+    auto* self = self_cast();
+    return slice(start, self->get_count());
+}
+
+template <typename Self, typename T>
+Slice<const T> ArrayBase<Self, T>::slice() const {
+    auto* self = self_cast();
+    return slice(0, self->get_count());
+}
+
+// LIST IMPLEMENTATION
+template <typename T>
+List<T> List<T>::alloc(Allocator* a, UZ cap) {
+    List<T> list{};
+    list.items = a->alloc<T>(cap);
+    list.count = 0;
+    list.capacity = cap;
+    list.allocator = a;
+
+    return list;
+}
+
+template <typename T>
+void List<T>::push(const T& item) {
+    emplace(item);
+}
+
+template <typename T>
+void List<T>::push(T&& item) {
+    emplace(move(item));
+}
+
+template <typename T>
+template <typename... Args>
+T& List<T>::emplace(Args&&... args) {
+    if (count >= capacity) {
+        UZ new_capacity = OK_LIST_GROW_FACTOR(capacity);
+        items = allocator->resize<T>(items, capacity, new_capacity, count);
+        capacity = new_capacity;
+    }
+
+    T* slot = items + count++;
+    OK_PLACEMENT_NEW(slot) T(forward<Args>(args)...);
+    return *slot;
+}
+
+template <typename T>
+inline void List<T>::remove_at(UZ idx) {
+    OK_ASSERT(idx < count);
+    remove_range(idx, idx + 1);
+}
+
+// Where `other` starts in `items`, or -1 if it's not a part of them. Parts of the list move
+// when it grows, so they are found again by offset.
+template <typename T>
+static inline UZ _list_offset_of(const T* items, UZ count, Slice<const T> other) {
+    uintptr_t start = (uintptr_t)items;
+    uintptr_t p = (uintptr_t)other.items;
+    if (other.count == 0 || p < start || p >= start + count * sizeof(T)) return (UZ)-1;
+    return (p - start) / sizeof(T);
+}
+
+template <typename T>
+inline void List<T>::append_slice(Slice<const T> other) {
+    UZ offset = _list_offset_of<T>(items, count, other);
+
+    UZ new_count = count + other.count;
+    if (new_count > capacity) reserve(max(new_count, OK_LIST_GROW_FACTOR(capacity)));
+    if (offset != (UZ)-1) other.items = items + offset;
+
+    copy_items(items + count, other.items, other.count);
+    count = new_count;
+}
+
+template <typename T>
+inline void List<T>::insert_slice(UZ idx, Slice<const T> other) {
+    OK_ASSERT(idx <= count);
+    UZ offset = _list_offset_of<T>(items, count, other);
+
+    UZ new_count = count + other.count;
+    if (new_count > capacity) reserve(max(new_count, OK_LIST_GROW_FACTOR(capacity)));
+
+    relocate_items(items + idx + other.count, items + idx, count - idx);
+
+    if (offset == (UZ)-1) {
+        copy_items(items + idx, other.items, other.count);
+    } else {
+        // The part of `other` before `idx` stayed, the rest moved up with the tail.
+        UZ before = offset < idx ? min(idx - offset, other.count) : 0;
+        copy_items(items + idx, items + offset, before);
+        copy_items(items + idx + before, items + offset + before + other.count, other.count - before);
+    }
+    count = new_count;
+}
+
+template <typename T>
+inline void List<T>::remove_range(UZ start, UZ end) {
+    OK_ASSERT(start <= end);
+    OK_ASSERT(end <= count);
+
+    destroy_items(items + start, end - start);
+    relocate_items(items + start, items + end, count - end);
+    count -= end - start;
+}
+
+template <typename T>
+inline void List<T>::swap_remove(UZ idx) {
+    OK_ASSERT(idx < count);
+
+    count--;
+    if (idx != count) {
+        destroy_items(items + idx, 1);
+        relocate_items(items + idx, items + count, 1);
+    } else {
+        destroy_items(items + count, 1);
+    }
+}
+
+template <typename T>
+template <typename F>
+inline void List<T>::retain(F pred) {
+    UZ kept = 0;
+
+    for (UZ i = 0; i < count; i++) {
+        if (!pred(items[i])) {
+            destroy_items(items + i, 1);
+            continue;
+        }
+
+        if (kept != i) relocate_items(items + kept, items + i, 1);
+        kept++;
+    }
+
+    count = kept;
+}
+
+template <typename T>
+inline List<T> List<T>::copy(Allocator* a, UZ start, UZ end) const {
+    OK_ASSERT(end >= start);
+    OK_ASSERT(end <= count);
+
+    auto res = List<T>::alloc(a, end - start);
+    copy_items(res.items, items + start, end - start);
+    res.count = end - start;
+    return res;
+}
+
+template <typename T>
+inline void List<T>::extend(List<T> other) {
+    append_slice(other.slice());
+}
+
+template <typename T>
+inline void List<T>::reserve(UZ new_cap) {
+    if (new_cap <= capacity) {
+        return;
+    }
+
+    items = allocator->resize<T>(items, capacity, new_cap, count);
+    capacity = new_cap;
+}
+
+// SMALL LIST IMPLEMENTATION
+template <typename T, UZ N>
+SmallList<T, N> SmallList<T, N>::alloc(Allocator* a) {
+    SmallList<T, N> list{};
+    list.count = 0;
+    list.capacity = N;
+    list.allocator = a;
+
+    return list;
+}
+
+template <typename T, UZ N>
+void SmallList<T, N>::push(const T& item) {
+    if (count >= get_capacity()) {
+        reserve(OK_LIST_GROW_FACTOR(get_capacity()));
+    }
+
+    OK_PLACEMENT_NEW(get_items() + count) T(item);
+    count++;
+}
+
+template <typename T, UZ N>
+inline void SmallList<T, N>::remove_at(UZ idx) {
+    OK_ASSERT(idx < count);
+
+    T* items = get_items();
+    destroy_items(items + idx, 1);
+    relocate_items(items + idx, items + idx + 1, count - idx - 1);
+    count--;
+}
+
+template <typename T, UZ N>
+inline void SmallList<T, N>::reserve(UZ new_cap) {
+    if (new_cap <= get_capacity()) {
+        return;
+    }
+
+    if (is_inline()) {
+        T* new_items = allocator->alloc<T>(new_cap);
+        relocate_items(new_items, reinterpret_cast<T*>(inline_items), count);
+        heap_items = new_items;
+    } else {
+        heap_items = allocator->resize<T>(heap_items, capacity, new_cap, count);
+    }
+
+    capacity = new_cap;
+}
+
+// MULTI LIST IMPLEMENTATION
+template <typename... Types>
+UZ MultiList<Types...>::layout(UZ capacity, UZ* offsets) {
+    constexpr UZ sizes[] = {sizeof(Types)...};
+
+    UZ offset = 0;
+    for (UZ i = 0; i < COLUMN_COUNT; i++) {
+        offset = align_up(offset, COLUMN_ALIGN);
+        offsets[i] = offset;
+        offset += sizes[i] * capacity;
+    }
+
+    // The allocator only guarantees pointer alignment, leave room to align the base.
+    return offset + COLUMN_ALIGN;
+}
+
+template <typename... Types>
+MultiList<Types...> MultiList<Types...>::alloc(Allocator* allocator, UZ capacity) {
+    MultiList<Types...> list{};
+    list.allocator = allocator;
+    list.reserve(capacity);
+    return list;
+}
+
+template <typename... Types>
+void MultiList<Types...>::reserve(UZ new_cap) {
+    if (new_cap <= capacity && data != nullptr) return;
+
+    UZ offsets[COLUMN_COUNT];
+    UZ new_data_size = layout(new_cap, offsets);
+    void* new_data = allocator->alloc<U8>(new_data_size);
+    U8* base = (U8*)align_up((uintptr_t)new_data, COLUMN_ALIGN);
+
+    void* new_columns[COLUMN_COUNT];
+    for (UZ i = 0; i < COLUMN_COUNT; i++) new_columns[i] = base + offsets[i];
+
+    if (data != nullptr) {
+        _relocate_columns<0>(new_columns);
+        allocator->dealloc<U8>((U8*)data, data_size);
+    }
+
+    memcpy(columns, new_columns, sizeof(columns));
+    data = new_data;
+    data_size = new_data_size;
+    capacity = new_cap;
+}
+
+template <typename... Types>
+template <UZ I>
+void MultiList<Types...>::_relocate_columns(void** new_columns) {
+    if constexpr (I < COLUMN_COUNT) {
+        relocate_items(static_cast<Column<I>*>(new_columns[I]), items<I>(), count);
+        _relocate_columns<I + 1>(new_columns);
+    }
+}
+
+template <typename... Types>
+void MultiList<Types...>::push(const Types&... values) {
+    if (count >= capacity) reserve(OK_LIST_GROW_FACTOR(capacity));
+    _push_impl<0>(values...);
+    count++;
+}
+
+template <typename... Types>
+template <UZ I, typename X, typename... Xs>
+void MultiList<Types...>::_push_impl(const X& x, const Xs&... xs) {
+    OK_PLACEMENT_NEW(items<I>() + count) X(x);
+    if constexpr (sizeof...(Xs) > 0) _push_impl<I + 1>(xs...);
+}
+
+template <typename... Types>
+void MultiList<Types...>::push_slices(Slice<const Types>... slices) {
+    UZ counts[] = {slices.count...};
+    UZ added = counts[0];
+    for (UZ i = 1; i < COLUMN_COUNT; i++) OK_ASSERT(counts[i] == added);
+
+    UZ new_count = count + added;
+    if (new_count > capacity) reserve(max(new_count, OK_LIST_GROW_FACTOR(capacity)));
+
+    _push_slices_impl<0, Types...>(slices...);
+    count = new_count;
+}
+
+template <typename... Types>
+template <UZ I, typename X, typename... Xs>
+void MultiList<Types...>::_push_slices_impl(Slice<const X> x, Slice<const Xs>... xs) {
+    copy_items(items<I>() + count, x.items, x.count);
+    if constexpr (sizeof...(Xs) > 0) _push_slices_impl<I + 1, Xs...>(xs...);
+}
+
+template <typename... Types>
+void MultiList<Types...>::swap_remove(UZ idx) {
+    OK_ASSERT(idx < count);
+    count--;
+    _swap_remove_impl<0>(idx);
+}
+
+template <typename... Types>
+template <UZ I>
+void MultiList<Types...>::_swap_remove_impl(UZ idx) {
+    if constexpr (I < COLUMN_COUNT) {
+        Column<I>* col = items<I>();
+        destroy_items(col + idx, 1);
+        if (idx != count) relocate_items(col + idx, col + count, 1);
+
+        _swap_remove_impl<I + 1>(idx);
+    }
+}
+
+template <typename... Types>
+template <UZ I>
+void MultiList<Types...>::_destroy_columns() {
+    if constexpr (I < COLUMN_COUNT) {
+        destroy_items(items<I>(), count);
+        _destroy_columns<I + 1>();
+    }
+}
+
+template <typename... Types>
+void MultiList<Types...>::dealloc() {
+    if (data == nullptr) return;
+
+    _destroy_columns<0>();
+    allocator->dealloc<U8>((U8*)data, data_size);
+    memset((void*)this, 0, sizeof(*this));
+}
+
+// DEQUE IMPLEMENTATION
+template <typename T>
+Deque<T> Deque<T>::alloc(Allocator* a, UZ cap) {
+    Deque<T> deque{};
+    deque.capacity = next_power_of_two(max(cap, (UZ)1));
+    deque.items = a->alloc<T>(deque.capacity);
+    deque.allocator = a;
+    return deque;
+}
+
+template <typename T>
+void Deque<T>::reserve(UZ new_cap) {
+    if (new_cap <= capacity) return;
+
+    new_cap = next_power_of_two(new_cap);
+    T* new_items = allocator->alloc<T>(new_cap);
+
+    Slice<T> first, second;
+    slices(&first, &second);
+    relocate_items(new_items, first.items, first.count);
+    relocate_items(new_items + first.count, second.items, second.count);
+
+    allocator->dealloc<T>(items, capacity);
+    items = new_items;
+    capacity = new_cap;
+    head = 0;
+}
+
+template <typename T>
+void Deque<T>::slices(Slice<T>* first, Slice<T>* second) {
+    UZ first_count = min(count, capacity - head);
+    *first = Slice<T>{items + head, first_count};
+    *second = Slice<T>{items, count - first_count};
+}
+
+template <typename T>
+void Deque<T>::slices(Slice<const T>* first, Slice<const T>* second) const {
+    UZ first_count = min(count, capacity - head);
+    *first = Slice<const T>{items + head, first_count};
+    *second = Slice<const T>{items, count - first_count};
+}
+
+template <typename T>
+UZ Deque<T>::find_index(const T& elem) const {
+    Slice<const T> first, second;
+    slices(&first, &second);
+
+    UZ idx = first.find_index(elem);
+    if (idx != (UZ)-1) return idx;
+
+    idx = second.find_index(elem);
+    return idx == (UZ)-1 ? idx : first.count + idx;
+}
+
+template <typename T>
+UZ Deque<T>::count_of(const T& elem) const {
+    Slice<const T> first, second;
+    slices(&first, &second);
+    return first.count_of(elem) + second.count_of(elem);
+}
+
+template <typename T>
+template <typename F>
+UZ Deque<T>::find_index(F pred) const {
+    Slice<const T> first, second;
+    slices(&first, &second);
+
+    UZ idx = first.find_index(pred);
+    if (idx != (UZ)-1) return idx;
+
+    idx = second.find_index(pred);
+    return idx == (UZ)-1 ? idx : first.count + idx;
+}
+
+template <typename T>
+template <typename... Args>
+T& Deque<T>::emplace_back(Args&&... args) {
+    if (count >= capacity) reserve(capacity * 2);
+
+    T* slot = items + ((head + count) & mask());
+    OK_PLACEMENT_NEW(slot) T(forward<Args>(args)...);
+    count++;
+    return *slot;
+}
+
+template <typename T>
+template <typename... Args>
+T& Deque<T>::emplace_front(Args&&... args) {
+    if (count >= capacity) reserve(capacity * 2);
+
+    head = (head - 1) & mask();
+    T* slot = items + head;
+    OK_PLACEMENT_NEW(slot) T(forward<Args>(args)...);
+    count++;
+    return *slot;
+}
+
+template <typename T>
+void Deque<T>::push_back(const T& item) {
+    emplace_back(item);
+}
+
+template <typename T>
+void Deque<T>::push_back(T&& item) {
+    emplace_back(move(item));
+}
+
+template <typename T>
+void Deque<T>::push_front(const T& item) {
+    emplace_front(item);
+}
+
+template <typename T>
+void Deque<T>::push_front(T&& item) {
+    emplace_front(move(item));
+}
+
+template <typename T>
+T Deque<T>::pop_front() {
+    OK_ASSERT(count > 0);
+
+    T* slot = items + head;
+    T result = move(*slot);
+    destroy_items(slot, 1);
+
+    head = (head + 1) & mask();
+    count--;
+    return result;
+}
+
+template <typename T>
+T Deque<T>::pop_back() {
+    OK_ASSERT(count > 0);
+
+    count--;
+    T* slot = items + ((head + count) & mask());
+    T result = move(*slot);
+    destroy_items(slot, 1);
+    return result;
+}
+
+// PRIORITY QUEUE IMPLEMENTATION
+template <typename T, typename Cmp>
+PriorityQueue<T, Cmp> PriorityQueue<T, Cmp>::alloc(Allocator* a, UZ cap) {
+    PriorityQueue<T, Cmp> queue{};
+    queue.heap = List<T>::alloc(a, cap);
+    return queue;
+}
+
+template <typename T, typename Cmp>
+PriorityQueue<T, Cmp> PriorityQueue<T, Cmp>::from(Allocator* a, Slice<const T> items) {
+    PriorityQueue<T, Cmp> queue = PriorityQueue<T, Cmp>::alloc(a, max(items.count, (UZ)1));
+    queue.heap.append_slice(items);
+
+    if (items.count > 1) {
+        for (UZ i = (items.count - 2) / ARITY + 1; i > 0; i--) queue.sift_down(i - 1);
+    }
+
+    return queue;
+}
+
+template <typename T, typename Cmp>
+void PriorityQueue<T, Cmp>::push(const T& item) {
+    heap.push(item);
+    sift_up(heap.count - 1);
+}
+
+template <typename T, typename Cmp>
+void PriorityQueue<T, Cmp>::push(T&& item) {
+    heap.push(move(item));
+    sift_up(heap.count - 1);
+}
+
+template <typename T, typename Cmp>
+T PriorityQueue<T, Cmp>::pop() {
+    OK_ASSERT(heap.count > 0);
+
+    T top = move(heap.items[0]);
+    heap.count--;
+
+    if (heap.count > 0) {
+        heap.items[0] = move(heap.items[heap.count]);
+        sift_down(0);
+    }
+
+    destroy_items(heap.items + heap.count, 1);
+    return top;
+}
+
+template <typename T, typename Cmp>
+void PriorityQueue<T, Cmp>::sift_up(UZ idx) {
+    T* items = heap.items;
+    T item = move(items[idx]);
+
+    while (idx > 0) {
+        UZ parent = (idx - 1) / ARITY;
+        if (!Cmp::less(item, items[parent])) break;
+
+        items[idx] = move(items[parent]);
+        idx = parent;
+    }
+
+    items[idx] = move(item);
+}
+
+template <typename T, typename Cmp>
+void PriorityQueue<T, Cmp>::sift_down(UZ idx) {
+    T* items = heap.items;
+    UZ count = heap.count;
+    T item = move(items[idx]);
+
+    while (true) {
+        UZ first_child = idx * ARITY + 1;
+        if (first_child >= count) break;
+
+        UZ last_child = min(first_child + ARITY, count);
+        UZ best = first_child;
+        for (UZ c = first_child + 1; c < last_child; c++) {
+            if (Cmp::less(items[c], items[best])) best = c;
+        }
+
+        if (!Cmp::less(items[best], item)) break;
+
+        items[idx] = move(items[best]);
+        idx = best;
+    }
+
+    items[idx] = move(item);
+}
+
+template <typename T, typename Cmp>
+IndexedPriorityQueue<T, Cmp> IndexedPriorityQueue<T, Cmp>::alloc(Allocator* a, UZ id_capacity) {
+    IndexedPriorityQueue<T, Cmp> queue{};
+    queue.heap = List<U32>::alloc(a, id_capacity);
+    queue.priorities = List<T>::alloc(a, id_capacity);
+    queue.positions = List<U32>::alloc(a, id_capacity);
+    return queue;
+}
+
+template <typename T, typename Cmp>
+void IndexedPriorityQueue<T, Cmp>::push(U32 id, const T& priority) {
+    OK_ASSERT(!contains(id));
+
+    if (id >= positions.count) {
+        positions.reserve(id + 1);
+        priorities.reserve(id + 1);
+        while (positions.count <= id) positions.push(NOT_QUEUED);
+        while (priorities.count <= id) priorities.push(priority);
+    }
+
+    priorities.items[id] = priority;
+    heap.push(id);
+    positions.items[id] = (U32)(heap.count - 1);
+    sift_up(heap.count - 1);
+}
+
+template <typename T, typename Cmp>
+void IndexedPriorityQueue<T, Cmp>::decrease_key(U32 id, const T& priority) {
+    OK_ASSERT(contains(id));
+    OK_ASSERT(!Cmp::less(priorities.items[id], priority));
+
+    priorities.items[id] = priority;
+    sift_up(positions.items[id]);
+}
+
+template <typename T, typename Cmp>
+void IndexedPriorityQueue<T, Cmp>::update(U32 id, const T& priority) {
+    OK_ASSERT(contains(id));
+
+    bool decreased = Cmp::less(priority, priorities.items[id]);
+    priorities.items[id] = priority;
+
+    if (decreased) sift_up(positions.items[id]);
+    else sift_down(positions.items[id]);
+}
+
+template <typename T, typename Cmp>
+void IndexedPriorityQueue<T, Cmp>::remove(U32 id) {
+    OK_ASSERT(contains(id));
+
+    UZ idx = positions.items[id];
+    U32 last = heap.items[--heap.count];
+    positions.items[id] = NOT_QUEUED;
+
+    if (idx == heap.count) return;
+
+    place(idx, last);
+    if (idx > 0 && less(last, heap.items[(idx - 1) / ARITY])) sift_up(idx);
+    else sift_down(idx);
+}
+
+template <typename T, typename Cmp>
+U32 IndexedPriorityQueue<T, Cmp>::pop() {
+    U32 id = peek();
+    remove(id);
+    return id;
+}
+
+template <typename T, typename Cmp>
+void IndexedPriorityQueue<T, Cmp>::sift_up(UZ idx) {
+    U32 id = heap.items[idx];
+
+    while (idx > 0) {
+        UZ parent = (idx - 1) / ARITY;
+        if (!less(id, heap.items[parent])) break;
+
+        place(idx, heap.items[parent]);
+        idx = parent;
+    }
+
+    place(idx, id);
+}
+
+template <typename T, typename Cmp>
+void IndexedPriorityQueue<T, Cmp>::sift_down(UZ idx) {
+    U32 id = heap.items[idx];
+    UZ count = heap.count;
+
+    while (true) {
+        UZ first_child = idx * ARITY + 1;
+        if (first_child >= count) break;
+
+        UZ last_child = min(first_child + ARITY, count);
+        UZ best = first_child;
+        for (UZ c = first_child + 1; c < last_child; c++) {
+            if (less(heap.items[c], heap.items[best])) best = c;
+        }
+
+        if (!less(heap.items[best], id)) break;
+
+        place(idx, heap.items[best]);
+        idx = best;
+    }
+
+    place(idx, id);
+}
+
+// SORT IMPLEMENTATION
+// Pattern-defeating quicksort, ported from Orson Peters' pdqsort
+// (https://github.com/orlp/pdqsort), including the block partitioning of BlockQuicksort
+// (S. Edelkamp and A. Weiss). pdqsort is distributed under the zlib license:
+//
+//     Copyright (c) 2021 Orson Peters
+//
+//     This software is provided 'as-is', without any express or implied warranty. In no
+//     event will the authors be held liable for any damages arising from the use of this
+//     software.
+//
+//     Permission is granted to anyone to use this software for any purpose, including
+//     commercial applications, and to alter it and redistribute it freely, subject to the
+//     following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not claim that
+//        you wrote the original software. If you use this software in a product, an
+//        acknowledgment in the product documentation would be appreciated but is not
+//        required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not be
+//        misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source distribution.
+//
+// This is an altered version: comparisons go through `Cmp::less`, elements are moved with
+// `ok::move`, and the constants are named for this file.
+static constexpr UZ SORT_INSERTION_THRESHOLD = 24;
+static constexpr UZ SORT_NINTHER_THRESHOLD = 128;
+static constexpr UZ SORT_PARTIAL_INSERTION_LIMIT = 8;
+static constexpr UZ SORT_BLOCK_SIZE = 64;
+
+template <typename T, typename Cmp>
+void _insertion_sort(T* begin, T* end) {
+    if (begin == end) return;
+
+    for (T* cur = begin + 1; cur != end; ++cur) {
+        T* sift = cur;
+        T* sift_1 = cur - 1;
+
+        if (Cmp::less(*sift, *sift_1)) {
+            T tmp = move(*sift);
+
+            do {
+                *sift-- = move(*sift_1);
+            } while (sift != begin && Cmp::less(tmp, *--sift_1));
+
+            *sift = move(tmp);
+        }
+    }
+}
+
+// NOTE: Only valid when there is an element before `begin` that is not greater than any
+// element of the range, which then stops the inner loop.
+template <typename T, typename Cmp>
+void _unguarded_insertion_sort(T* begin, T* end) {
+    if (begin == end) return;
+
+    for (T* cur = begin + 1; cur != end; ++cur) {
+        T* sift = cur;
+        T* sift_1 = cur - 1;
+
+        if (Cmp::less(*sift, *sift_1)) {
+            T tmp = move(*sift);
+
+            do {
+                *sift-- = move(*sift_1);
+            } while (Cmp::less(tmp, *--sift_1));
+
+            *sift = move(tmp);
+        }
+    }
+}
+
+// Insertion sort that gives up after moving more than `SORT_PARTIAL_INSERTION_LIMIT`
+// elements. Returns true if the range ended up sorted.
+template <typename T, typename Cmp>
+bool _partial_insertion_sort(T* begin, T* end) {
+    if (begin == end) return true;
+
+    UZ limit = 0;
+    for (T* cur = begin + 1; cur != end; ++cur) {
+        T* sift = cur;
+        T* sift_1 = cur - 1;
+
+        if (Cmp::less(*sift, *sift_1)) {
+            T tmp = move(*sift);
+
+            do {
+                *sift-- = move(*sift_1);
+            } while (sift != begin && Cmp::less(tmp, *--sift_1));
+
+            *sift = move(tmp);
+            limit += cur - sift;
+        }
+
+        if (limit > SORT_PARTIAL_INSERTION_LIMIT) return false;
+    }
+
+    return true;
+}
+
+template <typename T, typename Cmp>
+inline void _sort2(T* a, T* b) {
+    if (Cmp::less(*b, *a)) ok::swap(*a, *b);
+}
+
+template <typename T, typename Cmp>
+inline void _sort3(T* a, T* b, T* c) {
+    _sort2<T, Cmp>(a, b);
+    _sort2<T, Cmp>(b, c);
+    _sort2<T, Cmp>(a, b);
+}
+
+template <typename T, typename Cmp>
+void _heap_sift_down(T* items, UZ idx, UZ count) {
+    T item = move(items[idx]);
+
+    while (true) {
+        UZ child = idx * 2 + 1;
+        if (child >= count) break;
+        if (child + 1 < count && Cmp::less(items[child], items[child + 1])) child++;
+        if (!Cmp::less(item, items[child])) break;
+
+        items[idx] = move(items[child]);
+        idx = child;
+    }
+
+    items[idx] = move(item);
+}
+
+template <typename T, typename Cmp>
+void _heap_sort(T* begin, T* end) {
+    UZ count = end - begin;
+
+    for (UZ i = count / 2; i > 0; i--) _heap_sift_down<T, Cmp>(begin, i - 1, count);
+
+    for (UZ i = count; i > 1; i--) {
+        ok::swap(begin[0], begin[i - 1]);
+        _heap_sift_down<T, Cmp>(begin, 0, i - 1);
+    }
+}
+
+// Partitions around `*begin` and returns where the pivot ended up. Elements equal to the
+// pivot go to the right. `partitioned` is set if no elements had to be swapped.
+template <typename T, typename Cmp>
+T* _partition_right(T* begin, T* end, bool* partitioned) {
+    T pivot = move(*begin);
+    T* first = begin;
+    T* last = end;
+
+    // The median-of-3 pivot selection guarantees that there is an element not less than
+    // the pivot to stop the first scan.
+    while (Cmp::less(*++first, pivot));
+
+    if (first - 1 == begin) {
+        while (first < last && !Cmp::less(*--last, pivot));
+    } else {
+        while (!Cmp::less(*--last, pivot));
+    }
+
+    *partitioned = first >= last;
+
+    while (first < last) {
+        ok::swap(*first, *last);
+        while (Cmp::less(*++first, pivot));
+        while (!Cmp::less(*--last, pivot));
+    }
+
+    T* pivot_pos = first - 1;
+    *begin = move(*pivot_pos);
+    *pivot_pos = move(pivot);
+    return pivot_pos;
+}
+
+template <typename T>
+inline void _swap_offsets(T* first, T* last, const U8* offsets_l, const U8* offsets_r, UZ num, bool use_swaps) {
+    if (use_swaps) {
+        // Needed for descending inputs, where the cyclic permutation below would break
+        // the O(n) bound of a partition.
+        for (UZ i = 0; i < num; ++i) ok::swap(first[offsets_l[i]], *(last - offsets_r[i]));
+    } else if (num > 0) {
+        T* l = first + offsets_l[0];
+        T* r = last - offsets_r[0];
+        T tmp = move(*l);
+        *l = move(*r);
+
+        for (UZ i = 1; i < num; ++i) {
+            l = first + offsets_l[i];
+            *r = move(*l);
+            r = last - offsets_r[i];
+            *l = move(*r);
+        }
+
+        *r = move(tmp);
+    }
+}
+
+// Same contract as `_partition_right`. The comparisons only record offsets of misplaced
+// elements into small blocks, which are then swapped in bulk, so the loop has no
+// data-dependent branches to mispredict (BlockQuicksort, Edelkamp and Weiss).
+template <typename T, typename Cmp>
+T* _partition_right_branchless(T* begin, T* end, bool* partitioned) {
+    T pivot = move(*begin);
+    T* first = begin;
+    T* last = end;
+
+    while (Cmp::less(*++first, pivot));
+
+    if (first - 1 == begin) {
+        while (first < last && !Cmp::less(*--last, pivot));
+    } else {
+        while (!Cmp::less(*--last, pivot));
+    }
+
+    *partitioned = first >= last;
+
+    if (!*partitioned) {
+        ok::swap(*first, *last);
+        ++first;
+
+        alignas(OK_CACHE_LINE_SIZE) U8 offsets_l[SORT_BLOCK_SIZE];
+        alignas(OK_CACHE_LINE_SIZE) U8 offsets_r[SORT_BLOCK_SIZE];
+
+        T* offsets_l_base = first;
+        T* offsets_r_base = last;
+        UZ num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+        while (first < last) {
+            UZ num_unknown = last - first;
+            UZ left_split = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+            UZ right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+
+            UZ left_count = min(left_split, SORT_BLOCK_SIZE);
+            for (UZ i = 0; i < left_count;) {
+                offsets_l[num_l] = (U8)i++;
+                num_l += !Cmp::less(*first, pivot);
+                ++first;
+            }
+
+            UZ right_count = min(right_split, SORT_BLOCK_SIZE);
+            for (UZ i = 0; i < right_count;) {
+                offsets_r[num_r] = (U8)++i;
+                num_r += Cmp::less(*--last, pivot);
+            }
+
+            UZ num = min(num_l, num_r);
+            _swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+            num_l -= num;
+            num_r -= num;
+            start_l += num;
+            start_r += num;
+
+            if (num_l == 0) {
+                start_l = 0;
+                offsets_l_base = first;
+            }
+
+            if (num_r == 0) {
+                start_r = 0;
+                offsets_r_base = last;
+            }
+        }
+
+        // One of the blocks may still hold misplaced elements, they go next to the
+        // boundary.
+        if (num_l > 0) {
+            const U8* offsets = offsets_l + start_l;
+            while (num_l--) ok::swap(offsets_l_base[offsets[num_l]], *--last);
+            first = last;
+        }
+
+        if (num_r > 0) {
+            const U8* offsets = offsets_r + start_r;
+            while (num_r--) {
+                ok::swap(*(offsets_r_base - offsets[num_r]), *first);
+                ++first;
+            }
+        }
+    }
+
+    T* pivot_pos = first - 1;
+    *begin = move(*pivot_pos);
+    *pivot_pos = move(pivot);
+    return pivot_pos;
+}
+
+// Partitions around `*begin` with the elements equal to the pivot going to the left.
+// Used when the pivot equals the element right before the range, in which case all of
+// the elements equal to it are already in their final place.
+template <typename T, typename Cmp>
+T* _partition_left(T* begin, T* end) {
+    T pivot = move(*begin);
+    T* first = begin;
+    T* last = end;
+
+    while (Cmp::less(pivot, *--last));
+
+    if (last + 1 == end) {
+        while (first < last && !Cmp::less(pivot, *++first));
+    } else {
+        while (!Cmp::less(pivot, *++first));
+    }
+
+    while (first < last) {
+        ok::swap(*first, *last);
+        while (Cmp::less(pivot, *--last));
+        while (!Cmp::less(pivot, *++first));
+    }
+
+    T* pivot_pos = last;
+    *begin = move(*pivot_pos);
+    *pivot_pos = move(pivot);
+    return pivot_pos;
+}
+
+template <typename T, typename Cmp>
+void _pdqsort_loop(T* begin, T* end, UZ bad_allowed, bool leftmost) {
+    while (true) {
+        UZ size = end - begin;
+
+        if (size < SORT_INSERTION_THRESHOLD) {
+            if (leftmost) {
+                _insertion_sort<T, Cmp>(begin, end);
+            } else {
+                _unguarded_insertion_sort<T, Cmp>(begin, end);
+            }
+            return;
+        }
+
+        // Median of 3, or the pseudo-median of 9 for larger ranges, moved to `*begin`.
+        UZ half = size / 2;
+        if (size > SORT_NINTHER_THRESHOLD) {
+            _sort3<T, Cmp>(begin, begin + half, end - 1);
+            _sort3<T, Cmp>(begin + 1, begin + (half - 1), end - 2);
+            _sort3<T, Cmp>(begin + 2, begin + (half + 1), end - 3);
+            _sort3<T, Cmp>(begin + (half - 1), begin + half, begin + (half + 1));
+            ok::swap(*begin, begin[half]);
+        } else {
+            _sort3<T, Cmp>(begin + half, begin, end - 1);
+        }
+
+        // If the pivot equals the element before the range (the pivot of the parent), every
+        // element equal to it can be skipped. This keeps inputs with many duplicates linear.
+        if (!leftmost && !Cmp::less(*(begin - 1), *begin)) {
+            begin = _partition_left<T, Cmp>(begin, end) + 1;
+            continue;
+        }
+
+        bool partitioned;
+        T* pivot_pos;
+        if constexpr (is_trivially_copyable<T>) {
+            pivot_pos = _partition_right_branchless<T, Cmp>(begin, end, &partitioned);
+        } else {
+            pivot_pos = _partition_right<T, Cmp>(begin, end, &partitioned);
+        }
+
+        UZ l_size = pivot_pos - begin;
+        UZ r_size = end - (pivot_pos + 1);
+        bool highly_unbalanced = l_size < size / 8 || r_size < size / 8;
+
+        if (highly_unbalanced) {
+            if (--bad_allowed == 0) {
+                _heap_sort<T, Cmp>(begin, end);
+                return;
+            }
+
+            // Break up the patterns that lead to the bad pivot by swapping a few elements
+            // around.
+            if (l_size >= SORT_INSERTION_THRESHOLD) {
+                ok::swap(begin[0], begin[l_size / 4]);
+                ok::swap(pivot_pos[-1], *(pivot_pos - l_size / 4));
+
+                if (l_size > SORT_NINTHER_THRESHOLD) {
+                    ok::swap(begin[1], begin[l_size / 4 + 1]);
+                    ok::swap(begin[2], begin[l_size / 4 + 2]);
+                    ok::swap(pivot_pos[-2], *(pivot_pos - (l_size / 4 + 1)));
+                    ok::swap(pivot_pos[-3], *(pivot_pos - (l_size / 4 + 2)));
+                }
+            }
+
+            if (r_size >= SORT_INSERTION_THRESHOLD) {
+                ok::swap(pivot_pos[1], pivot_pos[1 + r_size / 4]);
+                ok::swap(end[-1], *(end - r_size / 4));
+
+                if (r_size > SORT_NINTHER_THRESHOLD) {
+                    ok::swap(pivot_pos[2], pivot_pos[2 + r_size / 4]);
+                    ok::swap(pivot_pos[3], pivot_pos[3 + r_size / 4]);
+                    ok::swap(end[-2], *(end - (1 + r_size / 4)));
+                    ok::swap(end[-3], *(end - (2 + r_size / 4)));
+                }
+            }
+        } else if (partitioned
+                   && _partial_insertion_sort<T, Cmp>(begin, pivot_pos)
+                   && _partial_insertion_sort<T, Cmp>(pivot_pos + 1, end)) {
+            // Nothing was swapped, so the input is likely already (almost) sorted.
+            return;
+        }
+
+        // Recurse into the left part, loop on the right one.
+        _pdqsort_loop<T, Cmp>(begin, pivot_pos, bad_allowed, leftmost);
+        begin = pivot_pos + 1;
+        leftmost = false;
+    }
+}
+
+template <typename T, typename Cmp>
+void sort(Slice<T> items) {
+    if (items.count < 2) return;
+
+    UZ log2 = 0;
+    for (UZ n = items.count; n > 1; n >>= 1) log2++;
+
+    _pdqsort_loop<T, Cmp>(items.items, items.items + items.count, log2, true);
+}
+
+// Merges the sorted runs `[begin, mid)` and `[mid, end)`. The left run is moved out into
+// `buffer`, after which the output can never overtake the unread part of the right run.
+template <typename T, typename Cmp>
+void _merge_with_buffer(T* begin, T* mid, T* end, T* buffer) {
+    UZ left_count = mid - begin;
+    relocate_items(buffer, begin, left_count);
+
+    T* out = begin;
+    T* left = buffer;
+    T* left_end = buffer + left_count;
+    T* right = mid;
+
+    while (left != left_end && right != end) {
+        T* src = Cmp::less(*right, *left) ? right++ : left++;
+        OK_PLACEMENT_NEW(out++) T(move(*src));
+        src->~T();
+    }
+
+    relocate_items(out, left, left_end - left);
+}
+
+template <typename T, typename Cmp>
+void _merge_sort(T* begin, T* end, T* buffer) {
+    UZ count = end - begin;
+    if (count <= SORT_INSERTION_THRESHOLD) {
+        _insertion_sort<T, Cmp>(begin, end);
+        return;
+    }
+
+    T* mid = begin + count / 2;
+    _merge_sort<T, Cmp>(begin, mid, buffer);
+    _merge_sort<T, Cmp>(mid, end, buffer);
+
+    if (!Cmp::less(*mid, *(mid - 1))) return;
+    _merge_with_buffer<T, Cmp>(begin, mid, end, buffer);
+}
+
+template <typename T, typename Cmp>
+void stable_sort(Slice<T> items, Allocator* scratch) {
+    if (items.count <= SORT_INSERTION_THRESHOLD) {
+        _insertion_sort<T, Cmp>(items.items, items.items + items.count);
+        return;
+    }
+
+    UZ buffer_count = items.count / 2;
+    T* buffer = scratch->alloc<T>(buffer_count);
+    OK_ASSERT(buffer != nullptr);
+
+    _merge_sort<T, Cmp>(items.items, items.items + items.count, buffer);
+
+    scratch->dealloc<T>(buffer, buffer_count);
+}
+
+template <typename T, typename F>
+void radix_sort_by_key(Slice<T> items, Allocator* scratch, F key) {
+    using Key = RemoveCVRef<decltype(key(items.items[0]))>;
+    static_assert(is_integer<Key>, "radix sort keys have to be integers");
+
+    using Bits = typename UnsignedOfSize<sizeof(Key)>::Type;
+    constexpr UZ DIGITS = sizeof(Key);
+    constexpr Bits SIGN_FLIP = is_signed<Key> ? (Bits)((Bits)1 << (sizeof(Key) * 8 - 1)) : 0;
+
+    if (items.count < 2) return;
+
+    // All of the histograms are filled in a single pass over the input.
+    UZ counts[DIGITS][256] = {};
+    for (UZ i = 0; i < items.count; i++) {
+        Bits bits = (Bits)key(items.items[i]) ^ SIGN_FLIP;
+        for (UZ d = 0; d < DIGITS; d++) counts[d][(bits >> (d * 8)) & 0xff]++;
+    }
+
+    T* buffer = scratch->alloc<T>(items.count);
+    OK_ASSERT(buffer != nullptr);
+
+    T* src = items.items;
+    T* dst = buffer;
+
+    for (UZ d = 0; d < DIGITS; d++) {
+        UZ* digit_counts = counts[d];
+
+        Bits first_digit = ((Bits)key(src[0]) ^ SIGN_FLIP) >> (d * 8) & 0xff;
+        if (digit_counts[first_digit] == items.count) continue;
+
+        UZ offsets[256];
+        UZ offset = 0;
+        for (UZ b = 0; b < 256; b++) {
+            offsets[b] = offset;
+            offset += digit_counts[b];
+        }
+
+        for (UZ i = 0; i < items.count; i++) {
+            Bits digit = ((Bits)key(src[i]) ^ SIGN_FLIP) >> (d * 8) & 0xff;
+            OK_PLACEMENT_NEW(dst + offsets[digit]++) T(move(src[i]));
+            src[i].~T();
+        }
+
+        T* tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != items.items) relocate_items(items.items, src, items.count);
+
+    scratch->dealloc<T>(buffer, items.count);
+}
+
+template <typename T>
+requires is_integer<T>
+void radix_sort(Slice<T> items, Allocator* scratch) {
+    radix_sort_by_key(items, scratch, [](const T& item) { return item; });
+}
+
+// BIT SET IMPLEMENTATION
+template <typename Self>
+void BitSetBase<Self>::fill() {
+    Self* self = self_cast();
+    UZ bit_count = self->get_bit_count();
+    UZ word_count = words_for(bit_count);
+    if (word_count == 0) return;
+
+    memset(self->get_words(), 0xff, word_count * sizeof(U64));
+
+    UZ tail_bits = bit_count % WORD_BITS;
+    if (tail_bits != 0) self->get_words()[word_count - 1] = ((U64)1 << tail_bits) - 1;
+}
+
+template <typename Self>
+UZ BitSetBase<Self>::count_ones() const {
+    const Self* self = self_cast();
+    return bits_popcount(self->get_words(), words_for(self->get_bit_count()));
+}
+
+template <typename Self>
+UZ BitSetBase<Self>::find_next_set(UZ from) const {
+    const Self* self = self_cast();
+    UZ bit_count = self->get_bit_count();
+    if (from >= bit_count) return (UZ)-1;
+
+    const U64* words = self->get_words();
+    UZ word_count = words_for(bit_count);
+    UZ w = from / WORD_BITS;
+    U64 word = words[w] & (~(U64)0 << (from % WORD_BITS));
+
+    while (true) {
+        if (word != 0) return w * WORD_BITS + count_trailing_zeros(word);
+        if (++w == word_count) return (UZ)-1;
+        word = words[w];
+    }
+}
+
+template <typename Self>
+UZ BitSetBase<Self>::find_next_clear(UZ from) const {
+    const Self* self = self_cast();
+    UZ bit_count = self->get_bit_count();
+    if (from >= bit_count) return (UZ)-1;
+
+    const U64* words = self->get_words();
+    UZ word_count = words_for(bit_count);
+    UZ w = from / WORD_BITS;
+    U64 word = ~words[w] & (~(U64)0 << (from % WORD_BITS));
+
+    while (true) {
+        if (word != 0) {
+            UZ idx = w * WORD_BITS + count_trailing_zeros(word);
+            return idx < bit_count ? idx : (UZ)-1;
+        }
+        if (++w == word_count) return (UZ)-1;
+        word = ~words[w];
+    }
+}
+
+template <typename Self>
+template <typename F>
+void BitSetBase<Self>::for_each_set(F f) const {
+    const Self* self = self_cast();
+    const U64* words = self->get_words();
+    UZ word_count = words_for(self->get_bit_count());
+
+    for (UZ w = 0; w < word_count; w++) {
+        U64 word = words[w];
+        while (word != 0) {
+            f(w * WORD_BITS + count_trailing_zeros(word));
+            word &= word - 1;
+        }
+    }
+}
+
+template <typename Self>
+template <typename Other>
+void BitSetBase<Self>::and_with(const BitSetBase<Other>& other) {
+    OK_ASSERT(self_cast()->get_bit_count() == other.self_cast()->get_bit_count());
+    bits_and(self_cast()->get_words(), other.self_cast()->get_words(), words_for(self_cast()->get_bit_count()));
+}
+
+template <typename Self>
+template <typename Other>
+void BitSetBase<Self>::or_with(const BitSetBase<Other>& other) {
+    OK_ASSERT(self_cast()->get_bit_count() == other.self_cast()->get_bit_count());
+    bits_or(self_cast()->get_words(), other.self_cast()->get_words(), words_for(self_cast()->get_bit_count()));
+}
+
+template <typename Self>
+template <typename Other>
+void BitSetBase<Self>::xor_with(const BitSetBase<Other>& other) {
+    OK_ASSERT(self_cast()->get_bit_count() == other.self_cast()->get_bit_count());
+    bits_xor(self_cast()->get_words(), other.self_cast()->get_words(), words_for(self_cast()->get_bit_count()));
+}
+
+template <typename Self>
+template <typename Other>
+void BitSetBase<Self>::andnot_with(const BitSetBase<Other>& other) {
+    OK_ASSERT(self_cast()->get_bit_count() == other.self_cast()->get_bit_count());
+    bits_andnot(self_cast()->get_words(), other.self_cast()->get_words(), words_for(self_cast()->get_bit_count()));
+}
+
+// SLOT MAP IMPLEMENTATION
+template <typename T>
+SlotMap<T> SlotMap<T>::alloc(Allocator* a, UZ capacity) {
+    SlotMap<T> map;
+    map.values = List<T>::alloc(a, capacity);
+    map.dense_to_slot = List<U32>::alloc(a, capacity);
+    map.slots = List<Slot>::alloc(a, capacity);
+    map.free_head = NO_SLOT;
+    return map;
+}
+
+// Takes a slot off the free list, or a fresh one, and points it at the end of `values`.
+template <typename T>
+SlotHandle SlotMap<T>::claim_slot() {
+    U32 slot_idx;
+    if (free_head != NO_SLOT) {
+        slot_idx = free_head;
+        free_head = slots.items[slot_idx].dense_or_next_free;
+    } else {
+        OK_ASSERT(slots.count < NO_SLOT);
+        slot_idx = (U32)slots.count;
+        slots.push(Slot{0, 0});
+    }
+
+    Slot* slot = slots.items + slot_idx;
+    slot->generation++;
+    slot->dense_or_next_free = (U32)values.count;
+    dense_to_slot.push(slot_idx);
+
+    return SlotHandle{((U64)slot->generation << 32) | slot_idx};
+}
+
+template <typename T>
+SlotHandle SlotMap<T>::insert(const T& value) {
+    SlotHandle handle = claim_slot();
+    values.push(value);
+    return handle;
+}
+
+template <typename T>
+SlotHandle SlotMap<T>::insert(T&& value) {
+    SlotHandle handle = claim_slot();
+    values.push(ok::move(value));
+    return handle;
+}
+
+template <typename T>
+bool SlotMap<T>::remove(SlotHandle handle) {
+    if (!has(handle)) return false;
+
+    Slot* slot = slots.items + handle.index();
+    U32 dense_idx = slot->dense_or_next_free;
+    U32 last_idx = (U32)values.count - 1;
+
+    if (dense_idx != last_idx) {
+        U32 moved_slot = dense_to_slot.items[last_idx];
+        slots.items[moved_slot].dense_or_next_free = dense_idx;
+        dense_to_slot.items[dense_idx] = moved_slot;
+    }
+
+    values.swap_remove(dense_idx);
+    dense_to_slot.count--;
+
+    // The generation wraps around after 2^31 reuses of a single slot.
+    slot->generation++;
+    slot->dense_or_next_free = free_head;
+    free_head = handle.index();
+
+    return true;
+}
+
+template <typename T>
+Optional<T> SlotMap<T>::get(SlotHandle handle) const {
+    if (!has(handle)) return Optional<T>::empty();
+    return values.items[slots.items[handle.index()].dense_or_next_free];
+}
+
+template <typename T>
+Optional<T&> SlotMap<T>::get_ref(SlotHandle handle) {
+    if (!has(handle)) return Optional<T&>::empty();
+    return values.items[slots.items[handle.index()].dense_or_next_free];
+}
+
+template <typename T>
+void SlotMap<T>::clear() {
+    for (UZ i = 0; i < values.count; i++) {
+        U32 slot_idx = dense_to_slot.items[i];
+        Slot* slot = slots.items + slot_idx;
+        slot->generation++;
+        slot->dense_or_next_free = free_head;
+        free_head = slot_idx;
+    }
+
+    destroy_items(values.items, values.count);
+    values.count = 0;
+    dense_to_slot.count = 0;
+}
+
+// B-TREE MAP IMPLEMENTATION
+template <typename K, typename V, typename Cmp>
+BTreeMap<K, V, Cmp> BTreeMap<K, V, Cmp>::alloc(Allocator* a) {
+    BTreeMap<K, V, Cmp> map{};
+    map.allocator = a;
+    return map;
+}
+
+template <typename K, typename V, typename Cmp>
+UZ BTreeMap<K, V, Cmp>::lower_bound_in(const K* keys, UZ n, const K& key) {
+    UZ lo = 0;
+    while (n > 0) {
+        UZ half = n / 2;
+        if (Cmp::less(keys[lo + half], key)) {
+            lo += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return lo;
+}
+
+template <typename K, typename V, typename Cmp>
+UZ BTreeMap<K, V, Cmp>::upper_bound_in(const K* keys, UZ n, const K& key) {
+    UZ lo = 0;
+    while (n > 0) {
+        UZ half = n / 2;
+        if (!Cmp::less(key, keys[lo + half])) {
+            lo += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return lo;
+}
+
+template <typename K, typename V, typename Cmp>
+typename BTreeMap<K, V, Cmp>::Leaf* BTreeMap<K, V, Cmp>::new_leaf() {
+    Leaf* leaf = (Leaf*)allocator->raw_alloc(NODE_SIZE);
+    OK_ASSERT(leaf != nullptr);
+    leaf->count = 0;
+    leaf->is_leaf = true;
+    leaf->next = nullptr;
+    return leaf;
+}
+
+template <typename K, typename V, typename Cmp>
+typename BTreeMap<K, V, Cmp>::Inner* BTreeMap<K, V, Cmp>::new_inner() {
+    Inner* inner = (Inner*)allocator->raw_alloc(NODE_SIZE);
+    OK_ASSERT(inner != nullptr);
+    inner->count = 0;
+    inner->is_leaf = false;
+    return inner;
+}
+
+template <typename K, typename V, typename Cmp>
+void BTreeMap<K, V, Cmp>::free_node(Node* node) {
+    allocator->raw_dealloc(node, NODE_SIZE);
+}
+
+template <typename K, typename V, typename Cmp>
+void BTreeMap<K, V, Cmp>::destroy_subtree(Node* node) {
+    if (node->is_leaf) {
+        Leaf* leaf = static_cast<Leaf*>(node);
+        destroy_items(leaf->keys(), leaf->count);
+        destroy_items(leaf->values(), leaf->count);
+    } else {
+        Inner* inner = static_cast<Inner*>(node);
+        for (UZ i = 0; i <= inner->count; i++) destroy_subtree(inner->children[i]);
+        destroy_items(inner->keys(), inner->count);
+    }
+
+    free_node(node);
+}
+
+template <typename K, typename V, typename Cmp>
+void BTreeMap<K, V, Cmp>::dealloc() {
+    if (root != nullptr) destroy_subtree(root);
+    memset((void*)this, 0, sizeof(*this));
+}
+
+template <typename K, typename V, typename Cmp>
+typename BTreeMap<K, V, Cmp>::Leaf* BTreeMap<K, V, Cmp>::find_leaf(const K& key) const {
+    Node* node = root;
+    if (node == nullptr) return nullptr;
+
+    while (!node->is_leaf) {
+        Inner* inner = static_cast<Inner*>(node);
+        node = inner->children[upper_bound_in(inner->keys(), inner->count, key)];
+    }
+
+    return static_cast<Leaf*>(node);
+}
+
+template <typename K, typename V, typename Cmp>
+Optional<V> BTreeMap<K, V, Cmp>::get(const K& key) const {
+    Leaf* leaf = find_leaf(key);
+    if (leaf == nullptr) return Optional<V>::empty();
+
+    UZ idx = lower_bound_in(leaf->keys(), leaf->count, key);
+    if (idx < leaf->count && equal(leaf->keys()[idx], key)) return leaf->values()[idx];
+
+    return Optional<V>::empty();
+}
+
+template <typename K, typename V, typename Cmp>
+Optional<V&> BTreeMap<K, V, Cmp>::get_ref(const K& key) {
+    Leaf* leaf = find_leaf(key);
+    if (leaf == nullptr) return Optional<V&>::empty();
+
+    UZ idx = lower_bound_in(leaf->keys(), leaf->count, key);
+    if (idx < leaf->count && equal(leaf->keys()[idx], key)) return leaf->values()[idx];
+
+    return Optional<V&>::empty();
+}
+
+template <typename K, typename V, typename Cmp>
+bool BTreeMap<K, V, Cmp>::has(const K& key) const {
+    Leaf* leaf = find_leaf(key);
+    if (leaf == nullptr) return false;
+
+    UZ idx = lower_bound_in(leaf->keys(), leaf->count, key);
+    return idx < leaf->count && equal(leaf->keys()[idx], key);
+}
+
+template <typename K, typename V, typename Cmp>
+void BTreeMap<K, V, Cmp>::split_child(Inner* parent, UZ idx) {
+    Node* child = parent->children[idx];
+    Node* right;
+
+    if (child->is_leaf) {
+        Leaf* left_leaf = static_cast<Leaf*>(child);
+        Leaf* right_leaf = new_leaf();
+
+        UZ mid = left_leaf->count / 2;
+        UZ moved = left_leaf->count - mid;
+        relocate_items(right_leaf->keys(), left_leaf->keys() + mid, moved);
+        relocate_items(right_leaf->values(), left_leaf->values() + mid, moved);
+        left_leaf->count = (U16)mid;
+        right_leaf->count = (U16)moved;
+
+        right_leaf->next = left_leaf->next;
+        left_leaf->next = right_leaf;
+
+        relocate_items(parent->keys() + idx + 1, parent->keys() + idx, parent->count - idx);
+        OK_PLACEMENT_NEW(parent->keys() + idx) K(right_leaf->keys()[0]);
+        right = right_leaf;
+    } else {
+        Inner* left_inner = static_cast<Inner*>(child);
+        Inner* right_inner = new_inner();
+
+        UZ mid = left_inner->count / 2;
+        UZ moved = left_inner->count - mid - 1;
+        relocate_items(right_inner->keys(), left_inner->keys() + mid + 1, moved);
+        memcpy(right_inner->children, left_inner->children + mid + 1, (moved + 1) * sizeof(Node*));
+        right_inner->count = (U16)moved;
+
+        relocate_items(parent->keys() + idx + 1, parent->keys() + idx, parent->count - idx);
+        relocate_items(parent->keys() + idx, left_inner->keys() + mid, 1);
+        left_inner->count = (U16)mid;
+        right = right_inner;
+    }
+
+    memmove(parent->children + idx + 2, parent->children + idx + 1, (parent->count - idx) * sizeof(Node*));
+    parent->children[idx + 1] = right;
+    parent->count++;
+}
+
+template <typename K, typename V, typename Cmp>
+void BTreeMap<K, V, Cmp>::put(const K& key, const V& value) {
+    put<const K&, const V&>(key, value);
+}
+
+// NOTE: Full nodes are split on the way down, so the leaf always has room and no
+// split ever has to travel back up the tree.
+template <typename K, typename V, typename Cmp>
+template <typename KK, typename VV>
+requires is_same<RemoveCVRef<KK>, K> && is_same<RemoveCVRef<VV>, V>
+void BTreeMap<K, V, Cmp>::put(KK&& key, VV&& value) {
+    if (root == nullptr) root = new_leaf();
+
+    if (is_full(root)) {
+        Inner* new_root = new_inner();
+        new_root->children[0] = root;
+        root = new_root;
+        split_child(new_root, 0);
+    }
+
+    Node* node = root;
+    while (!node->is_leaf) {
+        Inner* inner = static_cast<Inner*>(node);
+        UZ idx = upper_bound_in(inner->keys(), inner->count, key);
+
+        if (is_full(inner->children[idx])) {
+            split_child(inner, idx);
+            if (!Cmp::less(key, inner->keys()[idx])) idx++;
+        }
+
+        node = inner->children[idx];
+    }
+
+    Leaf* leaf = static_cast<Leaf*>(node);
+    UZ idx = lower_bound_in(leaf->keys(), leaf->count, key);
+
+    if (idx < leaf->count && equal(leaf->keys()[idx], key)) {
+        leaf->values()[idx] = forward<VV>(value);
+        return;
+    }
+
+    relocate_items(leaf->keys() + idx + 1, leaf->keys() + idx, leaf->count - idx);
+    relocate_items(leaf->values() + idx + 1, leaf->values() + idx, leaf->count - idx);
+    OK_PLACEMENT_NEW(leaf->keys() + idx) K(forward<KK>(key));
+    OK_PLACEMENT_NEW(leaf->values() + idx) V(forward<VV>(value));
+    leaf->count++;
+    count++;
+}
+
+template <typename K, typename V, typename Cmp>
+bool BTreeMap<K, V, Cmp>::remove(const K& key) {
+    if (root == nullptr || !remove_from(root, key)) return false;
+
+    count--;
+
+    if (root->is_leaf) {
+        if (root->count == 0) {
+            free_node(root);
+            root = nullptr;
+        }
+    } else if (root->count == 0) {
+        Node* old_root = root;
+        root = static_cast<Inner*>(root)->children[0];
+        free_node(old_root);
+    }
+
+    return true;
+}
+
+// NOTE: Separators are left alone when their key is removed from a leaf. A stale
+// separator still splits the key space correctly, it's just not present in the map.
+template <typename K, typename V, typename Cmp>
+bool BTreeMap<K, V, Cmp>::remove_from(Node* node, const K& key) {
+    if (node->is_leaf) {
+        Leaf* leaf = static_cast<Leaf*>(node);
+        UZ idx = lower_bound_in(leaf->keys(), leaf->count, key);
+        if (idx == leaf->count || !equal(leaf->keys()[idx], key)) return false;
+
+        destroy_items(leaf->keys() + idx, 1);
+        destroy_items(leaf->values() + idx, 1);
+        relocate_items(leaf->keys() + idx, leaf->keys() + idx + 1, leaf->count - idx - 1);
+        relocate_items(leaf->values() + idx, leaf->values() + idx + 1, leaf->count - idx - 1);
+        leaf->count--;
+        return true;
+    }
+
+    Inner* inner = static_cast<Inner*>(node);
+    UZ idx = upper_bound_in(inner->keys(), inner->count, key);
+    if (!remove_from(inner->children[idx], key)) return false;
+
+    if (is_underfull(inner->children[idx])) rebalance(inner, idx);
+    return true;
+}
+
+template <typename K, typename V, typename Cmp>
+void BTreeMap<K, V, Cmp>::rebalance(Inner* parent, UZ idx) {
+    Node* child = parent->children[idx];
+    Node* left = idx > 0 ? parent->children[idx - 1] : nullptr;
+    Node* right = idx < parent->count ? parent->children[idx + 1] : nullptr;
+    UZ min_count = child->is_leaf ? LEAF_MIN : INNER_MIN;
+    K* separators = parent->keys();
+
+    if (left != nullptr && left->count > min_count) {
+        if (child->is_leaf) {
+            Leaf* c = static_cast<Leaf*>(child);
+            Leaf* l = static_cast<Leaf*>(left);
+            relocate_items(c->keys() + 1, c->keys(), c->count);
+            relocate_items(c->values() + 1, c->values(), c->count);
+            relocate_items(c->keys(), l->keys() + l->count - 1, 1);
+            relocate_items(c->values(), l->values() + l->count - 1, 1);
+            separators[idx - 1] = c->keys()[0];
+        } else {
+            Inner* c = static_cast<Inner*>(child);
+            Inner* l = static_cast<Inner*>(left);
+            relocate_items(c->keys() + 1, c->keys(), c->count);
+            memmove(c->children + 1, c->children, (c->count + 1) * sizeof(Node*));
+            relocate_items(c->keys(), separators + idx - 1, 1);
+            c->children[0] = l->children[l->count];
+            relocate_items(separators + idx - 1, l->keys() + l->count - 1, 1);
+        }
+
+        child->count++;
+        left->count--;
+    } else if (right != nullptr && right->count > min_count) {
+        if (child->is_leaf) {
+            Leaf* c = static_cast<Leaf*>(child);
+            Leaf* r = static_cast<Leaf*>(right);
+            relocate_items(c->keys() + c->count, r->keys(), 1);
+            relocate_items(c->values() + c->count, r->values(), 1);
+            relocate_items(r->keys(), r->keys() + 1, r->count - 1);
+            relocate_items(r->values(), r->values() + 1, r->count - 1);
+            separators[idx] = r->keys()[0];
+        } else {
+            Inner* c = static_cast<Inner*>(child);
+            Inner* r = static_cast<Inner*>(right);
+            relocate_items(c->keys() + c->count, separators + idx, 1);
+            c->children[c->count + 1] = r->children[0];
+            relocate_items(separators + idx, r->keys(), 1);
+            relocate_items(r->keys(), r->keys() + 1, r->count - 1);
+            memmove(r->children, r->children + 1, r->count * sizeof(Node*));
+        }
+
+        child->count++;
+        right->count--;
+    } else {
+        merge_children(parent, left != nullptr ? idx - 1 : idx);
+    }
+}
+
+// Folds `children[idx + 1]` into `children[idx]` and drops the separator between them.
+template <typename K, typename V, typename Cmp>
+void BTreeMap<K, V, Cmp>::merge_children(Inner* parent, UZ idx) {
+    Node* left = parent->children[idx];
+    Node* right = parent->children[idx + 1];
+
+    if (left->is_leaf) {
+        Leaf* l = static_cast<Leaf*>(left);
+        Leaf* r = static_cast<Leaf*>(right);
+        relocate_items(l->keys() + l->count, r->keys(), r->count);
+        relocate_items(l->values() + l->count, r->values(), r->count);
+        l->count += r->count;
+        l->next = r->next;
+        destroy_items(parent->keys() + idx, 1);
+    } else {
+        Inner* l = static_cast<Inner*>(left);
+        Inner* r = static_cast<Inner*>(right);
+        relocate_items(l->keys() + l->count, parent->keys() + idx, 1);
+        relocate_items(l->keys() + l->count + 1, r->keys(), r->count);
+        memcpy(l->children + l->count + 1, r->children, (r->count + 1) * sizeof(Node*));
+        l->count += r->count + 1;
+    }
+
+    relocate_items(parent->keys() + idx, parent->keys() + idx + 1, parent->count - idx - 1);
+    memmove(parent->children + idx + 1, parent->children + idx + 2, (parent->count - idx - 1) * sizeof(Node*));
+    parent->count--;
+
+    free_node(right);
+}
+
+template <typename K, typename V, typename Cmp>
+typename BTreeMap<K, V, Cmp>::ConstIterator BTreeMap<K, V, Cmp>::begin() const {
+    Node* node = root;
+    if (node == nullptr) return ConstIterator{nullptr, 0};
+
+    while (!node->is_leaf) node = static_cast<Inner*>(node)->children[0];
+    return ConstIterator{static_cast<Leaf*>(node), 0};
+}
+
+template <typename K, typename V, typename Cmp>
+typename BTreeMap<K, V, Cmp>::ConstIterator BTreeMap<K, V, Cmp>::lower_bound(const K& key) const {
+    Leaf* leaf = find_leaf(key);
+    if (leaf == nullptr) return ConstIterator{nullptr, 0};
+
+    UZ idx = lower_bound_in(leaf->keys(), leaf->count, key);
+    if (idx == leaf->count) return ConstIterator{leaf->next, 0};
+
+    return ConstIterator{leaf, idx};
+}
+
+template <typename K, typename V, typename Cmp>
+typename BTreeMap<K, V, Cmp>::ConstIterator BTreeMap<K, V, Cmp>::upper_bound(const K& key) const {
+    Leaf* leaf = find_leaf(key);
+    if (leaf == nullptr) return ConstIterator{nullptr, 0};
+
+    UZ idx = upper_bound_in(leaf->keys(), leaf->count, key);
+    if (idx == leaf->count) return ConstIterator{leaf->next, 0};
+
+    return ConstIterator{leaf, idx};
+}
+
+template <typename K, typename V, typename Cmp>
+template <typename F>
+void BTreeMap<K, V, Cmp>::for_each_in_range(const K& lo, const K& hi, F f) const {
+    for (ConstIterator it = lower_bound(lo); it.valid() && Cmp::less(it.key(), hi); it.next()) {
+        f(it.key(), it.value());
+    }
+}
+
+template <typename K, typename V, typename Cmp>
+template <typename F>
+void BTreeMap<K, V, Cmp>::for_each_in_range(const K& lo, const K& hi, F f) {
+    for (Iterator it = lower_bound(lo); it.valid() && Cmp::less(it.key(), hi); it.next()) {
+        f(it.key(), it.value());
+    }
+}
+
+template <typename K, typename V, typename Cmp>
+BTreeMap<K, V, Cmp> BTreeMap<K, V, Cmp>::from_sorted(Allocator* a, Slice<const K> keys, Slice<const V> values) {
+    OK_ASSERT(keys.count == values.count);
+    for (UZ i = 1; i < keys.count; i++) OK_ASSERT(Cmp::less(keys[i - 1], keys[i]));
+
+    BTreeMap<K, V, Cmp> map = BTreeMap<K, V, Cmp>::alloc(a);
+    if (keys.count == 0) return map;
+
+    // Node counts per level, leaves first. Every level spreads its entries evenly over
+    // the nodes, which keeps all of the nodes at least half full.
+    UZ level_counts[64];
+    UZ levels = 1;
+    level_counts[0] = (keys.count + LEAF_CAP - 1) / LEAF_CAP;
+    while (level_counts[levels - 1] > 1) {
+        level_counts[levels] = (level_counts[levels - 1] + INNER_CAP) / (INNER_CAP + 1);
+        levels++;
+    }
+
+    Leaf* prev_leaf = nullptr;
+    map.root = map.build_level(keys, values, level_counts, levels - 1, 0, &prev_leaf);
+    map.count = keys.count;
+    return map;
+}
+
+// Builds node `idx` of `level`. Node `i` out of `n` on a level owns the items (or the
+// children) in `[i * total / n, (i + 1) * total / n)`.
+template <typename K, typename V, typename Cmp>
+typename BTreeMap<K, V, Cmp>::Node* BTreeMap<K, V, Cmp>::build_level(Slice<const K> keys, Slice<const V> values, const UZ* level_counts, UZ level, UZ idx, Leaf** prev_leaf) {
+    if (level == 0) {
+        UZ leaf_count = level_counts[0];
+        UZ start = idx * keys.count / leaf_count;
+        UZ end = (idx + 1) * keys.count / leaf_count;
+
+        Leaf* leaf = new_leaf();
+        copy_items(leaf->keys(), keys.items + start, end - start);
+        copy_items(leaf->values(), values.items + start, end - start);
+        leaf->count = (U16)(end - start);
+
+        if (*prev_leaf != nullptr) (*prev_leaf)->next = leaf;
+        *prev_leaf = leaf;
+        return leaf;
+    }
+
+    UZ child_total = level_counts[level - 1];
+    UZ start = idx * child_total / level_counts[level];
+    UZ end = (idx + 1) * child_total / level_counts[level];
+
+    Inner* inner = new_inner();
+    for (UZ child = start; child < end; child++) {
+        if (child > start) {
+            // The separator is the smallest key under `child`, found by following its
+            // leftmost descendants down to a leaf.
+            UZ first = child;
+            for (UZ l = level - 1; l > 0; l--) first = first * level_counts[l - 1] / level_counts[l];
+            UZ item = first * keys.count / level_counts[0];
+            OK_PLACEMENT_NEW(inner->keys() + child - start - 1) K(keys[item]);
+        }
+
+        inner->children[child - start] = build_level(keys, values, level_counts, level - 1, child, prev_leaf);
+    }
+
+    inner->count = (U16)(end - start - 1);
+    return inner;
+}
+
+// TABLE IMPLEMENTATION
+
+template <typename K, typename V>
+Table<K, V> Table<K, V>::alloc(Allocator* a, UZ capacity) {
+    Table<K, V> tab{};
+
+    tab.keys = a->alloc<K>(capacity);
+    tab.values = a->alloc<V>(capacity);
+    tab.meta = a->alloc<Meta>(capacity);
+    tab.count = 0;
+    tab.capacity = capacity;
+    tab.allocator = a;
+
+    return tab;
+}
+
+template <typename K, typename V>
+void Table<K, V>::put(const K& key, const V& value) {
+    put<const K&, const V&>(key, value);
+}
+
+template <typename TKey, typename TValue>
+template <typename K, typename V>
+requires is_same<RemoveCVRef<K>, TKey> && is_same<RemoveCVRef<V>, TValue>
+void Table<TKey, TValue>::put(K&& key, V&& value) {
+    if (load_percentage() >= 70) grow();
+
+    U64 idx = Hash<TKey>::hash(key) % capacity;
+
+    while (true) {
+        if (OK_TAB_IS_FREE(meta[idx])) {
+            meta[idx] |= OK_TAB_META_OCCUPIED;
+            OK_PLACEMENT_NEW(keys + idx) TKey(forward<K>(key));
+            OK_PLACEMENT_NEW(values + idx) TValue(forward<V>(value));
+            count++;
+            return;
+        }
+
+        if (keys[idx] == key) {
+            values[idx] = forward<V>(value);
+            return;
+        }
+
+        idx = (idx + 1) % capacity;
+    }
+}
+
+template <typename K, typename V>
+void Table<K, V>::grow() {
+    auto grown = Table<K, V>::alloc(allocator, OK_TABLE_GROWTH_FACTOR(capacity));
+
+    for (UZ i = 0; i < capacity; i++) {
+        if (OK_TAB_IS_FREE(meta[i])) continue;
+
+        grown.put(move(keys[i]), move(values[i]));
+        destroy_items(keys + i, 1);
+        destroy_items(values + i, 1);
+    }
+
+    this->dealloc();
+    *this = grown;
+}
+
+template <typename K, typename V>
+Optional<V> Table<K, V>::get(const K& key) const {
+    U64 idx = Hash<K>::hash(key) % capacity;
+    U64 initial_idx = idx;
+
+    do {
+        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
+            return values[idx];
+        }
+
+        idx = (idx + 1) % capacity;
+    } while (idx != initial_idx);
+
+    return Optional<V>::empty();
+}
+
+template <typename TKey, typename TValue>
+template <typename K>
+Optional<TValue> Table<TKey, TValue>::get(const K& key) const {
+    U64 idx = Hash<K>::hash(key) % capacity;
+    U64 initial_idx = idx;
+
+    do {
+        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
+            return values[idx];
+        }
+
+        idx = (idx + 1) % capacity;
+    } while (idx != initial_idx);
+
+    return Optional<TValue>::empty();
+}
+
+template <typename K, typename V>
+Optional<V&> Table<K, V>::get_ref(const K& key) {
+    U64 idx = Hash<K>::hash(key) % capacity;
+    U64 initial_idx = idx;
+
+    do {
+        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
+            return values[idx];
+        }
+
+        idx = (idx + 1) % capacity;
+    } while (idx != initial_idx);
+
+    return Optional<V&>::empty();
+}
+
+template <typename K, typename V>
+Optional<const V&> Table<K, V>::get_ref(const K& key) const {
+    U64 idx = Hash<K>::hash(key) % capacity;
+    U64 initial_idx = idx;
+
+    do {
+        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
+            return values[idx];
+        }
+
+        idx = (idx + 1) % capacity;
+    } while (idx != initial_idx);
+
+    return Optional<const V&>::empty();
+}
+
+template <typename TKey, typename TValue>
+template <typename K>
+Optional<TValue&> Table<TKey, TValue>::get_ref(const K& key) {
+    U64 idx = Hash<K>::hash(key) % capacity;
+    U64 initial_idx = idx;
+
+    do {
+        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
+            return values[idx];
+        }
+
+        idx = (idx + 1) % capacity;
+    } while (idx != initial_idx);
+
+    return Optional<TValue&>::empty();
+}
+
+template <typename TKey, typename TValue>
+template <typename K>
+Optional<const TValue&> Table<TKey, TValue>::get_ref(const K& key) const {
+    U64 idx = Hash<K>::hash(key) % capacity;
+    U64 initial_idx = idx;
+
+    do {
+        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
+            return values[idx];
+        }
+
+        idx = (idx + 1) % capacity;
+    } while (idx != initial_idx);
+
+    return Optional<const TValue&>::empty();
+}
+
+template <typename K, typename V>
+bool Table<K, V>::has(const K& key) const {
+    U64 idx = Hash<K>::hash(key) % capacity;
+    U64 initial_idx = idx;
+
+    do {
+        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
+            return true;
+        }
+
+        idx = (idx + 1) % capacity;
+    } while (idx != initial_idx);
+
+    return false;
+}
+
+template <typename TKey, typename TValue>
+template <typename K>
+bool Table<TKey, TValue>::has(const K& key) const {
     U64 idx = Hash<K>::hash(key) % capacity;
     U64 initial_idx = idx;
 
-    do {
-        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
-            return true;
-        }
+    do {
+        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
+            return true;
+        }
+
+        idx = (idx + 1) % capacity;
+    } while (idx != initial_idx);
+
+    return false;
+}
+
+// NOTE(oleh): Should we call destructors here?
+template <typename TKey, typename TValue>
+bool Table<TKey, TValue>::remove(const TKey& key) {
+    U64 idx = Hash<TKey>::hash(key) % capacity;
+    bool result = OK_TAB_IS_OCCUPIED(meta[idx]);
+    if (result) --count;
+    meta[idx] &= ~OK_TAB_META_OCCUPIED;
+    return result;
+}
+
+// SET IMPLEMENTATION
+template <typename T>
+Set<T> Set<T>::alloc(Allocator* a, UZ capacity) {
+    Set<T> set;
+    set.allocator = a;
+    set.count = 0;
+    set.capacity = capacity;
+    set.values = a->alloc<T>(capacity);
+    set.meta = a->alloc<Meta>(capacity);
+    return set;
+}
+
+template <typename T>
+void Set<T>::put(const T& elem) {
+    if (load_percentage() >= 70) {
+        auto new_set = Set<T>::alloc(allocator, OK_SET_GROWTH_FACTOR(capacity));
+
+        for (UZ i = 0; i < capacity; i++) {
+            if (OK_TAB_IS_FREE(meta[i])) {
+                continue;
+            }
+
+            new_set.put(values[i]);
+        }
+
+        *this = new_set;
+    }
+
+    U64 hash = Hash<T>::hash(elem);
+
+    while (true) {
+        if (OK_TAB_IS_FREE(meta[hash])) {
+            meta[hash] |= OK_TAB_META_OCCUPIED;
+            values[hash] = elem;
+            count++;
+            return;
+        }
+
+        if (values[hash] == elem) {
+            values[hash] = elem;
+            return;
+        }
+
+        hash = (hash + 1) % capacity;
+    }
+}
+
+template <typename T>
+bool Set<T>::has(const T& elem) const {
+    U64 hash = Hash<T>::hash(elem);
+    U64 idx = hash;
+
+    do {
+        if (OK_TAB_IS_OCCUPIED(meta[idx]) && values[idx] == elem) {
+            return true;
+        }
+
+        idx = (idx + 1) % capacity;
+    } while (idx != hash);
+
+    return false;
+}
+
+// Filesystem API
+struct File {
+#if OK_UNIX
+    enum class IOError {
+        ACCESS_DENIED,
+        INVALID_PATH,
+        IS_DIRECTORY,
+        TOO_MANY_SYMLINKS,
+        PROCESS_OPEN_FILES_LIMIT_REACHED,
+        SYSTEM_OPEN_FILES_LIMIT_REACHED,
+        PATH_TOO_LONG,
+        KERNEL_OUT_OF_MEMORY,
+        OUT_OF_SPACE,
+        IS_SOCKET,
+        FILE_TOO_BIG,
+        READONLY_FILE,
+        IO,
+        NOT_ALLOWED,
+        BAD_DATA,
+        BAD_FILE_DESCRIPTOR,
+        INTERRUPTED_BY_SIGNAL,
+        CURRENTLY_IN_USE,
+        READONLY_FS,
+        DOES_NOT_EXIST,
+    };
+
+    using OpenError = IOError;
+    using ReadError = IOError;
+    using WriteError = IOError;
+    using CloseError = IOError;
+    using RemoveError = IOError;
+#elif OK_WINDOWS
+    using IOError = DWORD;
+    using OpenError = DWORD;
+    using ReadError = DWORD;
+    using WriteError = DWORD;
+    using CloseError = DWORD;
+    using RemoveError = DWORD;
+#else
+    struct IOError {};
+    struct OpenError {};
+    struct ReadError {};
+    struct WriteError {};
+    struct CloseError {};
+    struct RemoveError {};
+#endif // Platform check.
+
+    static Optional<OpenError> open(File* out, const char* path);
+    static Optional<OpenError> open(File* out, StringView path);
+
+    static bool exists(const char* path);
+    static bool exists(StringView path);
+
+#if OK_UNIX
+    static File from_fd(int fd, const char *path) {
+        return File{
+            .fd = fd,
+            .offset = 0,
+            .path = path,
+        };
+    }
+
+    static String error_string(Allocator*, IOError);
+#elif OK_WINDOWS
+    static String error_string(Allocator*, DWORD);
+#endif // Platform check.
+
+    void seek_to(U64 offset);
+
+    inline void seek_start() {
+        return seek_to(0);
+    }
+
+    U64 seek_end();
+
+    Optional<ReadError> read(U8* buf, UZ count, UZ* n_read);
+    Optional<ReadError> read_full(Allocator* a, List<U8>* out);
+
+    Optional<WriteError> write(const U8 *data, UZ count, UZ *n_written);
+
+    inline Optional<WriteError> write(Slice<U8> data) {
+        return write(data.items, data.count, nullptr);
+    }
+
+    UZ size();
+
+    inline Optional<WriteError> write(StringView data) {
+        Slice<const char> chars = data.slice();
+        return write(chars.cast<U8>());
+    }
+
+    Optional<CloseError> close() const;
+
+    Optional<RemoveError> remove();
+
+    Optional<IOError> truncate(UZ);
+
+#if OK_UNIX
+    int fd;
+#elif OK_WINDOWS
+    HANDLE handle;
+#endif // Platform check.
+    UZ offset;
+
+    const char* path;
+};
+
+// Procedures.
+// The formatting overloads of `println` and `eprintln` are further down. These print
+// runtime text as is. They only take C string pointers, `StringView`s and `String`s,
+// so that literals, which are arrays, always go through the checked format strings.
+template <typename S>
+constexpr bool _is_runtime_text = is_same<S, const char*> || is_same<S, char*> || is_same<S, StringView> ||
+                                  is_same<S, String>;
+
+template <typename S>
+requires _is_runtime_text<S>
+void println(const S& text);
+
+template <typename S>
+requires _is_runtime_text<S>
+void eprintln(const S& text);
+
+// Integer to text. The `format_*` procedures write into `buf`, which needs room for
+// `MAX_INT_CHARS` chars, and return how many they wrote. Nothing gets null terminated.
+// Negative values come out as a minus sign followed by the magnitude, in every base.
+static constexpr UZ MAX_DECIMAL_INT_CHARS = 20 + 1;
+static constexpr UZ MAX_INT_CHARS = 64 + 1;
+
+U32 count_decimal_digits(U64 value);
+U32 count_digits_in_base(U64 value, U32 base);
+
+UZ format_uint(char* buf, U64 value);
+UZ format_uint_hex(char* buf, U64 value, bool uppercase = false);
+// `base` goes from 2 to 36, digits past 9 are letters.
+UZ format_uint_base(char* buf, U64 value, U32 base, bool uppercase = false);
+
+template <typename T>
+requires is_integer<T>
+inline U64 int_magnitude(T value, bool* negative) {
+    using U = typename UnsignedOfSize<sizeof(T)>::Type;
+
+    *negative = false;
+    if constexpr (is_signed<T>) {
+        if (value < 0) {
+            *negative = true;
+            return (U)(0 - (U)value);
+        }
+    }
+
+    return (U)value;
+}
+
+template <typename T>
+requires is_integer<T>
+inline UZ format_int(char* buf, T value) {
+    bool negative;
+    U64 magnitude = int_magnitude(value, &negative);
+    if (negative) *buf = '-';
+    return negative + format_uint(buf + negative, magnitude);
+}
+
+template <typename T>
+requires is_integer<T>
+inline UZ format_int_hex(char* buf, T value, bool uppercase = false) {
+    bool negative;
+    U64 magnitude = int_magnitude(value, &negative);
+    if (negative) *buf = '-';
+    return negative + format_uint_hex(buf + negative, magnitude, uppercase);
+}
+
+template <typename T>
+requires is_integer<T>
+inline UZ format_int_base(char* buf, T value, U32 base, bool uppercase = false) {
+    bool negative;
+    U64 magnitude = int_magnitude(value, &negative);
+    if (negative) *buf = '-';
+    return negative + format_uint_base(buf + negative, magnitude, base, uppercase);
+}
+
+// Write straight into the string's spare capacity.
+template <typename T>
+requires is_integer<T>
+inline void append_int(String* s, T value) {
+    s->reserve_extra(MAX_DECIMAL_INT_CHARS);
+    UZ count = s->count();
+    s->set_count(count + format_int(s->get_items() + count, value));
+}
+
+template <typename T>
+requires is_integer<T>
+inline void append_int_hex(String* s, T value, bool uppercase = false) {
+    s->reserve_extra(MAX_INT_CHARS);
+    UZ count = s->count();
+    s->set_count(count + format_int_hex(s->get_items() + count, value, uppercase));
+}
+
+template <typename T>
+requires is_integer<T>
+inline void append_int_base(String* s, T value, U32 base, bool uppercase = false) {
+    s->reserve_extra(MAX_INT_CHARS);
+    UZ count = s->count();
+    s->set_count(count + format_int_base(s->get_items() + count, value, base, uppercase));
+}
+
+// Floating point to text and back, both correctly rounded. `format_f64` and `format_f32`
+// write the shortest text that reads back as the same value, picking plain or scientific
+// notation by whichever is shorter, like `std::to_chars`. `buf` needs room for
+// `MAX_FLOAT_CHARS` chars.
+static constexpr UZ MAX_FLOAT_CHARS = 32;
+
+UZ format_f64(char* buf, F64 value);
+UZ format_f32(char* buf, F32 value);
+
+inline void append_f64(String* s, F64 value) {
+    s->reserve_extra(MAX_FLOAT_CHARS);
+    UZ count = s->count();
+    s->set_count(count + format_f64(s->get_items() + count, value));
+}
+
+inline void append_f32(String* s, F32 value) {
+    s->reserve_extra(MAX_FLOAT_CHARS);
+    UZ count = s->count();
+    s->set_count(count + format_f32(s->get_items() + count, value));
+}
+
+// Accepts an optional sign, then digits with an optional fraction and exponent, or `inf`,
+// `infinity` and `nan` in any case. With `consumed` the number may be followed by other text
+// and its length is stored there, without it the number has to span the whole source.
+bool parse_f64(StringView source, F64* out, UZ* consumed = nullptr);
+bool parse_f32(StringView source, F32* out, UZ* consumed = nullptr);
+
+String to_string(Allocator*, S32);
+String to_string(Allocator*, U32);
+String to_string(Allocator*, S64);
+String to_string(Allocator*, U64);
+
+// Text to integer. Takes an optional sign and then digits in `base`, which is 2, 8, 10 or 16,
+// or 0 to pick one from a `0b`, `0o` or `0x` prefix. The prefix is also allowed when the base
+// is given. Fails if the value doesn't fit in `T`. `consumed` works like with `parse_f64`.
+//
+// The value's magnitude may go up to `positive_limit`, or `negative_limit` if it has a minus.
+bool parse_int_magnitude(StringView source, U32 base, U64 positive_limit, U64 negative_limit, U64* magnitude,
+                         bool* negative, UZ* consumed);
+
+template <typename T>
+requires is_integer<T>
+inline bool parse_int(StringView source, T* out, UZ* consumed = nullptr, U32 base = 10) {
+    using U = typename UnsignedOfSize<sizeof(T)>::Type;
+
+    U64 positive_limit = is_signed<T> ? (U64)((U)~(U)0 >> 1) : (U64)(U)~(U)0;
+    U64 negative_limit = is_signed<T> ? positive_limit + 1 : 0;
+
+    U64 magnitude;
+    bool negative;
+    if (!parse_int_magnitude(source, base, positive_limit, negative_limit, &magnitude, &negative, consumed)) {
+        return false;
+    }
+
+    *out = negative ? (T)(0 - (U)magnitude) : (T)magnitude;
+    return true;
+}
+
+bool parse_int64(StringView, S64*);
+
+// UTF-8. Valid means what Unicode says: no overlong encodings, no surrogates and nothing past
+// U+10FFFF.
+bool is_valid_utf8(StringView text);
+
+// These expect valid UTF-8, see `Utf8View`.
+UZ utf8_count_codepoints(StringView text);
+
+inline UZ utf8_sequence_length(char lead) {
+    U8 b = (U8)lead;
+    if (b < 0x80) return 1;
+    if (b < 0xe0) return 2;
+    if (b < 0xf0) return 3;
+    return 4;
+}
+
+// Decodes the codepoint starting at `p` and stores the length of its encoding in `length`.
+inline U32 utf8_decode(const char* p, UZ* length) {
+    const U8* b = (const U8*)p;
+    if (b[0] < 0x80) {
+        *length = 1;
+        return b[0];
+    }
+    if (b[0] < 0xe0) {
+        *length = 2;
+        return ((U32)(b[0] & 0x1f) << 6) | (b[1] & 0x3f);
+    }
+    if (b[0] < 0xf0) {
+        *length = 3;
+        return ((U32)(b[0] & 0x0f) << 12) | ((U32)(b[1] & 0x3f) << 6) | (b[2] & 0x3f);
+    }
+    *length = 4;
+    return ((U32)(b[0] & 0x07) << 18) | ((U32)(b[1] & 0x3f) << 12) | ((U32)(b[2] & 0x3f) << 6) | (b[3] & 0x3f);
+}
+
+// Writes 1 to 4 bytes and returns how many. `codepoint` has to be a Unicode scalar value.
+inline UZ utf8_encode(U32 codepoint, char* out) {
+    U8* b = (U8*)out;
+    if (codepoint < 0x80) {
+        b[0] = (U8)codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800) {
+        b[0] = (U8)(0xc0 | (codepoint >> 6));
+        b[1] = (U8)(0x80 | (codepoint & 0x3f));
+        return 2;
+    }
+    if (codepoint < 0x10000) {
+        b[0] = (U8)(0xe0 | (codepoint >> 12));
+        b[1] = (U8)(0x80 | ((codepoint >> 6) & 0x3f));
+        b[2] = (U8)(0x80 | (codepoint & 0x3f));
+        return 3;
+    }
+    b[0] = (U8)(0xf0 | (codepoint >> 18));
+    b[1] = (U8)(0x80 | ((codepoint >> 12) & 0x3f));
+    b[2] = (U8)(0x80 | ((codepoint >> 6) & 0x3f));
+    b[3] = (U8)(0x80 | (codepoint & 0x3f));
+    return 4;
+}
+
+// Text that has been checked to be valid UTF-8, so iterating and transcoding it can skip
+// every check.
+struct Utf8View {
+    struct Iterator {
+        inline bool valid() const {
+            return p < end;
+        }
+
+        inline U32 codepoint() const {
+            UZ length;
+            return utf8_decode(p, &length);
+        }
+
+        // Byte offset of the current codepoint.
+        inline UZ offset() const {
+            return (UZ)(p - start);
+        }
+
+        inline void next() {
+            p += utf8_sequence_length(*p);
+        }
+
+        const char* start;
+        const char* p;
+        const char* end;
+    };
+
+    static Optional<Utf8View> from(StringView text);
+
+    // NOTE: No check, for text known to be valid already, like literals.
+    static inline Utf8View from_valid(StringView text) {
+        Utf8View result;
+        result.view = text;
+        return result;
+    }
+
+    inline Iterator iter() const {
+        return Iterator{view.data, view.data, view.data + view.count};
+    }
+
+    inline UZ count_codepoints() const {
+        return utf8_count_codepoints(view);
+    }
+
+    StringView view;
+};
+
+inline Optional<Utf8View> Utf8View::from(StringView text) {
+    if (!is_valid_utf8(text)) return Optional<Utf8View>::empty();
+    return from_valid(text);
+}
+
+// UTF-16 in native byte order. The `_length` functions return the exact number of code units
+// or bytes the conversion writes, so the output can be allocated up front.
+UZ utf8_to_utf16_length(Utf8View text);
+UZ utf8_to_utf16(Utf8View text, U16* out);
+List<U16> utf8_to_utf16(Allocator* a, Utf8View text);
+
+// Unpaired surrogates aren't valid but still show up in the wild, for example in file names on
+// Windows. They are converted to U+FFFD.
+bool is_valid_utf16(const U16* units, UZ count);
+UZ utf16_to_utf8_length(const U16* units, UZ count);
+UZ utf16_to_utf8(const U16* units, UZ count, char* out);
+String utf16_to_utf8(Allocator* a, const U16* units, UZ count);
+
+Optional<File::OpenError> create_temp_file(File* file);
+
+void seed_rand(U64);
+U32 get_rand();
+
+// Formatting.
+// `{}` placeholders are replaced by the arguments in order, and `{{` and `}}` stand for
+// literal braces. A placeholder may carry a spec after a colon, a subset of the one used by
+// `std::format`:
+//
+//     {:[[fill]align][0][width][.precision][type]}
+//
+// where align is one of `<`, `>` and `^`, and type is one of `b o d x X c` for integers,
+// `e E f F g G` for floats, `s` for strings and `p` for pointers. A precision is only taken
+// by floats, strings, which it cuts short, and custom types. Format strings are checked at
+// compile time: the placeholder count, the spec syntax and whether the type and precision
+// fit the argument they're paired with.
+//
+// @Customization: Other types are formatted by an overload of
+// `void ok_format(FormatWriter*, const FormatSpec&, const T&)`, found through ADL.
+struct FormatSpec {
+    enum class Align : U8 {
+        NONE,
+        LEFT,
+        RIGHT,
+        CENTER,
+    };
+
+    static constexpr U32 MAX_WIDTH = 4096;
+    static constexpr S32 MAX_PRECISION = 99;
+
+    U32 width;
+    // -1 if not given.
+    S32 precision;
+    char fill;
+    // '\0' if not given.
+    char type;
+    Align align;
+    bool zero_pad;
+};
+
+enum class FormatKind : U8 {
+    CUSTOM,
+    BOOL,
+    CHAR,
+    INTEGER,
+    FLOAT,
+    STRING,
+    POINTER,
+};
+
+template <typename T>
+struct FormatKindOf {
+    static constexpr FormatKind value = is_same<T, bool>                               ? FormatKind::BOOL
+                                      : is_same<T, char>                               ? FormatKind::CHAR
+                                      : is_integer<T>                                  ? FormatKind::INTEGER
+                                      : is_same<T, F32> || is_same<T, F64>             ? FormatKind::FLOAT
+                                      : is_same<T, const char*> || is_same<T, char*>   ? FormatKind::STRING
+                                      : is_same<T, StringView> || is_same<T, String>   ? FormatKind::STRING
+                                      : is_pointer<T>                                  ? FormatKind::POINTER
+                                      : FormatKind::CUSTOM;
+};
+
+template <UZ N> struct FormatKindOf<char[N]>       { static constexpr FormatKind value = FormatKind::STRING; };
+template <UZ N> struct FormatKindOf<const char[N]> { static constexpr FormatKind value = FormatKind::STRING; };
+
+constexpr bool format_type_fits(FormatKind kind, char type) {
+    if (type == '\0') return true;
+
+    bool integer_type = type == 'b' || type == 'o' || type == 'd' || type == 'x' || type == 'X';
+
+    switch (kind) {
+    case FormatKind::CUSTOM:  return true;
+    case FormatKind::BOOL:    return type == 's' || integer_type;
+    case FormatKind::CHAR:    return type == 'c' || integer_type;
+    case FormatKind::INTEGER: return type == 'c' || integer_type;
+    case FormatKind::FLOAT:   return type == 'e' || type == 'E' || type == 'f' || type == 'F' || type == 'g' || type == 'G';
+    case FormatKind::STRING:  return type == 's';
+    case FormatKind::POINTER: return type == 'p';
+    }
+
+    return false;
+}
+
+constexpr bool format_precision_fits(FormatKind kind, S32 precision) {
+    if (precision < 0) return true;
+    return kind == FormatKind::FLOAT || kind == FormatKind::STRING || kind == FormatKind::CUSTOM;
+}
+
+// Parses a placeholder, with `p` right after its opening brace. Returns the position after
+// the closing brace, or `nullptr` if the placeholder is malformed.
+constexpr const char* parse_format_placeholder(const char* p, const char* end, FormatSpec* spec) {
+    *spec = FormatSpec{0, -1, ' ', '\0', FormatSpec::Align::NONE, false};
+
+    if (p == end) return nullptr;
+    if (*p == '}') return p + 1;
+    if (*p != ':') return nullptr;
+    p++;
+
+    auto align_of = [](char c) {
+        switch (c) {
+        case '<': return FormatSpec::Align::LEFT;
+        case '>': return FormatSpec::Align::RIGHT;
+        case '^': return FormatSpec::Align::CENTER;
+        default:  return FormatSpec::Align::NONE;
+        }
+    };
+
+    if (end - p >= 2 && align_of(p[1]) != FormatSpec::Align::NONE && p[0] != '{' && p[0] != '}') {
+        spec->fill = p[0];
+        spec->align = align_of(p[1]);
+        p += 2;
+    } else if (p < end && align_of(*p) != FormatSpec::Align::NONE) {
+        spec->align = align_of(*p);
+        p++;
+    }
+
+    if (p < end && *p == '0') {
+        spec->zero_pad = true;
+        p++;
+    }
+
+    while (p < end && *p >= '0' && *p <= '9') {
+        spec->width = spec->width * 10 + (*p++ - '0');
+        if (spec->width > FormatSpec::MAX_WIDTH) return nullptr;
+    }
+
+    if (p < end && *p == '.') {
+        p++;
+        if (p == end || *p < '0' || *p > '9') return nullptr;
+
+        spec->precision = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            spec->precision = spec->precision * 10 + (*p++ - '0');
+            if (spec->precision > FormatSpec::MAX_PRECISION) return nullptr;
+        }
+    }
+
+    if (p < end && *p != '}') {
+        char type = *p++;
+        switch (type) {
+        case 'b': case 'o': case 'd': case 'x': case 'X': case 'c':
+        case 'e': case 'E': case 'f': case 'F': case 'g': case 'G':
+        case 's': case 'p':
+            spec->type = type;
+            break;
+        default:
+            return nullptr;
+        }
+    }
+
+    if (p == end || *p != '}') return nullptr;
+    return p + 1;
+}
+
+// Not `constexpr`, so calling one of these while checking a format string at compile time
+// is what makes it fail, with the name of the function in the error message.
+void format_error_malformed_placeholder();
+void format_error_unmatched_brace();
+void format_error_argument_count_mismatch();
+void format_error_type_mismatch();
+void format_error_precision_not_allowed();
+
+template <typename... Args>
+struct FormatString {
+    template <UZ N>
+    consteval FormatString(const char (&str)[N]) : view{str, N - 1} {
+        constexpr FormatKind kinds[] = {FormatKindOf<RemoveCVRef<Args>>::value..., FormatKind::CUSTOM};
+
+        const char* p = str;
+        const char* end = str + N - 1;
+        UZ arg = 0;
+
+        while (p < end) {
+            char c = *p++;
+
+            if (c == '{') {
+                if (p < end && *p == '{') {
+                    p++;
+                    continue;
+                }
+
+                FormatSpec spec{};
+                p = parse_format_placeholder(p, end, &spec);
+                if (p == nullptr) format_error_malformed_placeholder();
+                if (arg >= sizeof...(Args)) format_error_argument_count_mismatch();
+                if (!format_type_fits(kinds[arg], spec.type)) format_error_type_mismatch();
+                if (!format_precision_fits(kinds[arg], spec.precision)) format_error_precision_not_allowed();
+                arg++;
+            } else if (c == '}') {
+                if (p < end && *p == '}') p++;
+                else format_error_unmatched_brace();
+            }
+        }
+
+        if (arg != sizeof...(Args)) format_error_argument_count_mismatch();
+    }
+
+    StringView view;
+};
+
+// Formatted output goes through a buffer that `flush` empties into the destination. The
+// buffer is often the destination itself, a `String`'s spare capacity or the caller's
+// array, so for the most part the chars are written exactly once.
+struct FormatWriter {
+    // Hands the `count` chars in `buffer` over and makes room for at least `min_room` more.
+    using FlushProc = void (*)(FormatWriter* writer, UZ min_room);
+
+    // The most `reserve` can ask for.
+    static constexpr UZ MAX_RESERVE = 512;
+
+    inline void write(const char* chars, UZ chars_count) {
+        while (chars_count > 0) {
+            if (count == capacity) flush(this, 1);
+
+            UZ n = min(chars_count, capacity - count);
+            memcpy(buffer + count, chars, n);
+            count += n;
+            chars += n;
+            chars_count -= n;
+        }
+    }
+
+    inline void write(StringView sv) {
+        write(sv.data, sv.count);
+    }
+
+    inline void push(char c) {
+        if (count == capacity) flush(this, 1);
+        buffer[count++] = c;
+    }
+
+    void push_many(char c, UZ n);
+
+    // Room for `n` contiguous chars, to be followed by `commit`.
+    inline char* reserve(UZ n) {
+        OK_ASSERT(n <= MAX_RESERVE);
+        if (capacity - count < n) flush(this, n);
+        return buffer + count;
+    }
+
+    inline void commit(UZ n) {
+        OK_ASSERT(count + n <= capacity);
+        count += n;
+    }
+
+    // Number of chars written so far.
+    inline UZ get_total() const {
+        return flushed + count;
+    }
+
+    inline void finish() {
+        flush(this, 0);
+    }
+
+    char* buffer;
+    UZ capacity;
+    UZ count;
+    UZ flushed;
+    FlushProc flush;
+    void* data;
+};
+
+// Pads `chars` out to `spec.width`. `default_align` applies when the spec doesn't give one.
+void format_padded(FormatWriter* w, const FormatSpec& spec, const char* chars, UZ chars_count,
+                   FormatSpec::Align default_align);
+void format_integer(FormatWriter* w, const FormatSpec& spec, U64 magnitude, bool negative);
+void format_float(FormatWriter* w, const FormatSpec& spec, F64 value, bool single_precision);
+
+void ok_format(FormatWriter* w, const FormatSpec& spec, bool value);
+void ok_format(FormatWriter* w, const FormatSpec& spec, char value);
+void ok_format(FormatWriter* w, const FormatSpec& spec, F32 value);
+void ok_format(FormatWriter* w, const FormatSpec& spec, F64 value);
+void ok_format(FormatWriter* w, const FormatSpec& spec, const char* value);
+void ok_format(FormatWriter* w, const FormatSpec& spec, StringView value);
+void ok_format(FormatWriter* w, const FormatSpec& spec, const String& value);
+void ok_format(FormatWriter* w, const FormatSpec& spec, const void* value);
+
+template <typename T>
+requires is_integer<T>
+inline void ok_format(FormatWriter* w, const FormatSpec& spec, T value) {
+    bool negative;
+    U64 magnitude = int_magnitude(value, &negative);
+    format_integer(w, spec, magnitude, negative);
+}
+
+struct FormatArg {
+    void (*proc)(FormatWriter* w, const FormatSpec& spec, const void* value);
+    const void* value;
+};
+
+template <typename T>
+inline FormatArg make_format_arg(const T& value) {
+    return FormatArg{
+        [](FormatWriter* w, const FormatSpec& spec, const void* v) { ok_format(w, spec, *(const T*)v); },
+        &value,
+    };
+}
+
+// The non-template part of formatting, the arguments come type-erased.
+void format_args(FormatWriter* w, StringView fmt, const FormatArg* args, UZ arg_count);
+
+template <typename... Args>
+inline void format_to(FormatWriter* w, FormatString<TypeIdentity<Args>...> fmt, const Args&... args) {
+    FormatArg erased[] = {make_format_arg(args)..., FormatArg{nullptr, nullptr}};
+    format_args(w, fmt.view, erased, sizeof...(Args));
+}
+
+FormatWriter format_writer_for(String* out);
+FormatWriter format_writer_for(StringBuilder* out);
+
+// Appends to `out`.
+template <typename... Args>
+inline void format_to(String* out, FormatString<TypeIdentity<Args>...> fmt, const Args&... args) {
+    FormatWriter w = format_writer_for(out);
+    format_to<Args...>(&w, fmt, args...);
+    w.finish();
+}
+
+template <typename... Args>
+inline void format_to(StringBuilder* out, FormatString<TypeIdentity<Args>...> fmt, const Args&... args) {
+    FormatWriter w = format_writer_for(out);
+    format_to<Args...>(&w, fmt, args...);
+    w.finish();
+}
+
+template <typename... Args>
+inline String format(Allocator* a, FormatString<TypeIdentity<Args>...> fmt, const Args&... args) {
+    String result = String::alloc(a);
+    format_to<Args...>(&result, fmt, args...);
+    return result;
+}
+
+struct FixedFormatTarget {
+    char* chars;
+    UZ size;
+    UZ used;
+    char scratch[FormatWriter::MAX_RESERVE];
+};
+
+FormatWriter format_writer_for(FixedFormatTarget* target);
+
+// Writes at most `buffer_size` chars, without a null terminator, and returns the length of
+// the whole formatted text, which is more than `buffer_size` when it got cut off.
+template <typename... Args>
+inline UZ format_to(char* buffer, UZ buffer_size, FormatString<TypeIdentity<Args>...> fmt, const Args&... args) {
+    FixedFormatTarget target;
+    target.chars = buffer;
+    target.size = buffer_size;
+    target.used = 0;
+
+    FormatWriter w = format_writer_for(&target);
+    format_to<Args...>(&w, fmt, args...);
+    w.finish();
+    return w.get_total();
+}
+
+struct FileFormatTarget {
+    static constexpr UZ BUFFER_SIZE = 4096;
+
+    File* file;
+    Optional<File::WriteError> error;
+    char buffer[BUFFER_SIZE];
+};
+
+FormatWriter format_writer_for(FileFormatTarget* target);
+
+// Buffers the output and writes it to `file` in blocks. Stops writing after the first error.
+template <typename... Args>
+inline Optional<File::WriteError> format_to(File* file, FormatString<TypeIdentity<Args>...> fmt, const Args&... args) {
+    FileFormatTarget target;
+    target.file = file;
+    target.error = Optional<File::WriteError>::empty();
+
+    FormatWriter w = format_writer_for(&target);
+    format_to<Args...>(&w, fmt, args...);
+    w.finish();
+    return target.error;
+}
+
+struct LogFormatTarget {
+    static constexpr UZ BUFFER_SIZE = 1024;
+
+    bool to_stderr;
+    char buffer[BUFFER_SIZE];
+};
+
+FormatWriter format_writer_for(LogFormatTarget* target);
+
+template <typename... Args>
+inline void print(FormatString<TypeIdentity<Args>...> fmt, const Args&... args) {
+    LogFormatTarget target;
+    target.to_stderr = false;
+
+    FormatWriter w = format_writer_for(&target);
+    format_to<Args...>(&w, fmt, args...);
+    w.finish();
+}
+
+template <typename... Args>
+inline void println(FormatString<TypeIdentity<Args>...> fmt, const Args&... args) {
+    LogFormatTarget target;
+    target.to_stderr = false;
+
+    FormatWriter w = format_writer_for(&target);
+    format_to<Args...>(&w, fmt, args...);
+    w.push('\n');
+    w.finish();
+}
+
+template <typename... Args>
+inline void eprintln(FormatString<TypeIdentity<Args>...> fmt, const Args&... args) {
+    LogFormatTarget target;
+    target.to_stderr = true;
+
+    FormatWriter w = format_writer_for(&target);
+    format_to<Args...>(&w, fmt, args...);
+    w.push('\n');
+    w.finish();
+}
+
+template <typename S>
+requires _is_runtime_text<S>
+void println(const S& text) {
+    println("{}", text);
+}
+
+template <typename S>
+requires _is_runtime_text<S>
+void eprintln(const S& text) {
+    eprintln("{}", text);
+}
+
+// JSON.
+// Parsing makes two passes. The first finds the structural chars a vector at a time: brackets,
+// colons, commas, and the first char of every string, number and literal. The second checks
+// the grammar over just those and pairs up the brackets. After that the document is known to
+// be valid. `JsonValue` only reads the parts it is asked for, and only unescapes strings on
+// request.
+enum class JsonType : U8 {
+    OBJECT,
+    ARRAY,
+    STRING,
+    NUMBER,
+    BOOLEAN,
+    NULL_VALUE,
+};
+
+struct JsonValue;
+struct JsonArrayIterator;
+struct JsonObjectIterator;
+
+struct JsonDocument {
+    enum class ParseError {
+        EMPTY,
+        TOO_LARGE,
+        INVALID_UTF8,
+        UNCLOSED_STRING,
+        // Unescaped control chars or invalid escapes.
+        INVALID_STRING,
+        INVALID_NUMBER,
+        INVALID_LITERAL,
+        UNEXPECTED_CHAR,
+        UNEXPECTED_END,
+        TOO_DEEP,
+    };
+
+    static constexpr U32 MAX_DEPTH = 1024;
+
+    // The index, and any strings that had to be unescaped later, go into `arena` and live as
+    // long as it does. Strings without escapes point into `input`, so it has to outlive the
+    // document too.
+    static Optional<ParseError> parse(JsonDocument* out, ArenaAllocator* arena, StringView input);
+
+    JsonValue root() const;
+
+    // Index of the structural right after the value starting at structural `index`.
+    inline U32 skip(U32 index) const {
+        char c = input.data[structurals[index]];
+        return c == '{' || c == '[' ? closing[index] + 1 : index + 1;
+    }
+
+    StringView input;
+    // Offsets of the structural chars in `input`, and then `input.count`.
+    U32* structurals;
+    // For the structurals that open an object or array, the index of the one closing it.
+    U32* closing;
+    U32 structural_count;
+    ArenaAllocator* arena;
+    // Where parsing failed.
+    UZ error_offset;
+};
+
+// A value in a `JsonDocument`. The getters return false if the value has another type, or
+// for numbers, doesn't fit.
+struct JsonValue {
+    JsonType type() const;
+
+    inline bool is_null() const {
+        return type() == JsonType::NULL_VALUE;
+    }
+
+    bool get_bool(bool* out) const;
+    bool get_f64(F64* out) const;
+
+    // Only integers, `1.0` or `1e2` don't count.
+    template <typename T>
+    requires is_integer<T>
+    inline bool get_int(T* out) const {
+        return type() == JsonType::NUMBER && parse_int(raw(), out);
+    }
+
+    // Without the quotes. Only strings with escapes are copied into the arena, the rest point
+    // into the input.
+    bool get_string(StringView* out) const;
+
+    // The text of the value in the input. That includes the quotes of a string, and everything
+    // inside an object or array.
+    StringView raw() const;
+
+    // These are empty if the value is not an object or an array.
+    JsonArrayIterator iter_array() const;
+    JsonObjectIterator iter_object() const;
+
+    // Linear in the number of entries before the one returned.
+    Optional<JsonValue> get(StringView key) const;
+    Optional<JsonValue> at(UZ idx) const;
+    // Entries in an object or an array, linear in their count.
+    UZ count() const;
+
+    const JsonDocument* doc;
+    U32 index;
+};
+
+struct JsonArrayIterator {
+    inline bool valid() const {
+        return index < end;
+    }
+
+    inline JsonValue value() const {
+        return JsonValue{doc, index};
+    }
+
+    // Past the value and the comma after it.
+    inline void next() {
+        U32 after = doc->skip(index);
+        index = after == end ? end : after + 1;
+    }
+
+    const JsonDocument* doc;
+    U32 index;
+    // The closing bracket.
+    U32 end;
+};
+
+struct JsonObjectIterator {
+    inline bool valid() const {
+        return index < end;
+    }
+
+    // Unescaped like `JsonValue::get_string`, every time it's called.
+    StringView key() const;
+
+    inline JsonValue value() const {
+        return JsonValue{doc, index + 2};
+    }
+
+    inline void next() {
+        U32 after = doc->skip(index + 2);
+        index = after == end ? end : after + 1;
+    }
+
+    const JsonDocument* doc;
+    // The key, then the colon and the value follow.
+    U32 index;
+    U32 end;
+};
+
+inline JsonValue JsonDocument::root() const {
+    return JsonValue{this, 0};
+}
+
+// Writes JSON to a `FormatWriter` as the calls come in, without building anything up, and puts
+// the commas and colons in. Only asserts check that the calls nest properly. To write into a
+// buffered file, go through a `FileFormatTarget`:
+//
+//     FileFormatTarget target{&file, Optional<File::WriteError>::empty(), {}};
+//     FormatWriter w = format_writer_for(&target);
+//     JsonWriter json = JsonWriter::to(&w);
+//     ...
+//     w.finish();
+struct JsonWriter {
+    static inline JsonWriter to(FormatWriter* out) {
+        return JsonWriter{out, 0, false};
+    }
+
+    void begin_object();
+    void end_object();
+    void begin_array();
+    void end_array();
+
+    // Inside an object, before each value.
+    void key(StringView key);
+
+    void value_null();
+    void value_bool(bool value);
+    // Infinities and NaN aren't JSON, they are written as `null`.
+    void value_f64(F64 value);
+    void value_string(StringView value);
+    // Text that is JSON already.
+    void value_raw(StringView json);
+
+    template <typename T>
+    requires is_integer<T>
+    inline void value_int(T value) {
+        begin_value();
+        out->commit(format_int(out->reserve(MAX_INT_CHARS), value));
+        needs_comma = true;
+    }
+
+    inline void begin_value() {
+        if (needs_comma) out->push(',');
+    }
+
+    FormatWriter* out;
+    U32 depth;
+    bool needs_comma;
+};
+
+// `value` in quotes, with `"`, `\` and control chars escaped.
+void json_write_string(FormatWriter* w, StringView value);
+
+static inline U64 nanos_timestamp() {
+#if OK_UNIX
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec * 1'000'000'000ul + ts.tv_nsec;
+#elif OK_WINDOWS
+    LARGE_INTEGER frequency{};
+    QueryPerformanceFrequency(&frequency);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart / frequency.QuadPart * 1'000'000'000ul;
+#else
+    OK_TODO();
+#endif // Platform check.
+}
+
+// Atomics.
+// @Portability: These go through the `__atomic` builtins of GCC and Clang.
+enum class MemoryOrder : int {
+    RELAXED = __ATOMIC_RELAXED,
+    ACQUIRE = __ATOMIC_ACQUIRE,
+    RELEASE = __ATOMIC_RELEASE,
+    ACQ_REL = __ATOMIC_ACQ_REL,
+    SEQ_CST = __ATOMIC_SEQ_CST,
+};
+
+template <typename T>
+struct Atomic {
+    inline T load(MemoryOrder order = MemoryOrder::SEQ_CST) const {
+        return __atomic_load_n(&value, (int)order);
+    }
+
+    inline void store(T desired, MemoryOrder order = MemoryOrder::SEQ_CST) {
+        __atomic_store_n(&value, desired, (int)order);
+    }
+
+    inline T exchange(T desired, MemoryOrder order = MemoryOrder::SEQ_CST) {
+        return __atomic_exchange_n(&value, desired, (int)order);
+    }
+
+    // On failure `*expected` receives the current value.
+    inline bool compare_exchange(T* expected, T desired,
+                                 MemoryOrder success = MemoryOrder::SEQ_CST,
+                                 MemoryOrder failure = MemoryOrder::SEQ_CST) {
+        return __atomic_compare_exchange_n(&value, expected, desired, false, (int)success, (int)failure);
+    }
+
+    inline T fetch_add(T arg, MemoryOrder order = MemoryOrder::SEQ_CST) {
+        return __atomic_fetch_add(&value, arg, (int)order);
+    }
+
+    inline T fetch_sub(T arg, MemoryOrder order = MemoryOrder::SEQ_CST) {
+        return __atomic_fetch_sub(&value, arg, (int)order);
+    }
+
+    T value;
+};
+
+inline void atomic_fence(MemoryOrder order = MemoryOrder::SEQ_CST) {
+    __atomic_thread_fence((int)order);
+}
+
+// Hint for spin-wait loops.
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Threads.
+// NOTE: A `Thread`, `Mutex` or `CondVar` must not be moved once it's in use.
+struct Thread {
+    using Proc = void (*)(void*);
+
+    void start(Proc thread_proc, void* thread_arg);
+    void join();
+
+    Proc proc;
+    void* arg;
+#if OK_UNIX
+    pthread_t handle;
+#elif OK_WINDOWS
+    HANDLE handle;
+#endif // Platform check.
+};
+
+struct Mutex {
+    void init();
+    void deinit();
+    void lock();
+    void unlock();
+
+#if OK_UNIX
+    pthread_mutex_t handle;
+#elif OK_WINDOWS
+    SRWLOCK handle;
+#endif // Platform check.
+};
+
+struct CondVar {
+    void init();
+    void deinit();
+    void wait(Mutex* mutex);
+    void notify_one();
+    void notify_all();
+
+#if OK_UNIX
+    pthread_cond_t handle;
+#elif OK_WINDOWS
+    CONDITION_VARIABLE handle;
+#endif // Platform check.
+};
+
+UZ hardware_thread_count();
+void yield_thread();
+
+// Fork-join pool with a work-stealing deque per worker. `join` pushes one of its closures
+// for the others to steal and runs the other one itself, and while it waits for a stolen
+// closure to finish it runs other work. Idle workers sleep on a condition variable.
+//
+// The thread calling into the pool becomes worker 0 for the duration of the call, so a
+// pool with N threads spawns N - 1 of them. Calls from outside the pool are serialized.
+struct ThreadPool {
+    struct Task {
+        void (*proc)(void*);
+        void* data;
+        Atomic<U32> done;
+    };
+
+    // Chase-Lev deque with a fixed capacity. The owner pushes and pops at the bottom, the
+    // thieves take from the top. Forks nest only as deep as the recursion, so a small
+    // capacity is plenty; when it does run out `join` simply runs both closures itself.
+    struct WorkDeque {
+        static constexpr UZ CAPACITY = 256;
+
+        bool push(Task* task);
+        Task* pop();
+        Task* steal();
+
+        inline bool is_empty() const {
+            return bottom.load(MemoryOrder::ACQUIRE) <= top.load(MemoryOrder::ACQUIRE);
+        }
+
+        alignas(OK_CACHE_LINE_SIZE) Atomic<S64> top;
+        alignas(OK_CACHE_LINE_SIZE) Atomic<S64> bottom;
+        Atomic<Task*> tasks[CAPACITY];
+    };
+
+    struct State;
+
+    struct alignas(OK_CACHE_LINE_SIZE) Worker {
+        WorkDeque deque;
+        State* state;
+        Thread thread;
+        U64 rng;
+        UZ index;
+        // What the thread in worker 0 was before it entered this pool, so a task of one pool
+        // can use another and stay a worker of both.
+        Worker* outer;
+    };
+
+    struct State {
+        Worker* workers;
+        UZ worker_count;
+        void* workers_memory;
+        UZ workers_memory_size;
+
+        Mutex sleep_mutex;
+        CondVar sleep_cond;
+        Atomic<U32> sleepers;
+        Atomic<U32> shutdown;
+
+        Mutex external_mutex;
+    };
+
+    static constexpr UZ DEFAULT_GRAIN = 4096;
+
+    // `thread_count` of zero means one thread per hardware thread.
+    static ThreadPool alloc(Allocator* a, UZ thread_count = 0);
+
+    // Runs `a` and `b`, potentially in parallel, and returns once both are done.
+    template <typename A, typename B>
+    void join(A&& a, B&& b);
+
+    // Runs `f` as a worker of this pool.
+    template <typename F>
+    void run(F f);
+
+    inline UZ get_thread_count() const {
+        return state->worker_count;
+    }
+
+    Worker* current_worker() const;
+    void enter();
+    void leave();
+    void wake_one();
+    void wait_for(Worker* worker, Task* task);
+
+    void dealloc();
+
+    State* state;
+    Allocator* allocator;
+};
+
+// Parallel algorithms. Ranges are split in halves until they are at most `grain` items
+// long, and each of those runs on a single thread. Scratch memory is taken from
+// `scratch` on the calling thread.
+
+// Calls `f(start, end)` for disjoint subranges covering `[0, count)`.
+template <typename F>
+void parallel_for(ThreadPool* pool, UZ count, F f, UZ grain = ThreadPool::DEFAULT_GRAIN);
+
+// `out[i] = f(in[i])`. `out` has to be at least as long as `in`.
+template <typename T, typename U, typename F>
+void parallel_transform(ThreadPool* pool, Slice<T> in, Slice<U> out, F f, UZ grain = ThreadPool::DEFAULT_GRAIN);
+
+// Folds `items` with `combine`, which has to be associative. `identity` starts every
+// subrange, so it has to be neutral for `combine`.
+template <typename T, typename F>
+RemoveCVRef<T> parallel_reduce(ThreadPool* pool, Slice<T> items, RemoveCVRef<T> identity, F combine, UZ grain = ThreadPool::DEFAULT_GRAIN);
+
+// Replaces every item with the sum of itself and all of the items before it.
+template <typename T>
+void parallel_prefix_sum(ThreadPool* pool, Slice<T> items, Allocator* scratch, UZ grain = ThreadPool::DEFAULT_GRAIN);
+
+// Parallel merge sort with `sort` at the leaves. The merges themselves are split in
+// parallel too, by binary searching for the split point. Takes a buffer of
+// `items.count` elements from `scratch`. Not stable.
+template <typename T, typename Cmp = Less<T>>
+void parallel_sort(ThreadPool* pool, Slice<T> items, Allocator* scratch, UZ grain = ThreadPool::DEFAULT_GRAIN);
+
+// PARALLEL IMPLEMENTATION
+template <typename A, typename B>
+void ThreadPool::join(A&& a, B&& b) {
+    Worker* worker = current_worker();
+    if (worker == nullptr) {
+        run([&] { join(a, b); });
+        return;
+    }
+
+    Task task{};
+    task.proc = [](void* data) {
+        (*(typename RemoveReference<B>::Type*)data)();
+    };
+    task.data = (void*)&b;
+
+    if (!worker->deque.push(&task)) {
+        a();
+        b();
+        return;
+    }
+
+    wake_one();
+    a();
+
+    // Everything `a` pushed has been taken off the deque by now, so the only thing left on
+    // it can be our own task, unless it got stolen.
+    Task* popped = worker->deque.pop();
+    if (popped != nullptr) {
+        OK_ASSERT(popped == &task);
+        b();
+        return;
+    }
+
+    wait_for(worker, &task);
+}
+
+template <typename F>
+void ThreadPool::run(F f) {
+    if (current_worker() != nullptr) {
+        f();
+        return;
+    }
+
+    enter();
+    f();
+    leave();
+}
+
+template <typename F>
+void _parallel_for_range(ThreadPool* pool, UZ start, UZ end, F& f, UZ grain) {
+    if (end - start <= grain) {
+        f(start, end);
+        return;
+    }
+
+    UZ mid = start + (end - start) / 2;
+    pool->join([&] { _parallel_for_range(pool, start, mid, f, grain); },
+               [&] { _parallel_for_range(pool, mid, end, f, grain); });
+}
+
+template <typename F>
+void parallel_for(ThreadPool* pool, UZ count, F f, UZ grain) {
+    if (count == 0) return;
+
+    grain = max(grain, (UZ)1);
+    pool->run([&] { _parallel_for_range(pool, 0, count, f, grain); });
+}
+
+template <typename T, typename U, typename F>
+void parallel_transform(ThreadPool* pool, Slice<T> in, Slice<U> out, F f, UZ grain) {
+    OK_ASSERT(out.count >= in.count);
+
+    parallel_for(pool, in.count, [&](UZ start, UZ end) {
+        for (UZ i = start; i < end; i++) out.items[i] = f(in.items[i]);
+    }, grain);
+}
+
+template <typename T, typename F>
+RemoveCVRef<T> _parallel_reduce_range(ThreadPool* pool, const T* items, UZ count, const RemoveCVRef<T>& identity, F& combine, UZ grain) {
+    if (count <= grain) {
+        RemoveCVRef<T> acc = identity;
+        for (UZ i = 0; i < count; i++) acc = combine(acc, items[i]);
+        return acc;
+    }
+
+    UZ half = count / 2;
+    RemoveCVRef<T> left = identity;
+    RemoveCVRef<T> right = identity;
+    pool->join([&] { left = _parallel_reduce_range(pool, items, half, identity, combine, grain); },
+               [&] { right = _parallel_reduce_range(pool, items + half, count - half, identity, combine, grain); });
+
+    return combine(left, right);
+}
+
+template <typename T, typename F>
+RemoveCVRef<T> parallel_reduce(ThreadPool* pool, Slice<T> items, RemoveCVRef<T> identity, F combine, UZ grain) {
+    grain = max(grain, (UZ)1);
+
+    RemoveCVRef<T> result = identity;
+    pool->run([&] { result = _parallel_reduce_range(pool, items.items, items.count, identity, combine, grain); });
+    return result;
+}
+
+// Two passes over the chunks: the first one sums up every chunk, then after a sequential
+// scan over the chunk sums the second one scans every chunk starting from its offset.
+template <typename T>
+void parallel_prefix_sum(ThreadPool* pool, Slice<T> items, Allocator* scratch, UZ grain) {
+    if (items.count == 0) return;
+
+    grain = max(grain, (UZ)1);
+    UZ chunk_count = (items.count + grain - 1) / grain;
+
+    T* offsets = scratch->alloc<T>(chunk_count);
+    OK_ASSERT(offsets != nullptr);
+
+    parallel_for(pool, chunk_count, [&](UZ start, UZ end) {
+        for (UZ c = start; c < end; c++) {
+            T* chunk = items.items + c * grain;
+            UZ chunk_size = min(grain, items.count - c * grain);
+
+            T sum = chunk[0];
+            for (UZ i = 1; i < chunk_size; i++) sum = sum + chunk[i];
+            OK_PLACEMENT_NEW(offsets + c) T(sum);
+        }
+    }, 1);
+
+    T running = offsets[0];
+    for (UZ c = 1; c < chunk_count; c++) {
+        T chunk_sum = offsets[c];
+        offsets[c] = running;
+        running = running + chunk_sum;
+    }
+
+    parallel_for(pool, chunk_count, [&](UZ start, UZ end) {
+        for (UZ c = start; c < end; c++) {
+            T* chunk = items.items + c * grain;
+            UZ chunk_size = min(grain, items.count - c * grain);
+
+            if (c > 0) chunk[0] = offsets[c] + chunk[0];
+            for (UZ i = 1; i < chunk_size; i++) chunk[i] = chunk[i - 1] + chunk[i];
+        }
+    }, 1);
+
+    destroy_items(offsets, chunk_count);
+    scratch->dealloc<T>(offsets, chunk_count);
+}
+
+// Merges the sorted runs `a` and `b` into the uninitialized `out`, relocating the items.
+template <typename T, typename Cmp>
+void _parallel_merge(ThreadPool* pool, T* a, UZ a_count, T* b, UZ b_count, T* out, UZ grain) {
+    if (a_count < b_count) {
+        T* tmp = a;
+        a = b;
+        b = tmp;
+
+        UZ tmp_count = a_count;
+        a_count = b_count;
+        b_count = tmp_count;
+    }
+
+    if (a_count + b_count <= grain) {
+        T* a_end = a + a_count;
+        T* b_end = b + b_count;
+
+        while (a != a_end && b != b_end) {
+            T* src = Cmp::less(*b, *a) ? b++ : a++;
+            OK_PLACEMENT_NEW(out++) T(move(*src));
+            src->~T();
+        }
+
+        relocate_items(out, a, a_end - a);
+        relocate_items(out + (a_end - a), b, b_end - b);
+        return;
+    }
+
+    // Split `a` in half and `b` right before the first item not less than the middle of
+    // `a`. Everything in the two left parts goes before everything in the right ones.
+    UZ a_mid = a_count / 2;
+    UZ lo = 0;
+    UZ hi = b_count;
+    while (lo < hi) {
+        UZ mid = lo + (hi - lo) / 2;
+        if (Cmp::less(b[mid], a[a_mid])) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    UZ b_mid = lo;
+
+    pool->join([&] { _parallel_merge<T, Cmp>(pool, a, a_mid, b, b_mid, out, grain); },
+               [&] { _parallel_merge<T, Cmp>(pool, a + a_mid, a_count - a_mid, b + b_mid, b_count - b_mid, out + a_mid + b_mid, grain); });
+}
+
+// Sorts `src` and leaves the result in `dst` when `into_dst` is set, or in `src` otherwise.
+// The halves are sorted into the other buffer, so every level of merging flips between
+// the two and nothing has to be copied back.
+template <typename T, typename Cmp>
+void _parallel_merge_sort(ThreadPool* pool, T* src, T* dst, UZ count, bool into_dst, UZ leaf_size, UZ grain) {
+    if (count <= leaf_size) {
+        sort<T, Cmp>(Slice<T>{src, count});
+        if (into_dst) relocate_items(dst, src, count);
+        return;
+    }
+
+    UZ half = count / 2;
+    pool->join([&] { _parallel_merge_sort<T, Cmp>(pool, src, dst, half, !into_dst, leaf_size, grain); },
+               [&] { _parallel_merge_sort<T, Cmp>(pool, src + half, dst + half, count - half, !into_dst, leaf_size, grain); });
+
+    if (into_dst) {
+        _parallel_merge<T, Cmp>(pool, src, half, src + half, count - half, dst, grain);
+    } else {
+        _parallel_merge<T, Cmp>(pool, dst, half, dst + half, count - half, src, grain);
+    }
+}
+
+template <typename T, typename Cmp>
+void parallel_sort(ThreadPool* pool, Slice<T> items, Allocator* scratch, UZ grain) {
+    grain = max(grain, (UZ)2);
+
+    if (items.count <= grain) {
+        sort<T, Cmp>(items);
+        return;
+    }
+
+    T* buffer = scratch->alloc<T>(items.count);
+    OK_ASSERT(buffer != nullptr);
+
+    // Every level of merging moves all of the items, so the leaves are only made as small
+    // as needed to keep every thread busy.
+    UZ leaf_size = max(grain, items.count / (4 * pool->get_thread_count()));
+
+    pool->run([&] { _parallel_merge_sort<T, Cmp>(pool, items.items, buffer, items.count, false, leaf_size, grain); });
+
+    scratch->dealloc<T>(buffer, items.count);
+}
+
+// Bounded single-producer single-consumer ring. `push` and `pop` never wait, they fail when
+// the ring is full or empty. Head and tail live on their own cache lines and each side keeps
+// a private copy of the other side's index, so the shared lines are only touched when that
+// copy runs out. `push_many` and `pop_many` publish a whole batch with a single store.
+//
+// NOTE: The queue must not be moved once it's shared between threads.
+template <typename T>
+struct SpscQueue {
+    // `capacity` is rounded up to a power of two.
+    static SpscQueue alloc(Allocator* a, UZ capacity);
+
+    // Producer side.
+    bool push(const T& item);
+    UZ push_many(const T* items, UZ count);
+
+    // Consumer side.
+    bool pop(T* out);
+    UZ pop_many(T* out, UZ max_count);
+
+    // Only a snapshot while both sides are running.
+    inline UZ get_count() const {
+        return tail.load(MemoryOrder::ACQUIRE) - head.load(MemoryOrder::ACQUIRE);
+    }
+
+    inline UZ get_capacity() const {
+        return mask + 1;
+    }
+
+    void dealloc();
+
+    T* slots;
+    UZ mask;
+    Allocator* allocator;
+
+    alignas(OK_CACHE_LINE_SIZE) Atomic<UZ> tail;
+    UZ cached_head;
+
+    alignas(OK_CACHE_LINE_SIZE) Atomic<UZ> head;
+    UZ cached_tail;
+};
+
+// Bounded multi-producer multi-consumer queue after Dmitry Vyukov's design. Every slot
+// carries a sequence number that tells whether it is ready to be written or read for a given
+// lap around the ring, so producers and consumers only contend on their own index.
+//
+// NOTE: The queue must not be moved once it's shared between threads.
+template <typename T>
+struct MpmcQueue {
+    struct Slot {
+        Atomic<UZ> sequence;
+        alignas(T) U8 storage[sizeof(T)];
+    };
+
+    // `capacity` is rounded up to a power of two, and has to be at least 2.
+    static MpmcQueue alloc(Allocator* a, UZ capacity);
+
+    // Fails when the queue is full.
+    bool push(const T& item);
+
+    // Fails when the queue is empty.
+    bool pop(T* out);
+
+    inline UZ get_capacity() const {
+        return mask + 1;
+    }
+
+    void dealloc();
+
+    Slot* slots;
+    UZ mask;
+    Allocator* allocator;
+
+    alignas(OK_CACHE_LINE_SIZE) Atomic<UZ> enqueue_pos;
+    alignas(OK_CACHE_LINE_SIZE) Atomic<UZ> dequeue_pos;
+};
+
+// QUEUES IMPLEMENTATION
+template <typename T>
+SpscQueue<T> SpscQueue<T>::alloc(Allocator* a, UZ capacity) {
+    OK_ASSERT(capacity > 0);
+    capacity = next_power_of_two(capacity);
+
+    SpscQueue<T> queue{};
+    queue.slots = a->alloc<T>(capacity);
+    OK_ASSERT(queue.slots != nullptr);
+    queue.mask = capacity - 1;
+    queue.allocator = a;
+    return queue;
+}
+
+template <typename T>
+bool SpscQueue<T>::push(const T& item) {
+    UZ t = tail.load(MemoryOrder::RELAXED);
+    if (t - cached_head > mask) {
+        cached_head = head.load(MemoryOrder::ACQUIRE);
+        if (t - cached_head > mask) return false;
+    }
+
+    OK_PLACEMENT_NEW(slots + (t & mask)) T(item);
+    tail.store(t + 1, MemoryOrder::RELEASE);
+    return true;
+}
+
+template <typename T>
+UZ SpscQueue<T>::push_many(const T* items, UZ count) {
+    UZ t = tail.load(MemoryOrder::RELAXED);
+    UZ space = mask + 1 - (t - cached_head);
+    if (space < count) {
+        cached_head = head.load(MemoryOrder::ACQUIRE);
+        space = mask + 1 - (t - cached_head);
+    }
+
+    count = min(count, space);
+    for (UZ i = 0; i < count; i++) OK_PLACEMENT_NEW(slots + ((t + i) & mask)) T(items[i]);
+
+    if (count > 0) tail.store(t + count, MemoryOrder::RELEASE);
+    return count;
+}
+
+template <typename T>
+bool SpscQueue<T>::pop(T* out) {
+    UZ h = head.load(MemoryOrder::RELAXED);
+    if (h == cached_tail) {
+        cached_tail = tail.load(MemoryOrder::ACQUIRE);
+        if (h == cached_tail) return false;
+    }
+
+    T* slot = slots + (h & mask);
+    *out = ok::move(*slot);
+    slot->~T();
+    head.store(h + 1, MemoryOrder::RELEASE);
+    return true;
+}
+
+template <typename T>
+UZ SpscQueue<T>::pop_many(T* out, UZ max_count) {
+    UZ h = head.load(MemoryOrder::RELAXED);
+    UZ available = cached_tail - h;
+    if (available < max_count) {
+        cached_tail = tail.load(MemoryOrder::ACQUIRE);
+        available = cached_tail - h;
+    }
+
+    UZ count = min(max_count, available);
+    for (UZ i = 0; i < count; i++) {
+        T* slot = slots + ((h + i) & mask);
+        out[i] = ok::move(*slot);
+        slot->~T();
+    }
+
+    if (count > 0) head.store(h + count, MemoryOrder::RELEASE);
+    return count;
+}
+
+template <typename T>
+void SpscQueue<T>::dealloc() {
+    if (allocator == nullptr) return;
+
+    if constexpr (!is_trivially_destructible<T>) {
+        UZ t = tail.load(MemoryOrder::ACQUIRE);
+        for (UZ h = head.load(MemoryOrder::ACQUIRE); h != t; h++) slots[h & mask].~T();
+    }
+
+    allocator->dealloc<T>(slots, mask + 1);
+    slots = nullptr;
+    mask = 0;
+    allocator = nullptr;
+}
+
+template <typename T>
+MpmcQueue<T> MpmcQueue<T>::alloc(Allocator* a, UZ capacity) {
+    OK_ASSERT(capacity >= 2);
+    capacity = next_power_of_two(capacity);
+
+    MpmcQueue<T> queue{};
+    queue.slots = a->alloc<Slot>(capacity);
+    OK_ASSERT(queue.slots != nullptr);
+    for (UZ i = 0; i < capacity; i++) queue.slots[i].sequence.store(i, MemoryOrder::RELAXED);
+
+    queue.mask = capacity - 1;
+    queue.allocator = a;
+    return queue;
+}
+
+template <typename T>
+bool MpmcQueue<T>::push(const T& item) {
+    UZ pos = enqueue_pos.load(MemoryOrder::RELAXED);
+    Slot* slot;
+
+    while (true) {
+        slot = slots + (pos & mask);
+        UZ sequence = slot->sequence.load(MemoryOrder::ACQUIRE);
+        SZ diff = (SZ)sequence - (SZ)pos;
+
+        if (diff == 0) {
+            if (enqueue_pos.compare_exchange(&pos, pos + 1, MemoryOrder::RELAXED, MemoryOrder::RELAXED)) break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = enqueue_pos.load(MemoryOrder::RELAXED);
+        }
+    }
+
+    OK_PLACEMENT_NEW(slot->storage) T(item);
+    slot->sequence.store(pos + 1, MemoryOrder::RELEASE);
+    return true;
+}
+
+template <typename T>
+bool MpmcQueue<T>::pop(T* out) {
+    UZ pos = dequeue_pos.load(MemoryOrder::RELAXED);
+    Slot* slot;
+
+    while (true) {
+        slot = slots + (pos & mask);
+        UZ sequence = slot->sequence.load(MemoryOrder::ACQUIRE);
+        SZ diff = (SZ)sequence - (SZ)(pos + 1);
+
+        if (diff == 0) {
+            if (dequeue_pos.compare_exchange(&pos, pos + 1, MemoryOrder::RELAXED, MemoryOrder::RELAXED)) break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = dequeue_pos.load(MemoryOrder::RELAXED);
+        }
+    }
+
+    T* item = reinterpret_cast<T*>(slot->storage);
+    *out = ok::move(*item);
+    item->~T();
+    slot->sequence.store(pos + mask + 1, MemoryOrder::RELEASE);
+    return true;
+}
+
+template <typename T>
+void MpmcQueue<T>::dealloc() {
+    if (allocator == nullptr) return;
+
+    // NOTE: Nobody else may be using the queue by now, so everything between the two
+    // positions has been fully written.
+    if constexpr (!is_trivially_destructible<T>) {
+        UZ end = enqueue_pos.load(MemoryOrder::ACQUIRE);
+        for (UZ pos = dequeue_pos.load(MemoryOrder::ACQUIRE); pos != end; pos++) {
+            destroy_items(reinterpret_cast<T*>(slots[pos & mask].storage), 1);
+        }
+    }
+
+    allocator->dealloc<Slot>(slots, mask + 1);
+    slots = nullptr;
+    mask = 0;
+    allocator = nullptr;
+}
+
+// Deduplicates strings into chunks of arena memory and hands out dense ids, starting at
+// zero in the order the strings were first seen. Interned strings never move and are
+// followed by a null terminator, so `view(id).data` can be passed on as a C string.
+//
+// With `concurrent` set the hash index is split into shards, each behind its own mutex,
+// and any number of threads may call `intern` and `lookup`. `view` never takes a lock. The
+// allocator is only ever called behind another mutex, so it doesn't have to be thread safe.
+//
+// NOTE: The interner must not be moved once it's shared between threads.
+struct StringInterner {
+    static constexpr UZ CHUNK_SIZE = 64 * 1024;
+    static constexpr UZ SHARD_COUNT = 16;
+    static constexpr UZ FIRST_SEGMENT_BITS = 10;
+    static constexpr UZ SEGMENT_COUNT = 32 - FIRST_SEGMENT_BITS + 1;
+    // How long `intern` busy-waits on `published` before it starts yielding.
+    static constexpr UZ PUBLISH_SPIN_ROUNDS = 64;
+
+    struct Chunk {
+        Chunk* next;
+        UZ size;
+        UZ used;
+    };
+
+    // Open addressing over `(upper hash bits << 32) | (id + 1)`, zero marks an empty slot.
+    // The probe position comes from the stored hash bits, so growing never rehashes.
+    struct alignas(OK_CACHE_LINE_SIZE) Shard {
+        Mutex mutex;
+        U64* slots;
+        UZ capacity;
+        UZ count;
+        Chunk* chunks;
+    };
+
+    static StringInterner alloc(Allocator* a, bool concurrent = false);
+
+    U32 intern(StringView string);
+    Optional<U32> lookup(StringView string);
+
+    // Views of ids live in segments of doubling size that are never moved, so a view can
+    // be read while other threads keep interning. Any id below `get_count()` can be read,
+    // not only the ones this thread got back from `intern`.
+    inline StringView view(U32 id) const {
+        OK_ASSERT(id < published.load(MemoryOrder::ACQUIRE));
+        return stored_view(id);
+    }
+
+    inline U32 get_count() const {
+        return published.load(MemoryOrder::ACQUIRE);
+    }
+
+    // Also works for ids that aren't published yet, as long as their slot has been written.
+    inline StringView stored_view(U32 id) const {
+        UZ k = (UZ)id + ((UZ)1 << FIRST_SEGMENT_BITS);
+        UZ segment = 63 - count_leading_zeros(k) - FIRST_SEGMENT_BITS;
+        return segments[segment].load(MemoryOrder::ACQUIRE)[k - ((UZ)1 << (segment + FIRST_SEGMENT_BITS))];
+    }
+
+    Shard* shard_for(U64 hash);
+    Optional<U32> find_in_shard(Shard* shard, StringView string, U64 hash) const;
+    StringView* slot_for_id(U32 id);
+    void wait_until_published(U32 count);
+    void* locked_alloc(UZ size);
+    void locked_dealloc(void* ptr, UZ size);
+
+    void dealloc();
+
+    Shard* shards;
+    UZ shard_count;
+    void* shards_memory;
+    UZ shards_memory_size;
+    Atomic<StringView*> segments[SEGMENT_COUNT];
+    // Ids are handed out from `next_id`, but only readable once `published` has gone past
+    // them. It moves in id order, after each slot is written.
+    Atomic<U32> next_id;
+    Atomic<U32> published;
+    bool concurrent;
+    Mutex* allocator_mutex;
+    Allocator* allocator;
+};
+
+#ifdef OK_IMPLEMENTATION
+#ifdef OK_NO_STDLIB
+    void *memcpy(void *dst, const void *src, UZ count) {
+        for (UZ i = 0; i < count; ++i) {
+            *((U8 *)dst + i) = *((U8 *)src + i);
+        }
+        return dst;
+    }
+
+    void *memmove(void *dst, const void *src, UZ count) {
+        if ((U8 *)dst < (const U8 *)src) return memcpy(dst, src, count);
+
+        for (UZ i = count; i > 0; --i) {
+            *((U8 *)dst + i - 1) = *((const U8 *)src + i - 1);
+        }
+        return dst;
+    }
+
+    void *memset(void *ptr, U8 b, UZ c) {
+        for (UZ i = 0; i < c; ++i) {
+            *((U8*)ptr + i) = c;
+        }
+        return ptr;
+    }
+
+    UZ strlen(const char *s) {
+        UZ c = 0;
+        while (*(s + c)) ++c;
+        return c;
+    }
+#endif // OK_NO_STDLIB
+
+static FixedBufferAllocator temp_allocator_impl{};
+
+Allocator *temp_allocator() {
+    return &temp_allocator_impl;
+}
+
+static void _init_region(ArenaAllocator::Region* region, UZ size) {
+    region->data = (U8*)OK_ALLOC_PAGE(size);
+    OK_ASSERT(region->data != (void*)-1);
+    region->size = size;
+    region->off = 0;
+    region->next = nullptr;
+}
+
+// ALLOCATORS IMPLEMENTATION
+void* FixedBufferAllocator::raw_alloc(UZ size) {
+    size = align_up(size, sizeof(void*));
+
+    if (buffer == nullptr) {
+        buffer_size = max(size, OK_PAGE_SIZE * FixedBufferAllocator::DEFAULT_PAGE_COUNT);
+        buffer_size = align_up(buffer_size, OK_PAGE_ALIGN);
+        buffer = OK_ALLOC_PAGE(buffer_size);
+        buffer_off = 0;
+    }
+
+    if (size > buffer_size) return nullptr;
+
+    if (buffer_size - buffer_off < size) {
+        buffer_off = size;
+        return buffer;
+    }
+
+    auto* ptr = (U8*)buffer + buffer_off;
+    buffer_off += size;
+    return (void*)ptr;
+}
+
+void FixedBufferAllocator::raw_dealloc(void* ptr, UZ size) {
+    if (ptr == (void*)((U8*)buffer + buffer_off)) buffer_off -= size;
+}
+
+ArenaAllocator::Region* ArenaAllocator::alloc_region(UZ region_size) {
+    using Region = ArenaAllocator::Region;
+
+    region_size = align_up(region_size, OK_PAGE_ALIGN);
+
+    Region* current_region = region_pool;
+
+    while (current_region) {
+        if (current_region->size - current_region->off >= sizeof(Region)) {
+            auto* region = (Region*)((U8*)current_region->data + current_region->off);
+
+            _init_region(region, region_size);
+
+            current_region->off += align_up(sizeof(Region), sizeof(void*));
+
+            return region;
+        }
+
+        current_region = current_region->next;
+    }
+
+    current_region = (Region*)OK_ALLOC_SMOL(sizeof(Region));
+
+    current_region->data = OK_ALLOC_PAGE(OK_PAGE_SIZE);
+    current_region->size = OK_PAGE_SIZE;
+    current_region->off = align_up(sizeof(Region), sizeof(void*));
+    current_region->next = region_pool;
+
+    this->region_pool = current_region;
+
+    auto* resulting_region = (Region*)current_region->data;
+    _init_region(resulting_region, region_size);
+    return resulting_region;
+}
+
+void* ArenaAllocator::raw_alloc(UZ size) {
+    void* ptr;
+    UZ region_size;
+
+    ArenaAllocator::Region* region_head = this->head;
+
+    size = align_up(size, sizeof(void*));
+
+    while (region_head != nullptr) {
+        if (region_head->size - region_head->off >= size) {
+            ptr = (void*)((U8*)region_head->data + region_head->off);
+            region_head->off += size;
+            goto end;
+        }
+
+        region_head = region_head->next;
+    }
+
+    region_size = align_up(size, OK_PAGE_ALIGN);
+    region_head = alloc_region(region_size);
+    region_head->next = this->head;
+    this->head = region_head;
+
+    ptr = (void*)((U8*)region_head->data + region_head->off);
+    region_head->off += size;
+
+end:
+    last_alloc_ptr = ptr;
+    return ptr;
+}
+
+void ArenaAllocator::raw_dealloc(void* ptr, UZ size) {
+    if (last_alloc_ptr == ptr) {
+        size = align_up(size, sizeof(void*));
+        head->off -= size;
+    }
+}
+
+void* ArenaAllocator::raw_resize(void* old_ptr, UZ old_size, UZ new_size) {
+    old_size = align_up(old_size, sizeof(void*));
+    new_size = align_up(new_size, sizeof(void*));
+
+    // If this was the last allocation, try to grow it in place.
+    if (old_ptr != nullptr && old_ptr == last_alloc_ptr) {
+        for (Region* r = head; r != nullptr; r = r->next) {
+            if ((U8*)r->data + r->off != (U8*)old_ptr + old_size) continue;
+
+            if (r->off - old_size + new_size <= r->size) {
+                r->off = r->off - old_size + new_size;
+                return old_ptr;
+            }
+
+            break;
+        }
+    }
+
+    void* new_ptr = raw_alloc(new_size);
+    if (old_ptr != nullptr) memcpy(new_ptr, old_ptr, min(old_size, new_size));
+    return new_ptr;
+}
+
+void* PoolAllocator::raw_alloc(UZ size) {
+    OK_ASSERT(size <= block_size);
+
+    if (free_list != nullptr) {
+        FreeBlock* block = free_list;
+        free_list = block->next;
+        return block;
+    }
+
+    if (chunk_cursor == chunk_end) {
+        UZ header_size = align_up(sizeof(Chunk), sizeof(void*));
+        UZ chunk_size = header_size + block_size * blocks_per_chunk;
+
+        Chunk* chunk = (Chunk*)backing->raw_alloc(chunk_size);
+        chunk->next = chunks;
+        chunk->size = chunk_size;
+        chunks = chunk;
+
+        chunk_cursor = (U8*)chunk + header_size;
+        chunk_end = (U8*)chunk + chunk_size;
+    }
+
+    void* ptr = chunk_cursor;
+    chunk_cursor += block_size;
+    return ptr;
+}
+
+void PoolAllocator::raw_dealloc(void* ptr, UZ size) {
+    OK_UNUSED(size);
+    if (ptr == nullptr) return;
+
+    FreeBlock* block = (FreeBlock*)ptr;
+    block->next = free_list;
+    free_list = block;
+}
+
+void PoolAllocator::free() {
+    Chunk* chunk = chunks;
+    while (chunk != nullptr) {
+        Chunk* next = chunk->next;
+        backing->raw_dealloc(chunk, chunk->size);
+        chunk = next;
+    }
+
+    free_list = nullptr;
+    chunks = nullptr;
+    chunk_cursor = nullptr;
+    chunk_end = nullptr;
+}
+
+// SIMD IMPLEMENTATION
+// Every vector flavour provides the same handful of operations. `mask` packs the result
+// of a comparison into an integer with the bits of byte `i` starting at `i << SHIFT`,
+// and only the top bit of every byte's group set.
+#if OK_SIMD_SSE2
+struct _simd128 {
+    using Vec = __m128i;
+
+    static constexpr UZ WIDTH = 16;
+    static constexpr U32 SHIFT = 0;
+    static constexpr U64 FULL = 0xffff;
+
+    static inline Vec load(const void* p) {
+        return _mm_loadu_si128((const __m128i*)p);
+    }
+
+    template <typename T>
+    static inline Vec splat(T value) {
+        if constexpr (sizeof(T) == 1) return _mm_set1_epi8((char)value);
+        else if constexpr (sizeof(T) == 2) return _mm_set1_epi16((short)value);
+        else if constexpr (sizeof(T) == 4) return _mm_set1_epi32((int)value);
+        else return _mm_set1_epi64x((long long)value);
+    }
+
+    template <typename T>
+    static inline Vec eq(Vec a, Vec b) {
+        if constexpr (sizeof(T) == 1) return _mm_cmpeq_epi8(a, b);
+        else if constexpr (sizeof(T) == 2) return _mm_cmpeq_epi16(a, b);
+        else if constexpr (sizeof(T) == 4) return _mm_cmpeq_epi32(a, b);
+        else {
+            // No 64-bit compare before SSE4.1, so both halves have to match.
+            Vec eq32 = _mm_cmpeq_epi32(a, b);
+            return _mm_and_si128(eq32, _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+    }
+
+    static inline Vec bit_and(Vec a, Vec b) {
+        return _mm_and_si128(a, b);
+    }
+
+    static inline Vec bit_or(Vec a, Vec b) {
+        return _mm_or_si128(a, b);
+    }
+
+    static inline Vec bit_xor(Vec a, Vec b) {
+        return _mm_xor_si128(a, b);
+    }
+
+    // `a & ~b`
+    static inline Vec bit_andnot(Vec a, Vec b) {
+        return _mm_andnot_si128(b, a);
+    }
+
+    static inline void store(void* p, Vec v) {
+        _mm_storeu_si128((__m128i*)p, v);
+    }
+
+    static inline U64 mask(Vec v) {
+        return (U32)_mm_movemask_epi8(v);
+    }
+
+    // Bytes from `first` to `last` inclusive, as unsigned. The subtraction wraps everything
+    // below `first` around to past `last - first`.
+    static inline Vec in_range(Vec v, U8 first, U8 last) {
+        Vec offset = _mm_sub_epi8(v, _mm_set1_epi8((char)first));
+        return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8((char)(last - first))), offset);
+    }
+};
+#elif OK_SIMD_NEON
+struct _simd128 {
+    using Vec = uint8x16_t;
+
+    static constexpr UZ WIDTH = 16;
+    static constexpr U32 SHIFT = 2;
+    static constexpr U64 FULL = 0x8888888888888888ull;
+
+    static inline Vec load(const void* p) {
+        return vld1q_u8((const uint8_t*)p);
+    }
+
+    template <typename T>
+    static inline Vec splat(T value) {
+        if constexpr (sizeof(T) == 1) return vdupq_n_u8((uint8_t)value);
+        else if constexpr (sizeof(T) == 2) return vreinterpretq_u8_u16(vdupq_n_u16((uint16_t)value));
+        else if constexpr (sizeof(T) == 4) return vreinterpretq_u8_u32(vdupq_n_u32((uint32_t)value));
+        else return vreinterpretq_u8_u64(vdupq_n_u64((uint64_t)value));
+    }
+
+    template <typename T>
+    static inline Vec eq(Vec a, Vec b) {
+        if constexpr (sizeof(T) == 1) return vceqq_u8(a, b);
+        else if constexpr (sizeof(T) == 2) return vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+        else if constexpr (sizeof(T) == 4) return vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+        else return vreinterpretq_u8_u64(vceqq_u64(vreinterpretq_u64_u8(a), vreinterpretq_u64_u8(b)));
+    }
+
+    static inline Vec bit_and(Vec a, Vec b) {
+        return vandq_u8(a, b);
+    }
+
+    static inline Vec bit_or(Vec a, Vec b) {
+        return vorrq_u8(a, b);
+    }
+
+    static inline Vec bit_xor(Vec a, Vec b) {
+        return veorq_u8(a, b);
+    }
+
+    static inline Vec bit_andnot(Vec a, Vec b) {
+        return vbicq_u8(a, b);
+    }
+
+    static inline void store(void* p, Vec v) {
+        vst1q_u8((uint8_t*)p, v);
+    }
+
+    // No movemask on NEON: narrowing every 16-bit lane by 4 bits leaves a nibble per byte.
+    static inline U64 mask(Vec v) {
+        uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(v), 4);
+        return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & FULL;
+    }
+
+    static inline Vec in_range(Vec v, U8 first, U8 last) {
+        return vcleq_u8(vsubq_u8(v, vdupq_n_u8(first)), vdupq_n_u8((U8)(last - first)));
+    }
+};
+#endif // OK_SIMD_SSE2
+
+#if OK_SIMD_AVX2
+struct _simd256 {
+    using Vec = __m256i;
+
+    static constexpr UZ WIDTH = 32;
+    static constexpr U32 SHIFT = 0;
+    static constexpr U64 FULL = 0xffffffff;
+
+    static inline Vec load(const void* p) {
+        return _mm256_loadu_si256((const __m256i*)p);
+    }
+
+    template <typename T>
+    static inline Vec splat(T value) {
+        if constexpr (sizeof(T) == 1) return _mm256_set1_epi8((char)value);
+        else if constexpr (sizeof(T) == 2) return _mm256_set1_epi16((short)value);
+        else if constexpr (sizeof(T) == 4) return _mm256_set1_epi32((int)value);
+        else return _mm256_set1_epi64x((long long)value);
+    }
+
+    template <typename T>
+    static inline Vec eq(Vec a, Vec b) {
+        if constexpr (sizeof(T) == 1) return _mm256_cmpeq_epi8(a, b);
+        else if constexpr (sizeof(T) == 2) return _mm256_cmpeq_epi16(a, b);
+        else if constexpr (sizeof(T) == 4) return _mm256_cmpeq_epi32(a, b);
+        else return _mm256_cmpeq_epi64(a, b);
+    }
+
+    static inline Vec bit_and(Vec a, Vec b) {
+        return _mm256_and_si256(a, b);
+    }
+
+    static inline Vec bit_or(Vec a, Vec b) {
+        return _mm256_or_si256(a, b);
+    }
+
+    static inline Vec bit_xor(Vec a, Vec b) {
+        return _mm256_xor_si256(a, b);
+    }
+
+    static inline Vec bit_andnot(Vec a, Vec b) {
+        return _mm256_andnot_si256(b, a);
+    }
+
+    static inline void store(void* p, Vec v) {
+        _mm256_storeu_si256((__m256i*)p, v);
+    }
+
+    static inline U64 mask(Vec v) {
+        return (U32)_mm256_movemask_epi8(v);
+    }
+
+    static inline Vec in_range(Vec v, U8 first, U8 last) {
+        Vec offset = _mm256_sub_epi8(v, _mm256_set1_epi8((char)first));
+        return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8((char)(last - first))), offset);
+    }
+};
+
+using _simd_wide = _simd256;
+#elif OK_SIMD_SSE2 || OK_SIMD_NEON
+using _simd_wide = _simd128;
+#endif // OK_SIMD_AVX2
+
+#if OK_SIMD_SSE2 || OK_SIMD_NEON
+#define OK_SIMD_ANY 1
+#endif
+
+template <typename T>
+static UZ _simd_find(const T* items, UZ count, T value) {
+    UZ i = 0;
+
+#if OK_SIMD_ANY
+    using S = _simd_wide;
+    constexpr UZ LANES = S::WIDTH / sizeof(T);
+    auto needle = S::template splat<T>(value);
+
+    for (; i + LANES <= count; i += LANES) {
+        U64 mask = S::mask(S::template eq<T>(S::load(items + i), needle));
+        if (mask != 0) return i + (count_trailing_zeros(mask) >> S::SHIFT) / sizeof(T);
+    }
+#endif // OK_SIMD_ANY
+
+    for (; i < count; i++) {
+        if (items[i] == value) return i;
+    }
+
+    return (UZ)-1;
+}
+
+template <typename T>
+static UZ _simd_count(const T* items, UZ count, T value) {
+    UZ i = 0;
+    UZ result = 0;
+
+#if OK_SIMD_ANY
+    using S = _simd_wide;
+    constexpr UZ LANES = S::WIDTH / sizeof(T);
+    auto needle = S::template splat<T>(value);
+
+    for (; i + LANES <= count; i += LANES) {
+        U64 mask = S::mask(S::template eq<T>(S::load(items + i), needle));
+        result += popcount(mask) / sizeof(T);
+    }
+#endif // OK_SIMD_ANY
+
+    for (; i < count; i++) result += items[i] == value;
+
+    return result;
+}
+
+UZ simd_find(const U8* items, UZ count, U8 value) { return _simd_find(items, count, value); }
+UZ simd_find(const U16* items, UZ count, U16 value) { return _simd_find(items, count, value); }
+UZ simd_find(const U32* items, UZ count, U32 value) { return _simd_find(items, count, value); }
+UZ simd_find(const U64* items, UZ count, U64 value) { return _simd_find(items, count, value); }
+
+UZ simd_count(const U8* items, UZ count, U8 value) { return _simd_count(items, count, value); }
+UZ simd_count(const U16* items, UZ count, U16 value) { return _simd_count(items, count, value); }
+UZ simd_count(const U32* items, UZ count, U32 value) { return _simd_count(items, count, value); }
+UZ simd_count(const U64* items, UZ count, U64 value) { return _simd_count(items, count, value); }
+
+static inline U64 _load_u64(const U8* p) {
+    U64 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline U32 _load_u32(const U8* p) {
+    U32 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+#if OK_SIMD_ANY
+// Index of the first byte that differs within a block, or `S::WIDTH` if all are equal.
+template <typename S>
+static inline UZ _simd_first_mismatch(const U8* a, const U8* b) {
+    U64 mask = S::mask(S::template eq<U8>(S::load(a), S::load(b))) ^ S::FULL;
+    return mask == 0 ? S::WIDTH : count_trailing_zeros(mask) >> S::SHIFT;
+}
+#endif // OK_SIMD_ANY
+
+bool simd_equal(const void* a, const void* b, UZ size) {
+    const U8* x = (const U8*)a;
+    const U8* y = (const U8*)b;
+
+#if OK_SIMD_ANY
+    // Whole blocks, then one more block ending right at the end, overlapping the previous
+    // one. Sizes under a full block are handled with smaller overlapping loads.
+    if (size >= _simd_wide::WIDTH) {
+        using S = _simd_wide;
+        for (UZ i = 0; i + S::WIDTH <= size; i += S::WIDTH) {
+            if (_simd_first_mismatch<S>(x + i, y + i) != S::WIDTH) return false;
+        }
+        return _simd_first_mismatch<S>(x + size - S::WIDTH, y + size - S::WIDTH) == S::WIDTH;
+    }
+
+    if (size >= _simd128::WIDTH) {
+        using S = _simd128;
+        return _simd_first_mismatch<S>(x, y) == S::WIDTH
+            && _simd_first_mismatch<S>(x + size - S::WIDTH, y + size - S::WIDTH) == S::WIDTH;
+    }
+#else
+    for (; size >= 8; size -= 8, x += 8, y += 8) {
+        if (_load_u64(x) != _load_u64(y)) return false;
+    }
+#endif // OK_SIMD_ANY
+
+    if (size >= 8) return _load_u64(x) == _load_u64(y) && _load_u64(x + size - 8) == _load_u64(y + size - 8);
+    if (size >= 4) return _load_u32(x) == _load_u32(y) && _load_u32(x + size - 4) == _load_u32(y + size - 4);
+
+    for (UZ i = 0; i < size; i++) {
+        if (x[i] != y[i]) return false;
+    }
+
+    return true;
+}
+
+int simd_compare(const void* a, const void* b, UZ size) {
+    const U8* x = (const U8*)a;
+    const U8* y = (const U8*)b;
+    UZ i = 0;
+
+#if OK_SIMD_ANY
+    using S = _simd128;
+    for (; i + S::WIDTH <= size; i += S::WIDTH) {
+        UZ mismatch = _simd_first_mismatch<S>(x + i, y + i);
+        if (mismatch != S::WIDTH) return (int)x[i + mismatch] - (int)y[i + mismatch];
+    }
+#endif // OK_SIMD_ANY
+
+    for (; i + 8 <= size; i += 8) {
+        U64 wx = _load_u64(x + i);
+        U64 wy = _load_u64(y + i);
+        if (wx != wy) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            UZ mismatch = count_trailing_zeros(wx ^ wy) / 8;
+#else
+            UZ mismatch = count_leading_zeros(wx ^ wy) / 8;
+#endif
+            return (int)x[i + mismatch] - (int)y[i + mismatch];
+        }
+    }
+
+    for (; i < size; i++) {
+        if (x[i] != y[i]) return (int)x[i] - (int)y[i];
+    }
+
+    return 0;
+}
+
+UZ simd_find_bytes(const U8* haystack, UZ haystack_size, const U8* needle, UZ needle_size) {
+    if (needle_size == 0) return 0;
+    if (needle_size > haystack_size) return (UZ)-1;
+    if (needle_size == 1) return _simd_find(haystack, haystack_size, needle[0]);
+
+    // Number of positions the needle can start at.
+    UZ starts = haystack_size - needle_size + 1;
+    UZ last = needle_size - 1;
+    UZ i = 0;
+
+#if OK_SIMD_ANY
+    using S = _simd_wide;
+    auto first_byte = S::template splat<U8>(needle[0]);
+    auto last_byte = S::template splat<U8>(needle[last]);
+
+    for (; i + S::WIDTH <= starts; i += S::WIDTH) {
+        auto first_eq = S::template eq<U8>(S::load(haystack + i), first_byte);
+        auto last_eq = S::template eq<U8>(S::load(haystack + i + last), last_byte);
+        U64 mask = S::mask(S::bit_and(first_eq, last_eq));
+
+        while (mask != 0) {
+            UZ pos = i + (count_trailing_zeros(mask) >> S::SHIFT);
+            if (simd_equal(haystack + pos + 1, needle + 1, needle_size - 2)) return pos;
+            mask &= mask - 1;
+        }
+    }
+#endif // OK_SIMD_ANY
+
+    for (; i < starts; i++) {
+        if (haystack[i] == needle[0] && haystack[i + last] == needle[last]
+            && simd_equal(haystack + i + 1, needle + 1, needle_size - 2)) {
+            return i;
+        }
+    }
+
+    return (UZ)-1;
+}
+
+UZ simd_rfind_bytes(const U8* haystack, UZ haystack_size, const U8* needle, UZ needle_size) {
+    if (needle_size > haystack_size) return (UZ)-1;
+    if (needle_size == 0) return haystack_size;
+
+    UZ end = haystack_size - needle_size + 1;
+    UZ last = needle_size - 1;
+
+#if OK_SIMD_ANY
+    using S = _simd_wide;
+    auto first_byte = S::template splat<U8>(needle[0]);
+    auto last_byte = S::template splat<U8>(needle[last]);
+
+    // Blocks of starting positions, walking back from the end.
+    for (; end >= S::WIDTH; end -= S::WIDTH) {
+        UZ block = end - S::WIDTH;
+        auto first_eq = S::template eq<U8>(S::load(haystack + block), first_byte);
+        auto last_eq = S::template eq<U8>(S::load(haystack + block + last), last_byte);
+        U64 mask = S::mask(S::bit_and(first_eq, last_eq));
+
+        while (mask != 0) {
+            U32 top_bit = 63 - count_leading_zeros(mask);
+            UZ pos = block + (top_bit >> S::SHIFT);
+            if (needle_size < 2 || simd_equal(haystack + pos + 1, needle + 1, needle_size - 2)) return pos;
+            mask &= ~((U64)1 << top_bit);
+        }
+    }
+#endif // OK_SIMD_ANY
+
+    while (end > 0) {
+        UZ i = --end;
+        if (haystack[i] == needle[0] && haystack[i + last] == needle[last]
+            && (needle_size < 2 || simd_equal(haystack + i + 1, needle + 1, needle_size - 2))) {
+            return i;
+        }
+    }
+
+    return (UZ)-1;
+}
+
+template <typename Op>
+static void _bits_apply(U64* dst, const U64* src, UZ word_count) {
+    UZ i = 0;
+
+#if OK_SIMD_ANY
+    using S = _simd_wide;
+    constexpr UZ LANES = S::WIDTH / sizeof(U64);
+
+    for (; i + LANES <= word_count; i += LANES) {
+        S::store(dst + i, Op::vec(S::load(dst + i), S::load(src + i)));
+    }
+#endif // OK_SIMD_ANY
+
+    for (; i < word_count; i++) dst[i] = Op::word(dst[i], src[i]);
+}
+
+#if OK_SIMD_ANY
+#define OK_BITS_OP(name, vec_op, expr) \
+    struct name { \
+        static inline _simd_wide::Vec vec(_simd_wide::Vec a, _simd_wide::Vec b) { return _simd_wide::vec_op(a, b); } \
+        static inline U64 word(U64 a, U64 b) { return expr; } \
+    };
+#else
+#define OK_BITS_OP(name, vec_op, expr) \
+    struct name { \
+        static inline U64 word(U64 a, U64 b) { return expr; } \
+    };
+#endif // OK_SIMD_ANY
+
+OK_BITS_OP(_bits_and_op, bit_and, a & b)
+OK_BITS_OP(_bits_or_op, bit_or, a | b)
+OK_BITS_OP(_bits_xor_op, bit_xor, a ^ b)
+OK_BITS_OP(_bits_andnot_op, bit_andnot, a & ~b)
+
+#undef OK_BITS_OP
+
+void bits_and(U64* dst, const U64* src, UZ word_count) { _bits_apply<_bits_and_op>(dst, src, word_count); }
+void bits_or(U64* dst, const U64* src, UZ word_count) { _bits_apply<_bits_or_op>(dst, src, word_count); }
+void bits_xor(U64* dst, const U64* src, UZ word_count) { _bits_apply<_bits_xor_op>(dst, src, word_count); }
+void bits_andnot(U64* dst, const U64* src, UZ word_count) { _bits_apply<_bits_andnot_op>(dst, src, word_count); }
+
+// Four independent accumulators so consecutive popcounts don't wait on each other.
+UZ bits_popcount(const U64* words, UZ word_count) {
+    UZ c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    UZ i = 0;
+
+    for (; i + 4 <= word_count; i += 4) {
+        c0 += popcount(words[i]);
+        c1 += popcount(words[i + 1]);
+        c2 += popcount(words[i + 2]);
+        c3 += popcount(words[i + 3]);
+    }
+
+    for (; i < word_count; i++) c0 += popcount(words[i]);
+
+    return c0 + c1 + c2 + c3;
+}
+
+// STRING IMPLEMENTATION
+
+String String::alloc(Allocator* a, UZ capacity) {
+    String s{};
+    s.allocator = a;
+    s.reserve(capacity);
+
+    return s;
+}
+
+String String::alloc(Allocator* a, const char* data, UZ data_len) {
+    auto s = String::alloc(a, data_len);
+
+    if (data_len > 0) memcpy(s.get_items(), data, data_len);
+    s.set_count(data_len);
+
+    return s;
+}
+
+String String::alloc(Allocator* a, const char* data) {
+    UZ data_len = strlen((const char*)data);
+    return String::alloc(a, data, data_len);
+}
+
+void String::reserve(UZ chars) {
+    UZ capacity = get_capacity();
+    if (chars <= capacity) return;
+
+    UZ c = count();
+    char* items;
+    if (is_small()) {
+        items = allocator->alloc<char>(chars + 1);
+        OK_ASSERT(items != nullptr);
+        memcpy(items, small, c + 1);
+    } else {
+        items = allocator->resize<char>(heap.items, capacity + 1, chars + 1);
+        OK_ASSERT(items != nullptr);
+    }
+
+    set_heap(items, c, chars);
+}
+
+String String::from(List<char> chars) {
+    String s{};
+    s.allocator = chars.allocator;
+
+    // Short enough to go inline, so the list can go right away.
+    if (chars.count <= SMALL_CAPACITY) {
+        if (chars.count > 0) memcpy(s.small, chars.items, chars.count);
+        s.set_count(chars.count);
+        chars.dealloc();
+        return s;
+    }
+
+    if (chars.capacity == chars.count) chars.reserve(chars.count + 1);
+    s.set_heap(chars.items, chars.count, chars.capacity - 1);
+    s.heap.items[chars.count] = NULL_CHAR;
+    return s;
+}
+
+String String::from(List<U8> bytes) {
+    List<char> chars = bytes.cast<char>();
+    return String::from(chars);
+}
+
+String String::from_cstr_set_allocator(Allocator* allocator, char* cstr, UZ count) {
+    OK_ASSERT(cstr[count] == '\0');
+
+    String string{};
+    string.allocator = allocator;
+    string.set_heap(cstr, count, count);
+    return string;
+}
+
+String String::format(Allocator* a, const char* fmt, ...) {
+    va_list sprintf_args;
+    va_list retry_args;
+
+    // Most results fit on the stack, so they get formatted once and copied over.
+    char stack_buf[256];
+
+    va_start(sprintf_args, fmt);
+    va_copy(retry_args, sprintf_args);
+
+    int buf_size = OK_VSNPRINTF(stack_buf, sizeof(stack_buf), fmt, sprintf_args);
+    OK_ASSERT(buf_size != -1);
+
+    String buf{};
+    if ((UZ)buf_size < sizeof(stack_buf)) {
+        buf = String::alloc(a, stack_buf, buf_size);
+    } else {
+        buf = String::alloc(a, buf_size);
+        int bytes_written = OK_VSNPRINTF(buf.get_items(), buf_size + 1, fmt, retry_args);
+        OK_ASSERT(bytes_written != -1);
+        buf.set_count(buf_size);
+    }
+
+    va_end(retry_args);
+    va_end(sprintf_args);
+
+    return buf;
+}
+
+void String::append(const char* chars, UZ chars_count) {
+    if (chars_count == 0) return;
+
+    // `chars` can point into this string, which moves when it grows.
+    UZ old_count = count();
+    uintptr_t start = (uintptr_t)get_items();
+    bool aliased = (uintptr_t)chars >= start && (uintptr_t)chars < start + old_count;
+    UZ offset = aliased ? (UZ)((uintptr_t)chars - start) : 0;
+
+    reserve_extra(chars_count);
+    if (aliased) chars = get_items() + offset;
+
+    memcpy(get_items() + old_count, chars, chars_count);
+    set_count(old_count + chars_count);
+}
+
+void String::append(StringView sv) {
+    append(sv.data, sv.count);
+}
+
+void String::append(String str) {
+    append(str.get_items(), str.count());
+}
+
+void String::format_append(const char* fmt, ...) {
+    va_list sprintf_args;
+    va_list retry_args;
+
+    va_start(sprintf_args, fmt);
+    va_copy(retry_args, sprintf_args);
+
+    // Format straight into the spare capacity, the null terminator has a slot of its own.
+    // Only if that's too small does it get formatted a second time.
+    UZ old_count = count();
+    UZ room = get_capacity() - old_count;
+
+    int required_buf_size = OK_VSNPRINTF(get_items() + old_count, room + 1, fmt, sprintf_args);
+    OK_ASSERT(required_buf_size != -1);
+
+    if ((UZ)required_buf_size > room) {
+        reserve_extra(required_buf_size);
+        int bytes_written = OK_VSNPRINTF(get_items() + old_count, required_buf_size + 1, fmt, retry_args);
+        OK_ASSERT(bytes_written != -1);
+    }
+
+    va_end(retry_args);
+    va_end(sprintf_args);
+
+    set_count(old_count + required_buf_size);
+}
+
+// STRING BUILDER IMPLEMENTATION
+StringBuilder StringBuilder::alloc(Allocator* a, UZ chunk_size) {
+    StringBuilder builder{};
+    builder.allocator = a;
+    builder.next_chunk_size = max(chunk_size, (UZ)64);
+    return builder;
+}
+
+StringBuilder::Chunk* StringBuilder::new_chunk(UZ min_size) {
+    // A chunk left over from `clear` is reused if it's big enough.
+    if (tail != nullptr && tail->next != nullptr && tail->next->size >= min_size) {
+        tail = tail->next;
+        tail->used = 0;
+        return tail;
+    }
+
+    UZ size = max(next_chunk_size, min_size);
+    next_chunk_size = min(next_chunk_size * 2, MAX_CHUNK_SIZE);
+
+    Chunk* chunk = (Chunk*)allocator->raw_alloc(sizeof(Chunk) + size);
+    OK_ASSERT(chunk != nullptr);
+    chunk->size = size;
+    chunk->used = 0;
+
+    if (tail == nullptr) {
+        chunk->next = head;
+        head = chunk;
+    } else {
+        chunk->next = tail->next;
+        tail->next = chunk;
+    }
+    tail = chunk;
+
+    return chunk;
+}
+
+void StringBuilder::append(const char* chars, UZ chars_count) {
+    count += chars_count;
+
+    while (chars_count > 0) {
+        // Fill up whatever is left of the current chunk before starting the next one.
+        if (tail == nullptr || tail->used == tail->size) new_chunk(min(chars_count, MAX_CHUNK_SIZE));
+
+        UZ n = min(chars_count, tail->size - tail->used);
+        memcpy(tail->chars() + tail->used, chars, n);
+        tail->used += n;
+        chars += n;
+        chars_count -= n;
+    }
+}
+
+char* StringBuilder::begin_write(UZ max_count) {
+    if (tail == nullptr || tail->size - tail->used < max_count) new_chunk(max_count);
+    return tail->chars() + tail->used;
+}
+
+void StringBuilder::format_append(const char* fmt, ...) {
+    va_list sprintf_args;
+    va_list retry_args;
+
+    va_start(sprintf_args, fmt);
+    va_copy(retry_args, sprintf_args);
+
+    // Try whatever is left of the current chunk first.
+    UZ room = tail == nullptr ? 0 : tail->size - tail->used;
+    char* buf = room == 0 ? nullptr : tail->chars() + tail->used;
+
+    int required_size = OK_VSNPRINTF(buf, room, fmt, sprintf_args);
+    OK_ASSERT(required_size != -1);
+
+    // `vsnprintf` always writes the null terminator, so it needs one more byte of room.
+    if ((UZ)required_size >= room) {
+        buf = begin_write(required_size + 1);
+        int bytes_written = OK_VSNPRINTF(buf, required_size + 1, fmt, retry_args);
+        OK_ASSERT(bytes_written != -1);
+    }
+
+    va_end(retry_args);
+    va_end(sprintf_args);
+
+    commit(required_size);
+}
+
+String StringBuilder::finish(Allocator* a) const {
+    String result = String::alloc(a, count);
+
+    char* out = result.get_items();
+    for (Chunk* chunk = head; chunk != nullptr; chunk = chunk->next) {
+        memcpy(out, chunk->chars(), chunk->used);
+        out += chunk->used;
+        if (chunk == tail) break;
+    }
+
+    result.set_count(count);
+    return result;
+}
+
+void StringBuilder::clear() {
+    for (Chunk* chunk = head; chunk != nullptr; chunk = chunk->next) chunk->used = 0;
+
+    tail = head;
+    count = 0;
+}
+
+void StringBuilder::dealloc() {
+    Chunk* chunk = head;
+    while (chunk != nullptr) {
+        Chunk* next = chunk->next;
+        allocator->raw_dealloc(chunk, sizeof(Chunk) + chunk->size);
+        chunk = next;
+    }
+
+    head = nullptr;
+    tail = nullptr;
+    count = 0;
+}
+
+// STRING VIEW IMPLEMENTATION
+String StringView::to_string(Allocator* a) const {
+    return String::alloc(a, data, count);
+}
+
+#if OK_SIMD_ANY
+static constexpr UZ BYTE_WINDOW = 64 >> _simd_wide::SHIFT;
+static constexpr U32 BYTE_WINDOW_SHIFT = _simd_wide::SHIFT;
+#else
+static constexpr UZ BYTE_WINDOW = 8;
+static constexpr U32 BYTE_WINDOW_SHIFT = 3;
+#endif // OK_SIMD_ANY
+
+// Bit `i << BYTE_WINDOW_SHIFT` is set if `p[i] == value`, for the first `count` of the
+// `BYTE_WINDOW` bytes at `p`.
+static inline U64 _byte_window_mask(const U8* p, UZ count, U8 value) {
+    if (count < BYTE_WINDOW) {
+        U8 padded[BYTE_WINDOW] = {};
+        if (count > 0) memcpy(padded, p, count);
+        return _byte_window_mask(padded, BYTE_WINDOW, value) & (((U64)1 << (count << BYTE_WINDOW_SHIFT)) - 1);
+    }
+
+#if OK_SIMD_ANY
+    using S = _simd_wide;
+    auto needle = S::splat<U8>(value);
+
+    U64 mask = 0;
+    for (UZ i = 0; i < BYTE_WINDOW; i += S::WIDTH) {
+        mask |= S::mask(S::eq<U8>(S::load(p + i), needle)) << (i << S::SHIFT);
+    }
+    return mask;
+#elif __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // The high bit of every byte that is zero after the xor, without carries between bytes.
+    constexpr U64 LOW_7 = 0x7f7f7f7f7f7f7f7full;
+    U64 x = _load_u64(p) ^ (0x0101010101010101ull * value);
+    return ~(((x & LOW_7) + LOW_7) | x | LOW_7);
+#else
+    U64 mask = 0;
+    for (UZ i = 0; i < BYTE_WINDOW; i++) {
+        if (p[i] == value) mask |= (U64)0x80 << (i << 3);
+    }
+    return mask;
+#endif // OK_SIMD_ANY
+}
+
+CharSplitter CharSplitter::from(StringView source, char delimiter) {
+    CharSplitter splitter;
+    splitter.source = source;
+    splitter.current = StringView{};
+    splitter.position = 0;
+    splitter.window = 0;
+    splitter.mask = _byte_window_mask((const U8*)source.data, min(BYTE_WINDOW, source.count), (U8)delimiter);
+    splitter.delimiter = delimiter;
+    splitter.has_part = true;
+    splitter.finished = false;
+    splitter.next();
+    return splitter;
+}
+
+void CharSplitter::next() {
+    if (finished) {
+        has_part = false;
+        return;
+    }
+
+    while (mask == 0) {
+        window += BYTE_WINDOW;
+        if (window >= source.count) {
+            current = source.view(position);
+            finished = true;
+            return;
+        }
+
+        mask = _byte_window_mask((const U8*)source.data + window, min(BYTE_WINDOW, source.count - window),
+                                 (U8)delimiter);
+    }
+
+    UZ idx = window + (count_trailing_zeros(mask) >> BYTE_WINDOW_SHIFT);
+    mask &= mask - 1;
+
+    current = source.view(position, idx);
+    position = idx + 1;
+}
+
+// CHAR CLASSES IMPLEMENTATION
+// Flips the case of the ASCII letters from `first` to `last` in all eight bytes at once. Adding
+// to the low seven bits of every byte can't carry into the next one, so bit 7 of the sums says
+// whether a byte is at least `first` or past `last`.
+static inline U64 _swar_flip_case(U64 x, U8 first, U8 last) {
+    constexpr U64 ONES = 0x0101010101010101ull;
+
+    U64 low = x & (0x7f * ONES);
+    U64 at_least_first = low + (U64)(0x80 - first) * ONES;
+    U64 past_last = low + (U64)(0x7f - last) * ONES;
+    U64 in_range = (at_least_first ^ past_last) & ~x & (0x80 * ONES);
+
+    return x ^ (in_range >> 2);
+}
+
+static inline U64 _swar_to_lower(U64 x) {
+    return _swar_flip_case(x, 'A', 'Z');
+}
+
+#if OK_SIMD_ANY
+template <typename S>
+static inline typename S::Vec _simd_flip_case(typename S::Vec v, U8 first, U8 last) {
+    return S::bit_xor(v, S::bit_and(S::in_range(v, first, last), S::template splat<U8>(0x20)));
+}
+#endif // OK_SIMD_ANY
+
+static void _ascii_flip_case(char* chars, UZ count, U8 first, U8 last) {
+    U8* p = (U8*)chars;
+    UZ i = 0;
+
+#if OK_SIMD_ANY
+    using S = _simd_wide;
+    if (count >= S::WIDTH) {
+        for (; i + S::WIDTH <= count; i += S::WIDTH) S::store(p + i, _simd_flip_case<S>(S::load(p + i), first, last));
+
+        // One more block ending at the end, over chars that already changed case, which
+        // doesn't change them again.
+        if (i < count) {
+            i = count - S::WIDTH;
+            S::store(p + i, _simd_flip_case<S>(S::load(p + i), first, last));
+        }
+        return;
+    }
+#endif // OK_SIMD_ANY
+
+    for (; i + 8 <= count; i += 8) {
+        U64 x = _load_u64(p + i);
+        x = _swar_flip_case(x, first, last);
+        memcpy(p + i, &x, sizeof(x));
+    }
+    for (; i < count; i++) {
+        if ((U8)(p[i] - first) <= last - first) p[i] ^= 0x20;
+    }
+}
+
+void ascii_to_lower(char* chars, UZ count) {
+    _ascii_flip_case(chars, count, 'A', 'Z');
+}
+
+void ascii_to_upper(char* chars, UZ count) {
+    _ascii_flip_case(chars, count, 'a', 'z');
+}
+
+bool ascii_eq_ignore_case(const char* a, const char* b, UZ count) {
+    const U8* x = (const U8*)a;
+    const U8* y = (const U8*)b;
+    UZ i = 0;
+
+#if OK_SIMD_ANY
+    using S = _simd_wide;
+    if (count >= S::WIDTH) {
+        for (; i + S::WIDTH <= count; i += S::WIDTH) {
+            auto lower_x = _simd_flip_case<S>(S::load(x + i), 'A', 'Z');
+            auto lower_y = _simd_flip_case<S>(S::load(y + i), 'A', 'Z');
+            if (S::mask(S::eq<U8>(lower_x, lower_y)) != S::FULL) return false;
+        }
+        if (i == count) return true;
+
+        i = count - S::WIDTH;
+        auto lower_x = _simd_flip_case<S>(S::load(x + i), 'A', 'Z');
+        auto lower_y = _simd_flip_case<S>(S::load(y + i), 'A', 'Z');
+        return S::mask(S::eq<U8>(lower_x, lower_y)) == S::FULL;
+    }
+#endif // OK_SIMD_ANY
+
+    for (; i + 8 <= count; i += 8) {
+        if (_swar_to_lower(_load_u64(x + i)) != _swar_to_lower(_load_u64(y + i))) return false;
+    }
+    for (; i < count; i++) {
+        if (to_lower((char)x[i]) != to_lower((char)y[i])) return false;
+    }
+
+    return true;
+}
+
+#if OK_SIMD_ANY
+// The ranges making up `classes`, which get tested against every block.
+struct _char_range_set {
+    U8 first[OK_ARR_LEN(CHAR_CLASS_RANGES)];
+    U8 last[OK_ARR_LEN(CHAR_CLASS_RANGES)];
+    UZ count;
+};
+
+static inline _char_range_set _char_class_ranges(CharClass classes) {
+    _char_range_set ranges;
+    ranges.count = 0;
+    for (const CharRange& range : CHAR_CLASS_RANGES) {
+        if ((range.classes & classes) == 0) continue;
+        ranges.first[ranges.count] = range.first;
+        ranges.last[ranges.count] = range.last;
+        ranges.count++;
+    }
+    return ranges;
+}
+
+// The mask, as from `S::mask`, of the chars in the block at `p` that are in one of the ranges.
+template <typename S>
+static inline U64 _char_class_mask(const U8* p, const _char_range_set& ranges) {
+    auto v = S::load(p);
+    auto in_class = S::in_range(v, ranges.first[0], ranges.last[0]);
+    for (UZ r = 1; r < ranges.count; r++) in_class = S::bit_or(in_class, S::in_range(v, ranges.first[r], ranges.last[r]));
+    return S::mask(in_class);
+}
+
+// `flip` is 0 to find the first char in the class, or `S::FULL` for the first one that isn't.
+static UZ _simd_find_class(const U8* p, UZ count, CharClass classes, U64 flip) {
+    using S = _simd_wide;
+
+    _char_range_set ranges = _char_class_ranges(classes);
+    if (ranges.count == 0) return flip == 0 ? (UZ)-1 : 0;
+
+    UZ i = 0;
+    for (; i + S::WIDTH <= count; i += S::WIDTH) {
+        U64 mask = _char_class_mask<S>(p + i, ranges) ^ flip;
+        if (mask != 0) return i + (count_trailing_zeros(mask) >> S::SHIFT);
+    }
+
+    for (; i < count; i++) {
+        bool in_class = (CHAR_CLASSES.classes[p[i]] & classes) != 0;
+        if (in_class == (flip == 0)) return i;
+    }
+    return (UZ)-1;
+}
+#endif // OK_SIMD_ANY
+
+// Runs of a class tend to be short, like the spaces around a header value, so the first few
+// chars are looked up one by one before setting up the vector ranges.
+static constexpr UZ CHAR_CLASS_SCALAR_PREFIX = 8;
+
+UZ find_first_of_class(const char* chars, UZ count, CharClass classes) {
+    const U8* p = (const U8*)chars;
+    UZ prefix = min(count, CHAR_CLASS_SCALAR_PREFIX);
+
+    for (UZ i = 0; i < prefix; i++) {
+        if (CHAR_CLASSES.classes[p[i]] & classes) return i;
+    }
+
+#if OK_SIMD_ANY
+    if (count - prefix >= _simd_wide::WIDTH) {
+        UZ idx = _simd_find_class(p + prefix, count - prefix, classes, 0);
+        return idx == (UZ)-1 ? idx : idx + prefix;
+    }
+#endif // OK_SIMD_ANY
+
+    for (UZ i = prefix; i < count; i++) {
+        if (CHAR_CLASSES.classes[p[i]] & classes) return i;
+    }
+    return (UZ)-1;
+}
+
+UZ find_first_not_of_class(const char* chars, UZ count, CharClass classes) {
+    const U8* p = (const U8*)chars;
+    UZ prefix = min(count, CHAR_CLASS_SCALAR_PREFIX);
+
+    for (UZ i = 0; i < prefix; i++) {
+        if ((CHAR_CLASSES.classes[p[i]] & classes) == 0) return i;
+    }
+
+#if OK_SIMD_ANY
+    if (count - prefix >= _simd_wide::WIDTH) {
+        UZ idx = _simd_find_class(p + prefix, count - prefix, classes, _simd_wide::FULL);
+        return idx == (UZ)-1 ? idx : idx + prefix;
+    }
+#endif // OK_SIMD_ANY
+
+    for (UZ i = prefix; i < count; i++) {
+        if ((CHAR_CLASSES.classes[p[i]] & classes) == 0) return i;
+    }
+    return (UZ)-1;
+}
+
+UZ find_last_not_of_class(const char* chars, UZ count, CharClass classes) {
+    const U8* p = (const U8*)chars;
+    UZ i = count;
+
+    for (UZ prefix = min(count, CHAR_CLASS_SCALAR_PREFIX); prefix > 0; prefix--) {
+        i--;
+        if ((CHAR_CLASSES.classes[p[i]] & classes) == 0) return i;
+    }
+
+#if OK_SIMD_ANY
+    using S = _simd_wide;
+    if (count >= S::WIDTH) {
+        _char_range_set ranges = _char_class_ranges(classes);
+        if (ranges.count == 0) return count - 1;
+
+        for (; i >= S::WIDTH; i -= S::WIDTH) {
+            U64 mask = _char_class_mask<S>(p + i - S::WIDTH, ranges) ^ S::FULL;
+            if (mask != 0) return i - S::WIDTH + ((63 - count_leading_zeros(mask)) >> S::SHIFT);
+        }
+    }
+#endif // OK_SIMD_ANY
+
+    while (i > 0) {
+        i--;
+        if ((CHAR_CLASSES.classes[p[i]] & classes) == 0) return i;
+    }
+    return (UZ)-1;
+}
+
+// FILESYSTEM API IMPLEMENTATION
+Optional<File::OpenError> File::open(File* out, const char* path) {
+#if OK_UNIX
+    int fd = ::open(path, O_RDWR | O_CREAT, 0666);
+    int error = errno;
+
+    if (fd < 0) {
+        switch (error) {
+        case EACCES:       return OpenError::ACCESS_DENIED;
+        case EINVAL:       return OpenError::INVALID_PATH;
+        case EISDIR:       return OpenError::IS_DIRECTORY;
+        case ELOOP:        return OpenError::TOO_MANY_SYMLINKS;
+        case EMFILE:       return OpenError::PROCESS_OPEN_FILES_LIMIT_REACHED;
+        case ENFILE:       return OpenError::SYSTEM_OPEN_FILES_LIMIT_REACHED;
+        case ENAMETOOLONG: return OpenError::PATH_TOO_LONG;
+        case ENOMEM:       return OpenError::KERNEL_OUT_OF_MEMORY;
+        case ENOSPC:       return OpenError::OUT_OF_SPACE;
+        case ENXIO:        return OpenError::IS_SOCKET;
+        case EOVERFLOW:    return OpenError::FILE_TOO_BIG;
+        case EROFS:        return OpenError::READONLY_FILE;
+        case EFAULT:       OK_PANIC_FMT("Parameter 'path' (%p) is not mapped to the current process", (void*)path);
+        default:           OK_PANIC_FMT("Unexpected error: %s", strerror(error));
+        }
+    }
+
+    out->offset = 0;
+    out->fd = fd;
+    out->path = path;
+
+    return {};
+#elif OK_WINDOWS
+    // NOTE: Possible CreateFileA errors
+    //   ERROR_SHARING_VIOLATION
+
+    constexpr DWORD FILE_SHARE_MODE = 0;
+    constexpr LPSECURITY_ATTRIBUTES SECURITY_ATTRIBUTES = nullptr;
+    constexpr HANDLE TEMPLATE_FILE = nullptr;
+
+    HANDLE file_handle = CreateFileA(path,
+                                     GENERIC_READ | GENERIC_WRITE,
+                                     FILE_SHARE_MODE,
+                                     SECURITY_ATTRIBUTES,
+                                     OPEN_ALWAYS,
+                                     FILE_ATTRIBUTE_NORMAL,
+                                     TEMPLATE_FILE);
+
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        DWORD file_open_error = GetLastError();
+        return file_open_error;
+    }
+
+    out->handle = file_handle;
+    out->path = path;
+    return {};
+#else
+    OK_TODO();
+#endif // OK_UNIX
+}
+
+Optional<File::OpenError> File::open(File* out, StringView path) {
+    // FIXME: Temporary allocation in potentially multi-threaded context.
+    char* path_cstr = temp_allocator()->alloc<char>(path.count + 1);
+    memcpy(path_cstr, path.data, path.count);
+    path_cstr[path.count] = '\0';
+    return File::open(out, path_cstr);
+}
+
+bool File::exists(const char* path) {
+#if OK_UNIX
+    return ::access(path, F_OK) == 0;
+#elif OK_WINDOWS
+    DWORD attrs = GetFileAttributesA(path);
+    return attrs != INVALID_FILE_ATTRIBUTES;
+#else
+    OK_TODO();
+#endif
+}
+
+bool File::exists(StringView path) {
+    char* path_cstr = temp_allocator()->alloc<char>(path.count + 1);
+    memcpy(path_cstr, path.data, path.count);
+    path_cstr[path.count] = '\0';
+    return File::exists(path_cstr);
+}
+
+#if OK_UNIX
+String File::error_string(Allocator* allocator, File::OpenError error) {
+    switch (error) {
+    case IOError::ACCESS_DENIED:                    return String::alloc(allocator, "access denied");
+    case IOError::INVALID_PATH:                     return String::alloc(allocator, "invalid file path");
+    case IOError::IS_DIRECTORY:                     return String::alloc(allocator, "file is a directory");
+    case IOError::TOO_MANY_SYMLINKS:                return String::alloc(allocator, "too many symlinks");
+    case IOError::PROCESS_OPEN_FILES_LIMIT_REACHED: return String::alloc(allocator, "process open files limit has been reached");
+    case IOError::SYSTEM_OPEN_FILES_LIMIT_REACHED:  return String::alloc(allocator, "system open files limit has been reached");
+    case IOError::PATH_TOO_LONG:                    return String::alloc(allocator, "file path is too long");
+    case IOError::KERNEL_OUT_OF_MEMORY:             return String::alloc(allocator, "kernel out of memory");
+    case IOError::OUT_OF_SPACE:                     return String::alloc(allocator, "disk out of space");
+    case IOError::IS_SOCKET:                        return String::alloc(allocator, "file is a socket");
+    case IOError::FILE_TOO_BIG:                     return String::alloc(allocator, "file is too big");
+    case IOError::READONLY_FILE:                    return String::alloc(allocator, "file is readonly");
+    case IOError::IO:                               return String::alloc(allocator, "I/O error");
+    case IOError::NOT_ALLOWED:                      return String::alloc(allocator, "operation not allowed");
+    case IOError::BAD_DATA:                         return String::alloc(allocator, "bad data");
+    case IOError::BAD_FILE_DESCRIPTOR:              return String::alloc(allocator, "bad file descriptor");
+    case IOError::INTERRUPTED_BY_SIGNAL:            return String::alloc(allocator, "interrupted by signal");
+    case IOError::CURRENTLY_IN_USE:                 return String::alloc(allocator, "currently in use");
+    case IOError::READONLY_FS:                      return String::alloc(allocator, "readonly file system");
+    case IOError::DOES_NOT_EXIST:                   return String::alloc(allocator, "does not exist");
+    }
+
+    OK_UNREACHABLE();
+}
+
+#elif OK_WINDOWS
+
+String File::error_string(Allocator* allocator, DWORD error) {
+    constexpr DWORD LANGUAGE_ID = 0;
+    constexpr DWORD ERROR_BUFFER_SIZE = 1024;
+
+    char* error_buffer = allocator->alloc<char>(ERROR_BUFFER_SIZE);
+
+    DWORD result = FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM,
+                                 nullptr,
+                                 error,
+                                 LANGUAGE_ID,
+                                 error_buffer,
+                                 ERROR_BUFFER_SIZE,
+                                 nullptr);
+
+    OK_ASSERT(result != 0);
+
+    return String::from_cstr_set_allocator(allocator, error_buffer, ERROR_BUFFER_SIZE);
+}
+
+#endif // Platform check.
+
+void File::seek_to(U64 seek_offset) {
+    this->offset = seek_offset;
+#if OK_UNIX
+    OK_ASSERT(lseek(fd, seek_offset, SEEK_SET) != (off_t)-1);
+#elif OK_WINDOWS
+    LONG higher_order_bits = 0;
+    DWORD lower_order_bits = SetFilePointer(handle, (LONG)seek_offset, &higher_order_bits, FILE_BEGIN);
+    OK_ASSERT(lower_order_bits != INVALID_SET_FILE_POINTER);
+#else
+    OK_TODO();
+#endif // Platform check.
+}
+
+U64 File::seek_end() {
+#if OK_UNIX
+    off_t seek_res = lseek(fd, 0, SEEK_END);
+    OK_ASSERT(seek_res != (off_t)-1);
+    offset = seek_res;
+    return seek_res;
+#elif OK_WINDOWS
+    long higher_order_bits = 0;
+    DWORD lower_order_bits = SetFilePointer(handle, 0, &higher_order_bits, FILE_END);
+    OK_ASSERT(lower_order_bits != INVALID_SET_FILE_POINTER);
+
+    offset = (U64)higher_order_bits << 32 | (U64)lower_order_bits;
+    return offset;
+#else
+    OK_TODO();
+#endif // Platform check.
+}
+
+UZ File::size() {
+    UZ prev_offset = this->offset;
+    U64 res = seek_end();
+    seek_to(prev_offset);
+    return res;
+}
+
+Optional<File::ReadError> File::read(U8* buf, UZ count, UZ* n_read) {
+#if OK_UNIX
+    S64 r = ::read(fd, buf, count);
+
+    if (r < 0) {
+        switch (errno) {
+        case EIO: return ReadError::IO;
+        case EFAULT: OK_PANIC_FMT("The buffer (%p) is mapped outside the current process", (void*)buf);
+        default: OK_UNREACHABLE();
+        }
+    }
+
+    *n_read = r;
+
+    return {};
+#elif OK_WINDOWS
+    bool ok = ReadFile(handle, (void*)buf, (DWORD)count, (LPDWORD)n_read, nullptr);
+    if (!ok) return GetLastError();
+    return {};
+#else
+    OK_TODO();
+#endif // Platform check
+}
+
+Optional<File::ReadError> File::read_full(Allocator* a, List<U8>* out) {
+    UZ file_offset = offset;
+
+    UZ file_size = size();
+    *out = List<U8>::alloc(a, file_size);
+
+    Optional<ReadError> err{};
+
+    seek_start();
+    UZ n_read = 0;
+    err = read(out->items, file_size, &n_read);
+
+    if (err.has_value()) goto end;
+
+    out->count = n_read;
+
+end:
+    seek_to(file_offset);
+
+    return err;
+}
+
+Optional<File::RemoveError> File::remove() {
+#if OK_UNIX
+    int res = ::remove(this->path);
+    if (res != -1)     return {};
+
+    switch (errno) {
+    case EPERM:
+    case EACCES:       return RemoveError::ACCESS_DENIED;
+    case EBUSY:        return RemoveError::CURRENTLY_IN_USE;
+    case EIO:          return RemoveError::IO;
+    case ENAMETOOLONG: return RemoveError::PATH_TOO_LONG;
+    case ENOTDIR:
+    case ENOENT:       return RemoveError::DOES_NOT_EXIST;
+    case ENOMEM:       return RemoveError::KERNEL_OUT_OF_MEMORY;
+    case EROFS:        return RemoveError::READONLY_FS;
+    default: OK_UNREACHABLE();
+    }
+#elif OK_WINDOWS
+    OK_TODO();
+#else
+    OK_TODO();
+#endif // Platform check.
+}
+
+Optional<File::CloseError> File::close() const {
+#if OK_UNIX
+    int ret = ::close(fd);
+    if (ret == 0) return {};
+
+    switch (ret) {
+    case EBADF:  return CloseError::BAD_FILE_DESCRIPTOR;
+    case EINTR:  return CloseError::INTERRUPTED_BY_SIGNAL;
+    case EIO:    return CloseError::IO;
+    case ENOSPC:
+    case EDQUOT: return CloseError::OUT_OF_SPACE;
+    default: OK_UNREACHABLE();
+    }
+#elif OK_WINDOWS
+    bool ok = CloseHandle(handle);
+    if (ok) return {};
+    return GetLastError();
+#else
+    OK_TODO();
+#endif // Platform check.
+}
+
+Optional<File::WriteError> File::write(const U8* data, UZ count, UZ *n_written) {
+#if OK_UNIX
+    OK_VERIFY(data != nullptr);
+
+    S64 ret = ::write(fd, (const void*)data, count);
+
+    if (ret != -1) {
+        if (n_written != nullptr) {
+            *n_written = (UZ) ret;
+        }
+
+        return {};
+    }
+
+    switch (errno) {
+    case EBADF:  return WriteError::NOT_ALLOWED;
+    case ENOSPC: return WriteError::OUT_OF_SPACE;
+    case EINVAL: return WriteError::BAD_DATA;
+    default:     OK_PANIC_FMT("Unhandled error %s", strerror(errno));
+    }
+#elif OK_WINDOWS
+    // We first seek to the start of the file, and then set that as the end of file,
+    // so when the write proceeds, it will flush the buffer to disk and set a the new
+    // end of file to the length of the supplied buffer, overriding the file contents
+    // fully.
+    seek_start();
+    SetEndOfFile(handle);
+
+    DWORD n_written = 0;
+    bool ok = WriteFile(handle,
+                        data,
+                        (DWORD)count,
+                        &n_written,
+                        nullptr);
+
+    if (!ok) return GetLastError();
+    return {};
+#else
+    OK_TODO();
+#endif // Platform check.
+}
+
+Optional<File::IOError> File::truncate(UZ size) {
+#if OK_UNIX
+    int status = ::ftruncate(fd, size);
+    if (status == 0) return {};
+
+    switch (errno) {
+    case EACCES:  return IOError::ACCESS_DENIED;
+    case EFBIG:   return IOError::FILE_TOO_BIG;
+    case EINTR:   return IOError::INTERRUPTED_BY_SIGNAL;
+    case EIO:     return IOError::IO;
+    case EISDIR:  return IOError::IS_DIRECTORY;
+    case EPERM:   return IOError::NOT_ALLOWED;
+    case EROFS:   return IOError::READONLY_FS;
+    case ETXTBSY: return IOError::CURRENTLY_IN_USE;
+    case EBADF:   return IOError::BAD_FILE_DESCRIPTOR;
+    case EINVAL:  return IOError::NOT_ALLOWED;
+    default: OK_PANIC_FMT("Unhandled error %s", strerror(errno));
+    }
+
+    OK_UNREACHABLE();
+#else
+    OK_UNUSED(size);
+    OK_TODO();
+#endif // OK_UNIX
+}
+
+// SUBPROCESS API IMPLEMENTATION
+Optional<Command::ExecError> Command::exec() {
+#if OK_UNIX
+        Optional<ExecError> exec_err{};
+        pid_t child_pid;
+
+        posix_spawn_file_actions_t actions{};
+        posix_spawnattr_t attributes{};
+
+        int stdin_fds[2];
+        UZ stdin_write_count;
+
+        int spawn_ret;
+        int child_status;
+        pid_t wait_ret;
+
+        arg(nullptr);
+        env(nullptr);
+
+        if (pipe(stdin_fds) < -1) {
+            switch (errno) {
+            case EMFILE: exec_err = ExecError::PROCESS_OPEN_FILE_LIMIT_REACHED; goto cleanup;
+            case ENFILE: exec_err = ExecError::SYSTEM_OPEN_FILE_LIMIT_REACHED; goto cleanup;
+            case EFAULT: OK_UNREACHABLE();
+            default: OK_PANIC_FMT("unhandled error %d", errno);
+            }
+        }
+
+        OK_ASSERT(posix_spawn_file_actions_init(&actions) == 0);
+
+        // Close the write end
+        OK_ASSERT(posix_spawn_file_actions_addclose(&actions, stdin_fds[1]) == 0);
+        // Map the read end to stdin
+        OK_ASSERT(posix_spawn_file_actions_adddup2(&actions, stdin_fds[0], STDIN_FILENO) == 0);
+
+        spawn_ret = posix_spawnp(&child_pid, name, &actions, &attributes, args.get_items(), envs.get_items());
+
+        if (spawn_ret != 0) {
+            switch (spawn_ret) {
+            case E2BIG:    exec_err = ExecError::TOO_BIG; goto cleanup;
+
+            case EPERM:
+            case EACCES:   exec_err = ExecError::ACCESS_DENIED; goto cleanup;
+
+            case EAGAIN:   exec_err = ExecError::PROCESS_LIMIT_EXCEEDED; goto cleanup;
+
+            case ENOEXEC:
+            case ELIBBAD:
+            case EISDIR:
+            case EINVAL:   exec_err = ExecError::INVALID_EXECUTABLE; goto cleanup;
+
+            case EIO:      exec_err = ExecError::IO; goto cleanup;
+            case ELOOP:    exec_err = ExecError::LOOP; goto cleanup;
+            case ENFILE:   exec_err = ExecError::TOO_MANY_FILES; goto cleanup;
+            case ENOENT:   exec_err = ExecError::EXECUTABLE_NOT_FOUND; goto cleanup;
+            case ENOMEM:   exec_err = ExecError::KERNEL_OUT_OF_MEMORY; goto cleanup;
+            case ENOTDIR:  exec_err = ExecError::INVALID_PATH; goto cleanup;
+            case ETXTBSY:  exec_err = ExecError::BUSY; goto cleanup;
+            case EFAULT:   OK_UNREACHABLE();
+            default:       OK_PANIC_FMT("unhandled error %d", spawn_ret);
+            }
+        }
+
+        stdin_write_count = 0;
+        while (stdin_write_count < stdin_data.count) {
+            U8* data = stdin_data.items + stdin_write_count;
+            UZ data_count = stdin_data.count - stdin_write_count;
+
+            SZ write_count = write(stdin_fds[1], data, data_count);
+            if (write_count < 0) {
+                switch (errno) {
+                case EFBIG:  exec_err = ExecError::TOO_BIG; goto cleanup;
+                case EIO:    exec_err = ExecError::IO; goto cleanup;
+                case ENOSPC: exec_err = ExecError::OUT_OF_SPACE; goto cleanup;
+                case EPERM:  exec_err = ExecError::ACCESS_DENIED; goto cleanup;
+                case EPIPE:
+                case EBADFD:
+                case EDESTADDRREQ:
+                case EAGAIN:
+                case EDQUOT:
+                case EINVAL:
+                case EINTR:
+                    OK_UNREACHABLE();
+                default: OK_PANIC_FMT("unhandled error %d", errno);
+                }
+            }
+
+            stdin_write_count += write_count;
+        }
+
+        OK_ASSERT(close(stdin_fds[1]) == 0);
+
+        wait_ret = waitpid(child_pid, &child_status, 0);
+        if (wait_ret == (pid_t)-1) OK_UNREACHABLE();
+
+        if (WIFEXITED(child_status)) {
+            exit_code = WEXITSTATUS(child_status);
+            goto cleanup;
+        }
+
+        if (WIFSIGNALED(child_status)) {
+            term_signal_num = WTERMSIG(child_status);
+            exec_err = ExecError::TERMINATED_BY_SIGNAL;
+            goto cleanup;
+        }
+
+        if (WIFSTOPPED(child_status)) {
+            stop_signal_num = WSTOPSIG(child_status);
+            exec_err = ExecError::STOPPED;
+            goto cleanup;
+        }
+
+cleanup:
+    posix_spawn_file_actions_destroy(&actions);
+
+    return exec_err;
+#else
+        OK_TODO();
+#endif // OS guard
+}
+
+// PROCEDURES IMPLEMENTATION
+String to_string(Allocator* allocator, U32 value) {
+    String s = String::alloc(allocator);
+    append_int(&s, value);
+    return s;
+}
+
+String to_string(Allocator* allocator, S32 value) {
+    String s = String::alloc(allocator);
+    append_int(&s, value);
+    return s;
+}
+
+String to_string(Allocator* allocator, U64 value) {
+    String s = String::alloc(allocator);
+    append_int(&s, value);
+    return s;
+}
+
+String to_string(Allocator* allocator, S64 value) {
+    String s = String::alloc(allocator);
+    append_int(&s, value);
+    return s;
+}
+
+// INTEGER PARSING IMPLEMENTATION
+// Digit values for every base up to 16, 0xff for anything else.
+static constexpr U8 hex_digit_values[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0,    1,    2,    3,    4,    5,    6,    7,    8,    9,    0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 10,   11,   12,   13,   14,   15,   0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 10,   11,   12,   13,   14,   15,   0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+// Eight ASCII digits in a word, the first one in the lowest byte (D. Lemire, "Fast numeric
+// string to int").
+static inline bool is_eight_digits(U64 chars) {
+    return (((chars & 0xf0f0f0f0f0f0f0f0ull) | (((chars + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) >> 4)) ==
+            0x3333333333333333ull);
+}
+
+static inline U64 eight_digits_value(U64 chars) {
+    chars -= 0x3030303030303030ull;
+    // Pairs, then quads, then the whole thing.
+    chars = (chars * 10) + (chars >> 8);
+    return (((chars & 0x000000ff000000ffull) * (100 + (1000000ull << 32))) +
+            (((chars >> 16) & 0x000000ff000000ffull) * (1 + (10000ull << 32)))) >> 32;
+}
+#endif // __BYTE_ORDER__
+
+bool parse_int_magnitude(StringView source, U32 base, U64 positive_limit, U64 negative_limit, U64* magnitude,
+                         bool* negative, UZ* consumed) {
+    OK_ASSERT(base == 0 || base == 2 || base == 8 || base == 10 || base == 16);
+
+    const char* p = source.data;
+    const char* end = source.data + source.count;
+
+    *negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        *negative = *p == '-';
+        p++;
+    }
+
+    // A prefix only counts if a digit follows it, "0x" alone is a zero followed by an 'x'.
+    if (end - p >= 3 && p[0] == '0') {
+        char c = p[1] | 0x20;
+        U32 prefix_base = c == 'x' ? 16 : c == 'o' ? 8 : c == 'b' ? 2 : 0;
+        if (prefix_base != 0 && (base == 0 || base == prefix_base) && hex_digit_values[(U8)p[2]] < prefix_base) {
+            base = prefix_base;
+            p += 2;
+        }
+    }
+    if (base == 0) base = 10;
+
+    U64 limit = *negative ? negative_limit : positive_limit;
+    const char* digits_start = p;
+    U64 value = 0;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // Eight digits at a time while the value can't overflow yet, 10^11 * 10^8 still fits.
+    if (base == 10) {
+        while (end - p >= 8 && value < 100000000000ull) {
+            U64 chars;
+            memcpy(&chars, p, sizeof(chars));
+            if (!is_eight_digits(chars)) break;
+
+            value = value * 100000000 + eight_digits_value(chars);
+            p += 8;
+        }
+    }
+#endif // __BYTE_ORDER__
+
+    while (p < end) {
+        U32 digit = hex_digit_values[(U8)*p];
+        if (digit >= base) break;
+
+        if (__builtin_mul_overflow(value, (U64)base, &value) || __builtin_add_overflow(value, (U64)digit, &value)) {
+            return false;
+        }
+        p++;
+    }
+
+    if (p == digits_start || value > limit) return false;
+
+    if (consumed != nullptr) {
+        *consumed = p - source.data;
+    } else if (p != end) {
+        return false;
+    }
+
+    *magnitude = value;
+    return true;
+}
+
+bool parse_int64(StringView source, S64* out) {
+    return parse_int(source, out);
+}
+
+// UTF-8 IMPLEMENTATION
+static bool _utf8_validate_scalar(const U8* p, const U8* end) {
+    while (p < end) {
+        if (end - p >= 8 && (_load_u64(p) & 0x8080808080808080ull) == 0) {
+            p += 8;
+            continue;
+        }
+
+        U8 lead = *p;
+        if (lead < 0x80) {
+            p++;
+            continue;
+        }
+
+        // 0x80 to 0xbf are continuation bytes, and 0xc0 and 0xc1 could only start overlong
+        // encodings of ASCII.
+        if (lead < 0xc2 || lead > 0xf4) return false;
+
+        UZ length = utf8_sequence_length((char)lead);
+        if ((UZ)(end - p) < length) return false;
+        for (UZ i = 1; i < length; i++) {
+            if ((p[i] & 0xc0) != 0x80) return false;
+        }
+
+        // The second byte rules out overlong encodings, surrogates and codepoints past U+10FFFF.
+        U8 second = p[1];
+        if (lead == 0xe0 && second < 0xa0) return false;
+        if (lead == 0xed && second >= 0xa0) return false;
+        if (lead == 0xf0 && second < 0x90) return false;
+        if (lead == 0xf4 && second >= 0x90) return false;
+
+        p += length;
+    }
+
+    return true;
+}
+
+// The lookup algorithm from "Validating UTF-8 In Less Than One Instruction Per Byte" by
+// Keiser and Lemire. Every error shows up in the first two bytes of a sequence, plus whether
+// the following bytes are continuations, so three 16 entry tables indexed by the nibbles of
+// each byte and the one before it flag everything but the length checks, which come from
+// shifting in the two bytes before that.
+//
+// It needs a byte shuffle, so plain SSE2 only gets the scalar version.
+#if OK_SIMD_AVX2
+struct _utf8_simd {
+    using Vec = __m256i;
+
+    static constexpr UZ WIDTH = 32;
+
+    static inline Vec load(const U8* p) {
+        return _mm256_loadu_si256((const __m256i*)p);
+    }
+
+    static inline Vec splat(U8 value) {
+        return _mm256_set1_epi8((char)value);
+    }
+
+    static inline Vec bit_and(Vec a, Vec b) {
+        return _mm256_and_si256(a, b);
+    }
+
+    static inline Vec bit_or(Vec a, Vec b) {
+        return _mm256_or_si256(a, b);
+    }
+
+    static inline Vec bit_xor(Vec a, Vec b) {
+        return _mm256_xor_si256(a, b);
+    }
+
+    static inline Vec saturating_sub(Vec a, Vec b) {
+        return _mm256_subs_epu8(a, b);
+    }
+
+    static inline Vec high_nibbles(Vec v) {
+        return _mm256_and_si256(_mm256_srli_epi16(v, 4), splat(0x0f));
+    }
+
+    static inline Vec lookup(const U8* table, Vec index) {
+        return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)table)), index);
+    }
+
+    // The bytes of `input` shifted up by `N`, with the last `N` bytes of `previous` in front.
+    template <int N>
+    static inline Vec prev(Vec input, Vec previous) {
+        return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+    }
+
+    static inline bool is_ascii(Vec v) {
+        return _mm256_movemask_epi8(v) == 0;
+    }
+
+    static inline bool any(Vec v) {
+        return !_mm256_testz_si256(v, v);
+    }
+};
+#elif OK_SIMD_SSSE3
+struct _utf8_simd {
+    using Vec = __m128i;
+
+    static constexpr UZ WIDTH = 16;
+
+    static inline Vec load(const U8* p) {
+        return _mm_loadu_si128((const __m128i*)p);
+    }
+
+    static inline Vec splat(U8 value) {
+        return _mm_set1_epi8((char)value);
+    }
+
+    static inline Vec bit_and(Vec a, Vec b) {
+        return _mm_and_si128(a, b);
+    }
+
+    static inline Vec bit_or(Vec a, Vec b) {
+        return _mm_or_si128(a, b);
+    }
+
+    static inline Vec bit_xor(Vec a, Vec b) {
+        return _mm_xor_si128(a, b);
+    }
+
+    static inline Vec saturating_sub(Vec a, Vec b) {
+        return _mm_subs_epu8(a, b);
+    }
+
+    static inline Vec high_nibbles(Vec v) {
+        return _mm_and_si128(_mm_srli_epi16(v, 4), splat(0x0f));
+    }
+
+    static inline Vec lookup(const U8* table, Vec index) {
+        return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)table), index);
+    }
+
+    template <int N>
+    static inline Vec prev(Vec input, Vec previous) {
+        return _mm_alignr_epi8(input, previous, 16 - N);
+    }
+
+    static inline bool is_ascii(Vec v) {
+        return _mm_movemask_epi8(v) == 0;
+    }
+
+    static inline bool any(Vec v) {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) != 0xffff;
+    }
+};
+#elif OK_SIMD_NEON
+struct _utf8_simd {
+    using Vec = uint8x16_t;
+
+    static constexpr UZ WIDTH = 16;
+
+    static inline Vec load(const U8* p) {
+        return vld1q_u8(p);
+    }
+
+    static inline Vec splat(U8 value) {
+        return vdupq_n_u8(value);
+    }
+
+    static inline Vec bit_and(Vec a, Vec b) {
+        return vandq_u8(a, b);
+    }
+
+    static inline Vec bit_or(Vec a, Vec b) {
+        return vorrq_u8(a, b);
+    }
+
+    static inline Vec bit_xor(Vec a, Vec b) {
+        return veorq_u8(a, b);
+    }
+
+    static inline Vec saturating_sub(Vec a, Vec b) {
+        return vqsubq_u8(a, b);
+    }
+
+    static inline Vec high_nibbles(Vec v) {
+        return vshrq_n_u8(v, 4);
+    }
+
+    static inline Vec lookup(const U8* table, Vec index) {
+        return vqtbl1q_u8(vld1q_u8(table), index);
+    }
+
+    template <int N>
+    static inline Vec prev(Vec input, Vec previous) {
+        return vextq_u8(previous, input, 16 - N);
+    }
+
+    static inline bool is_ascii(Vec v) {
+        return vmaxvq_u8(v) < 0x80;
+    }
+
+    static inline bool any(Vec v) {
+        return vmaxvq_u8(v) != 0;
+    }
+};
+#endif // OK_SIMD_AVX2
+
+#if OK_SIMD_AVX2 || OK_SIMD_SSSE3 || OK_SIMD_NEON
+static constexpr U8 UTF8_TOO_SHORT = 1 << 0;
+static constexpr U8 UTF8_TOO_LONG = 1 << 1;
+static constexpr U8 UTF8_OVERLONG_3 = 1 << 2;
+static constexpr U8 UTF8_TOO_LARGE = 1 << 3;
+static constexpr U8 UTF8_SURROGATE = 1 << 4;
+static constexpr U8 UTF8_OVERLONG_2 = 1 << 5;
+// Past U+10FFFF with a 0xf4 lead, or an overlong 4 byte encoding. Which one depends on the
+// low nibble of the lead, so they can share a bit.
+static constexpr U8 UTF8_TOO_LARGE_1000 = 1 << 6;
+static constexpr U8 UTF8_OVERLONG_4 = 1 << 6;
+static constexpr U8 UTF8_TWO_CONTS = 1 << 7;
+static constexpr U8 UTF8_CARRY = UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS;
+
+// Indexed by the high nibble of the previous byte.
+static constexpr U8 utf8_byte_1_high[16] = {
+    // ASCII.
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    // Continuation.
+    UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+    // 110_ leads.
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+    UTF8_TOO_SHORT,
+    // 1110 and 1111 leads.
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+};
+
+// Indexed by the low nibble of the previous byte.
+static constexpr U8 utf8_byte_1_low[16] = {
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+    UTF8_CARRY | UTF8_OVERLONG_2,
+    UTF8_CARRY,
+    UTF8_CARRY,
+    UTF8_CARRY | UTF8_TOO_LARGE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+};
+
+// Indexed by the high nibble of the current byte.
+static constexpr U8 utf8_byte_2_high[16] = {
+    // ASCII.
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    // Continuation, 1000, 1001 and 101_.
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    // Leads.
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+};
+
+// Any byte this large in the last three of a block starts a sequence that runs into the
+// next block.
+alignas(32) static constexpr U8 utf8_incomplete_limits[32] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1,
+};
+
+struct _utf8_checker {
+    using S = _utf8_simd;
+    using Vec = S::Vec;
+
+    inline void check_block(Vec input) {
+        if (S::is_ascii(input)) {
+            error = S::bit_or(error, incomplete);
+            incomplete = S::splat(0);
+        } else {
+            Vec prev1 = S::prev<1>(input, previous);
+            Vec special = S::bit_and(S::bit_and(S::lookup(utf8_byte_1_high, S::high_nibbles(prev1)),
+                                                S::lookup(utf8_byte_1_low, S::bit_and(prev1, S::splat(0x0f)))),
+                                     S::lookup(utf8_byte_2_high, S::high_nibbles(input)));
+
+            // The second byte after a 3 or 4 byte lead, and the third after a 4 byte one, have
+            // to be continuations. The tables already flag continuations that aren't needed.
+            Vec third = S::saturating_sub(S::prev<2>(input, previous), S::splat(0xe0 - 0x80));
+            Vec fourth = S::saturating_sub(S::prev<3>(input, previous), S::splat(0xf0 - 0x80));
+            Vec must_continue = S::bit_and(S::bit_or(third, fourth), S::splat(0x80));
+
+            error = S::bit_or(error, S::bit_xor(must_continue, special));
+            incomplete = S::saturating_sub(input, S::load(utf8_incomplete_limits + 32 - S::WIDTH));
+        }
+        previous = input;
+    }
+
+    Vec error;
+    Vec previous;
+    Vec incomplete;
+};
+
+static bool _utf8_validate_simd(const U8* p, UZ count) {
+    using S = _utf8_simd;
+
+    _utf8_checker checker;
+    checker.error = S::splat(0);
+    checker.previous = S::splat(0);
+    checker.incomplete = S::splat(0);
+
+    UZ i = 0;
+    for (; i + S::WIDTH <= count; i += S::WIDTH) checker.check_block(S::load(p + i));
+
+    // The tail goes through a block padded with ASCII, which also catches sequences cut off by
+    // the end.
+    if (i < count) {
+        U8 tail[S::WIDTH] = {};
+        memcpy(tail, p + i, count - i);
+        checker.check_block(S::load(tail));
+    }
+
+    return !S::any(S::bit_or(checker.error, checker.incomplete));
+}
+#endif // OK_SIMD_AVX2 || OK_SIMD_SSSE3 || OK_SIMD_NEON
+
+bool is_valid_utf8(StringView text) {
+    const U8* p = (const U8*)text.data;
+
+#if OK_SIMD_AVX2 || OK_SIMD_SSSE3 || OK_SIMD_NEON
+    if (text.count >= _utf8_simd::WIDTH) return _utf8_validate_simd(p, text.count);
+#endif // OK_SIMD_AVX2 || OK_SIMD_SSSE3 || OK_SIMD_NEON
+
+    return _utf8_validate_scalar(p, p + text.count);
+}
+
+// Bit 7 of every byte of the result is set if that byte of `w` is a continuation, 10xxxxxx.
+static inline U64 _utf8_continuation_bits(U64 w) {
+    return w & ~(w << 1) & 0x8080808080808080ull;
+}
+
+// The same for the leads of 4 byte sequences, 11110xxx in valid UTF-8.
+static inline U64 _utf8_four_byte_lead_bits(U64 w) {
+    return w & (w << 1) & (w << 2) & (w << 3) & 0x8080808080808080ull;
+}
+
+// Adds up the flags a byte at a time, and only across the bytes every 255 words, before any
+// byte can overflow. Much cheaper than a `popcount` per word where that's not an instruction.
+template <typename F>
+static inline UZ _utf8_count_flags(const U8* p, UZ words, F flags) {
+    UZ result = 0;
+
+    while (words > 0) {
+        UZ chunk = min(words, (UZ)255);
+        U64 sums = 0;
+        for (UZ i = 0; i < chunk; i++) sums += flags(_load_u64(p + i * 8)) >> 7;
+
+        sums = (sums & 0x00ff00ff00ff00ffull) + ((sums >> 8) & 0x00ff00ff00ff00ffull);
+        result += (UZ)((sums * 0x0001000100010001ull) >> 48);
+
+        p += chunk * 8;
+        words -= chunk;
+    }
+
+    return result;
+}
+
+UZ utf8_count_codepoints(StringView text) {
+    const U8* p = (const U8*)text.data;
+    UZ words = text.count / 8;
+    UZ continuations = _utf8_count_flags(p, words, _utf8_continuation_bits);
+
+    for (UZ i = words * 8; i < text.count; i++) continuations += (p[i] & 0xc0) == 0x80;
+
+    return text.count - continuations;
+}
+
+UZ utf8_to_utf16_length(Utf8View text) {
+    const U8* p = (const U8*)text.view.data;
+    UZ count = text.view.count;
+    UZ words = count / 8;
+    UZ continuations = _utf8_count_flags(p, words, _utf8_continuation_bits);
+    UZ surrogate_pairs = _utf8_count_flags(p, words, _utf8_four_byte_lead_bits);
+
+    for (UZ i = words * 8; i < count; i++) {
+        continuations += (p[i] & 0xc0) == 0x80;
+        surrogate_pairs += p[i] >= 0xf0;
+    }
+
+    return count - continuations + surrogate_pairs;
+}
+
+UZ utf8_to_utf16(Utf8View text, U16* out) {
+    const char* p = text.view.data;
+    const char* end = p + text.view.count;
+    U16* o = out;
+
+    while (p < end) {
+#if OK_SIMD_SSE2
+        if (end - p >= 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)p);
+            if (_mm_movemask_epi8(v) == 0) {
+                _mm_storeu_si128((__m128i*)o, _mm_unpacklo_epi8(v, _mm_setzero_si128()));
+                _mm_storeu_si128((__m128i*)(o + 8), _mm_unpackhi_epi8(v, _mm_setzero_si128()));
+                p += 16;
+                o += 16;
+                continue;
+            }
+        }
+#elif OK_SIMD_NEON
+        if (end - p >= 16) {
+            uint8x16_t v = vld1q_u8((const uint8_t*)p);
+            if (vmaxvq_u8(v) < 0x80) {
+                vst1q_u16(o, vmovl_u8(vget_low_u8(v)));
+                vst1q_u16(o + 8, vmovl_high_u8(v));
+                p += 16;
+                o += 16;
+                continue;
+            }
+        }
+#endif // OK_SIMD_SSE2
+
+        if (end - p >= 8 && (_load_u64((const U8*)p) & 0x8080808080808080ull) == 0) {
+            for (UZ i = 0; i < 8; i++) o[i] = (U8)p[i];
+            p += 8;
+            o += 8;
+            continue;
+        }
+
+        UZ length;
+        U32 codepoint = utf8_decode(p, &length);
+        p += length;
+
+        if (codepoint < 0x10000) {
+            *o++ = (U16)codepoint;
+        } else {
+            codepoint -= 0x10000;
+            *o++ = (U16)(0xd800 + (codepoint >> 10));
+            *o++ = (U16)(0xdc00 + (codepoint & 0x3ff));
+        }
+    }
+
+    return (UZ)(o - out);
+}
+
+List<U16> utf8_to_utf16(Allocator* a, Utf8View text) {
+    List<U16> result = List<U16>::alloc(a, utf8_to_utf16_length(text));
+    result.count = utf8_to_utf16(text, result.items);
+    return result;
+}
+
+static constexpr U32 UTF16_REPLACEMENT_CHARACTER = 0xfffd;
+
+// Decodes the codepoint at `units[*i]` and moves `i` past it.
+static inline U32 _utf16_decode(const U16* units, UZ count, UZ* i) {
+    U32 unit = units[(*i)++];
+    if (unit < 0xd800 || unit > 0xdfff) return unit;
+
+    if (unit < 0xdc00 && *i < count && units[*i] >= 0xdc00 && units[*i] <= 0xdfff) {
+        U32 low = units[(*i)++];
+        return 0x10000 + ((unit - 0xd800) << 10) + (low - 0xdc00);
+    }
+
+    return UTF16_REPLACEMENT_CHARACTER;
+}
+
+// Four code units that are all ASCII, read as one word.
+static inline bool _utf16_is_ascii4(const U16* units) {
+    U64 w;
+    memcpy(&w, units, sizeof(w));
+    return (w & 0xff80ff80ff80ff80ull) == 0;
+}
+
+bool is_valid_utf16(const U16* units, UZ count) {
+    for (UZ i = 0; i < count; i++) {
+        U16 unit = units[i];
+        if (unit < 0xd800 || unit > 0xdfff) continue;
+        if (unit >= 0xdc00 || i + 1 == count) return false;
+        if (units[i + 1] < 0xdc00 || units[i + 1] > 0xdfff) return false;
+        i++;
+    }
+
+    return true;
+}
+
+UZ utf16_to_utf8_length(const U16* units, UZ count) {
+    UZ result = 0;
+
+    UZ i = 0;
+    while (i < count) {
+        if (i + 4 <= count && _utf16_is_ascii4(units + i)) {
+            result += 4;
+            i += 4;
+            continue;
+        }
+
+        U32 codepoint = _utf16_decode(units, count, &i);
+        result += codepoint < 0x80 ? 1 : codepoint < 0x800 ? 2 : codepoint < 0x10000 ? 3 : 4;
+    }
+
+    return result;
+}
+
+UZ utf16_to_utf8(const U16* units, UZ count, char* out) {
+    char* o = out;
+
+    UZ i = 0;
+    while (i < count) {
+        if (i + 4 <= count && _utf16_is_ascii4(units + i)) {
+            for (UZ j = 0; j < 4; j++) o[j] = (char)units[i + j];
+            o += 4;
+            i += 4;
+            continue;
+        }
+
+        o += utf8_encode(_utf16_decode(units, count, &i), o);
+    }
+
+    return (UZ)(o - out);
+}
+
+String utf16_to_utf8(Allocator* a, const U16* units, UZ count) {
+    UZ length = utf16_to_utf8_length(units, count);
+    String result = String::alloc(a, length);
+    result.set_count(utf16_to_utf8(units, count, result.get_items()));
+    return result;
+}
+
+// INTEGER TO TEXT IMPLEMENTATION
+static constexpr char decimal_digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static constexpr U64 powers_of_ten[] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+U32 count_decimal_digits(U64 value) {
+    // 1233 / 4096 is a hair over log10(2), so this guesses the digit count from the bit
+    // count and is off by at most one, which the table lookup fixes. Setting the low bit
+    // only changes the count for zero, which has one digit too.
+    value |= 1;
+    U32 bits = 64 - count_leading_zeros(value);
+    U32 guess = (bits * 1233) >> 12;
+    return guess + 1 - (value < powers_of_ten[guess]);
+}
+
+U32 count_digits_in_base(U64 value, U32 base) {
+    OK_ASSERT(base >= 2 && base <= 36);
+
+    if ((base & (base - 1)) == 0) {
+        U32 bits = 64 - count_leading_zeros(value | 1);
+        U32 bits_per_digit = count_trailing_zeros(base);
+        return (bits + bits_per_digit - 1) / bits_per_digit;
+    }
+
+    U32 count = 1;
+    while (value >= base) {
+        value /= base;
+        count++;
+    }
+    return count;
+}
+
+UZ format_uint(char* buf, U64 value) {
+    U32 count = count_decimal_digits(value);
+    char* p = buf + count;
+
+    // Two digits per division, back to front.
+    while (value >= 100) {
+        UZ pair = (value % 100) * 2;
+        value /= 100;
+        p -= 2;
+        p[0] = decimal_digit_pairs[pair];
+        p[1] = decimal_digit_pairs[pair + 1];
+    }
+
+    if (value >= 10) {
+        p[-2] = decimal_digit_pairs[value * 2];
+        p[-1] = decimal_digit_pairs[value * 2 + 1];
+    } else {
+        p[-1] = (char)('0' + value);
+    }
+
+    return count;
+}
+
+UZ format_uint_hex(char* buf, U64 value, bool uppercase) {
+    const char* digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+
+    U32 count = count_digits_in_base(value, 16);
+    for (U32 i = count; i > 0; i--) {
+        buf[i - 1] = digits[value & 0xf];
+        value >>= 4;
+    }
+
+    return count;
+}
+
+UZ format_uint_base(char* buf, U64 value, U32 base, bool uppercase) {
+    if (base == 10) return format_uint(buf, value);
+    if (base == 16) return format_uint_hex(buf, value, uppercase);
+
+    const char* digits = uppercase ? "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ" : "0123456789abcdefghijklmnopqrstuvwxyz";
+
+    U32 count = count_digits_in_base(value, base);
+    if ((base & (base - 1)) == 0) {
+        U32 shift = count_trailing_zeros(base);
+        for (U32 i = count; i > 0; i--) {
+            buf[i - 1] = digits[value & (base - 1)];
+            value >>= shift;
+        }
+    } else {
+        for (U32 i = count; i > 0; i--) {
+            buf[i - 1] = digits[value % base];
+            value /= base;
+        }
+    }
+
+    return count;
+}
+
+// FLOAT CONVERSION IMPLEMENTATION
+// 10^k for k in [POW10_TABLE_MIN, POW10_TABLE_MAX], scaled by a power of two into
+// [2^127, 2^128) and rounded down, as {high, low} halves. Only 10^0 to 10^55 fit exactly.
+static constexpr S32 POW10_TABLE_MIN = -342;
+static constexpr S32 POW10_TABLE_MAX = 326;
+static constexpr S32 POW10_TABLE_LAST_EXACT = 55;
+
+static constexpr U64 pow10_table[][2] = {
+    {0xeef453d6923bd65aull, 0x113faa2906a13b3full},
+    {0x9558b4661b6565f8ull, 0x4ac7ca59a424c507ull},
+    {0xbaaee17fa23ebf76ull, 0x5d79bcf00d2df649ull},
+    {0xe95a99df8ace6f53ull, 0xf4d82c2c107973dcull},
+    {0x91d8a02bb6c10594ull, 0x79071b9b8a4be869ull},
+    {0xb64ec836a47146f9ull, 0x9748e2826cdee284ull},
+    {0xe3e27a444d8d98b7ull, 0xfd1b1b2308169b25ull},
+    {0x8e6d8c6ab0787f72ull, 0xfe30f0f5e50e20f7ull},
+    {0xb208ef855c969f4full, 0xbdbd2d335e51a935ull},
+    {0xde8b2b66b3bc4723ull, 0xad2c788035e61382ull},
+    {0x8b16fb203055ac76ull, 0x4c3bcb5021afcc31ull},
+    {0xaddcb9e83c6b1793ull, 0xdf4abe242a1bbf3dull},
+    {0xd953e8624b85dd78ull, 0xd71d6dad34a2af0dull},
+    {0x87d4713d6f33aa6bull, 0x8672648c40e5ad68ull},
+    {0xa9c98d8ccb009506ull, 0x680efdaf511f18c2ull},
+    {0xd43bf0effdc0ba48ull, 0x0212bd1b2566def2ull},
+    {0x84a57695fe98746dull, 0x014bb630f7604b57ull},
+    {0xa5ced43b7e3e9188ull, 0x419ea3bd35385e2dull},
+    {0xcf42894a5dce35eaull, 0x52064cac828675b9ull},
+    {0x818995ce7aa0e1b2ull, 0x7343efebd1940993ull},
+    {0xa1ebfb4219491a1full, 0x1014ebe6c5f90bf8ull},
+    {0xca66fa129f9b60a6ull, 0xd41a26e077774ef6ull},
+    {0xfd00b897478238d0ull, 0x8920b098955522b4ull},
+    {0x9e20735e8cb16382ull, 0x55b46e5f5d5535b0ull},
+    {0xc5a890362fddbc62ull, 0xeb2189f734aa831dull},
+    {0xf712b443bbd52b7bull, 0xa5e9ec7501d523e4ull},
+    {0x9a6bb0aa55653b2dull, 0x47b233c92125366eull},
+    {0xc1069cd4eabe89f8ull, 0x999ec0bb696e840aull},
+    {0xf148440a256e2c76ull, 0xc00670ea43ca250dull},
+    {0x96cd2a865764dbcaull, 0x380406926a5e5728ull},
+    {0xbc807527ed3e12bcull, 0xc605083704f5ecf2ull},
+    {0xeba09271e88d976bull, 0xf7864a44c633682eull},
+    {0x93445b8731587ea3ull, 0x7ab3ee6afbe0211dull},
+    {0xb8157268fdae9e4cull, 0x5960ea05bad82964ull},
+    {0xe61acf033d1a45dfull, 0x6fb92487298e33bdull},
+    {0x8fd0c16206306babull, 0xa5d3b6d479f8e056ull},
+    {0xb3c4f1ba87bc8696ull, 0x8f48a4899877186cull},
+    {0xe0b62e2929aba83cull, 0x331acdabfe94de87ull},
+    {0x8c71dcd9ba0b4925ull, 0x9ff0c08b7f1d0b14ull},
+    {0xaf8e5410288e1b6full, 0x07ecf0ae5ee44dd9ull},
+    {0xdb71e91432b1a24aull, 0xc9e82cd9f69d6150ull},
+    {0x892731ac9faf056eull, 0xbe311c083a225cd2ull},
+    {0xab70fe17c79ac6caull, 0x6dbd630a48aaf406ull},
+    {0xd64d3d9db981787dull, 0x092cbbccdad5b108ull},
+    {0x85f0468293f0eb4eull, 0x25bbf56008c58ea5ull},
+    {0xa76c582338ed2621ull, 0xaf2af2b80af6f24eull},
+    {0xd1476e2c07286faaull, 0x1af5af660db4aee1ull},
+    {0x82cca4db847945caull, 0x50d98d9fc890ed4dull},
+    {0xa37fce126597973cull, 0xe50ff107bab528a0ull},
+    {0xcc5fc196fefd7d0cull, 0x1e53ed49a96272c8ull},
+    {0xff77b1fcbebcdc4full, 0x25e8e89c13bb0f7aull},
+    {0x9faacf3df73609b1ull, 0x77b191618c54e9acull},
+    {0xc795830d75038c1dull, 0xd59df5b9ef6a2417ull},
+    {0xf97ae3d0d2446f25ull, 0x4b0573286b44ad1dull},
+    {0x9becce62836ac577ull, 0x4ee367f9430aec32ull},
+    {0xc2e801fb244576d5ull, 0x229c41f793cda73full},
+    {0xf3a20279ed56d48aull, 0x6b43527578c1110full},
+    {0x9845418c345644d6ull, 0x830a13896b78aaa9ull},
+    {0xbe5691ef416bd60cull, 0x23cc986bc656d553ull},
+    {0xedec366b11c6cb8full, 0x2cbfbe86b7ec8aa8ull},
+    {0x94b3a202eb1c3f39ull, 0x7bf7d71432f3d6a9ull},
+    {0xb9e08a83a5e34f07ull, 0xdaf5ccd93fb0cc53ull},
+    {0xe858ad248f5c22c9ull, 0xd1b3400f8f9cff68ull},
+    {0x91376c36d99995beull, 0x23100809b9c21fa1ull},
+    {0xb58547448ffffb2dull, 0xabd40a0c2832a78aull},
+    {0xe2e69915b3fff9f9ull, 0x16c90c8f323f516cull},
+    {0x8dd01fad907ffc3bull, 0xae3da7d97f6792e3ull},
+    {0xb1442798f49ffb4aull, 0x99cd11cfdf41779cull},
+    {0xdd95317f31c7fa1dull, 0x40405643d711d583ull},
+    {0x8a7d3eef7f1cfc52ull, 0x482835ea666b2572ull},
+    {0xad1c8eab5ee43b66ull, 0xda3243650005eecfull},
+    {0xd863b256369d4a40ull, 0x90bed43e40076a82ull},
+    {0x873e4f75e2224e68ull, 0x5a7744a6e804a291ull},
+    {0xa90de3535aaae202ull, 0x711515d0a205cb36ull},
+    {0xd3515c2831559a83ull, 0x0d5a5b44ca873e03ull},
+    {0x8412d9991ed58091ull, 0xe858790afe9486c2ull},
+    {0xa5178fff668ae0b6ull, 0x626e974dbe39a872ull},
+    {0xce5d73ff402d98e3ull, 0xfb0a3d212dc8128full},
+    {0x80fa687f881c7f8eull, 0x7ce66634bc9d0b99ull},
+    {0xa139029f6a239f72ull, 0x1c1fffc1ebc44e80ull},
+    {0xc987434744ac874eull, 0xa327ffb266b56220ull},
+    {0xfbe9141915d7a922ull, 0x4bf1ff9f0062baa8ull},
+    {0x9d71ac8fada6c9b5ull, 0x6f773fc3603db4a9ull},
+    {0xc4ce17b399107c22ull, 0xcb550fb4384d21d3ull},
+    {0xf6019da07f549b2bull, 0x7e2a53a146606a48ull},
+    {0x99c102844f94e0fbull, 0x2eda7444cbfc426dull},
+    {0xc0314325637a1939ull, 0xfa911155fefb5308ull},
+    {0xf03d93eebc589f88ull, 0x793555ab7eba27caull},
+    {0x96267c7535b763b5ull, 0x4bc1558b2f3458deull},
+    {0xbbb01b9283253ca2ull, 0x9eb1aaedfb016f16ull},
+    {0xea9c227723ee8bcbull, 0x465e15a979c1cadcull},
+    {0x92a1958a7675175full, 0x0bfacd89ec191ec9ull},
+    {0xb749faed14125d36ull, 0xcef980ec671f667bull},
+    {0xe51c79a85916f484ull, 0x82b7e12780e7401aull},
+    {0x8f31cc0937ae58d2ull, 0xd1b2ecb8b0908810ull},
+    {0xb2fe3f0b8599ef07ull, 0x861fa7e6dcb4aa15ull},
+    {0xdfbdcece67006ac9ull, 0x67a791e093e1d49aull},
+    {0x8bd6a141006042bdull, 0xe0c8bb2c5c6d24e0ull},
+    {0xaecc49914078536dull, 0x58fae9f773886e18ull},
+    {0xda7f5bf590966848ull, 0xaf39a475506a899eull},
+    {0x888f99797a5e012dull, 0x6d8406c952429603ull},
+    {0xaab37fd7d8f58178ull, 0xc8e5087ba6d33b83ull},
+    {0xd5605fcdcf32e1d6ull, 0xfb1e4a9a90880a64ull},
+    {0x855c3be0a17fcd26ull, 0x5cf2eea09a55067full},
+    {0xa6b34ad8c9dfc06full, 0xf42faa48c0ea481eull},
+    {0xd0601d8efc57b08bull, 0xf13b94daf124da26ull},
+    {0x823c12795db6ce57ull, 0x76c53d08d6b70858ull},
+    {0xa2cb1717b52481edull, 0x54768c4b0c64ca6eull},
+    {0xcb7ddcdda26da268ull, 0xa9942f5dcf7dfd09ull},
+    {0xfe5d54150b090b02ull, 0xd3f93b35435d7c4cull},
+    {0x9efa548d26e5a6e1ull, 0xc47bc5014a1a6dafull},
+    {0xc6b8e9b0709f109aull, 0x359ab6419ca1091bull},
+    {0xf867241c8cc6d4c0ull, 0xc30163d203c94b62ull},
+    {0x9b407691d7fc44f8ull, 0x79e0de63425dcf1dull},
+    {0xc21094364dfb5636ull, 0x985915fc12f542e4ull},
+    {0xf294b943e17a2bc4ull, 0x3e6f5b7b17b2939dull},
+    {0x979cf3ca6cec5b5aull, 0xa705992ceecf9c42ull},
+    {0xbd8430bd08277231ull, 0x50c6ff782a838353ull},
+    {0xece53cec4a314ebdull, 0xa4f8bf5635246428ull},
+    {0x940f4613ae5ed136ull, 0x871b7795e136be99ull},
+    {0xb913179899f68584ull, 0x28e2557b59846e3full},
+    {0xe757dd7ec07426e5ull, 0x331aeada2fe589cfull},
+    {0x9096ea6f3848984full, 0x3ff0d2c85def7621ull},
+    {0xb4bca50b065abe63ull, 0x0fed077a756b53a9ull},
+    {0xe1ebce4dc7f16dfbull, 0xd3e8495912c62894ull},
+    {0x8d3360f09cf6e4bdull, 0x64712dd7abbbd95cull},
+    {0xb080392cc4349decull, 0xbd8d794d96aacfb3ull},
+    {0xdca04777f541c567ull, 0xecf0d7a0fc5583a0ull},
+    {0x89e42caaf9491b60ull, 0xf41686c49db57244ull},
+    {0xac5d37d5b79b6239ull, 0x311c2875c522ced5ull},
+    {0xd77485cb25823ac7ull, 0x7d633293366b828bull},
+    {0x86a8d39ef77164bcull, 0xae5dff9c02033197ull},
+    {0xa8530886b54dbdebull, 0xd9f57f830283fdfcull},
+    {0xd267caa862a12d66ull, 0xd072df63c324fd7bull},
+    {0x8380dea93da4bc60ull, 0x4247cb9e59f71e6dull},
+    {0xa46116538d0deb78ull, 0x52d9be85f074e608ull},
+    {0xcd795be870516656ull, 0x67902e276c921f8bull},
+    {0x806bd9714632dff6ull, 0x00ba1cd8a3db53b6ull},
+    {0xa086cfcd97bf97f3ull, 0x80e8a40eccd228a4ull},
+    {0xc8a883c0fdaf7df0ull, 0x6122cd128006b2cdull},
+    {0xfad2a4b13d1b5d6cull, 0x796b805720085f81ull},
+    {0x9cc3a6eec6311a63ull, 0xcbe3303674053bb0ull},
+    {0xc3f490aa77bd60fcull, 0xbedbfc4411068a9cull},
+    {0xf4f1b4d515acb93bull, 0xee92fb5515482d44ull},
+    {0x991711052d8bf3c5ull, 0x751bdd152d4d1c4aull},
+    {0xbf5cd54678eef0b6ull, 0xd262d45a78a0635dull},
+    {0xef340a98172aace4ull, 0x86fb897116c87c34ull},
+    {0x9580869f0e7aac0eull, 0xd45d35e6ae3d4da0ull},
+    {0xbae0a846d2195712ull, 0x8974836059cca109ull},
+    {0xe998d258869facd7ull, 0x2bd1a438703fc94bull},
+    {0x91ff83775423cc06ull, 0x7b6306a34627ddcfull},
+    {0xb67f6455292cbf08ull, 0x1a3bc84c17b1d542ull},
+    {0xe41f3d6a7377eecaull, 0x20caba5f1d9e4a93ull},
+    {0x8e938662882af53eull, 0x547eb47b7282ee9cull},
+    {0xb23867fb2a35b28dull, 0xe99e619a4f23aa43ull},
+    {0xdec681f9f4c31f31ull, 0x6405fa00e2ec94d4ull},
+    {0x8b3c113c38f9f37eull, 0xde83bc408dd3dd04ull},
+    {0xae0b158b4738705eull, 0x9624ab50b148d445ull},
+    {0xd98ddaee19068c76ull, 0x3badd624dd9b0957ull},
+    {0x87f8a8d4cfa417c9ull, 0xe54ca5d70a80e5d6ull},
+    {0xa9f6d30a038d1dbcull, 0x5e9fcf4ccd211f4cull},
+    {0xd47487cc8470652bull, 0x7647c3200069671full},
+    {0x84c8d4dfd2c63f3bull, 0x29ecd9f40041e073ull},
+    {0xa5fb0a17c777cf09ull, 0xf468107100525890ull},
+    {0xcf79cc9db955c2ccull, 0x7182148d4066eeb4ull},
+    {0x81ac1fe293d599bfull, 0xc6f14cd848405530ull},
+    {0xa21727db38cb002full, 0xb8ada00e5a506a7cull},
+    {0xca9cf1d206fdc03bull, 0xa6d90811f0e4851cull},
+    {0xfd442e4688bd304aull, 0x908f4a166d1da663ull},
+    {0x9e4a9cec15763e2eull, 0x9a598e4e043287feull},
+    {0xc5dd44271ad3cdbaull, 0x40eff1e1853f29fdull},
+    {0xf7549530e188c128ull, 0xd12bee59e68ef47cull},
+    {0x9a94dd3e8cf578b9ull, 0x82bb74f8301958ceull},
+    {0xc13a148e3032d6e7ull, 0xe36a52363c1faf01ull},
+    {0xf18899b1bc3f8ca1ull, 0xdc44e6c3cb279ac1ull},
+    {0x96f5600f15a7b7e5ull, 0x29ab103a5ef8c0b9ull},
+    {0xbcb2b812db11a5deull, 0x7415d448f6b6f0e7ull},
+    {0xebdf661791d60f56ull, 0x111b495b3464ad21ull},
+    {0x936b9fcebb25c995ull, 0xcab10dd900beec34ull},
+    {0xb84687c269ef3bfbull, 0x3d5d514f40eea742ull},
+    {0xe65829b3046b0afaull, 0x0cb4a5a3112a5112ull},
+    {0x8ff71a0fe2c2e6dcull, 0x47f0e785eaba72abull},
+    {0xb3f4e093db73a093ull, 0x59ed216765690f56ull},
+    {0xe0f218b8d25088b8ull, 0x306869c13ec3532cull},
+    {0x8c974f7383725573ull, 0x1e414218c73a13fbull},
+    {0xafbd2350644eeacfull, 0xe5d1929ef90898faull},
+    {0xdbac6c247d62a583ull, 0xdf45f746b74abf39ull},
+    {0x894bc396ce5da772ull, 0x6b8bba8c328eb783ull},
+    {0xab9eb47c81f5114full, 0x066ea92f3f326564ull},
+    {0xd686619ba27255a2ull, 0xc80a537b0efefebdull},
+    {0x8613fd0145877585ull, 0xbd06742ce95f5f36ull},
+    {0xa798fc4196e952e7ull, 0x2c48113823b73704ull},
+    {0xd17f3b51fca3a7a0ull, 0xf75a15862ca504c5ull},
+    {0x82ef85133de648c4ull, 0x9a984d73dbe722fbull},
+    {0xa3ab66580d5fdaf5ull, 0xc13e60d0d2e0ebbaull},
+    {0xcc963fee10b7d1b3ull, 0x318df905079926a8ull},
+    {0xffbbcfe994e5c61full, 0xfdf17746497f7052ull},
+    {0x9fd561f1fd0f9bd3ull, 0xfeb6ea8bedefa633ull},
+    {0xc7caba6e7c5382c8ull, 0xfe64a52ee96b8fc0ull},
+    {0xf9bd690a1b68637bull, 0x3dfdce7aa3c673b0ull},
+    {0x9c1661a651213e2dull, 0x06bea10ca65c084eull},
+    {0xc31bfa0fe5698db8ull, 0x486e494fcff30a62ull},
+    {0xf3e2f893dec3f126ull, 0x5a89dba3c3efccfaull},
+    {0x986ddb5c6b3a76b7ull, 0xf89629465a75e01cull},
+    {0xbe89523386091465ull, 0xf6bbb397f1135823ull},
+    {0xee2ba6c0678b597full, 0x746aa07ded582e2cull},
+    {0x94db483840b717efull, 0xa8c2a44eb4571cdcull},
+    {0xba121a4650e4ddebull, 0x92f34d62616ce413ull},
+    {0xe896a0d7e51e1566ull, 0x77b020baf9c81d17ull},
+    {0x915e2486ef32cd60ull, 0x0ace1474dc1d122eull},
+    {0xb5b5ada8aaff80b8ull, 0x0d819992132456baull},
+    {0xe3231912d5bf60e6ull, 0x10e1fff697ed6c69ull},
+    {0x8df5efabc5979c8full, 0xca8d3ffa1ef463c1ull},
+    {0xb1736b96b6fd83b3ull, 0xbd308ff8a6b17cb2ull},
+    {0xddd0467c64bce4a0ull, 0xac7cb3f6d05ddbdeull},
+    {0x8aa22c0dbef60ee4ull, 0x6bcdf07a423aa96bull},
+    {0xad4ab7112eb3929dull, 0x86c16c98d2c953c6ull},
+    {0xd89d64d57a607744ull, 0xe871c7bf077ba8b7ull},
+    {0x87625f056c7c4a8bull, 0x11471cd764ad4972ull},
+    {0xa93af6c6c79b5d2dull, 0xd598e40d3dd89bcfull},
+    {0xd389b47879823479ull, 0x4aff1d108d4ec2c3ull},
+    {0x843610cb4bf160cbull, 0xcedf722a585139baull},
+    {0xa54394fe1eedb8feull, 0xc2974eb4ee658828ull},
+    {0xce947a3da6a9273eull, 0x733d226229feea32ull},
+    {0x811ccc668829b887ull, 0x0806357d5a3f525full},
+    {0xa163ff802a3426a8ull, 0xca07c2dcb0cf26f7ull},
+    {0xc9bcff6034c13052ull, 0xfc89b393dd02f0b5ull},
+    {0xfc2c3f3841f17c67ull, 0xbbac2078d443ace2ull},
+    {0x9d9ba7832936edc0ull, 0xd54b944b84aa4c0dull},
+    {0xc5029163f384a931ull, 0x0a9e795e65d4df11ull},
+    {0xf64335bcf065d37dull, 0x4d4617b5ff4a16d5ull},
+    {0x99ea0196163fa42eull, 0x504bced1bf8e4e45ull},
+    {0xc06481fb9bcf8d39ull, 0xe45ec2862f71e1d6ull},
+    {0xf07da27a82c37088ull, 0x5d767327bb4e5a4cull},
+    {0x964e858c91ba2655ull, 0x3a6a07f8d510f86full},
+    {0xbbe226efb628afeaull, 0x890489f70a55368bull},
+    {0xeadab0aba3b2dbe5ull, 0x2b45ac74ccea842eull},
+    {0x92c8ae6b464fc96full, 0x3b0b8bc90012929dull},
+    {0xb77ada0617e3bbcbull, 0x09ce6ebb40173744ull},
+    {0xe55990879ddcaabdull, 0xcc420a6a101d0515ull},
+    {0x8f57fa54c2a9eab6ull, 0x9fa946824a12232dull},
+    {0xb32df8e9f3546564ull, 0x47939822dc96abf9ull},
+    {0xdff9772470297ebdull, 0x59787e2b93bc56f7ull},
+    {0x8bfbea76c619ef36ull, 0x57eb4edb3c55b65aull},
+    {0xaefae51477a06b03ull, 0xede622920b6b23f1ull},
+    {0xdab99e59958885c4ull, 0xe95fab368e45ecedull},
+    {0x88b402f7fd75539bull, 0x11dbcb0218ebb414ull},
+    {0xaae103b5fcd2a881ull, 0xd652bdc29f26a119ull},
+    {0xd59944a37c0752a2ull, 0x4be76d3346f0495full},
+    {0x857fcae62d8493a5ull, 0x6f70a4400c562ddbull},
+    {0xa6dfbd9fb8e5b88eull, 0xcb4ccd500f6bb952ull},
+    {0xd097ad07a71f26b2ull, 0x7e2000a41346a7a7ull},
+    {0x825ecc24c873782full, 0x8ed400668c0c28c8ull},
+    {0xa2f67f2dfa90563bull, 0x728900802f0f32faull},
+    {0xcbb41ef979346bcaull, 0x4f2b40a03ad2ffb9ull},
+    {0xfea126b7d78186bcull, 0xe2f610c84987bfa8ull},
+    {0x9f24b832e6b0f436ull, 0x0dd9ca7d2df4d7c9ull},
+    {0xc6ede63fa05d3143ull, 0x91503d1c79720dbbull},
+    {0xf8a95fcf88747d94ull, 0x75a44c6397ce912aull},
+    {0x9b69dbe1b548ce7cull, 0xc986afbe3ee11abaull},
+    {0xc24452da229b021bull, 0xfbe85badce996168ull},
+    {0xf2d56790ab41c2a2ull, 0xfae27299423fb9c3ull},
+    {0x97c560ba6b0919a5ull, 0xdccd879fc967d41aull},
+    {0xbdb6b8e905cb600full, 0x5400e987bbc1c920ull},
+    {0xed246723473e3813ull, 0x290123e9aab23b68ull},
+    {0x9436c0760c86e30bull, 0xf9a0b6720aaf6521ull},
+    {0xb94470938fa89bceull, 0xf808e40e8d5b3e69ull},
+    {0xe7958cb87392c2c2ull, 0xb60b1d1230b20e04ull},
+    {0x90bd77f3483bb9b9ull, 0xb1c6f22b5e6f48c2ull},
+    {0xb4ecd5f01a4aa828ull, 0x1e38aeb6360b1af3ull},
+    {0xe2280b6c20dd5232ull, 0x25c6da63c38de1b0ull},
+    {0x8d590723948a535full, 0x579c487e5a38ad0eull},
+    {0xb0af48ec79ace837ull, 0x2d835a9df0c6d851ull},
+    {0xdcdb1b2798182244ull, 0xf8e431456cf88e65ull},
+    {0x8a08f0f8bf0f156bull, 0x1b8e9ecb641b58ffull},
+    {0xac8b2d36eed2dac5ull, 0xe272467e3d222f3full},
+    {0xd7adf884aa879177ull, 0x5b0ed81dcc6abb0full},
+    {0x86ccbb52ea94baeaull, 0x98e947129fc2b4e9ull},
+    {0xa87fea27a539e9a5ull, 0x3f2398d747b36224ull},
+    {0xd29fe4b18e88640eull, 0x8eec7f0d19a03aadull},
+    {0x83a3eeeef9153e89ull, 0x1953cf68300424acull},
+    {0xa48ceaaab75a8e2bull, 0x5fa8c3423c052dd7ull},
+    {0xcdb02555653131b6ull, 0x3792f412cb06794dull},
+    {0x808e17555f3ebf11ull, 0xe2bbd88bbee40bd0ull},
+    {0xa0b19d2ab70e6ed6ull, 0x5b6aceaeae9d0ec4ull},
+    {0xc8de047564d20a8bull, 0xf245825a5a445275ull},
+    {0xfb158592be068d2eull, 0xeed6e2f0f0d56712ull},
+    {0x9ced737bb6c4183dull, 0x55464dd69685606bull},
+    {0xc428d05aa4751e4cull, 0xaa97e14c3c26b886ull},
+    {0xf53304714d9265dfull, 0xd53dd99f4b3066a8ull},
+    {0x993fe2c6d07b7fabull, 0xe546a8038efe4029ull},
+    {0xbf8fdb78849a5f96ull, 0xde98520472bdd033ull},
+    {0xef73d256a5c0f77cull, 0x963e66858f6d4440ull},
+    {0x95a8637627989aadull, 0xdde7001379a44aa8ull},
+    {0xbb127c53b17ec159ull, 0x5560c018580d5d52ull},
+    {0xe9d71b689dde71afull, 0xaab8f01e6e10b4a6ull},
+    {0x9226712162ab070dull, 0xcab3961304ca70e8ull},
+    {0xb6b00d69bb55c8d1ull, 0x3d607b97c5fd0d22ull},
+    {0xe45c10c42a2b3b05ull, 0x8cb89a7db77c506aull},
+    {0x8eb98a7a9a5b04e3ull, 0x77f3608e92adb242ull},
+    {0xb267ed1940f1c61cull, 0x55f038b237591ed3ull},
+    {0xdf01e85f912e37a3ull, 0x6b6c46dec52f6688ull},
+    {0x8b61313bbabce2c6ull, 0x2323ac4b3b3da015ull},
+    {0xae397d8aa96c1b77ull, 0xabec975e0a0d081aull},
+    {0xd9c7dced53c72255ull, 0x96e7bd358c904a21ull},
+    {0x881cea14545c7575ull, 0x7e50d64177da2e54ull},
+    {0xaa242499697392d2ull, 0xdde50bd1d5d0b9e9ull},
+    {0xd4ad2dbfc3d07787ull, 0x955e4ec64b44e864ull},
+    {0x84ec3c97da624ab4ull, 0xbd5af13bef0b113eull},
+    {0xa6274bbdd0fadd61ull, 0xecb1ad8aeacdd58eull},
+    {0xcfb11ead453994baull, 0x67de18eda5814af2ull},
+    {0x81ceb32c4b43fcf4ull, 0x80eacf948770ced7ull},
+    {0xa2425ff75e14fc31ull, 0xa1258379a94d028dull},
+    {0xcad2f7f5359a3b3eull, 0x096ee45813a04330ull},
+    {0xfd87b5f28300ca0dull, 0x8bca9d6e188853fcull},
+    {0x9e74d1b791e07e48ull, 0x775ea264cf55347dull},
+    {0xc612062576589ddaull, 0x95364afe032a819dull},
+    {0xf79687aed3eec551ull, 0x3a83ddbd83f52204ull},
+    {0x9abe14cd44753b52ull, 0xc4926a9672793542ull},
+    {0xc16d9a0095928a27ull, 0x75b7053c0f178293ull},
+    {0xf1c90080baf72cb1ull, 0x5324c68b12dd6338ull},
+    {0x971da05074da7beeull, 0xd3f6fc16ebca5e03ull},
+    {0xbce5086492111aeaull, 0x88f4bb1ca6bcf584ull},
+    {0xec1e4a7db69561a5ull, 0x2b31e9e3d06c32e5ull},
+    {0x9392ee8e921d5d07ull, 0x3aff322e62439fcfull},
+    {0xb877aa3236a4b449ull, 0x09befeb9fad487c2ull},
+    {0xe69594bec44de15bull, 0x4c2ebe687989a9b3ull},
+    {0x901d7cf73ab0acd9ull, 0x0f9d37014bf60a10ull},
+    {0xb424dc35095cd80full, 0x538484c19ef38c94ull},
+    {0xe12e13424bb40e13ull, 0x2865a5f206b06fb9ull},
+    {0x8cbccc096f5088cbull, 0xf93f87b7442e45d3ull},
+    {0xafebff0bcb24aafeull, 0xf78f69a51539d748ull},
+    {0xdbe6fecebdedd5beull, 0xb573440e5a884d1bull},
+    {0x89705f4136b4a597ull, 0x31680a88f8953030ull},
+    {0xabcc77118461cefcull, 0xfdc20d2b36ba7c3dull},
+    {0xd6bf94d5e57a42bcull, 0x3d32907604691b4cull},
+    {0x8637bd05af6c69b5ull, 0xa63f9a49c2c1b10full},
+    {0xa7c5ac471b478423ull, 0x0fcf80dc33721d53ull},
+    {0xd1b71758e219652bull, 0xd3c36113404ea4a8ull},
+    {0x83126e978d4fdf3bull, 0x645a1cac083126e9ull},
+    {0xa3d70a3d70a3d70aull, 0x3d70a3d70a3d70a3ull},
+    {0xccccccccccccccccull, 0xccccccccccccccccull},
+    {0x8000000000000000ull, 0x0000000000000000ull},
+    {0xa000000000000000ull, 0x0000000000000000ull},
+    {0xc800000000000000ull, 0x0000000000000000ull},
+    {0xfa00000000000000ull, 0x0000000000000000ull},
+    {0x9c40000000000000ull, 0x0000000000000000ull},
+    {0xc350000000000000ull, 0x0000000000000000ull},
+    {0xf424000000000000ull, 0x0000000000000000ull},
+    {0x9896800000000000ull, 0x0000000000000000ull},
+    {0xbebc200000000000ull, 0x0000000000000000ull},
+    {0xee6b280000000000ull, 0x0000000000000000ull},
+    {0x9502f90000000000ull, 0x0000000000000000ull},
+    {0xba43b74000000000ull, 0x0000000000000000ull},
+    {0xe8d4a51000000000ull, 0x0000000000000000ull},
+    {0x9184e72a00000000ull, 0x0000000000000000ull},
+    {0xb5e620f480000000ull, 0x0000000000000000ull},
+    {0xe35fa931a0000000ull, 0x0000000000000000ull},
+    {0x8e1bc9bf04000000ull, 0x0000000000000000ull},
+    {0xb1a2bc2ec5000000ull, 0x0000000000000000ull},
+    {0xde0b6b3a76400000ull, 0x0000000000000000ull},
+    {0x8ac7230489e80000ull, 0x0000000000000000ull},
+    {0xad78ebc5ac620000ull, 0x0000000000000000ull},
+    {0xd8d726b7177a8000ull, 0x0000000000000000ull},
+    {0x878678326eac9000ull, 0x0000000000000000ull},
+    {0xa968163f0a57b400ull, 0x0000000000000000ull},
+    {0xd3c21bcecceda100ull, 0x0000000000000000ull},
+    {0x84595161401484a0ull, 0x0000000000000000ull},
+    {0xa56fa5b99019a5c8ull, 0x0000000000000000ull},
+    {0xcecb8f27f4200f3aull, 0x0000000000000000ull},
+    {0x813f3978f8940984ull, 0x4000000000000000ull},
+    {0xa18f07d736b90be5ull, 0x5000000000000000ull},
+    {0xc9f2c9cd04674edeull, 0xa400000000000000ull},
+    {0xfc6f7c4045812296ull, 0x4d00000000000000ull},
+    {0x9dc5ada82b70b59dull, 0xf020000000000000ull},
+    {0xc5371912364ce305ull, 0x6c28000000000000ull},
+    {0xf684df56c3e01bc6ull, 0xc732000000000000ull},
+    {0x9a130b963a6c115cull, 0x3c7f400000000000ull},
+    {0xc097ce7bc90715b3ull, 0x4b9f100000000000ull},
+    {0xf0bdc21abb48db20ull, 0x1e86d40000000000ull},
+    {0x96769950b50d88f4ull, 0x1314448000000000ull},
+    {0xbc143fa4e250eb31ull, 0x17d955a000000000ull},
+    {0xeb194f8e1ae525fdull, 0x5dcfab0800000000ull},
+    {0x92efd1b8d0cf37beull, 0x5aa1cae500000000ull},
+    {0xb7abc627050305adull, 0xf14a3d9e40000000ull},
+    {0xe596b7b0c643c719ull, 0x6d9ccd05d0000000ull},
+    {0x8f7e32ce7bea5c6full, 0xe4820023a2000000ull},
+    {0xb35dbf821ae4f38bull, 0xdda2802c8a800000ull},
+    {0xe0352f62a19e306eull, 0xd50b2037ad200000ull},
+    {0x8c213d9da502de45ull, 0x4526f422cc340000ull},
+    {0xaf298d050e4395d6ull, 0x9670b12b7f410000ull},
+    {0xdaf3f04651d47b4cull, 0x3c0cdd765f114000ull},
+    {0x88d8762bf324cd0full, 0xa5880a69fb6ac800ull},
+    {0xab0e93b6efee0053ull, 0x8eea0d047a457a00ull},
+    {0xd5d238a4abe98068ull, 0x72a4904598d6d880ull},
+    {0x85a36366eb71f041ull, 0x47a6da2b7f864750ull},
+    {0xa70c3c40a64e6c51ull, 0x999090b65f67d924ull},
+    {0xd0cf4b50cfe20765ull, 0xfff4b4e3f741cf6dull},
+    {0x82818f1281ed449full, 0xbff8f10e7a8921a4ull},
+    {0xa321f2d7226895c7ull, 0xaff72d52192b6a0dull},
+    {0xcbea6f8ceb02bb39ull, 0x9bf4f8a69f764490ull},
+    {0xfee50b7025c36a08ull, 0x02f236d04753d5b4ull},
+    {0x9f4f2726179a2245ull, 0x01d762422c946590ull},
+    {0xc722f0ef9d80aad6ull, 0x424d3ad2b7b97ef5ull},
+    {0xf8ebad2b84e0d58bull, 0xd2e0898765a7deb2ull},
+    {0x9b934c3b330c8577ull, 0x63cc55f49f88eb2full},
+    {0xc2781f49ffcfa6d5ull, 0x3cbf6b71c76b25fbull},
+    {0xf316271c7fc3908aull, 0x8bef464e3945ef7aull},
+    {0x97edd871cfda3a56ull, 0x97758bf0e3cbb5acull},
+    {0xbde94e8e43d0c8ecull, 0x3d52eeed1cbea317ull},
+    {0xed63a231d4c4fb27ull, 0x4ca7aaa863ee4bddull},
+    {0x945e455f24fb1cf8ull, 0x8fe8caa93e74ef6aull},
+    {0xb975d6b6ee39e436ull, 0xb3e2fd538e122b44ull},
+    {0xe7d34c64a9c85d44ull, 0x60dbbca87196b616ull},
+    {0x90e40fbeea1d3a4aull, 0xbc8955e946fe31cdull},
+    {0xb51d13aea4a488ddull, 0x6babab6398bdbe41ull},
+    {0xe264589a4dcdab14ull, 0xc696963c7eed2dd1ull},
+    {0x8d7eb76070a08aecull, 0xfc1e1de5cf543ca2ull},
+    {0xb0de65388cc8ada8ull, 0x3b25a55f43294bcbull},
+    {0xdd15fe86affad912ull, 0x49ef0eb713f39ebeull},
+    {0x8a2dbf142dfcc7abull, 0x6e3569326c784337ull},
+    {0xacb92ed9397bf996ull, 0x49c2c37f07965404ull},
+    {0xd7e77a8f87daf7fbull, 0xdc33745ec97be906ull},
+    {0x86f0ac99b4e8dafdull, 0x69a028bb3ded71a3ull},
+    {0xa8acd7c0222311bcull, 0xc40832ea0d68ce0cull},
+    {0xd2d80db02aabd62bull, 0xf50a3fa490c30190ull},
+    {0x83c7088e1aab65dbull, 0x792667c6da79e0faull},
+    {0xa4b8cab1a1563f52ull, 0x577001b891185938ull},
+    {0xcde6fd5e09abcf26ull, 0xed4c0226b55e6f86ull},
+    {0x80b05e5ac60b6178ull, 0x544f8158315b05b4ull},
+    {0xa0dc75f1778e39d6ull, 0x696361ae3db1c721ull},
+    {0xc913936dd571c84cull, 0x03bc3a19cd1e38e9ull},
+    {0xfb5878494ace3a5full, 0x04ab48a04065c723ull},
+    {0x9d174b2dcec0e47bull, 0x62eb0d64283f9c76ull},
+    {0xc45d1df942711d9aull, 0x3ba5d0bd324f8394ull},
+    {0xf5746577930d6500ull, 0xca8f44ec7ee36479ull},
+    {0x9968bf6abbe85f20ull, 0x7e998b13cf4e1ecbull},
+    {0xbfc2ef456ae276e8ull, 0x9e3fedd8c321a67eull},
+    {0xefb3ab16c59b14a2ull, 0xc5cfe94ef3ea101eull},
+    {0x95d04aee3b80ece5ull, 0xbba1f1d158724a12ull},
+    {0xbb445da9ca61281full, 0x2a8a6e45ae8edc97ull},
+    {0xea1575143cf97226ull, 0xf52d09d71a3293bdull},
+    {0x924d692ca61be758ull, 0x593c2626705f9c56ull},
+    {0xb6e0c377cfa2e12eull, 0x6f8b2fb00c77836cull},
+    {0xe498f455c38b997aull, 0x0b6dfb9c0f956447ull},
+    {0x8edf98b59a373fecull, 0x4724bd4189bd5eacull},
+    {0xb2977ee300c50fe7ull, 0x58edec91ec2cb657ull},
+    {0xdf3d5e9bc0f653e1ull, 0x2f2967b66737e3edull},
+    {0x8b865b215899f46cull, 0xbd79e0d20082ee74ull},
+    {0xae67f1e9aec07187ull, 0xecd8590680a3aa11ull},
+    {0xda01ee641a708de9ull, 0xe80e6f4820cc9495ull},
+    {0x884134fe908658b2ull, 0x3109058d147fdcddull},
+    {0xaa51823e34a7eedeull, 0xbd4b46f0599fd415ull},
+    {0xd4e5e2cdc1d1ea96ull, 0x6c9e18ac7007c91aull},
+    {0x850fadc09923329eull, 0x03e2cf6bc604ddb0ull},
+    {0xa6539930bf6bff45ull, 0x84db8346b786151cull},
+    {0xcfe87f7cef46ff16ull, 0xe612641865679a63ull},
+    {0x81f14fae158c5f6eull, 0x4fcb7e8f3f60c07eull},
+    {0xa26da3999aef7749ull, 0xe3be5e330f38f09dull},
+    {0xcb090c8001ab551cull, 0x5cadf5bfd3072cc5ull},
+    {0xfdcb4fa002162a63ull, 0x73d9732fc7c8f7f6ull},
+    {0x9e9f11c4014dda7eull, 0x2867e7fddcdd9afaull},
+    {0xc646d63501a1511dull, 0xb281e1fd541501b8ull},
+    {0xf7d88bc24209a565ull, 0x1f225a7ca91a4226ull},
+    {0x9ae757596946075full, 0x3375788de9b06958ull},
+    {0xc1a12d2fc3978937ull, 0x0052d6b1641c83aeull},
+    {0xf209787bb47d6b84ull, 0xc0678c5dbd23a49aull},
+    {0x9745eb4d50ce6332ull, 0xf840b7ba963646e0ull},
+    {0xbd176620a501fbffull, 0xb650e5a93bc3d898ull},
+    {0xec5d3fa8ce427affull, 0xa3e51f138ab4cebeull},
+    {0x93ba47c980e98cdfull, 0xc66f336c36b10137ull},
+    {0xb8a8d9bbe123f017ull, 0xb80b0047445d4184ull},
+    {0xe6d3102ad96cec1dull, 0xa60dc059157491e5ull},
+    {0x9043ea1ac7e41392ull, 0x87c89837ad68db2full},
+    {0xb454e4a179dd1877ull, 0x29babe4598c311fbull},
+    {0xe16a1dc9d8545e94ull, 0xf4296dd6fef3d67aull},
+    {0x8ce2529e2734bb1dull, 0x1899e4a65f58660cull},
+    {0xb01ae745b101e9e4ull, 0x5ec05dcff72e7f8full},
+    {0xdc21a1171d42645dull, 0x76707543f4fa1f73ull},
+    {0x899504ae72497ebaull, 0x6a06494a791c53a8ull},
+    {0xabfa45da0edbde69ull, 0x0487db9d17636892ull},
+    {0xd6f8d7509292d603ull, 0x45a9d2845d3c42b6ull},
+    {0x865b86925b9bc5c2ull, 0x0b8a2392ba45a9b2ull},
+    {0xa7f26836f282b732ull, 0x8e6cac7768d7141eull},
+    {0xd1ef0244af2364ffull, 0x3207d795430cd926ull},
+    {0x8335616aed761f1full, 0x7f44e6bd49e807b8ull},
+    {0xa402b9c5a8d3a6e7ull, 0x5f16206c9c6209a6ull},
+    {0xcd036837130890a1ull, 0x36dba887c37a8c0full},
+    {0x802221226be55a64ull, 0xc2494954da2c9789ull},
+    {0xa02aa96b06deb0fdull, 0xf2db9baa10b7bd6cull},
+    {0xc83553c5c8965d3dull, 0x6f92829494e5acc7ull},
+    {0xfa42a8b73abbf48cull, 0xcb772339ba1f17f9ull},
+    {0x9c69a97284b578d7ull, 0xff2a760414536efbull},
+    {0xc38413cf25e2d70dull, 0xfef5138519684abaull},
+    {0xf46518c2ef5b8cd1ull, 0x7eb258665fc25d69ull},
+    {0x98bf2f79d5993802ull, 0xef2f773ffbd97a61ull},
+    {0xbeeefb584aff8603ull, 0xaafb550ffacfd8faull},
+    {0xeeaaba2e5dbf6784ull, 0x95ba2a53f983cf38ull},
+    {0x952ab45cfa97a0b2ull, 0xdd945a747bf26183ull},
+    {0xba756174393d88dfull, 0x94f971119aeef9e4ull},
+    {0xe912b9d1478ceb17ull, 0x7a37cd5601aab85dull},
+    {0x91abb422ccb812eeull, 0xac62e055c10ab33aull},
+    {0xb616a12b7fe617aaull, 0x577b986b314d6009ull},
+    {0xe39c49765fdf9d94ull, 0xed5a7e85fda0b80bull},
+    {0x8e41ade9fbebc27dull, 0x14588f13be847307ull},
+    {0xb1d219647ae6b31cull, 0x596eb2d8ae258fc8ull},
+    {0xde469fbd99a05fe3ull, 0x6fca5f8ed9aef3bbull},
+    {0x8aec23d680043beeull, 0x25de7bb9480d5854ull},
+    {0xada72ccc20054ae9ull, 0xaf561aa79a10ae6aull},
+    {0xd910f7ff28069da4ull, 0x1b2ba1518094da04ull},
+    {0x87aa9aff79042286ull, 0x90fb44d2f05d0842ull},
+    {0xa99541bf57452b28ull, 0x353a1607ac744a53ull},
+    {0xd3fa922f2d1675f2ull, 0x42889b8997915ce8ull},
+    {0x847c9b5d7c2e09b7ull, 0x69956135febada11ull},
+    {0xa59bc234db398c25ull, 0x43fab9837e699095ull},
+    {0xcf02b2c21207ef2eull, 0x94f967e45e03f4bbull},
+    {0x8161afb94b44f57dull, 0x1d1be0eebac278f5ull},
+    {0xa1ba1ba79e1632dcull, 0x6462d92a69731732ull},
+    {0xca28a291859bbf93ull, 0x7d7b8f7503cfdcfeull},
+    {0xfcb2cb35e702af78ull, 0x5cda735244c3d43eull},
+    {0x9defbf01b061adabull, 0x3a0888136afa64a7ull},
+    {0xc56baec21c7a1916ull, 0x088aaa1845b8fdd0ull},
+    {0xf6c69a72a3989f5bull, 0x8aad549e57273d45ull},
+    {0x9a3c2087a63f6399ull, 0x36ac54e2f678864bull},
+    {0xc0cb28a98fcf3c7full, 0x84576a1bb416a7ddull},
+    {0xf0fdf2d3f3c30b9full, 0x656d44a2a11c51d5ull},
+    {0x969eb7c47859e743ull, 0x9f644ae5a4b1b325ull},
+    {0xbc4665b596706114ull, 0x873d5d9f0dde1feeull},
+    {0xeb57ff22fc0c7959ull, 0xa90cb506d155a7eaull},
+    {0x9316ff75dd87cbd8ull, 0x09a7f12442d588f2ull},
+    {0xb7dcbf5354e9beceull, 0x0c11ed6d538aeb2full},
+    {0xe5d3ef282a242e81ull, 0x8f1668c8a86da5faull},
+    {0x8fa475791a569d10ull, 0xf96e017d694487bcull},
+    {0xb38d92d760ec4455ull, 0x37c981dcc395a9acull},
+    {0xe070f78d3927556aull, 0x85bbe253f47b1417ull},
+    {0x8c469ab843b89562ull, 0x93956d7478ccec8eull},
+    {0xaf58416654a6babbull, 0x387ac8d1970027b2ull},
+    {0xdb2e51bfe9d0696aull, 0x06997b05fcc0319eull},
+    {0x88fcf317f22241e2ull, 0x441fece3bdf81f03ull},
+    {0xab3c2fddeeaad25aull, 0xd527e81cad7626c3ull},
+    {0xd60b3bd56a5586f1ull, 0x8a71e223d8d3b074ull},
+    {0x85c7056562757456ull, 0xf6872d5667844e49ull},
+    {0xa738c6bebb12d16cull, 0xb428f8ac016561dbull},
+    {0xd106f86e69d785c7ull, 0xe13336d701beba52ull},
+    {0x82a45b450226b39cull, 0xecc0024661173473ull},
+    {0xa34d721642b06084ull, 0x27f002d7f95d0190ull},
+    {0xcc20ce9bd35c78a5ull, 0x31ec038df7b441f4ull},
+    {0xff290242c83396ceull, 0x7e67047175a15271ull},
+    {0x9f79a169bd203e41ull, 0x0f0062c6e984d386ull},
+    {0xc75809c42c684dd1ull, 0x52c07b78a3e60868ull},
+    {0xf92e0c3537826145ull, 0xa7709a56ccdf8a82ull},
+    {0x9bbcc7a142b17ccbull, 0x88a66076400bb691ull},
+    {0xc2abf989935ddbfeull, 0x6acff893d00ea435ull},
+    {0xf356f7ebf83552feull, 0x0583f6b8c4124d43ull},
+    {0x98165af37b2153deull, 0xc3727a337a8b704aull},
+    {0xbe1bf1b059e9a8d6ull, 0x744f18c0592e4c5cull},
+    {0xeda2ee1c7064130cull, 0x1162def06f79df73ull},
+    {0x9485d4d1c63e8be7ull, 0x8addcb5645ac2ba8ull},
+    {0xb9a74a0637ce2ee1ull, 0x6d953e2bd7173692ull},
+    {0xe8111c87c5c1ba99ull, 0xc8fa8db6ccdd0437ull},
+    {0x910ab1d4db9914a0ull, 0x1d9c9892400a22a2ull},
+    {0xb54d5e4a127f59c8ull, 0x2503beb6d00cab4bull},
+    {0xe2a0b5dc971f303aull, 0x2e44ae64840fd61dull},
+    {0x8da471a9de737e24ull, 0x5ceaecfed289e5d2ull},
+    {0xb10d8e1456105dadull, 0x7425a83e872c5f47ull},
+    {0xdd50f1996b947518ull, 0xd12f124e28f77719ull},
+    {0x8a5296ffe33cc92full, 0x82bd6b70d99aaa6full},
+    {0xace73cbfdc0bfb7bull, 0x636cc64d1001550bull},
+    {0xd8210befd30efa5aull, 0x3c47f7e05401aa4eull},
+    {0x8714a775e3e95c78ull, 0x65acfaec34810a71ull},
+    {0xa8d9d1535ce3b396ull, 0x7f1839a741a14d0dull},
+    {0xd31045a8341ca07cull, 0x1ede48111209a050ull},
+    {0x83ea2b892091e44dull, 0x934aed0aab460432ull},
+    {0xa4e4b66b68b65d60ull, 0xf81da84d5617853full},
+    {0xce1de40642e3f4b9ull, 0x36251260ab9d668eull},
+    {0x80d2ae83e9ce78f3ull, 0xc1d72b7c6b426019ull},
+    {0xa1075a24e4421730ull, 0xb24cf65b8612f81full},
+    {0xc94930ae1d529cfcull, 0xdee033f26797b627ull},
+    {0xfb9b7cd9a4a7443cull, 0x169840ef017da3b1ull},
+    {0x9d412e0806e88aa5ull, 0x8e1f289560ee864eull},
+    {0xc491798a08a2ad4eull, 0xf1a6f2bab92a27e2ull},
+    {0xf5b5d7ec8acb58a2ull, 0xae10af696774b1dbull},
+    {0x9991a6f3d6bf1765ull, 0xacca6da1e0a8ef29ull},
+    {0xbff610b0cc6edd3full, 0x17fd090a58d32af3ull},
+    {0xeff394dcff8a948eull, 0xddfc4b4cef07f5b0ull},
+    {0x95f83d0a1fb69cd9ull, 0x4abdaf101564f98eull},
+    {0xbb764c4ca7a4440full, 0x9d6d1ad41abe37f1ull},
+    {0xea53df5fd18d5513ull, 0x84c86189216dc5edull},
+    {0x92746b9be2f8552cull, 0x32fd3cf5b4e49bb4ull},
+    {0xb7118682dbb66a77ull, 0x3fbc8c33221dc2a1ull},
+    {0xe4d5e82392a40515ull, 0x0fabaf3feaa5334aull},
+    {0x8f05b1163ba6832dull, 0x29cb4d87f2a7400eull},
+    {0xb2c71d5bca9023f8ull, 0x743e20e9ef511012ull},
+    {0xdf78e4b2bd342cf6ull, 0x914da9246b255416ull},
+    {0x8bab8eefb6409c1aull, 0x1ad089b6c2f7548eull},
+    {0xae9672aba3d0c320ull, 0xa184ac2473b529b1ull},
+    {0xda3c0f568cc4f3e8ull, 0xc9e5d72d90a2741eull},
+    {0x8865899617fb1871ull, 0x7e2fa67c7a658892ull},
+    {0xaa7eebfb9df9de8dull, 0xddbb901b98feeab7ull},
+    {0xd51ea6fa85785631ull, 0x552a74227f3ea565ull},
+    {0x8533285c936b35deull, 0xd53a88958f87275full},
+    {0xa67ff273b8460356ull, 0x8a892abaf368f137ull},
+    {0xd01fef10a657842cull, 0x2d2b7569b0432d85ull},
+    {0x8213f56a67f6b29bull, 0x9c3b29620e29fc73ull},
+    {0xa298f2c501f45f42ull, 0x8349f3ba91b47b8full},
+    {0xcb3f2f7642717713ull, 0x241c70a936219a73ull},
+    {0xfe0efb53d30dd4d7ull, 0xed238cd383aa0110ull},
+    {0x9ec95d1463e8a506ull, 0xf4363804324a40aaull},
+    {0xc67bb4597ce2ce48ull, 0xb143c6053edcd0d5ull},
+    {0xf81aa16fdc1b81daull, 0xdd94b7868e94050aull},
+    {0x9b10a4e5e9913128ull, 0xca7cf2b4191c8326ull},
+    {0xc1d4ce1f63f57d72ull, 0xfd1c2f611f63a3f0ull},
+    {0xf24a01a73cf2dccfull, 0xbc633b39673c8cecull},
+    {0x976e41088617ca01ull, 0xd5be0503e085d813ull},
+    {0xbd49d14aa79dbc82ull, 0x4b2d8644d8a74e18ull},
+    {0xec9c459d51852ba2ull, 0xddf8e7d60ed1219eull},
+    {0x93e1ab8252f33b45ull, 0xcabb90e5c942b503ull},
+    {0xb8da1662e7b00a17ull, 0x3d6a751f3b936243ull},
+    {0xe7109bfba19c0c9dull, 0x0cc512670a783ad4ull},
+    {0x906a617d450187e2ull, 0x27fb2b80668b24c5ull},
+    {0xb484f9dc9641e9daull, 0xb1f9f660802dedf6ull},
+    {0xe1a63853bbd26451ull, 0x5e7873f8a0396973ull},
+    {0x8d07e33455637eb2ull, 0xdb0b487b6423e1e8ull},
+    {0xb049dc016abc5e5full, 0x91ce1a9a3d2cda62ull},
+    {0xdc5c5301c56b75f7ull, 0x7641a140cc7810fbull},
+    {0x89b9b3e11b6329baull, 0xa9e904c87fcb0a9dull},
+    {0xac2820d9623bf429ull, 0x546345fa9fbdcd44ull},
+    {0xd732290fbacaf133ull, 0xa97c177947ad4095ull},
+    {0x867f59a9d4bed6c0ull, 0x49ed8eabcccc485dull},
+    {0xa81f301449ee8c70ull, 0x5c68f256bfff5a74ull},
+    {0xd226fc195c6a2f8cull, 0x73832eec6fff3111ull},
+    {0x83585d8fd9c25db7ull, 0xc831fd53c5ff7eabull},
+    {0xa42e74f3d032f525ull, 0xba3e7ca8b77f5e55ull},
+    {0xcd3a1230c43fb26full, 0x28ce1bd2e55f35ebull},
+    {0x80444b5e7aa7cf85ull, 0x7980d163cf5b81b3ull},
+    {0xa0555e361951c366ull, 0xd7e105bcc332621full},
+    {0xc86ab5c39fa63440ull, 0x8dd9472bf3fefaa7ull},
+    {0xfa856334878fc150ull, 0xb14f98f6f0feb951ull},
+    {0x9c935e00d4b9d8d2ull, 0x6ed1bf9a569f33d3ull},
+    {0xc3b8358109e84f07ull, 0x0a862f80ec4700c8ull},
+    {0xf4a642e14c6262c8ull, 0xcd27bb612758c0faull},
+    {0x98e7e9cccfbd7dbdull, 0x8038d51cb897789cull},
+    {0xbf21e44003acdd2cull, 0xe0470a63e6bd56c3ull},
+    {0xeeea5d5004981478ull, 0x1858ccfce06cac74ull},
+    {0x95527a5202df0ccbull, 0x0f37801e0c43ebc8ull},
+    {0xbaa718e68396cffdull, 0xd30560258f54e6baull},
+    {0xe950df20247c83fdull, 0x47c6b82ef32a2069ull},
+    {0x91d28b7416cdd27eull, 0x4cdc331d57fa5441ull},
+    {0xb6472e511c81471dull, 0xe0133fe4adf8e952ull},
+    {0xe3d8f9e563a198e5ull, 0x58180fddd97723a6ull},
+    {0x8e679c2f5e44ff8full, 0x570f09eaa7ea7648ull},
+    {0xb201833b35d63f73ull, 0x2cd2cc6551e513daull},
+    {0xde81e40a034bcf4full, 0xf8077f7ea65e58d1ull},
+    {0x8b112e86420f6191ull, 0xfb04afaf27faf782ull},
+    {0xadd57a27d29339f6ull, 0x79c5db9af1f9b563ull},
+    {0xd94ad8b1c7380874ull, 0x18375281ae7822bcull},
+    {0x87cec76f1c830548ull, 0x8f2293910d0b15b5ull},
+    {0xa9c2794ae3a3c69aull, 0xb2eb3875504ddb22ull},
+    {0xd433179d9c8cb841ull, 0x5fa60692a46151ebull},
+    {0x849feec281d7f328ull, 0xdbc7c41ba6bcd333ull},
+    {0xa5c7ea73224deff3ull, 0x12b9b522906c0800ull},
+    {0xcf39e50feae16befull, 0xd768226b34870a00ull},
+    {0x81842f29f2cce375ull, 0xe6a1158300d46640ull},
+    {0xa1e53af46f801c53ull, 0x60495ae3c1097fd0ull},
+    {0xca5e89b18b602368ull, 0x385bb19cb14bdfc4ull},
+    {0xfcf62c1dee382c42ull, 0x46729e03dd9ed7b5ull},
+    {0x9e19db92b4e31ba9ull, 0x6c07a2c26a8346d1ull},
+    {0xc5a05277621be293ull, 0xc7098b7305241885ull},
+    {0xf70867153aa2db38ull, 0xb8cbee4fc66d1ea7ull},
+};
+
+struct U64Pair {
+    U64 high;
+    U64 low;
+};
+
+static inline U64Pair multiply_full(U64 a, U64 b) {
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 U128;
+    U128 product = (U128)a * b;
+    return {(U64)(product >> 64), (U64)product};
+#else
+    U64 a_low = (U32)a;
+    U64 a_high = a >> 32;
+    U64 b_low = (U32)b;
+    U64 b_high = b >> 32;
+
+    U64 low_low = a_low * b_low;
+    U64 low_high = a_low * b_high;
+    U64 high_low = a_high * b_low;
+    U64 high_high = a_high * b_high;
+
+    U64 middle = (low_low >> 32) + (U32)low_high + (U32)high_low;
+    return {high_high + (low_high >> 32) + (high_low >> 32) + (middle >> 32), (middle << 32) | (U32)low_low};
+#endif // __SIZEOF_INT128__
+}
+
+static inline U64Pair pow10_entry(S32 k, bool round_up) {
+    OK_ASSERT(k >= POW10_TABLE_MIN && k <= POW10_TABLE_MAX);
+
+    const U64* entry = pow10_table[k - POW10_TABLE_MIN];
+    U64Pair result{entry[0], entry[1]};
+    if (round_up) {
+        result.low++;
+        result.high += result.low == 0;
+    }
+    return result;
+}
+
+// Floating point to decimal is Schubfach (R. Giulietti, "The Schubfach way to render
+// doubles"). It needs 10^k rounded up, and picks the shortest decimal in the rounding
+// interval of the value, the closest one if there are several.
+static inline S32 floor_log2_pow10(S32 e) {
+    return (e * 1741647) >> 19;
+}
+
+static inline S32 floor_log10_pow2(S32 e) {
+    return (e * 1262611) >> 22;
+}
+
+static inline S32 floor_log10_three_quarters_pow2(S32 e) {
+    return (e * 1262611 - 524031) >> 22;
+}
+
+static inline U64 round_to_odd(U64Pair g, U64 cp) {
+    U64Pair x = multiply_full(g.low, cp);
+    U64Pair y = multiply_full(g.high, cp);
+
+    U64 z = y.low + x.high;
+    U64 z_high = y.high + (z < y.low);
+    return z_high | (z > 1);
+}
+
+struct DecimalFloat {
+    U64 digits;
+    S32 exponent;
+};
+
+// The value is `c * 2^q`, and its rounding interval is narrower below when
+// `lower_boundary_is_closer`.
+static DecimalFloat float_to_decimal(U64 c, S32 q, bool lower_boundary_is_closer) {
+    bool is_even = c % 2 == 0;
+
+    U64 cbl = 4 * c - 2 + lower_boundary_is_closer;
+    U64 cb = 4 * c;
+    U64 cbr = 4 * c + 2;
+
+    S32 k = lower_boundary_is_closer ? floor_log10_three_quarters_pow2(q) : floor_log10_pow2(q);
+    S32 h = q + floor_log2_pow10(-k) + 1;
+
+    U64Pair pow10 = pow10_entry(-k, -k < 0 || -k > POW10_TABLE_LAST_EXACT);
+    U64 vbl = round_to_odd(pow10, cbl << h);
+    U64 vb = round_to_odd(pow10, cb << h);
+    U64 vbr = round_to_odd(pow10, cbr << h);
+
+    U64 lower = vbl + !is_even;
+    U64 upper = vbr - !is_even;
+
+    U64 s = vb / 4;
+    if (s >= 10) {
+        // One digit less, if either neighbour fits in the interval.
+        U64 sp = s / 10;
+        bool up_inside = lower <= 40 * sp;
+        bool wp_inside = 40 * sp + 40 <= upper;
+        if (up_inside != wp_inside) return {up_inside ? sp : sp + 1, k + 1};
+    }
+
+    bool u_inside = lower <= 4 * s;
+    bool w_inside = 4 * s + 4 <= upper;
+    if (u_inside != w_inside) return {u_inside ? s : s + 1, k};
+
+    U64 mid = 4 * s + 2;
+    bool round_up = vb > mid || (vb == mid && (s & 1) != 0);
+    return {round_up ? s + 1 : s, k};
+}
+
+static UZ write_decimal_float(char* buf, bool negative, DecimalFloat decimal) {
+    while (decimal.digits % 10 == 0 && decimal.digits != 0) {
+        decimal.digits /= 10;
+        decimal.exponent++;
+    }
+
+    char digits[MAX_DECIMAL_INT_CHARS];
+    S32 n = (S32)format_uint(digits, decimal.digits);
+    S32 e = decimal.exponent;
+    S32 sci = n - 1 + e;
+
+    S32 abs_sci = sci < 0 ? -sci : sci;
+    S32 sci_count = n + (n > 1) + 2 + (abs_sci >= 100 ? 3 : 2);
+    S32 fixed_count = e >= 0 ? n + e : sci >= 0 ? n + 1 : n + 1 - sci;
+
+    char* p = buf;
+    if (negative) *p++ = '-';
+
+    if (fixed_count <= sci_count) {
+        if (e >= 0) {
+            memcpy(p, digits, n);
+            memset(p + n, '0', e);
+            p += n + e;
+        } else if (sci >= 0) {
+            memcpy(p, digits, sci + 1);
+            p[sci + 1] = '.';
+            memcpy(p + sci + 2, digits + sci + 1, n - sci - 1);
+            p += n + 1;
+        } else {
+            p[0] = '0';
+            p[1] = '.';
+            memset(p + 2, '0', -sci - 1);
+            memcpy(p + 1 - sci, digits, n);
+            p += n + 1 - sci;
+        }
+    } else {
+        *p++ = digits[0];
+        if (n > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, n - 1);
+            p += n - 1;
+        }
+
+        *p++ = 'e';
+        *p++ = sci < 0 ? '-' : '+';
+        if (abs_sci >= 100) {
+            *p++ = (char)('0' + abs_sci / 100);
+            abs_sci %= 100;
+        }
+        p[0] = decimal_digit_pairs[abs_sci * 2];
+        p[1] = decimal_digit_pairs[abs_sci * 2 + 1];
+        p += 2;
+    }
+
+    return p - buf;
+}
+
+static UZ write_special_float(char* buf, bool negative, bool is_nan, bool is_zero) {
+    const char* text = is_nan ? "nan" : is_zero ? "0" : "inf";
+    UZ count = strlen(text);
+
+    // No minus sign on NaNs.
+    UZ sign = negative && !is_nan;
+    if (sign) buf[0] = '-';
+    memcpy(buf + sign, text, count);
+    return sign + count;
+}
+
+UZ format_f64(char* buf, F64 value) {
+    U64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    bool negative = (bits >> 63) != 0;
+    U32 ieee_exponent = (U32)(bits >> 52) & 0x7ff;
+    U64 ieee_significand = bits & ((1ull << 52) - 1);
+
+    if (ieee_exponent == 0x7ff) return write_special_float(buf, negative, ieee_significand != 0, false);
+    if (ieee_exponent == 0 && ieee_significand == 0) return write_special_float(buf, negative, false, true);
+
+    U64 c;
+    S32 q;
+    if (ieee_exponent != 0) {
+        c = (1ull << 52) | ieee_significand;
+        q = (S32)ieee_exponent - 1075;
+
+        // Small integers are their own shortest representation.
+        if (q <= 0 && -q < 53 && (c & ((1ull << -q) - 1)) == 0) {
+            return write_decimal_float(buf, negative, DecimalFloat{c >> -q, 0});
+        }
+    } else {
+        c = ieee_significand;
+        q = 1 - 1075;
+    }
+
+    bool lower_boundary_is_closer = ieee_significand == 0 && ieee_exponent > 1;
+    return write_decimal_float(buf, negative, float_to_decimal(c, q, lower_boundary_is_closer));
+}
+
+UZ format_f32(char* buf, F32 value) {
+    U32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    bool negative = (bits >> 31) != 0;
+    U32 ieee_exponent = (bits >> 23) & 0xff;
+    U32 ieee_significand = bits & ((1u << 23) - 1);
+
+    if (ieee_exponent == 0xff) return write_special_float(buf, negative, ieee_significand != 0, false);
+    if (ieee_exponent == 0 && ieee_significand == 0) return write_special_float(buf, negative, false, true);
+
+    U64 c;
+    S32 q;
+    if (ieee_exponent != 0) {
+        c = (1u << 23) | ieee_significand;
+        q = (S32)ieee_exponent - 150;
+
+        if (q <= 0 && -q < 24 && (c & ((1ull << -q) - 1)) == 0) {
+            return write_decimal_float(buf, negative, DecimalFloat{c >> -q, 0});
+        }
+    } else {
+        c = ieee_significand;
+        q = 1 - 150;
+    }
+
+    bool lower_boundary_is_closer = ieee_significand == 0 && ieee_exponent > 1;
+    return write_decimal_float(buf, negative, float_to_decimal(c, q, lower_boundary_is_closer));
+}
+
+// Decimal to floating point is the Eisel-Lemire algorithm (D. Lemire, "Number Parsing at a
+// Gigabyte per Second"), which is exact for up to 19 significant digits. Longer inputs are
+// tried with the first 19 digits and with one more in the last place, and only if those
+// round differently does the exact comparison against the halfway point decide.
+struct BinaryFloatFormat {
+    U32 mantissa_bits;
+    U32 exponent_bits;
+    S32 minimum_exponent;
+    S32 infinite_power;
+    S32 min_round_to_even;
+    S32 max_round_to_even;
+    S32 smallest_power_of_ten;
+    S32 largest_power_of_ten;
+};
+
+static constexpr BinaryFloatFormat binary64_format = {52, 11, -1023, 0x7ff, -4, 23, -342, 308};
+static constexpr BinaryFloatFormat binary32_format = {23, 8, -127, 0xff, -17, 10, -64, 38};
+
+// Returns the bits of `w * 10^q` without the sign.
+static U64 eisel_lemire(const BinaryFloatFormat& format, U64 w, S64 q) {
+    if (w == 0 || q < format.smallest_power_of_ten) return 0;
+    if (q > format.largest_power_of_ten) return (U64)format.infinite_power << format.mantissa_bits;
+
+    U32 lz = count_leading_zeros(w);
+    w <<= lz;
+
+    // The negative powers with few enough digits are stored rounded up.
+    U64Pair power = pow10_entry((S32)q, q >= -27 && q < 0);
+    U64Pair product = multiply_full(w, power.high);
+
+    U64 precision_mask = ~0ull >> (format.mantissa_bits + 3);
+    if ((product.high & precision_mask) == precision_mask) {
+        U64Pair second = multiply_full(w, power.low);
+        product.low += second.high;
+        product.high += second.high > product.low;
+    }
+
+    U32 upper_bit = (U32)(product.high >> 63);
+    U32 shift = upper_bit + 64 - format.mantissa_bits - 3;
+    U64 mantissa = product.high >> shift;
+    S32 power2 = (S32)((((152170 + 65536) * q) >> 16) + 63) + (S32)upper_bit - (S32)lz - format.minimum_exponent;
+
+    if (power2 <= 0) {
+        if (-power2 + 1 >= 64) return 0;
+
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+
+        // Rounding up may have made it a normal number.
+        power2 = mantissa < (1ull << format.mantissa_bits) ? 0 : 1;
+        return ((U64)power2 << format.mantissa_bits) | (mantissa & ((1ull << format.mantissa_bits) - 1));
+    }
+
+    // Exactly halfway between two floats, round to even instead of up.
+    if (product.low <= 1 && q >= format.min_round_to_even && q <= format.max_round_to_even && (mantissa & 3) == 1) {
+        if ((mantissa << shift) == product.high) mantissa &= ~1ull;
+    }
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (2ull << format.mantissa_bits)) {
+        mantissa = 1ull << format.mantissa_bits;
+        power2++;
+    }
+    mantissa &= ~(1ull << format.mantissa_bits);
+
+    if (power2 >= format.infinite_power) return (U64)format.infinite_power << format.mantissa_bits;
+    return ((U64)power2 << format.mantissa_bits) | mantissa;
+}
+
+// Just big enough for the comparisons in `round_long_decimal`.
+struct BigUInt {
+    static constexpr UZ MAX_LIMBS = 128;
+
+    void multiply(U32 factor) {
+        U64 carry = 0;
+        for (UZ i = 0; i < count; i++) {
+            U64 product = (U64)limbs[i] * factor + carry;
+            limbs[i] = (U32)product;
+            carry = product >> 32;
+        }
+        if (carry != 0) push((U32)carry);
+    }
+
+    void add(U32 addend) {
+        U64 carry = addend;
+        for (UZ i = 0; i < count && carry != 0; i++) {
+            U64 sum = (U64)limbs[i] + carry;
+            limbs[i] = (U32)sum;
+            carry = sum >> 32;
+        }
+        if (carry != 0) push((U32)carry);
+    }
+
+    void multiply_pow5(U32 exponent) {
+        // 5^13 is the biggest power of five that fits in a limb.
+        while (exponent >= 13) {
+            multiply(1220703125);
+            exponent -= 13;
+        }
+
+        U32 rest = 1;
+        while (exponent-- > 0) rest *= 5;
+        multiply(rest);
+    }
+
+    void shift_left(U32 bits) {
+        if (count == 0) return;
+
+        U32 limb_shift = bits / 32;
+        U32 bit_shift = bits % 32;
+        OK_ASSERT(count + limb_shift + 1 <= MAX_LIMBS);
+
+        if (bit_shift != 0) {
+            U32 carry = 0;
+            for (UZ i = 0; i < count; i++) {
+                U32 limb = limbs[i];
+                limbs[i] = (limb << bit_shift) | carry;
+                carry = limb >> (32 - bit_shift);
+            }
+            if (carry != 0) limbs[count++] = carry;
+        }
+
+        if (limb_shift != 0) {
+            memmove(limbs + limb_shift, limbs, count * sizeof(U32));
+            memset(limbs, 0, limb_shift * sizeof(U32));
+            count += limb_shift;
+        }
+    }
+
+    void push(U32 limb) {
+        OK_ASSERT(count < MAX_LIMBS);
+        limbs[count++] = limb;
+    }
+
+    static S32 compare(const BigUInt& a, const BigUInt& b) {
+        if (a.count != b.count) return a.count < b.count ? -1 : 1;
+        for (UZ i = a.count; i > 0; i--) {
+            if (a.limbs[i - 1] != b.limbs[i - 1]) return a.limbs[i - 1] < b.limbs[i - 1] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    U32 limbs[MAX_LIMBS];
+    UZ count;
+};
+
+// Beyond this many digits only whether any of the rest are non-zero matters, no halfway
+// point between two doubles has more.
+static constexpr UZ MAX_EXACT_DIGITS = 800;
+
+// Decides between `candidate` and the next float up by comparing the exact decimal with the
+// point halfway between them. The decimal's significant digits are in `int_part` followed by
+// `frac_part`, after skipping `leading_zeros` of them, and `exponent` applies to all of them.
+static U64 round_long_decimal(const BinaryFloatFormat& format, U64 candidate, StringView int_part, StringView frac_part,
+                              UZ leading_zeros, S64 exponent) {
+    U64 significand_mask = (1ull << format.mantissa_bits) - 1;
+    S32 bias = -format.minimum_exponent + (S32)format.mantissa_bits;
+
+    U64 biased_exponent = candidate >> format.mantissa_bits;
+    U64 m = candidate & significand_mask;
+    S64 e2;
+    if (biased_exponent == 0) {
+        e2 = 1 - bias;
+    } else {
+        m |= 1ull << format.mantissa_bits;
+        e2 = (S64)biased_exponent - bias;
+    }
+
+    BigUInt digits{};
+    UZ used = 0;
+    bool sticky = false;
+    UZ skipped = 0;
+
+    for (UZ part = 0; part < 2; part++) {
+        StringView sv = part == 0 ? int_part : frac_part;
+        for (UZ i = 0; i < sv.count; i++) {
+            if (skipped < leading_zeros) {
+                skipped++;
+                continue;
+            }
+
+            U32 digit = (U32)(sv.data[i] - '0');
+            if (used < MAX_EXACT_DIGITS) {
+                digits.multiply(10);
+                digits.add(digit);
+                used++;
+            } else {
+                sticky |= digit != 0;
+                exponent++;
+            }
+        }
+    }
+
+    // digits * 10^exponent against (2m + 1) * 2^(e2 - 1).
+    BigUInt halfway{};
+    halfway.push((U32)(2 * m + 1));
+    if ((2 * m + 1) >> 32) halfway.push((U32)((2 * m + 1) >> 32));
+
+    if (exponent >= 0) {
+        digits.multiply_pow5((U32)exponent);
+    } else {
+        halfway.multiply_pow5((U32)-exponent);
+    }
+
+    S64 shift = exponent - (e2 - 1);
+    if (shift > 0) {
+        digits.shift_left((U32)shift);
+    } else {
+        halfway.shift_left((U32)-shift);
+    }
+
+    S32 order = BigUInt::compare(digits, halfway);
+    if (order == 0 && sticky) order = 1;
+
+    if (order > 0 || (order == 0 && (m & 1) != 0)) return candidate + 1;
+    return candidate;
+}
+
+static inline bool is_decimal_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool matches_ignore_case(const char* p, const char* end, const char* word) {
+    UZ count = strlen(word);
+    if ((UZ)(end - p) < count) return false;
+
+    for (UZ i = 0; i < count; i++) {
+        char c = p[i];
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        if (c != word[i]) return false;
+    }
+    return true;
+}
+
+static bool parse_float_bits(const BinaryFloatFormat& format, StringView source, U64* out, UZ* consumed) {
+    const char* p = source.data;
+    const char* end = source.data + source.count;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    U64 sign = (U64)negative << (format.mantissa_bits + format.exponent_bits);
+
+    if (p < end && !is_decimal_digit(*p) && *p != '.') {
+        U64 infinity = (U64)format.infinite_power << format.mantissa_bits;
+
+        if (matches_ignore_case(p, end, "infinity")) {
+            p += 8;
+            *out = sign | infinity;
+        } else if (matches_ignore_case(p, end, "inf")) {
+            p += 3;
+            *out = sign | infinity;
+        } else if (matches_ignore_case(p, end, "nan")) {
+            p += 3;
+            *out = sign | infinity | (1ull << (format.mantissa_bits - 1));
+        } else {
+            return false;
+        }
+
+        if (consumed != nullptr) *consumed = p - source.data;
+        return consumed != nullptr || p == end;
+    }
+
+    const char* int_start = p;
+    while (p < end && is_decimal_digit(*p)) p++;
+    StringView int_part{int_start, (UZ)(p - int_start)};
+
+    StringView frac_part{p, 0};
+    if (p < end && *p == '.') {
+        p++;
+        const char* frac_start = p;
+        while (p < end && is_decimal_digit(*p)) p++;
+        frac_part = StringView{frac_start, (UZ)(p - frac_start)};
+    }
+
+    if (int_part.count == 0 && frac_part.count == 0) return false;
+
+    S64 exponent = 0;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* exponent_start = p;
+        p++;
+
+        bool exponent_negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            exponent_negative = *p == '-';
+            p++;
+        }
+
+        if (p < end && is_decimal_digit(*p)) {
+            while (p < end && is_decimal_digit(*p)) {
+                // Anything this big is zero or infinity anyway.
+                if (exponent < 100000) exponent = exponent * 10 + (*p - '0');
+                p++;
+            }
+            if (exponent_negative) exponent = -exponent;
+        } else {
+            // Not an exponent after all, like the "e" in "1each".
+            p = exponent_start;
+        }
+    }
+
+    if (consumed != nullptr) {
+        *consumed = p - source.data;
+    } else if (p != end) {
+        return false;
+    }
+
+    // The first 19 significant digits go into `w`, and the rest only count towards the
+    // exponent.
+    U64 w = 0;
+    UZ significant = 0;
+    UZ leading_zeros = 0;
+
+    for (UZ part = 0; part < 2; part++) {
+        StringView sv = part == 0 ? int_part : frac_part;
+        for (UZ i = 0; i < sv.count; i++) {
+            U32 digit = (U32)(sv.data[i] - '0');
+            if (significant == 0 && digit == 0) {
+                leading_zeros++;
+                continue;
+            }
+
+            if (significant < 19) w = w * 10 + digit;
+            significant++;
+        }
+    }
+
+    exponent -= (S64)frac_part.count;
+    if (significant > 19) exponent += (S64)(significant - 19);
+
+    if (significant <= 19) {
+        // @Portability: Relies on floating point math being done at the precision of the
+        // type, which isn't the case on the x87 stack.
+#if !defined(__FLT_EVAL_METHOD__) || __FLT_EVAL_METHOD__ == 0
+        // Both `w` and the power of ten are exact, so a single rounding gets it right.
+        if (format.mantissa_bits == 52 && w <= (1ull << 53) && exponent >= -22 && exponent <= 22) {
+            static constexpr F64 powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                             1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                             1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+            F64 value = (F64)w;
+            value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+
+            U64 bits;
+            memcpy(&bits, &value, sizeof(bits));
+            *out = sign | bits;
+            return true;
+        }
+
+        if (format.mantissa_bits == 23 && w <= (1ull << 24) && exponent >= -10 && exponent <= 10) {
+            static constexpr F32 powers[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+            F32 value = (F32)w;
+            value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+
+            U32 bits;
+            memcpy(&bits, &value, sizeof(bits));
+            *out = sign | bits;
+            return true;
+        }
+#endif // __FLT_EVAL_METHOD__
+
+        *out = sign | eisel_lemire(format, w, exponent);
+        return true;
+    }
+
+    // The exact value is somewhere in [w, w + 1) * 10^exponent.
+    U64 lower = eisel_lemire(format, w, exponent);
+    U64 upper = eisel_lemire(format, w + 1, exponent);
+    if (lower == upper) {
+        *out = sign | lower;
+        return true;
+    }
+
+    S64 digits_exponent = exponent - (S64)(significant - 19);
+    *out = sign | round_long_decimal(format, lower, int_part, frac_part, leading_zeros, digits_exponent);
+    return true;
+}
+
+bool parse_f64(StringView source, F64* out, UZ* consumed) {
+    U64 bits;
+    if (!parse_float_bits(binary64_format, source, &bits, consumed)) return false;
+
+    memcpy(out, &bits, sizeof(*out));
+    return true;
+}
+
+bool parse_f32(StringView source, F32* out, UZ* consumed) {
+    U64 bits;
+    if (!parse_float_bits(binary32_format, source, &bits, consumed)) return false;
 
-        idx = (idx + 1) % capacity;
-    } while (idx != initial_idx);
+    U32 narrow = (U32)bits;
+    memcpy(out, &narrow, sizeof(*out));
+    return true;
+}
 
-    return false;
+// FORMAT IMPLEMENTATION
+void format_error_malformed_placeholder() {}
+void format_error_unmatched_brace() {}
+void format_error_argument_count_mismatch() {}
+void format_error_type_mismatch() {}
+void format_error_precision_not_allowed() {}
+
+void FormatWriter::push_many(char c, UZ n) {
+    while (n > 0) {
+        if (count == capacity) flush(this, 1);
+
+        UZ chunk = min(n, capacity - count);
+        memset(buffer + count, c, chunk);
+        count += chunk;
+        n -= chunk;
+    }
 }
 
-template <typename TKey, typename TValue>
-template <typename K>
-bool Table<TKey, TValue>::has(const K& key) const {
-    U64 idx = Hash<K>::hash(key) % capacity;
-    U64 initial_idx = idx;
+void format_args(FormatWriter* w, StringView fmt, const FormatArg* args, UZ arg_count) {
+    const char* p = fmt.data;
+    const char* end = fmt.data + fmt.count;
+    UZ arg = 0;
 
-    do {
-        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
-            return true;
+    while (p < end) {
+        const char* run = p;
+        while (p < end && *p != '{' && *p != '}') p++;
+        w->write(run, p - run);
+
+        if (p == end) break;
+
+        if (*p == '}') {
+            OK_ASSERT(p + 1 < end && p[1] == '}');
+            w->push('}');
+            p += 2;
+            continue;
         }
 
-        idx = (idx + 1) % capacity;
-    } while (idx != initial_idx);
+        if (p + 1 < end && p[1] == '{') {
+            w->push('{');
+            p += 2;
+            continue;
+        }
 
-    return false;
+        FormatSpec spec;
+        p = parse_format_placeholder(p + 1, end, &spec);
+        OK_ASSERT(p != nullptr);
+        OK_ASSERT(arg < arg_count);
+
+        args[arg].proc(w, spec, args[arg].value);
+        arg++;
+    }
 }
 
-// NOTE(oleh): Should we call destructors here?
-template <typename TKey, typename TValue>
-bool Table<TKey, TValue>::remove(const TKey& key) {
-    U64 idx = Hash<TKey>::hash(key) % capacity;
-    bool result = OK_TAB_IS_OCCUPIED(meta[idx]);
-    if (result) --count;
-    meta[idx] &= ~OK_TAB_META_OCCUPIED;
-    return result;
+void format_padded(FormatWriter* w, const FormatSpec& spec, const char* chars, UZ chars_count,
+                   FormatSpec::Align default_align) {
+    if (spec.width <= chars_count) {
+        w->write(chars, chars_count);
+        return;
+    }
+
+    UZ padding = spec.width - chars_count;
+    FormatSpec::Align align = spec.align == FormatSpec::Align::NONE ? default_align : spec.align;
+
+    switch (align) {
+    case FormatSpec::Align::NONE:
+    case FormatSpec::Align::LEFT:
+        w->write(chars, chars_count);
+        w->push_many(spec.fill, padding);
+        break;
+    case FormatSpec::Align::RIGHT:
+        w->push_many(spec.fill, padding);
+        w->write(chars, chars_count);
+        break;
+    case FormatSpec::Align::CENTER:
+        w->push_many(spec.fill, padding / 2);
+        w->write(chars, chars_count);
+        w->push_many(spec.fill, padding - padding / 2);
+        break;
+    }
 }
 
-// SET IMPLEMENTATION
-template <typename T>
-Set<T> Set<T>::alloc(Allocator* a, UZ capacity) {
-    Set<T> set;
-    set.allocator = a;
-    set.count = 0;
-    set.capacity = capacity;
-    set.values = a->alloc<T>(capacity);
-    set.meta = a->alloc<Meta>(capacity);
-    return set;
+// Writes out a number whose sign, if any, is the first char of `chars`. Zero padding goes
+// between the sign and the digits.
+static void format_number(FormatWriter* w, const FormatSpec& spec, const char* chars, UZ chars_count, bool has_sign) {
+    if (spec.zero_pad && spec.align == FormatSpec::Align::NONE && spec.width > chars_count) {
+        if (has_sign) w->push(chars[0]);
+        w->push_many('0', spec.width - chars_count);
+        w->write(chars + has_sign, chars_count - has_sign);
+        return;
+    }
+
+    format_padded(w, spec, chars, chars_count, FormatSpec::Align::RIGHT);
 }
 
-template <typename T>
-void Set<T>::put(const T& elem) {
-    if (load_percentage() >= 70) {
-        auto new_set = Set<T>::alloc(allocator, OK_SET_GROWTH_FACTOR(capacity));
+void format_integer(FormatWriter* w, const FormatSpec& spec, U64 magnitude, bool negative) {
+    if (spec.type == 'c') {
+        char c = (char)magnitude;
+        format_padded(w, spec, &c, 1, FormatSpec::Align::LEFT);
+        return;
+    }
 
-        for (UZ i = 0; i < capacity; i++) {
-            if (OK_TAB_IS_FREE(meta[i])) {
-                continue;
-            }
+    // Without a width the digits go straight into the destination.
+    char local[MAX_INT_CHARS];
+    char* p = spec.width == 0 ? w->reserve(MAX_INT_CHARS) : local;
 
-            new_set.put(values[i]);
-        }
+    if (negative) p[0] = '-';
 
-        *this = new_set;
+    UZ count = negative;
+    switch (spec.type) {
+    case 'x': count += format_uint_hex(p + count, magnitude, false); break;
+    case 'X': count += format_uint_hex(p + count, magnitude, true);  break;
+    case 'o': count += format_uint_base(p + count, magnitude, 8);    break;
+    case 'b': count += format_uint_base(p + count, magnitude, 2);    break;
+    default:  count += format_uint(p + count, magnitude);            break;
     }
 
-    U64 hash = Hash<T>::hash(elem);
+    if (p != local) {
+        w->commit(count);
+    } else {
+        format_number(w, spec, p, count, negative);
+    }
+}
 
-    while (true) {
-        if (OK_TAB_IS_FREE(meta[hash])) {
-            meta[hash] |= OK_TAB_META_OCCUPIED;
-            values[hash] = elem;
-            count++;
-            return;
-        }
+static int format_snprintf(char* buf, UZ size, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = OK_VSNPRINTF(buf, size, fmt, args);
+    va_end(args);
+    return n;
+}
 
-        if (values[hash] == elem) {
-            values[hash] = elem;
-            return;
-        }
+void format_float(FormatWriter* w, const FormatSpec& spec, F64 value, bool single_precision) {
+    // `%f` of the biggest double with the biggest precision is a bit over 400 chars.
+    char buf[FormatWriter::MAX_RESERVE];
+    int n;
 
-        hash = (hash + 1) % capacity;
+    if (spec.type == '\0' && spec.precision < 0) {
+        n = (int)(single_precision ? format_f32(buf, (F32)value) : format_f64(buf, value));
+    } else {
+        char printf_fmt[8] = "%.*g";
+        if (spec.type != '\0') printf_fmt[3] = spec.type;
+
+        int precision = spec.precision < 0 ? 6 : spec.precision;
+        n = format_snprintf(buf, sizeof(buf), printf_fmt, precision, value);
+    }
+
+    OK_ASSERT(n >= 0 && (UZ)n < sizeof(buf));
+
+    // Only pad with zeros when there are digits to pad, not for `inf` or `nan`.
+    bool has_sign = buf[0] == '-';
+    bool finite = buf[has_sign] >= '0' && buf[has_sign] <= '9';
+
+    if (finite) {
+        format_number(w, spec, buf, n, has_sign);
+    } else {
+        format_padded(w, spec, buf, n, FormatSpec::Align::RIGHT);
     }
 }
 
-template <typename T>
-bool Set<T>::has(const T& elem) const {
-    U64 hash = Hash<T>::hash(elem);
-    U64 idx = hash;
+void ok_format(FormatWriter* w, const FormatSpec& spec, bool value) {
+    if (spec.type != '\0' && spec.type != 's') {
+        format_integer(w, spec, value, false);
+        return;
+    }
 
-    do {
-        if (OK_TAB_IS_OCCUPIED(meta[idx]) && values[idx] == elem) {
-            return true;
-        }
+    if (value) {
+        format_padded(w, spec, "true", 4, FormatSpec::Align::LEFT);
+    } else {
+        format_padded(w, spec, "false", 5, FormatSpec::Align::LEFT);
+    }
+}
 
-        idx = (idx + 1) % capacity;
-    } while (idx != hash);
+void ok_format(FormatWriter* w, const FormatSpec& spec, char value) {
+    if (spec.type != '\0' && spec.type != 'c') {
+        format_integer(w, spec, (U8)value, false);
+        return;
+    }
 
-    return false;
+    format_padded(w, spec, &value, 1, FormatSpec::Align::LEFT);
 }
 
-// Filesystem API
-struct File {
-#if OK_UNIX
-    enum class IOError {
-        ACCESS_DENIED,
-        INVALID_PATH,
-        IS_DIRECTORY,
-        TOO_MANY_SYMLINKS,
-        PROCESS_OPEN_FILES_LIMIT_REACHED,
-        SYSTEM_OPEN_FILES_LIMIT_REACHED,
-        PATH_TOO_LONG,
-        KERNEL_OUT_OF_MEMORY,
-        OUT_OF_SPACE,
-        IS_SOCKET,
-        FILE_TOO_BIG,
-        READONLY_FILE,
-        IO,
-        NOT_ALLOWED,
-        BAD_DATA,
-        BAD_FILE_DESCRIPTOR,
-        INTERRUPTED_BY_SIGNAL,
-        CURRENTLY_IN_USE,
-        READONLY_FS,
-        DOES_NOT_EXIST,
-    };
+void ok_format(FormatWriter* w, const FormatSpec& spec, F32 value) {
+    format_float(w, spec, value, true);
+}
 
-    using OpenError = IOError;
-    using ReadError = IOError;
-    using WriteError = IOError;
-    using CloseError = IOError;
-    using RemoveError = IOError;
-#elif OK_WINDOWS
-    using IOError = DWORD;
-    using OpenError = DWORD;
-    using ReadError = DWORD;
-    using WriteError = DWORD;
-    using CloseError = DWORD;
-    using RemoveError = DWORD;
-#else
-    struct IOError {};
-    struct OpenError {};
-    struct ReadError {};
-    struct WriteError {};
-    struct CloseError {};
-    struct RemoveError {};
-#endif // Platform check.
+void ok_format(FormatWriter* w, const FormatSpec& spec, F64 value) {
+    format_float(w, spec, value, false);
+}
 
-    static Optional<OpenError> open(File* out, const char* path);
-    static Optional<OpenError> open(File* out, StringView path);
+void ok_format(FormatWriter* w, const FormatSpec& spec, StringView value) {
+    // Like with `printf`, a precision cuts strings short.
+    UZ count = value.count;
+    if (spec.precision >= 0) count = min(count, (UZ)spec.precision);
 
-    static bool exists(const char* path);
-    static bool exists(StringView path);
+    format_padded(w, spec, value.data, count, FormatSpec::Align::LEFT);
+}
 
-#if OK_UNIX
-    static File from_fd(int fd, const char *path) {
-        return File{
-            .fd = fd,
-            .offset = 0,
-            .path = path,
-        };
-    }
+void ok_format(FormatWriter* w, const FormatSpec& spec, const char* value) {
+    ok_format(w, spec, StringView{value, strlen(value)});
+}
 
-    static String error_string(Allocator*, IOError);
-#elif OK_WINDOWS
-    static String error_string(Allocator*, DWORD);
-#endif // Platform check.
+void ok_format(FormatWriter* w, const FormatSpec& spec, const String& value) {
+    ok_format(w, spec, value.view());
+}
 
-    void seek_to(U64 offset);
+void ok_format(FormatWriter* w, const FormatSpec& spec, const void* value) {
+    char buf[2 + 16];
+    char* end = buf + sizeof(buf);
+    char* p = end;
 
-    inline void seek_start() {
-        return seek_to(0);
-    }
+    uintptr_t bits = (uintptr_t)value;
+    do {
+        *--p = "0123456789abcdef"[bits & 0xf];
+        bits >>= 4;
+    } while (bits != 0);
 
-    U64 seek_end();
+    *--p = 'x';
+    *--p = '0';
 
-    Optional<ReadError> read(U8* buf, UZ count, UZ* n_read);
-    Optional<ReadError> read_full(Allocator* a, List<U8>* out);
+    format_padded(w, spec, p, end - p, FormatSpec::Align::RIGHT);
+}
 
-    Optional<WriteError> write(const U8 *data, UZ count, UZ *n_written);
+static void flush_string(FormatWriter* w, UZ min_room) {
+    String* s = (String*)w->data;
 
-    inline Optional<WriteError> write(Slice<U8> data) {
-        return write(data.items, data.count, nullptr);
+    s->set_count(s->count() + w->count);
+    w->flushed += w->count;
+    w->count = 0;
+
+    if (min_room > 0) s->reserve_extra(max(min_room, (UZ)64));
+
+    w->buffer = s->get_items() + s->count();
+    w->capacity = s->get_capacity() - s->count();
+}
+
+FormatWriter format_writer_for(String* out) {
+    FormatWriter w{};
+    w.flush = flush_string;
+    w.data = out;
+    w.buffer = out->get_items() + out->count();
+    w.capacity = out->get_capacity() - out->count();
+    return w;
+}
+
+static void flush_string_builder(FormatWriter* w, UZ min_room) {
+    StringBuilder* builder = (StringBuilder*)w->data;
+
+    if (w->count > 0) builder->commit(w->count);
+    w->flushed += w->count;
+    w->count = 0;
+
+    if (min_room > 0) {
+        w->buffer = builder->begin_write(min_room);
+        w->capacity = builder->tail->size - builder->tail->used;
+    } else {
+        w->buffer = nullptr;
+        w->capacity = 0;
     }
+}
 
-    UZ size();
+FormatWriter format_writer_for(StringBuilder* out) {
+    FormatWriter w{};
+    w.flush = flush_string_builder;
+    w.data = out;
+    return w;
+}
 
-    inline Optional<WriteError> write(StringView data) {
-        Slice<const char> chars = data.slice();
-        return write(chars.cast<U8>());
+static void flush_fixed(FormatWriter* w, UZ) {
+    FixedFormatTarget* target = (FixedFormatTarget*)w->data;
+
+    if (w->buffer == target->chars) {
+        target->used = w->count;
+    } else {
+        // Past the end of the caller's buffer, whatever still fits is copied over.
+        UZ n = min(w->count, target->size - target->used);
+        memcpy(target->chars + target->used, w->buffer, n);
+        target->used += n;
     }
 
-    Optional<CloseError> close() const;
+    w->flushed += w->count;
+    w->count = 0;
 
-    Optional<RemoveError> remove();
+    w->buffer = target->scratch;
+    w->capacity = sizeof(target->scratch);
+}
 
-    Optional<IOError> truncate(UZ);
+FormatWriter format_writer_for(FixedFormatTarget* target) {
+    FormatWriter w{};
+    w.flush = flush_fixed;
+    w.data = target;
+    w.buffer = target->chars;
+    w.capacity = target->size;
+    return w;
+}
 
-#if OK_UNIX
-    int fd;
-#elif OK_WINDOWS
-    HANDLE handle;
-#endif // Platform check.
-    UZ offset;
+static void flush_file(FormatWriter* w, UZ) {
+    FileFormatTarget* target = (FileFormatTarget*)w->data;
 
-    const char* path;
-};
+    UZ written = 0;
+    while (written < w->count && !target->error.has_value()) {
+        UZ n = 0;
+        target->error = target->file->write((const U8*)w->buffer + written, w->count - written, &n);
+        if (n == 0) break;
+        written += n;
+    }
 
-// Procedures.
-// NOTE(oleh): These should accept format strings like `std::print`.
-void println(const char*);
-void println(StringView);
-void println(String);
+    w->flushed += w->count;
+    w->count = 0;
+}
 
-void eprintln(const char*);
-void eprintln(String);
-void eprintln(StringView);
+FormatWriter format_writer_for(FileFormatTarget* target) {
+    FormatWriter w{};
+    w.flush = flush_file;
+    w.data = target;
+    w.buffer = target->buffer;
+    w.capacity = sizeof(target->buffer);
+    return w;
+}
 
-String to_string(Allocator*, S32);
-String to_string(Allocator*, U32);
-String to_string(Allocator*, S64);
-String to_string(Allocator*, U64);
+static void flush_log(FormatWriter* w, UZ) {
+    LogFormatTarget* target = (LogFormatTarget*)w->data;
 
-bool parse_int64(StringView, S64*);
+    if (w->count > 0) {
+        if (target->to_stderr) {
+            OK_LOG_ERROR("%.*s", (int)w->count, w->buffer);
+        } else {
+            OK_LOG("%.*s", (int)w->count, w->buffer);
+        }
+    }
 
-Optional<File::OpenError> create_temp_file(File* file);
+    w->flushed += w->count;
+    w->count = 0;
+}
 
-void seed_rand(U64);
-U32 get_rand();
+FormatWriter format_writer_for(LogFormatTarget* target) {
+    FormatWriter w{};
+    w.flush = flush_log;
+    w.data = target;
+    w.buffer = target->buffer;
+    w.capacity = sizeof(target->buffer);
+    return w;
+}
 
-static inline U64 nanos_timestamp() {
-#if OK_UNIX
-    struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    return ts.tv_sec * 1'000'000'000ul + ts.tv_nsec;
-#elif OK_WINDOWS
-    LARGE_INTEGER frequency{};
-    QueryPerformanceFrequency(&frequency);
-    LARGE_INTEGER counter;
-    QueryPerformanceCounter(&counter);
-    return counter.QuadPart / frequency.QuadPart * 1'000'000'000ul;
+static bool _rand_seeded = false;
+
+void seed_rand(U64 seed) {
+#ifndef OK_NO_STDLIB
+    srand(seed);
+#else
+    OK_TODO();
+#endif // OK_NO_STDLIB
+}
+
+// NOTE(oleh): We should probably provide a way to generate cryptographically secure numbers and
+// leave this one for general purpose numbers.
+U32 get_rand() {
+#ifndef OK_NO_STDLIB
+    if (!_rand_seeded) {
+        U64 seed = nanos_timestamp();
+        seed_rand(seed);
+        _rand_seeded = true;
+    }
+
+    return rand();
 #else
     OK_TODO();
-#endif // Platform check.
+#endif // OK_NO_STDLIB
 }
 
-#ifdef OK_IMPLEMENTATION
-#ifdef OK_NO_STDLIB
-    void *memcpy(void *dst, const void *src, UZ count) {
-        for (UZ i = 0; i < count; ++i) {
-            *((U8 *)dst + i) = *((U8 *)src + i);
-        }
-        return dst;
-    }
+Optional<File::OpenError> create_temp_file(File* file) {
+#if OK_UNIX
+    U64 timestamp = nanos_timestamp();
 
-    void *memset(void *ptr, U8 b, UZ c) {
-        for (UZ i = 0; i < c; ++i) {
-            *((U8*)ptr + i) = c;
-        }
-        return ptr;
-    }
+    String file_path = String::alloc(temp_allocator(), "/tmp/");
+    file_path.reserve(13);
 
-    UZ strlen(const char *s) {
-        UZ c = 0;
-        while (*(s + c)) ++c;
-        return c;
+    for (U8 i = 0; i < 8; ++i) {
+        U8 c0 = (timestamp >> (i * 4)) & 15;
+        U8 c1 = (timestamp >> (64 - ((i + 1) * 4))) & 15;
+        U8 c = 'a' + (c0 ^ c1);
+        file_path.push(c);
     }
-#endif // OK_NO_STDLIB
-
-static FixedBufferAllocator temp_allocator_impl{};
 
-Allocator *temp_allocator() {
-    return &temp_allocator_impl;
+    return File::open(file, file_path.cstr());
+#else
+    OK_TODO();
+#endif // Platform check.
 }
 
-static void _init_region(ArenaAllocator::Region* region, UZ size) {
-    region->data = (U8*)OK_ALLOC_PAGE(size);
-    OK_ASSERT(region->data != (void*)-1);
-    region->size = size;
-    region->off = 0;
-    region->next = nullptr;
+// BIT SET IMPLEMENTATION
+BitSet BitSet::alloc(Allocator* a, UZ bit_count) {
+    BitSet bits{};
+    bits.allocator = a;
+    bits.resize(bit_count);
+    return bits;
 }
 
-// ALLOCATORS IMPLEMENTATION
-void* FixedBufferAllocator::raw_alloc(UZ size) {
-    size = align_up(size, sizeof(void*));
+void BitSet::resize(UZ new_bit_count) {
+    UZ word_count = words_for(bit_count);
+    UZ new_word_count = words_for(new_bit_count);
 
-    if (buffer == nullptr) {
-        buffer_size = max(size, OK_PAGE_SIZE * FixedBufferAllocator::DEFAULT_PAGE_COUNT);
-        buffer_size = align_up(buffer_size, OK_PAGE_ALIGN);
-        buffer = OK_ALLOC_PAGE(buffer_size);
-        buffer_off = 0;
+    if (new_word_count > word_capacity) {
+        UZ new_capacity = max(new_word_count, word_capacity * 2, (UZ)1);
+        U64* new_words = allocator->alloc<U64>(new_capacity);
+        OK_ASSERT(new_words != nullptr);
+
+        if (word_count > 0) memcpy(new_words, words, word_count * sizeof(U64));
+        if (word_capacity > 0) allocator->dealloc<U64>(words, word_capacity);
+
+        words = new_words;
+        word_capacity = new_capacity;
     }
 
-    if (size > buffer_size) return nullptr;
+    if (new_word_count > word_count) {
+        memset(words + word_count, 0, (new_word_count - word_count) * sizeof(U64));
+    }
 
-    if (buffer_size - buffer_off < size) {
-        buffer_off = size;
-        return buffer;
+    // Keep the bits past the end cleared when shrinking.
+    if (new_bit_count < bit_count && new_bit_count % WORD_BITS != 0) {
+        words[new_word_count - 1] &= ((U64)1 << (new_bit_count % WORD_BITS)) - 1;
     }
 
-    auto* ptr = (U8*)buffer + buffer_off;
-    buffer_off += size;
-    return (void*)ptr;
+    bit_count = new_bit_count;
 }
 
-void FixedBufferAllocator::raw_dealloc(void* ptr, UZ size) {
-    if (ptr == (void*)((U8*)buffer + buffer_off)) buffer_off -= size;
+BitVector BitVector::from(Allocator* a, const U64* src, UZ bit_count) {
+    BitVector bv{};
+    bv.allocator = a;
+    bv.bit_count = bit_count;
+    bv.word_count = BitSet::words_for(bit_count);
+
+    // Rounded up to whole blocks, so the index never has to look at a partial one.
+    UZ block_count = bv.word_count / BLOCK_WORDS + 1;
+    UZ padded_words = block_count * BLOCK_WORDS;
+
+    bv.words = a->alloc<U64>(padded_words);
+    OK_ASSERT(bv.words != nullptr);
+    if (bv.word_count > 0) memcpy(bv.words, src, bv.word_count * sizeof(U64));
+    memset(bv.words + bv.word_count, 0, (padded_words - bv.word_count) * sizeof(U64));
+
+    if (bit_count % 64 != 0) bv.words[bv.word_count - 1] &= ((U64)1 << (bit_count % 64)) - 1;
+    bv.word_count = padded_words;
+
+    bv.index_count = block_count * 2;
+    bv.index = a->alloc<U64>(bv.index_count);
+    OK_ASSERT(bv.index != nullptr);
+
+    U64 total = 0;
+    for (UZ b = 0; b < block_count; b++) {
+        bv.index[b * 2] = total;
+
+        U64 inner = 0;
+        U64 packed = 0;
+        for (UZ w = 0; w < BLOCK_WORDS; w++) {
+            if (w > 0) packed |= inner << (9 * (w - 1));
+            inner += popcount(bv.words[b * BLOCK_WORDS + w]);
+        }
+
+        bv.index[b * 2 + 1] = packed;
+        total += inner;
+    }
+
+    bv.ones = total;
+    return bv;
 }
 
-ArenaAllocator::Region* ArenaAllocator::alloc_region(UZ region_size) {
-    using Region = ArenaAllocator::Region;
+UZ BitVector::rank1(UZ idx) const {
+    OK_ASSERT(idx <= bit_count);
 
-    region_size = align_up(region_size, OK_PAGE_ALIGN);
+    UZ word = idx / 64;
+    UZ block = word / BLOCK_WORDS;
+    UZ w = word % BLOCK_WORDS;
 
-    Region* current_region = region_pool;
+    UZ result = index[block * 2];
+    if (w > 0) result += (index[block * 2 + 1] >> (9 * (w - 1))) & 0x1ff;
 
-    while (current_region) {
-        if (current_region->size - current_region->off >= sizeof(Region)) {
-            auto* region = (Region*)((U8*)current_region->data + current_region->off);
+    UZ bit = idx % 64;
+    if (bit > 0) result += popcount(words[word] & (((U64)1 << bit) - 1));
 
-            _init_region(region, region_size);
+    return result;
+}
 
-            current_region->off += align_up(sizeof(Region), sizeof(void*));
+UZ BitVector::select1(UZ rank) const {
+    if (rank >= ones) return (UZ)-1;
 
-            return region;
+    // Last block with fewer ones before it than `rank + 1`.
+    UZ lo = 0;
+    UZ hi = index_count / 2;
+    while (hi - lo > 1) {
+        UZ mid = lo + (hi - lo) / 2;
+        if (index[mid * 2] <= rank) {
+            lo = mid;
+        } else {
+            hi = mid;
         }
-
-        current_region = current_region->next;
     }
 
-    current_region = (Region*)OK_ALLOC_SMOL(sizeof(Region));
+    UZ block = lo;
+    rank -= index[block * 2];
 
-    current_region->data = OK_ALLOC_PAGE(OK_PAGE_SIZE);
-    current_region->size = OK_PAGE_SIZE;
-    current_region->off = align_up(sizeof(Region), sizeof(void*));
-    current_region->next = region_pool;
+    U64 packed = index[block * 2 + 1];
+    UZ w = 0;
+    while (w + 1 < BLOCK_WORDS && ((packed >> (9 * w)) & 0x1ff) <= rank) w++;
+    if (w > 0) rank -= (packed >> (9 * (w - 1))) & 0x1ff;
 
-    this->region_pool = current_region;
+    U64 word = words[block * BLOCK_WORDS + w];
 
-    auto* resulting_region = (Region*)current_region->data;
-    _init_region(resulting_region, region_size);
-    return resulting_region;
-}
+    // Skip whole bytes, then clear the low bits one at a time.
+    UZ base = 0;
+    while (true) {
+        UZ byte_ones = popcount(word & 0xff);
+        if (byte_ones > rank) break;
+        rank -= byte_ones;
+        word >>= 8;
+        base += 8;
+    }
 
-void* ArenaAllocator::raw_alloc(UZ size) {
-    void* ptr;
-    UZ region_size;
+    for (; rank > 0; rank--) word &= word - 1;
 
-    ArenaAllocator::Region* region_head = this->head;
+    return (block * BLOCK_WORDS + w) * 64 + base + count_trailing_zeros(word);
+}
 
-    size = align_up(size, sizeof(void*));
+// JSON IMPLEMENTATION
+// Bit `i` of every mask is for byte `i` of a 64 byte block.
+struct _json_block {
+    U64 backslash;
+    U64 quote;
+    // Brackets, colons and commas.
+    U64 op;
+    U64 whitespace;
+    // Below 0x20, which strings can't hold unescaped.
+    U64 control;
+};
 
-    while (region_head != nullptr) {
-        if (region_head->size - region_head->off >= size) {
-            ptr = (void*)((U8*)region_head->data + region_head->off);
-            region_head->off += size;
-            goto end;
-        }
+#if OK_SIMD_ANY
+using _json_simd = _simd_wide;
 
-        region_head = region_head->next;
+// One bit per byte from a comparison, where NEON masks have four.
+static inline U64 _json_bits(_json_simd::Vec v) {
+    U64 mask = _json_simd::mask(v);
+    if constexpr (_json_simd::SHIFT == 2) {
+        mask = (mask >> 3) & 0x1111111111111111ull;
+        mask = (mask | (mask >> 3)) & 0x0303030303030303ull;
+        mask = (mask | (mask >> 6)) & 0x000f000f000f000full;
+        mask = (mask | (mask >> 12)) & 0x000000ff000000ffull;
+        mask = (mask | (mask >> 24)) & 0xffffull;
     }
-
-    region_size = align_up(size, OK_PAGE_ALIGN);
-    region_head = alloc_region(region_size);
-    region_head->next = this->head;
-    this->head = region_head;
-
-    ptr = (void*)((U8*)region_head->data + region_head->off);
-    region_head->off += size;
-
-end:
-    last_alloc_ptr = ptr;
-    return ptr;
+    return mask;
 }
 
-void ArenaAllocator::raw_dealloc(void* ptr, UZ size) {
-    if (last_alloc_ptr == ptr) {
-        size = align_up(size, sizeof(void*));
-        head->off -= size;
-    }
+// With a byte shuffle, a table indexed by the low nibble holds the one char with that nibble
+// to look for, and something that can't match it everywhere else. Other bytes either shuffle
+// to a different value or, with the high bit set, to zero.
+static inline _json_simd::Vec _json_whitespace(_json_simd::Vec v) {
+#if OK_SIMD_AVX2
+    const __m256i table = _mm256_setr_epi8(' ', 100, 100, 100, 17, 100, 113, 2, 100, '\t', '\n', 112, 100, '\r', 100, 100,
+                                           ' ', 100, 100, 100, 17, 100, 113, 2, 100, '\t', '\n', 112, 100, '\r', 100, 100);
+    return _mm256_cmpeq_epi8(_mm256_shuffle_epi8(table, v), v);
+#elif OK_SIMD_SSSE3
+    const __m128i table = _mm_setr_epi8(' ', 100, 100, 100, 17, 100, 113, 2, 100, '\t', '\n', 112, 100, '\r', 100, 100);
+    return _mm_cmpeq_epi8(_mm_shuffle_epi8(table, v), v);
+#elif OK_SIMD_NEON
+    static constexpr U8 table[16] = {' ', 100, 100, 100, 17, 100, 113, 2, 100, '\t', '\n', 112, 100, '\r', 100, 100};
+    return vceqq_u8(vqtbl1q_u8(vld1q_u8(table), vandq_u8(v, vdupq_n_u8(0x0f))), v);
+#else
+    using S = _json_simd;
+    return S::bit_or(S::bit_or(S::eq<U8>(v, S::splat<U8>(' ')), S::eq<U8>(v, S::splat<U8>('\t'))),
+                     S::bit_or(S::eq<U8>(v, S::splat<U8>('\n')), S::eq<U8>(v, S::splat<U8>('\r'))));
+#endif // OK_SIMD_AVX2
 }
 
-void* ArenaAllocator::raw_resize(void* old_ptr, UZ old_size, UZ new_size) {
-    raw_dealloc(old_ptr, old_size);
-    void* new_ptr = raw_alloc(new_size);
-    memcpy(new_ptr, old_ptr, old_size);
-    return new_ptr;
+// `[` and `]` only differ from `{` and `}` in 0x20, so with that bit set there are four chars
+// to look for. A couple of control chars end up matching as well, the grammar pass rejects
+// those.
+static inline _json_simd::Vec _json_op(_json_simd::Vec v) {
+    using S = _json_simd;
+    S::Vec curly = S::bit_or(v, S::splat<U8>(0x20));
+
+#if OK_SIMD_AVX2
+    const __m256i table = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0,
+                                           0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0);
+    return _mm256_cmpeq_epi8(_mm256_shuffle_epi8(table, curly), curly);
+#elif OK_SIMD_SSSE3
+    const __m128i table = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0);
+    return _mm_cmpeq_epi8(_mm_shuffle_epi8(table, curly), curly);
+#elif OK_SIMD_NEON
+    static constexpr U8 table[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0};
+    return vceqq_u8(vqtbl1q_u8(vld1q_u8(table), vandq_u8(curly, vdupq_n_u8(0x0f))), curly);
+#else
+    return S::bit_or(S::bit_or(S::eq<U8>(curly, S::splat<U8>('{')), S::eq<U8>(curly, S::splat<U8>('}'))),
+                     S::bit_or(S::eq<U8>(v, S::splat<U8>(':')), S::eq<U8>(v, S::splat<U8>(','))));
+#endif // OK_SIMD_AVX2
 }
+#endif // OK_SIMD_ANY
 
-// STRING IMPLEMENTATION
+static inline void _json_classify(const U8* p, _json_block* block) {
+    *block = _json_block{};
 
-String String::alloc(Allocator* a, UZ capacity) {
-    String s;
-    s.data = List<char>::alloc(a, capacity + 1);
-    s.data.push(NULL_CHAR);
+#if OK_SIMD_ANY
+    using S = _json_simd;
+    for (UZ i = 0; i < 64; i += S::WIDTH) {
+        S::Vec v = S::load(p + i);
+        block->backslash |= _json_bits(S::eq<U8>(v, S::splat<U8>('\\'))) << i;
+        block->quote |= _json_bits(S::eq<U8>(v, S::splat<U8>('"'))) << i;
+        block->op |= _json_bits(_json_op(v)) << i;
+        block->whitespace |= _json_bits(_json_whitespace(v)) << i;
+        block->control |= _json_bits(S::in_range(v, 0x00, 0x1f)) << i;
+    }
+#else
+    for (UZ i = 0; i < 64; i++) {
+        U64 bit = (U64)1 << i;
+        switch (p[i]) {
+        case '\\': block->backslash |= bit; break;
+        case '"': block->quote |= bit; break;
+        case '{': case '}': case '[': case ']': case ':': case ',': block->op |= bit; break;
+        case ' ': case '\t': case '\n': case '\r': block->whitespace |= bit; break;
+        default: break;
+        }
+        if (p[i] < 0x20) block->control |= bit;
+    }
+#endif // OK_SIMD_ANY
+}
 
-    return s;
+// Bit `i` is the xor of bits 0 to `i`, which is set inside strings, from the opening quote up
+// to but not including the closing one.
+static inline U64 _json_prefix_xor(U64 x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
 }
 
-String String::alloc(Allocator* a, const char* data, UZ data_len) {
-    auto s = String::alloc(a, data_len);
+// The chars escaped by a backslash. Of a run of backslashes every other one escapes the next
+// char, starting from the first, and a run can continue from the previous block.
+static inline U64 _json_escaped(U64 backslash, U64* prev_escaped) {
+    constexpr U64 EVEN_BITS = 0x5555555555555555ull;
 
-    for (UZ i = 0; i < data_len; i++) s.push((char)data[i]);
+    backslash &= ~*prev_escaped;
+    U64 follows_escape = (backslash << 1) | *prev_escaped;
 
-    return s;
+    // Adding the starts of the runs on odd bits carries through them, which flips which bits
+    // of those runs are escapes.
+    U64 odd_starts = backslash & ~EVEN_BITS & ~follows_escape;
+    U64 even_runs;
+    *prev_escaped = __builtin_add_overflow(odd_starts, backslash, &even_runs);
+
+    return (EVEN_BITS ^ (even_runs << 1)) & follows_escape;
 }
 
-String String::alloc(Allocator* a, const char* data) {
-    UZ data_len = strlen((const char*)data);
-    return String::alloc(a, data, data_len);
+static inline U32* _json_flatten(U32* out, U32 base, U64 bits) {
+    while (bits != 0) {
+        *out++ = base + count_trailing_zeros(bits);
+        bits &= bits - 1;
+    }
+    return out;
 }
 
-String String::from(List<char> chars) {
-    String s;
-    s.data = chars;
-    s.data.push('\0');
-    return s;
+static inline bool _json_is_hex4(StringView input, UZ pos) {
+    if (pos + 4 > input.count) return false;
+    for (UZ i = pos; i < pos + 4; i++) {
+        if (!is_char_class(input.data[i], CHAR_HEX_DIGIT)) return false;
+    }
+    return true;
 }
 
-String String::from(List<U8> bytes) {
-    List<char> chars = bytes.cast<char>();
-    return String::from(chars);
+// `pos` is the char after a backslash, which may be one past the end of the input.
+static inline bool _json_is_valid_escape(StringView input, UZ pos) {
+    if (pos >= input.count) return false;
+    switch (input.data[pos]) {
+    case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't': return true;
+    case 'u': return _json_is_hex4(input, pos + 1);
+    default: return false;
+    }
 }
 
-String String::from_cstr_set_allocator(Allocator* allocator, char* cstr, UZ count) {
-    OK_ASSERT(cstr[count] == '\0');
+static Optional<JsonDocument::ParseError> _json_find_structurals(StringView input, U32* out, U32* count,
+                                                                 UZ* error_offset) {
+    const U8* data = (const U8*)input.data;
+    U32* o = out;
 
-    List<char> data{};
-    data.allocator = allocator;
-    data.items = cstr;
-    data.count = count;
-    data.capacity = count;
+    U64 prev_escaped = 0;
+    U64 prev_in_string = 0;
+    U64 prev_scalar = 0;
 
-    String string{};
-    string.data = data;
-    return string;
-}
+    for (UZ base = 0; base < input.count; base += 64) {
+        const U8* p = data + base;
 
-String String::format(Allocator* a, const char* fmt, ...) {
-    va_list sprintf_args;
+        // The last block is padded with whitespace, which changes nothing.
+        U8 padded[64];
+        if (input.count - base < 64) {
+            memset(padded, ' ', sizeof(padded));
+            memcpy(padded, p, input.count - base);
+            p = padded;
+        }
 
-    int buf_size;
-    va_start(sprintf_args, fmt);
-    {
-        char* sprintf_buf = nullptr;
-        buf_size = OK_VSNPRINTF(sprintf_buf, 0, fmt, sprintf_args);
-        OK_ASSERT(buf_size != -1);
+        _json_block block;
+        _json_classify(p, &block);
 
-        buf_size += 1;
-    }
-    va_end(sprintf_args);
+        U64 escaped = _json_escaped(block.backslash, &prev_escaped);
+        U64 quote = block.quote & ~escaped;
+        U64 in_string = _json_prefix_xor(quote) ^ prev_in_string;
+        prev_in_string = (U64)((S64)in_string >> 63);
 
-    auto buf = String::alloc(a, buf_size);
+        U64 invalid = block.control & in_string;
+        for (U64 escapes = escaped & in_string; escapes != 0; escapes &= escapes - 1) {
+            UZ pos = base + count_trailing_zeros(escapes);
+            if (!_json_is_valid_escape(input, pos)) invalid |= (U64)1 << (pos - base);
+        }
+        if (invalid != 0) {
+            *error_offset = base + count_trailing_zeros(invalid);
+            return JsonDocument::ParseError::INVALID_STRING;
+        }
 
-    va_start(sprintf_args, fmt);
-    {
-        int bytes_written = OK_VSNPRINTF((char*)buf.data.items, buf_size, fmt, sprintf_args);
-        OK_ASSERT(bytes_written != -1);
-    }
-    va_end(sprintf_args);
+        // Anything else that isn't whitespace starts a number, a literal or a string, if the
+        // char before it isn't part of one already.
+        U64 scalar = ~(block.op | block.whitespace);
+        U64 nonquote_scalar = scalar & ~quote;
+        U64 follows_scalar = (nonquote_scalar << 1) | prev_scalar;
+        prev_scalar = nonquote_scalar >> 63;
 
-    buf.data.count = buf_size;
+        // Inside strings, only the opening quote counts.
+        U64 structural = (block.op | (scalar & ~follows_scalar)) & ~(in_string ^ quote);
+        o = _json_flatten(o, (U32)base, structural);
+    }
 
-    return buf;
-}
+    if (prev_in_string != 0) {
+        *error_offset = input.count;
+        return JsonDocument::ParseError::UNCLOSED_STRING;
+    }
 
-void String::append(StringView sv) {
-    for (UZ i = 0; i < sv.count; ++i) push(sv.data[i]);
+    *count = (U32)(o - out);
+    return Optional<JsonDocument::ParseError>::empty();
 }
 
-void String::append(String str) {
-    UZ str_count = str.count();
-    for (UZ i = 0; i < str_count; ++i) push(str.data.items[i]);
+static inline bool _json_is_terminator(StringView input, UZ pos) {
+    if (pos == input.count) return true;
+    switch (input.data[pos]) {
+    case ' ': case '\t': case '\n': case '\r': case ',': case ':': case '[': case ']': case '{': case '}': return true;
+    default: return false;
+    }
 }
 
-void String::format_append(const char* fmt, ...) {
-    va_list sprintf_args;
+// Length of the number at `pos`, or 0 if it isn't one.
+static inline UZ _json_number_length(StringView input, UZ pos) {
+    const char* start = input.data + pos;
+    const char* end = input.data + input.count;
+    const char* p = start;
 
-    int required_buf_size;
-    va_start(sprintf_args, fmt);
-    {
-        char* sprintf_buf = nullptr;
-        required_buf_size = OK_VSNPRINTF(sprintf_buf, 0, fmt, sprintf_args);
-        OK_ASSERT(required_buf_size != -1);
+    if (p < end && *p == '-') p++;
+    if (p == end || !is_digit(*p)) return 0;
+    if (*p == '0') {
+        p++;
+    } else {
+        while (p < end && is_digit(*p)) p++;
     }
-    va_end(sprintf_args);
 
-    UZ bytes_needed = count() + required_buf_size;
-    reserve(bytes_needed);
+    if (p < end && *p == '.') {
+        p++;
+        if (p == end || !is_digit(*p)) return 0;
+        while (p < end && is_digit(*p)) p++;
+    }
 
-    va_start(sprintf_args, fmt);
-    {
-        char* buf = (char*)data.items + count();
-        int bytes_written = OK_VSNPRINTF(buf, required_buf_size + 1, fmt, sprintf_args);
-        OK_ASSERT(bytes_written != -1);
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) p++;
+        if (p == end || !is_digit(*p)) return 0;
+        while (p < end && is_digit(*p)) p++;
     }
-    va_end(sprintf_args);
 
-    data.count += required_buf_size;
+    return (UZ)(p - start);
 }
 
-// STRING VIEW IMPLEMENTATION
-String StringView::to_string(Allocator* a) const {
-    return String::alloc(a, data, count);
+static inline Optional<JsonDocument::ParseError> _json_check_atom(StringView input, UZ pos) {
+    char c = input.data[pos];
+
+    if (c == 't' || c == 'f' || c == 'n') {
+        StringView literal = c == 't' ? "true"_sv : c == 'f' ? "false"_sv : "null"_sv;
+        if (input.count - pos < literal.count || memcmp(input.data + pos, literal.data, literal.count) != 0
+            || !_json_is_terminator(input, pos + literal.count)) {
+            return JsonDocument::ParseError::INVALID_LITERAL;
+        }
+        return Optional<JsonDocument::ParseError>::empty();
+    }
+
+    if (c == '-' || is_digit(c)) {
+        UZ length = _json_number_length(input, pos);
+        if (length == 0 || !_json_is_terminator(input, pos + length)) return JsonDocument::ParseError::INVALID_NUMBER;
+        return Optional<JsonDocument::ParseError>::empty();
+    }
+
+    return JsonDocument::ParseError::UNEXPECTED_CHAR;
 }
 
-// FILESYSTEM API IMPLEMENTATION
-Optional<File::OpenError> File::open(File* out, const char* path) {
-#if OK_UNIX
-    int fd = ::open(path, O_RDWR | O_CREAT, 0666);
-    int error = errno;
+// The second pass, which checks the grammar and fills in `closing`.
+static Optional<JsonDocument::ParseError> _json_check_grammar(JsonDocument* doc) {
+    using E = JsonDocument::ParseError;
 
-    if (fd < 0) {
-        switch (error) {
-        case EACCES:       return OpenError::ACCESS_DENIED;
-        case EINVAL:       return OpenError::INVALID_PATH;
-        case EISDIR:       return OpenError::IS_DIRECTORY;
-        case ELOOP:        return OpenError::TOO_MANY_SYMLINKS;
-        case EMFILE:       return OpenError::PROCESS_OPEN_FILES_LIMIT_REACHED;
-        case ENFILE:       return OpenError::SYSTEM_OPEN_FILES_LIMIT_REACHED;
-        case ENAMETOOLONG: return OpenError::PATH_TOO_LONG;
-        case ENOMEM:       return OpenError::KERNEL_OUT_OF_MEMORY;
-        case ENOSPC:       return OpenError::OUT_OF_SPACE;
-        case ENXIO:        return OpenError::IS_SOCKET;
-        case EOVERFLOW:    return OpenError::FILE_TOO_BIG;
-        case EROFS:        return OpenError::READONLY_FILE;
-        case EFAULT:       OK_PANIC_FMT("Parameter 'path' (%p) is not mapped to the current process", (void*)path);
-        default:           OK_PANIC_FMT("Unexpected error: %s", strerror(error));
+    const char* input = doc->input.data;
+    const U32* structurals = doc->structurals;
+    U32 count = doc->structural_count;
+
+    auto at = [&](U32 i) -> char {
+        return i < count ? input[structurals[i]] : '\0';
+    };
+    auto unexpected = [&](U32 i) -> E {
+        if (i >= count) {
+            doc->error_offset = doc->input.count;
+            return count == 0 ? E::EMPTY : E::UNEXPECTED_END;
+        }
+        doc->error_offset = structurals[i];
+        return E::UNEXPECTED_CHAR;
+    };
+
+    // The objects and arrays still open.
+    U32 open[JsonDocument::MAX_DEPTH];
+    bool is_object[JsonDocument::MAX_DEPTH];
+    U32 depth = 0;
+
+    U32 i = 0;
+    for (;;) {
+        // At a value.
+        if (i >= count) return unexpected(i);
+        char c = at(i);
+
+        if (c == '{' || c == '[') {
+            if (depth == JsonDocument::MAX_DEPTH) {
+                doc->error_offset = structurals[i];
+                return E::TOO_DEEP;
+            }
+            open[depth] = i;
+            is_object[depth] = c == '{';
+            depth++;
+            i++;
+
+            // Unless it's empty, on to the first value, which the loop below deals with.
+            if (at(i) != (c == '{' ? '}' : ']')) {
+                if (c == '{') {
+                    if (at(i) != '"') return unexpected(i);
+                    if (at(i + 1) != ':') return unexpected(i + 1);
+                    i += 2;
+                }
+                continue;
+            }
+        } else {
+            if (c != '"') {
+                Optional<E> error = _json_check_atom(doc->input, structurals[i]);
+                if (error) {
+                    doc->error_offset = structurals[i];
+                    return error;
+                }
+            }
+            i++;
+        }
+
+        // After a value, close what ends here, then a comma and the next value.
+        c = at(i);
+        while (depth > 0 && c == (is_object[depth - 1] ? '}' : ']')) {
+            doc->closing[open[--depth]] = i++;
+            c = at(i);
+        }
+        if (depth == 0) break;
+
+        if (c != ',') return unexpected(i);
+        i++;
+        if (is_object[depth - 1]) {
+            if (at(i) != '"') return unexpected(i);
+            if (at(i + 1) != ':') return unexpected(i + 1);
+            i += 2;
         }
     }
 
-    out->offset = 0;
-    out->fd = fd;
-    out->path = path;
+    if (i != count) return unexpected(i);
+    return Optional<E>::empty();
+}
 
-    return {};
-#elif OK_WINDOWS
-    // NOTE: Possible CreateFileA errors
-    //   ERROR_SHARING_VIOLATION
+Optional<JsonDocument::ParseError> JsonDocument::parse(JsonDocument* out, ArenaAllocator* arena, StringView input) {
+    *out = JsonDocument{};
+    out->input = input;
+    out->arena = arena;
 
-    constexpr DWORD FILE_SHARE_MODE = 0;
-    constexpr LPSECURITY_ATTRIBUTES SECURITY_ATTRIBUTES = nullptr;
-    constexpr HANDLE TEMPLATE_FILE = nullptr;
+    // Offsets are 32-bit, with room for the one past the end.
+    if (input.count >= 0xffffffffu) return ParseError::TOO_LARGE;
 
-    HANDLE file_handle = CreateFileA(path,
-                                     GENERIC_READ | GENERIC_WRITE,
-                                     FILE_SHARE_MODE,
-                                     SECURITY_ATTRIBUTES,
-                                     OPEN_ALWAYS,
-                                     FILE_ATTRIBUTE_NORMAL,
-                                     TEMPLATE_FILE);
+    if (!is_valid_utf8(input)) {
+        out->error_offset = 0;
+        return ParseError::INVALID_UTF8;
+    }
 
-    if (file_handle == INVALID_HANDLE_VALUE) {
-        DWORD file_open_error = GetLastError();
-        return file_open_error;
+    // As many as there could be, then shrunk in place to what there are.
+    UZ capacity = input.count + 1;
+    U32* structurals = arena->alloc<U32>(capacity);
+    U32 count = 0;
+
+    Optional<ParseError> error = _json_find_structurals(input, structurals, &count, &out->error_offset);
+    if (error) return error;
+
+    out->structurals = arena->resize<U32>(structurals, capacity, count + 1);
+    out->structurals[count] = (U32)input.count;
+    out->structural_count = count;
+    out->closing = arena->alloc<U32>(max(count, (U32)1));
+
+    return _json_check_grammar(out);
+}
+
+// Where the string, number or literal at `index` ends, the whitespace before the next
+// structural taken off.
+static inline UZ _json_atom_end(const JsonDocument* doc, U32 index) {
+    UZ end = doc->structurals[index + 1];
+    while (end > doc->structurals[index] + 1 && is_whitespace(doc->input.data[end - 1])) end--;
+    return end;
+}
+
+JsonType JsonValue::type() const {
+    switch (doc->input.data[doc->structurals[index]]) {
+    case '{': return JsonType::OBJECT;
+    case '[': return JsonType::ARRAY;
+    case '"': return JsonType::STRING;
+    case 't': case 'f': return JsonType::BOOLEAN;
+    case 'n': return JsonType::NULL_VALUE;
+    default: return JsonType::NUMBER;
     }
+}
 
-    out->handle = file_handle;
-    out->path = path;
-    return {};
-#else
-    OK_TODO();
-#endif // OK_UNIX
+bool JsonValue::get_bool(bool* out) const {
+    if (type() != JsonType::BOOLEAN) return false;
+    *out = doc->input.data[doc->structurals[index]] == 't';
+    return true;
 }
 
-Optional<File::OpenError> File::open(File* out, StringView path) {
-    // FIXME: Temporary allocation in potentially multi-threaded context.
-    char* path_cstr = temp_allocator()->alloc<char>(path.count + 1);
-    memcpy(path_cstr, path.data, path.count);
-    path_cstr[path.count] = '\0';
-    return File::open(out, path_cstr);
+bool JsonValue::get_f64(F64* out) const {
+    return type() == JsonType::NUMBER && parse_f64(raw(), out);
 }
 
-bool File::exists(const char* path) {
-#if OK_UNIX
-    return ::access(path, F_OK) == 0;
-#elif OK_WINDOWS
-    DWORD attrs = GetFileAttributesA(path);
-    return attrs != INVALID_FILE_ATTRIBUTES;
-#else
-    OK_TODO();
-#endif
+StringView JsonValue::raw() const {
+    UZ start = doc->structurals[index];
+    JsonType t = type();
+    if (t == JsonType::OBJECT || t == JsonType::ARRAY) return doc->input.view(start, doc->structurals[doc->closing[index]] + 1);
+    return doc->input.view(start, _json_atom_end(doc, index));
 }
 
-bool File::exists(StringView path) {
-    char* path_cstr = temp_allocator()->alloc<char>(path.count + 1);
-    memcpy(path_cstr, path.data, path.count);
-    path_cstr[path.count] = '\0';
-    return File::exists(path_cstr);
+static inline U32 _json_hex4(const char* p) {
+    U32 value = 0;
+    for (UZ i = 0; i < 4; i++) value = (value << 4) | hex_digit_values[(U8)p[i]];
+    return value;
 }
 
-#if OK_UNIX
-String File::error_string(Allocator* allocator, File::OpenError error) {
-    switch (error) {
-    case IOError::ACCESS_DENIED:                    return String::alloc(allocator, "access denied");
-    case IOError::INVALID_PATH:                     return String::alloc(allocator, "invalid file path");
-    case IOError::IS_DIRECTORY:                     return String::alloc(allocator, "file is a directory");
-    case IOError::TOO_MANY_SYMLINKS:                return String::alloc(allocator, "too many symlinks");
-    case IOError::PROCESS_OPEN_FILES_LIMIT_REACHED: return String::alloc(allocator, "process open files limit has been reached");
-    case IOError::SYSTEM_OPEN_FILES_LIMIT_REACHED:  return String::alloc(allocator, "system open files limit has been reached");
-    case IOError::PATH_TOO_LONG:                    return String::alloc(allocator, "file path is too long");
-    case IOError::KERNEL_OUT_OF_MEMORY:             return String::alloc(allocator, "kernel out of memory");
-    case IOError::OUT_OF_SPACE:                     return String::alloc(allocator, "disk out of space");
-    case IOError::IS_SOCKET:                        return String::alloc(allocator, "file is a socket");
-    case IOError::FILE_TOO_BIG:                     return String::alloc(allocator, "file is too big");
-    case IOError::READONLY_FILE:                    return String::alloc(allocator, "file is readonly");
-    case IOError::IO:                               return String::alloc(allocator, "I/O error");
-    case IOError::NOT_ALLOWED:                      return String::alloc(allocator, "operation not allowed");
-    case IOError::BAD_DATA:                         return String::alloc(allocator, "bad data");
-    case IOError::BAD_FILE_DESCRIPTOR:              return String::alloc(allocator, "bad file descriptor");
-    case IOError::INTERRUPTED_BY_SIGNAL:            return String::alloc(allocator, "interrupted by signal");
-    case IOError::CURRENTLY_IN_USE:                 return String::alloc(allocator, "currently in use");
-    case IOError::READONLY_FS:                      return String::alloc(allocator, "readonly file system");
-    case IOError::DOES_NOT_EXIST:                   return String::alloc(allocator, "does not exist");
+// `chars` has been checked to only hold valid escapes. Never longer than the input, since even
+// a lone surrogate in six chars turns into three bytes of U+FFFD.
+static StringView _json_unescape(ArenaAllocator* arena, const char* chars, UZ count) {
+    char* out = arena->alloc<char>(count);
+    UZ n = 0;
+
+    UZ i = 0;
+    while (i < count) {
+        UZ run = simd_find((const U8*)chars + i, count - i, (U8)'\\');
+        if (run == (UZ)-1) run = count - i;
+        memcpy(out + n, chars + i, run);
+        n += run;
+        i += run;
+        if (i == count) break;
+
+        char c = chars[i + 1];
+        i += 2;
+        switch (c) {
+        case 'b': out[n++] = '\b'; break;
+        case 'f': out[n++] = '\f'; break;
+        case 'n': out[n++] = '\n'; break;
+        case 'r': out[n++] = '\r'; break;
+        case 't': out[n++] = '\t'; break;
+        case 'u': {
+            U32 codepoint = _json_hex4(chars + i);
+            i += 4;
+
+            if (codepoint >= 0xd800 && codepoint <= 0xdfff) {
+                bool paired = codepoint < 0xdc00 && i + 6 <= count && chars[i] == '\\' && chars[i + 1] == 'u';
+                U32 low = paired ? _json_hex4(chars + i + 2) : 0;
+                if (low >= 0xdc00 && low <= 0xdfff) {
+                    codepoint = 0x10000 + ((codepoint - 0xd800) << 10) + (low - 0xdc00);
+                    i += 6;
+                } else {
+                    codepoint = 0xfffd;
+                }
+            }
+
+            n += utf8_encode(codepoint, out + n);
+            break;
+        }
+        default: out[n++] = c; break;
+        }
     }
 
-    OK_UNREACHABLE();
+    return StringView{out, n};
 }
 
-#elif OK_WINDOWS
+bool JsonValue::get_string(StringView* out) const {
+    if (type() != JsonType::STRING) return false;
 
-String File::error_string(Allocator* allocator, DWORD error) {
-    constexpr DWORD LANGUAGE_ID = 0;
-    constexpr DWORD ERROR_BUFFER_SIZE = 1024;
+    UZ start = doc->structurals[index] + 1;
+    UZ count = _json_atom_end(doc, index) - 1 - start;
+    const char* chars = doc->input.data + start;
 
-    char* error_buffer = allocator->alloc<char>(ERROR_BUFFER_SIZE);
+    if (simd_find((const U8*)chars, count, (U8)'\\') == (UZ)-1) {
+        *out = StringView{chars, count};
+    } else {
+        *out = _json_unescape(doc->arena, chars, count);
+    }
+    return true;
+}
 
-    DWORD result = FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM,
-                                 nullptr,
-                                 error,
-                                 LANGUAGE_ID,
-                                 error_buffer,
-                                 ERROR_BUFFER_SIZE,
-                                 nullptr);
+JsonArrayIterator JsonValue::iter_array() const {
+    if (type() != JsonType::ARRAY) return JsonArrayIterator{doc, 0, 0};
 
-    OK_ASSERT(result != 0);
+    U32 end = doc->closing[index];
+    return JsonArrayIterator{doc, index + 1, end};
+}
 
-    return String::from_cstr_set_allocator(allocator, error_buffer, ERROR_BUFFER_SIZE);
+JsonObjectIterator JsonValue::iter_object() const {
+    if (type() != JsonType::OBJECT) return JsonObjectIterator{doc, 0, 0};
+
+    U32 end = doc->closing[index];
+    return JsonObjectIterator{doc, index + 1, end};
 }
 
-#endif // Platform check.
+StringView JsonObjectIterator::key() const {
+    StringView result;
+    JsonValue{doc, index}.get_string(&result);
+    return result;
+}
 
-void File::seek_to(U64 seek_offset) {
-    this->offset = seek_offset;
-#if OK_UNIX
-    OK_ASSERT(lseek(fd, seek_offset, SEEK_SET) != (off_t)-1);
-#elif OK_WINDOWS
-    LONG higher_order_bits = 0;
-    DWORD lower_order_bits = SetFilePointer(handle, (LONG)seek_offset, &higher_order_bits, FILE_BEGIN);
-    OK_ASSERT(lower_order_bits != INVALID_SET_FILE_POINTER);
-#else
-    OK_TODO();
-#endif // Platform check.
+Optional<JsonValue> JsonValue::get(StringView key) const {
+    for (JsonObjectIterator it = iter_object(); it.valid(); it.next()) {
+        if (it.key() == key) return it.value();
+    }
+    return Optional<JsonValue>::empty();
 }
 
-U64 File::seek_end() {
-#if OK_UNIX
-    off_t seek_res = lseek(fd, 0, SEEK_END);
-    OK_ASSERT(seek_res != (off_t)-1);
-    offset = seek_res;
-    return seek_res;
-#elif OK_WINDOWS
-    long higher_order_bits = 0;
-    DWORD lower_order_bits = SetFilePointer(handle, 0, &higher_order_bits, FILE_END);
-    OK_ASSERT(lower_order_bits != INVALID_SET_FILE_POINTER);
+Optional<JsonValue> JsonValue::at(UZ idx) const {
+    UZ i = 0;
+    for (JsonArrayIterator it = iter_array(); it.valid(); it.next()) {
+        if (i++ == idx) return it.value();
+    }
+    return Optional<JsonValue>::empty();
+}
 
-    offset = (U64)higher_order_bits << 32 | (U64)lower_order_bits;
-    return offset;
-#else
-    OK_TODO();
-#endif // Platform check.
+UZ JsonValue::count() const {
+    UZ result = 0;
+    if (type() == JsonType::OBJECT) {
+        for (JsonObjectIterator it = iter_object(); it.valid(); it.next()) result++;
+    } else {
+        for (JsonArrayIterator it = iter_array(); it.valid(); it.next()) result++;
+    }
+    return result;
 }
 
-UZ File::size() {
-    UZ prev_offset = this->offset;
-    U64 res = seek_end();
-    seek_to(prev_offset);
-    return res;
+void JsonWriter::begin_object() {
+    begin_value();
+    out->push('{');
+    depth++;
+    needs_comma = false;
 }
 
-Optional<File::ReadError> File::read(U8* buf, UZ count, UZ* n_read) {
-#if OK_UNIX
-    S64 r = ::read(fd, buf, count);
+void JsonWriter::end_object() {
+    OK_ASSERT(depth > 0);
+    depth--;
+    out->push('}');
+    needs_comma = true;
+}
 
-    if (r < 0) {
-        switch (errno) {
-        case EIO: return ReadError::IO;
-        case EFAULT: OK_PANIC_FMT("The buffer (%p) is mapped outside the current process", (void*)buf);
-        default: OK_UNREACHABLE();
-        }
-    }
+void JsonWriter::begin_array() {
+    begin_value();
+    out->push('[');
+    depth++;
+    needs_comma = false;
+}
 
-    *n_read = r;
+void JsonWriter::end_array() {
+    OK_ASSERT(depth > 0);
+    depth--;
+    out->push(']');
+    needs_comma = true;
+}
 
-    return {};
-#elif OK_WINDOWS
-    bool ok = ReadFile(handle, (void*)buf, (DWORD)count, (LPDWORD)n_read, nullptr);
-    if (!ok) return GetLastError();
-    return {};
-#else
-    OK_TODO();
-#endif // Platform check
+void JsonWriter::key(StringView key) {
+    OK_ASSERT(depth > 0);
+    begin_value();
+    json_write_string(out, key);
+    out->push(':');
+    needs_comma = false;
 }
 
-Optional<File::ReadError> File::read_full(Allocator* a, List<U8>* out) {
-    UZ file_offset = offset;
+void JsonWriter::value_null() {
+    begin_value();
+    out->write("null"_sv);
+    needs_comma = true;
+}
 
-    UZ file_size = size();
-    *out = List<U8>::alloc(a, file_size);
+void JsonWriter::value_bool(bool value) {
+    begin_value();
+    out->write(value ? "true"_sv : "false"_sv);
+    needs_comma = true;
+}
 
-    Optional<ReadError> err{};
+void JsonWriter::value_f64(F64 value) {
+    if (value - value != 0) {
+        value_null();
+        return;
+    }
 
-    seek_start();
-    UZ n_read = 0;
-    err = read(out->items, file_size, &n_read);
+    begin_value();
+    out->commit(format_f64(out->reserve(MAX_FLOAT_CHARS), value));
+    needs_comma = true;
+}
 
-    if (err.has_value()) goto end;
+void JsonWriter::value_string(StringView value) {
+    begin_value();
+    json_write_string(out, value);
+    needs_comma = true;
+}
 
-    out->count = n_read;
+void JsonWriter::value_raw(StringView json) {
+    begin_value();
+    out->write(json);
+    needs_comma = true;
+}
 
-end:
-    seek_to(file_offset);
+// Index of the first char that has to be escaped, or `count`.
+static UZ _json_find_escape(const U8* p, UZ count) {
+    UZ i = 0;
 
-    return err;
+#if OK_SIMD_ANY
+    using S = _simd_wide;
+    auto quote = S::splat<U8>('"');
+    auto backslash = S::splat<U8>('\\');
+    for (; i + S::WIDTH <= count; i += S::WIDTH) {
+        auto v = S::load(p + i);
+        auto special = S::bit_or(S::bit_or(S::eq<U8>(v, quote), S::eq<U8>(v, backslash)), S::in_range(v, 0x00, 0x1f));
+        U64 mask = S::mask(special);
+        if (mask != 0) return i + (count_trailing_zeros(mask) >> S::SHIFT);
+    }
+#endif // OK_SIMD_ANY
+
+    for (; i < count; i++) {
+        if (p[i] == '"' || p[i] == '\\' || p[i] < 0x20) return i;
+    }
+    return count;
 }
 
-Optional<File::RemoveError> File::remove() {
+void json_write_string(FormatWriter* w, StringView value) {
+    const U8* p = (const U8*)value.data;
+
+    w->push('"');
+
+    UZ i = 0;
+    while (i < value.count) {
+        UZ run = _json_find_escape(p + i, value.count - i);
+        w->write(value.data + i, run);
+        i += run;
+        if (i == value.count) break;
+
+        U8 c = p[i++];
+        char* escape = w->reserve(6);
+        escape[0] = '\\';
+        switch (c) {
+        case '"': escape[1] = '"'; w->commit(2); break;
+        case '\\': escape[1] = '\\'; w->commit(2); break;
+        case '\b': escape[1] = 'b'; w->commit(2); break;
+        case '\f': escape[1] = 'f'; w->commit(2); break;
+        case '\n': escape[1] = 'n'; w->commit(2); break;
+        case '\r': escape[1] = 'r'; w->commit(2); break;
+        case '\t': escape[1] = 't'; w->commit(2); break;
+        default:
+            escape[1] = 'u';
+            escape[2] = '0';
+            escape[3] = '0';
+            escape[4] = "0123456789abcdef"[c >> 4];
+            escape[5] = "0123456789abcdef"[c & 0xf];
+            w->commit(6);
+            break;
+        }
+    }
+
+    w->push('"');
+}
+
+// THREADS IMPLEMENTATION
 #if OK_UNIX
-    int res = ::remove(this->path);
-    if (res != -1)     return {};
+static void* _thread_entry(void* arg) {
+    Thread* thread = (Thread*)arg;
+    thread->proc(thread->arg);
+    return nullptr;
+}
+#elif OK_WINDOWS
+static DWORD WINAPI _thread_entry(LPVOID arg) {
+    Thread* thread = (Thread*)arg;
+    thread->proc(thread->arg);
+    return 0;
+}
+#endif // Platform check.
 
-    switch (errno) {
-    case EPERM:
-    case EACCES:       return RemoveError::ACCESS_DENIED;
-    case EBUSY:        return RemoveError::CURRENTLY_IN_USE;
-    case EIO:          return RemoveError::IO;
-    case ENAMETOOLONG: return RemoveError::PATH_TOO_LONG;
-    case ENOTDIR:
-    case ENOENT:       return RemoveError::DOES_NOT_EXIST;
-    case ENOMEM:       return RemoveError::KERNEL_OUT_OF_MEMORY;
-    case EROFS:        return RemoveError::READONLY_FS;
-    default: OK_UNREACHABLE();
-    }
+void Thread::start(Proc thread_proc, void* thread_arg) {
+    proc = thread_proc;
+    arg = thread_arg;
+#if OK_UNIX
+    OK_ASSERT(pthread_create(&handle, nullptr, _thread_entry, this) == 0);
 #elif OK_WINDOWS
-    OK_TODO();
+    handle = CreateThread(nullptr, 0, _thread_entry, this, 0, nullptr);
+    OK_ASSERT(handle != nullptr);
 #else
     OK_TODO();
 #endif // Platform check.
 }
 
-Optional<File::CloseError> File::close() const {
+void Thread::join() {
 #if OK_UNIX
-    int ret = ::close(fd);
-    if (ret == 0) return {};
-
-    switch (ret) {
-    case EBADF:  return CloseError::BAD_FILE_DESCRIPTOR;
-    case EINTR:  return CloseError::INTERRUPTED_BY_SIGNAL;
-    case EIO:    return CloseError::IO;
-    case ENOSPC:
-    case EDQUOT: return CloseError::OUT_OF_SPACE;
-    default: OK_UNREACHABLE();
-    }
+    OK_ASSERT(pthread_join(handle, nullptr) == 0);
 #elif OK_WINDOWS
-    bool ok = CloseHandle(handle);
-    if (ok) return {};
-    return GetLastError();
+    WaitForSingleObject(handle, INFINITE);
+    CloseHandle(handle);
 #else
     OK_TODO();
 #endif // Platform check.
 }
 
-Optional<File::WriteError> File::write(const U8* data, UZ count, UZ *n_written) {
+void Mutex::init() {
 #if OK_UNIX
-    OK_VERIFY(data != nullptr);
+    OK_ASSERT(pthread_mutex_init(&handle, nullptr) == 0);
+#elif OK_WINDOWS
+    InitializeSRWLock(&handle);
+#endif // Platform check.
+}
 
-    S64 ret = ::write(fd, (const void*)data, count);
+void Mutex::deinit() {
+#if OK_UNIX
+    pthread_mutex_destroy(&handle);
+#endif // Platform check.
+}
 
-    if (ret != -1) {
-        if (n_written != nullptr) {
-            *n_written = (UZ) ret;
-        }
+void Mutex::lock() {
+#if OK_UNIX
+    pthread_mutex_lock(&handle);
+#elif OK_WINDOWS
+    AcquireSRWLockExclusive(&handle);
+#endif // Platform check.
+}
 
-        return {};
-    }
+void Mutex::unlock() {
+#if OK_UNIX
+    pthread_mutex_unlock(&handle);
+#elif OK_WINDOWS
+    ReleaseSRWLockExclusive(&handle);
+#endif // Platform check.
+}
 
-    switch (errno) {
-    case EBADF:  return WriteError::NOT_ALLOWED;
-    case ENOSPC: return WriteError::OUT_OF_SPACE;
-    case EINVAL: return WriteError::BAD_DATA;
-    default:     OK_PANIC_FMT("Unhandled error %s", strerror(errno));
-    }
+void CondVar::init() {
+#if OK_UNIX
+    OK_ASSERT(pthread_cond_init(&handle, nullptr) == 0);
 #elif OK_WINDOWS
-    // We first seek to the start of the file, and then set that as the end of file,
-    // so when the write proceeds, it will flush the buffer to disk and set a the new
-    // end of file to the length of the supplied buffer, overriding the file contents
-    // fully.
-    seek_start();
-    SetEndOfFile(handle);
+    InitializeConditionVariable(&handle);
+#endif // Platform check.
+}
 
-    DWORD n_written = 0;
-    bool ok = WriteFile(handle,
-                        data,
-                        (DWORD)count,
-                        &n_written,
-                        nullptr);
+void CondVar::deinit() {
+#if OK_UNIX
+    pthread_cond_destroy(&handle);
+#endif // Platform check.
+}
 
-    if (!ok) return GetLastError();
-    return {};
+void CondVar::wait(Mutex* mutex) {
+#if OK_UNIX
+    pthread_cond_wait(&handle, &mutex->handle);
+#elif OK_WINDOWS
+    SleepConditionVariableSRW(&handle, &mutex->handle, INFINITE, 0);
 #else
-    OK_TODO();
+    OK_UNUSED(mutex);
 #endif // Platform check.
 }
 
-Optional<File::IOError> File::truncate(UZ size) {
+void CondVar::notify_one() {
 #if OK_UNIX
-    int status = ::ftruncate(fd, size);
-    if (status == 0) return {};
+    pthread_cond_signal(&handle);
+#elif OK_WINDOWS
+    WakeConditionVariable(&handle);
+#endif // Platform check.
+}
 
-    switch (errno) {
-    case EACCES:  return IOError::ACCESS_DENIED;
-    case EFBIG:   return IOError::FILE_TOO_BIG;
-    case EINTR:   return IOError::INTERRUPTED_BY_SIGNAL;
-    case EIO:     return IOError::IO;
-    case EISDIR:  return IOError::IS_DIRECTORY;
-    case EPERM:   return IOError::NOT_ALLOWED;
-    case EROFS:   return IOError::READONLY_FS;
-    case ETXTBSY: return IOError::CURRENTLY_IN_USE;
-    case EBADF:   return IOError::BAD_FILE_DESCRIPTOR;
-    case EINVAL:  return IOError::NOT_ALLOWED;
-    default: OK_PANIC_FMT("Unhandled error %s", strerror(errno));
-    }
+void CondVar::notify_all() {
+#if OK_UNIX
+    pthread_cond_broadcast(&handle);
+#elif OK_WINDOWS
+    WakeAllConditionVariable(&handle);
+#endif // Platform check.
+}
 
-    OK_UNREACHABLE();
+UZ hardware_thread_count() {
+#if OK_UNIX
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (UZ)count : 1;
+#elif OK_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
 #else
-    OK_UNUSED(size);
-    OK_TODO();
-#endif // OK_UNIX
+    return 1;
+#endif // Platform check.
 }
 
-// SUBPROCESS API IMPLEMENTATION
-Optional<Command::ExecError> Command::exec() {
+void yield_thread() {
 #if OK_UNIX
-        Optional<ExecError> exec_err{};
-        pid_t child_pid;
+    sched_yield();
+#elif OK_WINDOWS
+    SwitchToThread();
+#endif // Platform check.
+}
 
-        posix_spawn_file_actions_t actions{};
-        posix_spawnattr_t attributes{};
+// THREAD POOL IMPLEMENTATION
+static thread_local ThreadPool::Worker* _current_worker = nullptr;
 
-        int stdin_fds[2];
-        UZ stdin_write_count;
+bool ThreadPool::WorkDeque::push(Task* task) {
+    S64 b = bottom.load(MemoryOrder::RELAXED);
+    S64 t = top.load(MemoryOrder::ACQUIRE);
+    if (b - t >= (S64)CAPACITY) return false;
 
-        int spawn_ret;
-        int child_status;
-        pid_t wait_ret;
+    tasks[b & (CAPACITY - 1)].store(task, MemoryOrder::RELAXED);
+    bottom.store(b + 1, MemoryOrder::RELEASE);
+    return true;
+}
 
-        arg(nullptr);
-        env(nullptr);
+ThreadPool::Task* ThreadPool::WorkDeque::pop() {
+    S64 b = bottom.load(MemoryOrder::RELAXED) - 1;
+    bottom.store(b, MemoryOrder::RELAXED);
+    atomic_fence(MemoryOrder::SEQ_CST);
+    S64 t = top.load(MemoryOrder::RELAXED);
 
-        if (pipe(stdin_fds) < -1) {
-            switch (errno) {
-            case EMFILE: exec_err = ExecError::PROCESS_OPEN_FILE_LIMIT_REACHED; goto cleanup;
-            case ENFILE: exec_err = ExecError::SYSTEM_OPEN_FILE_LIMIT_REACHED; goto cleanup;
-            case EFAULT: OK_UNREACHABLE();
-            default: OK_PANIC_FMT("unhandled error %d", errno);
-            }
-        }
+    if (t > b) {
+        bottom.store(b + 1, MemoryOrder::RELAXED);
+        return nullptr;
+    }
 
-        OK_ASSERT(posix_spawn_file_actions_init(&actions) == 0);
+    Task* task = tasks[b & (CAPACITY - 1)].load(MemoryOrder::RELAXED);
 
-        // Close the write end
-        OK_ASSERT(posix_spawn_file_actions_addclose(&actions, stdin_fds[1]) == 0);
-        // Map the read end to stdin
-        OK_ASSERT(posix_spawn_file_actions_adddup2(&actions, stdin_fds[0], STDIN_FILENO) == 0);
+    // Last task, race the thieves for it.
+    if (t == b) {
+        if (!top.compare_exchange(&t, t + 1, MemoryOrder::SEQ_CST, MemoryOrder::RELAXED)) task = nullptr;
+        bottom.store(b + 1, MemoryOrder::RELAXED);
+    }
 
-        spawn_ret = posix_spawnp(&child_pid, name, &actions, &attributes, args.items, envs.items);
+    return task;
+}
 
-        if (spawn_ret != 0) {
-            switch (spawn_ret) {
-            case E2BIG:    exec_err = ExecError::TOO_BIG; goto cleanup;
+ThreadPool::Task* ThreadPool::WorkDeque::steal() {
+    S64 t = top.load(MemoryOrder::ACQUIRE);
+    atomic_fence(MemoryOrder::SEQ_CST);
+    S64 b = bottom.load(MemoryOrder::ACQUIRE);
+    if (t >= b) return nullptr;
 
-            case EPERM:
-            case EACCES:   exec_err = ExecError::ACCESS_DENIED; goto cleanup;
+    Task* task = tasks[t & (CAPACITY - 1)].load(MemoryOrder::RELAXED);
+    if (!top.compare_exchange(&t, t + 1, MemoryOrder::SEQ_CST, MemoryOrder::RELAXED)) return nullptr;
 
-            case EAGAIN:   exec_err = ExecError::PROCESS_LIMIT_EXCEEDED; goto cleanup;
+    return task;
+}
 
-            case ENOEXEC:
-            case ELIBBAD:
-            case EISDIR:
-            case EINVAL:   exec_err = ExecError::INVALID_EXECUTABLE; goto cleanup;
+static void _run_task(ThreadPool::Task* task) {
+    task->proc(task->data);
+    task->done.store(1, MemoryOrder::RELEASE);
+}
 
-            case EIO:      exec_err = ExecError::IO; goto cleanup;
-            case ELOOP:    exec_err = ExecError::LOOP; goto cleanup;
-            case ENFILE:   exec_err = ExecError::TOO_MANY_FILES; goto cleanup;
-            case ENOENT:   exec_err = ExecError::EXECUTABLE_NOT_FOUND; goto cleanup;
-            case ENOMEM:   exec_err = ExecError::KERNEL_OUT_OF_MEMORY; goto cleanup;
-            case ENOTDIR:  exec_err = ExecError::INVALID_PATH; goto cleanup;
-            case ETXTBSY:  exec_err = ExecError::BUSY; goto cleanup;
-            case EFAULT:   OK_UNREACHABLE();
-            default:       OK_PANIC_FMT("unhandled error %d", spawn_ret);
-            }
-        }
+static ThreadPool::Task* _find_task(ThreadPool::Worker* worker) {
+    ThreadPool::Task* task = worker->deque.pop();
+    if (task != nullptr) return task;
 
-        stdin_write_count = 0;
-        while (stdin_write_count < stdin_data.count) {
-            U8* data = stdin_data.items + stdin_write_count;
-            UZ data_count = stdin_data.count - stdin_write_count;
+    ThreadPool::State* state = worker->state;
+    UZ count = state->worker_count;
+    if (count < 2) return nullptr;
 
-            SZ write_count = write(stdin_fds[1], data, data_count);
-            if (write_count < 0) {
-                switch (errno) {
-                case EFBIG:  exec_err = ExecError::TOO_BIG; goto cleanup;
-                case EIO:    exec_err = ExecError::IO; goto cleanup;
-                case ENOSPC: exec_err = ExecError::OUT_OF_SPACE; goto cleanup;
-                case EPERM:  exec_err = ExecError::ACCESS_DENIED; goto cleanup;
-                case EPIPE:
-                case EBADFD:
-                case EDESTADDRREQ:
-                case EAGAIN:
-                case EDQUOT:
-                case EINVAL:
-                case EINTR:
-                    OK_UNREACHABLE();
-                default: OK_PANIC_FMT("unhandled error %d", errno);
-                }
-            }
+    // xorshift, just to spread the thieves over the victims.
+    worker->rng ^= worker->rng << 13;
+    worker->rng ^= worker->rng >> 7;
+    worker->rng ^= worker->rng << 17;
 
-            stdin_write_count += write_count;
-        }
+    UZ start = worker->rng % count;
+    for (UZ i = 0; i < count; i++) {
+        ThreadPool::Worker* victim = &state->workers[(start + i) % count];
+        if (victim == worker) continue;
 
-        OK_ASSERT(close(stdin_fds[1]) == 0);
+        task = victim->deque.steal();
+        if (task != nullptr) return task;
+    }
 
-        wait_ret = waitpid(child_pid, &child_status, 0);
-        if (wait_ret == (pid_t)-1) OK_UNREACHABLE();
+    return nullptr;
+}
 
-        if (WIFEXITED(child_status)) {
-            exit_code = WEXITSTATUS(child_status);
-            goto cleanup;
+static bool _has_pending_tasks(ThreadPool::State* state) {
+    for (UZ i = 0; i < state->worker_count; i++) {
+        if (!state->workers[i].deque.is_empty()) return true;
+    }
+    return false;
+}
+
+static constexpr UZ THREAD_POOL_SPIN_ROUNDS = 64;
+
+static void _worker_main(void* arg) {
+    ThreadPool::Worker* worker = (ThreadPool::Worker*)arg;
+    ThreadPool::State* state = worker->state;
+    _current_worker = worker;
+
+    UZ idle_rounds = 0;
+    while (state->shutdown.load(MemoryOrder::ACQUIRE) == 0) {
+        ThreadPool::Task* task = _find_task(worker);
+        if (task != nullptr) {
+            _run_task(task);
+            idle_rounds = 0;
+            continue;
         }
 
-        if (WIFSIGNALED(child_status)) {
-            term_signal_num = WTERMSIG(child_status);
-            exec_err = ExecError::TERMINATED_BY_SIGNAL;
-            goto cleanup;
+        if (++idle_rounds < THREAD_POOL_SPIN_ROUNDS) {
+            cpu_relax();
+            continue;
         }
 
-        if (WIFSTOPPED(child_status)) {
-            stop_signal_num = WSTOPSIG(child_status);
-            exec_err = ExecError::STOPPED;
-            goto cleanup;
+        // NOTE: Registering as a sleeper before the final check pairs with the fence in
+        // `wake_one`: either we see the new task here, or the pusher sees us sleeping.
+        state->sleep_mutex.lock();
+        state->sleepers.fetch_add(1);
+        atomic_fence(MemoryOrder::SEQ_CST);
+
+        if (state->shutdown.load() == 0 && !_has_pending_tasks(state)) {
+            state->sleep_cond.wait(&state->sleep_mutex);
         }
 
-cleanup:
-    posix_spawn_file_actions_destroy(&actions);
+        state->sleepers.fetch_sub(1);
+        state->sleep_mutex.unlock();
+        idle_rounds = 0;
+    }
 
-    return exec_err;
-#else
-        OK_TODO();
-#endif // OS guard
+    _current_worker = nullptr;
 }
 
-// PROCEDURES IMPLEMENTATION
-String to_string(Allocator* allocator, U32 value) {
-    String s = String::alloc(allocator, 10);
+ThreadPool ThreadPool::alloc(Allocator* a, UZ thread_count) {
+    if (thread_count == 0) thread_count = hardware_thread_count();
 
-    U32 value_copy = value;
-    int idx = 0;
+    ThreadPool pool{};
+    pool.allocator = a;
+    pool.state = a->alloc<State>();
+    OK_ASSERT(pool.state != nullptr);
+    memset((void*)pool.state, 0, sizeof(State));
 
-    while (value_copy /= 10) idx++;
+    State* state = pool.state;
+    state->worker_count = thread_count;
+    state->workers_memory_size = sizeof(Worker) * thread_count + alignof(Worker);
+    state->workers_memory = a->raw_alloc(state->workers_memory_size);
+    OK_ASSERT(state->workers_memory != nullptr);
+    memset(state->workers_memory, 0, state->workers_memory_size);
+    state->workers = (Worker*)align_up((uintptr_t)state->workers_memory, alignof(Worker));
 
-    UZ string_count = idx + 1;
+    state->sleep_mutex.init();
+    state->sleep_cond.init();
+    state->external_mutex.init();
 
-    do {
-        char digit = value % 10;
-        value /= 10;
-        s.data.items[idx--] = digit + '0';
-    } while (value != 0);
+    for (UZ i = 0; i < thread_count; i++) {
+        Worker* worker = &state->workers[i];
+        worker->state = state;
+        worker->index = i;
+        worker->rng = 0x9e3779b97f4a7c15ull * (i + 1);
+    }
 
-    s.data.items[string_count] = String::NULL_CHAR;
-    s.data.count = string_count + 1;
+    // Worker 0 is whichever thread calls into the pool.
+    for (UZ i = 1; i < thread_count; i++) {
+        state->workers[i].thread.start(_worker_main, &state->workers[i]);
+    }
 
-    return s;
+    return pool;
 }
 
-String to_string(Allocator* allocator, S32 input_value) {
-    String s = String::alloc(allocator, 10);
+void ThreadPool::dealloc() {
+    if (state == nullptr) return;
+
+    state->sleep_mutex.lock();
+    state->shutdown.store(1);
+    state->sleep_cond.notify_all();
+    state->sleep_mutex.unlock();
+
+    for (UZ i = 1; i < state->worker_count; i++) state->workers[i].thread.join();
 
-    U32 value = input_value;
-    int idx = 0;
+    state->sleep_mutex.deinit();
+    state->sleep_cond.deinit();
+    state->external_mutex.deinit();
 
-    if (input_value < 0) {
-        s.push('-');
-        value = (U32)-input_value;
-        idx = 1;
+    allocator->raw_dealloc(state->workers_memory, state->workers_memory_size);
+    allocator->dealloc<State>(state, 1);
+    memset((void*)this, 0, sizeof(*this));
+}
+
+ThreadPool::Worker* ThreadPool::current_worker() const {
+    for (Worker* worker = _current_worker; worker != nullptr; worker = worker->outer) {
+        if (worker->state == state) return worker;
     }
+    return nullptr;
+}
 
-    U32 value_copy = value;
+void ThreadPool::enter() {
+    state->external_mutex.lock();
+    state->workers[0].outer = _current_worker;
+    _current_worker = &state->workers[0];
+}
 
-    while (value_copy /= 10) idx++;
+void ThreadPool::leave() {
+    _current_worker = state->workers[0].outer;
+    state->workers[0].outer = nullptr;
+    state->external_mutex.unlock();
+}
 
-    UZ string_count = idx + 1;
+void ThreadPool::wake_one() {
+    atomic_fence(MemoryOrder::SEQ_CST);
+    if (state->sleepers.load(MemoryOrder::RELAXED) == 0) return;
 
-    do {
-        char digit = value % 10;
-        value /= 10;
-        s.data.items[idx--] = digit + '0';
-    } while (value != 0);
+    state->sleep_mutex.lock();
+    state->sleep_cond.notify_one();
+    state->sleep_mutex.unlock();
+}
 
-    s.data.items[string_count] = String::NULL_CHAR;
-    s.data.count = string_count + 1;
+void ThreadPool::wait_for(Worker* worker, Task* task) {
+    UZ idle_rounds = 0;
 
-    return s;
+    while (task->done.load(MemoryOrder::ACQUIRE) == 0) {
+        Task* other = _find_task(worker);
+        if (other != nullptr) {
+            _run_task(other);
+            idle_rounds = 0;
+        } else if (++idle_rounds < THREAD_POOL_SPIN_ROUNDS) {
+            cpu_relax();
+        } else {
+            yield_thread();
+        }
+    }
 }
 
-String to_string(Allocator* allocator, U64 value) {
-    String s = String::alloc(allocator, 10);
+// STRING INTERNER IMPLEMENTATION
+StringInterner StringInterner::alloc(Allocator* a, bool concurrent) {
+    StringInterner interner{};
+    interner.allocator = a;
+    interner.concurrent = concurrent;
+    interner.shard_count = concurrent ? SHARD_COUNT : 1;
 
-    U64 value_copy = value;
-    int idx = 0;
+    interner.shards_memory_size = sizeof(Shard) * interner.shard_count + alignof(Shard);
+    interner.shards_memory = a->raw_alloc(interner.shards_memory_size);
+    OK_ASSERT(interner.shards_memory != nullptr);
+    memset(interner.shards_memory, 0, interner.shards_memory_size);
+    interner.shards = (Shard*)align_up((uintptr_t)interner.shards_memory, alignof(Shard));
 
-    while (value_copy /= 10) idx++;
+    if (concurrent) {
+        for (UZ i = 0; i < interner.shard_count; i++) interner.shards[i].mutex.init();
 
-    UZ string_count = idx + 1;
+        interner.allocator_mutex = a->alloc<Mutex>();
+        OK_ASSERT(interner.allocator_mutex != nullptr);
+        interner.allocator_mutex->init();
+    }
 
-    do {
-        char digit = value % 10;
-        value /= 10;
-        s.data.items[idx--] = digit + '0';
-    } while (value != 0);
+    return interner;
+}
 
-    s.data.items[string_count] = String::NULL_CHAR;
-    s.data.count = string_count + 1;
+void* StringInterner::locked_alloc(UZ size) {
+    if (concurrent) allocator_mutex->lock();
+    void* ptr = allocator->raw_alloc(size);
+    if (concurrent) allocator_mutex->unlock();
 
-    return s;
+    OK_ASSERT(ptr != nullptr);
+    return ptr;
 }
 
-String to_string(Allocator* allocator, S64 input_value) {
-    String s = String::alloc(allocator, 10);
+void StringInterner::locked_dealloc(void* ptr, UZ size) {
+    if (concurrent) allocator_mutex->lock();
+    allocator->raw_dealloc(ptr, size);
+    if (concurrent) allocator_mutex->unlock();
+}
 
-    U64 value = input_value;
-    int idx = 0;
+StringInterner::Shard* StringInterner::shard_for(U64 hash) {
+    // The low bits pick the shard, the high ones the slot inside it.
+    return shards + (hash & (shard_count - 1));
+}
 
-    if (input_value < 0) {
-        s.push('-');
-        value = -input_value;
-        idx = 1;
-    }
+Optional<U32> StringInterner::find_in_shard(Shard* shard, StringView string, U64 hash) const {
+    if (shard->capacity == 0) return Optional<U32>::empty();
 
-    U64 value_copy = value;
+    U64 tag = hash >> 32;
+    UZ mask = shard->capacity - 1;
 
-    while (value_copy /= 10) idx++;
+    for (UZ idx = tag & mask;; idx = (idx + 1) & mask) {
+        U64 slot = shard->slots[idx];
+        if (slot == 0) return Optional<U32>::empty();
 
-    UZ string_count = idx + 1;
+        if ((slot >> 32) == tag) {
+            U32 id = (U32)slot - 1;
+            StringView candidate = stored_view(id);
+            if (candidate.count == string.count && simd_equal(candidate.data, string.data, string.count)) {
+                return id;
+            }
+        }
+    }
+}
 
-    do {
-        char digit = value % 10;
-        value /= 10;
-        s.data.items[idx--] = digit + '0';
-    } while (value != 0);
+StringView* StringInterner::slot_for_id(U32 id) {
+    UZ k = (UZ)id + ((UZ)1 << FIRST_SEGMENT_BITS);
+    UZ segment = 63 - count_leading_zeros(k) - FIRST_SEGMENT_BITS;
 
-    s.data.items[string_count] = String::NULL_CHAR;
-    s.data.count = string_count + 1;
+    StringView* views = segments[segment].load(MemoryOrder::ACQUIRE);
+    if (views == nullptr) {
+        UZ segment_size = (UZ)1 << (segment + FIRST_SEGMENT_BITS);
+        StringView* fresh = (StringView*)locked_alloc(segment_size * sizeof(StringView));
 
-    return s;
+        // Whoever loses the race hands its segment back.
+        if (segments[segment].compare_exchange(&views, fresh, MemoryOrder::ACQ_REL, MemoryOrder::ACQUIRE)) {
+            views = fresh;
+        } else {
+            locked_dealloc(fresh, segment_size * sizeof(StringView));
+        }
+    }
+
+    return views + (k - ((UZ)1 << (segment + FIRST_SEGMENT_BITS)));
 }
 
-bool parse_int64(StringView source, S64* out) {
-    if (source.count == 0) return false;
+U32 StringInterner::intern(StringView string) {
+    U64 hash = hash::murmur64(string);
+    Shard* shard = shard_for(hash);
 
-    S64 result = 0;
-    UZ coef = 1;
+    if (concurrent) shard->mutex.lock();
 
-    for (intptr_t i = source.count - 1; i > 0; --i) {
-        auto c = source[i];
-        if (!is_digit(c)) return false;
+    Optional<U32> existing = find_in_shard(shard, string, hash);
+    if (existing.has_value()) {
+        if (concurrent) shard->mutex.unlock();
 
-        U8 digit = c - '0';
-        result += digit * coef;
-        coef *= 10;
+        // The thread that added it may not have published it yet.
+        wait_until_published(existing.get_unchecked() + 1);
+        return existing.get_unchecked();
     }
 
-    if (is_digit(source[0])) result += (source[0] - '0') * coef;
-    else if (source[0] == '-') result = -result;
-    else return false;
+    // Copy the bytes into the shard's current chunk, or start a new one.
+    UZ needed = string.count + 1;
+    Chunk* chunk = shard->chunks;
+    if (chunk == nullptr || chunk->size - chunk->used < needed) {
+        UZ chunk_size = max(CHUNK_SIZE, needed + sizeof(Chunk));
+        chunk = (Chunk*)locked_alloc(chunk_size);
 
-    *out = result;
+        chunk->next = shard->chunks;
+        chunk->size = chunk_size;
+        chunk->used = sizeof(Chunk);
+        shard->chunks = chunk;
+    }
 
-    return true;
-}
+    char* bytes = (char*)chunk + chunk->used;
+    if (string.count > 0) memcpy(bytes, string.data, string.count);
+    bytes[string.count] = '\0';
+    chunk->used += needed;
 
-void println(const char* msg) {
-    OK_LOG("%s\n", msg);
-}
+    U32 id = next_id.fetch_add(1, MemoryOrder::RELAXED);
+    OK_ASSERT(id != (U32)-1);
+    *slot_for_id(id) = StringView{bytes, string.count};
 
-void println(StringView sv) {
-    OK_LOG(OK_SV_FMT "\n", OK_SV_ARG(sv));
-}
+    if ((shard->count + 1) * 4 > shard->capacity * 3) {
+        UZ new_capacity = max(shard->capacity * 2, (UZ)64);
+        U64* new_slots = (U64*)locked_alloc(new_capacity * sizeof(U64));
+        memset(new_slots, 0, new_capacity * sizeof(U64));
 
-void println(String string) {
-    OK_LOG("%s\n", string.cstr());
-}
+        for (UZ i = 0; i < shard->capacity; i++) {
+            U64 slot = shard->slots[i];
+            if (slot == 0) continue;
 
-void eprintln(const char* msg) {
-    OK_LOG_ERROR("%s\n", msg);
-}
+            UZ idx = (slot >> 32) & (new_capacity - 1);
+            while (new_slots[idx] != 0) idx = (idx + 1) & (new_capacity - 1);
+            new_slots[idx] = slot;
+        }
 
-void eprintln(StringView sv) {
-    OK_LOG_ERROR(OK_SV_FMT "\n", OK_SV_ARG(sv));
-}
+        if (shard->capacity > 0) locked_dealloc(shard->slots, shard->capacity * sizeof(U64));
+        shard->slots = new_slots;
+        shard->capacity = new_capacity;
+    }
 
-void eprintln(String string) {
-    OK_LOG_ERROR("%s\n", string.cstr());
-}
+    U64 tag = hash >> 32;
+    UZ mask = shard->capacity - 1;
+    UZ idx = tag & mask;
+    while (shard->slots[idx] != 0) idx = (idx + 1) & mask;
+    shard->slots[idx] = (tag << 32) | ((U64)id + 1);
+    shard->count++;
 
-bool is_whitespace(char c) {
-    return c == '\t' ||
-           c == '\n' ||
-           c == '\v' ||
-           c == '\r' ||
-           c == ' ';
-}
+    if (concurrent) shard->mutex.unlock();
 
-bool is_digit(char c) {
-    return c >= '0' && c <= '9';
+    // NOTE: Publishing waits for the ids before this one. That happens outside the shard
+    // lock, so the threads that own those ids never wait on this one.
+    wait_until_published(id);
+    published.store(id + 1, MemoryOrder::RELEASE);
+    return id;
 }
 
-bool is_alpha(char c) {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+void StringInterner::wait_until_published(U32 count) {
+    for (UZ rounds = 0; published.load(MemoryOrder::ACQUIRE) < count; rounds++) {
+        if (rounds < PUBLISH_SPIN_ROUNDS) {
+            cpu_relax();
+        } else {
+            yield_thread();
+        }
+    }
 }
 
-static bool _rand_seeded = false;
+Optional<U32> StringInterner::lookup(StringView string) {
+    U64 hash = hash::murmur64(string);
+    Shard* shard = shard_for(hash);
 
-void seed_rand(U64 seed) {
-#ifndef OK_NO_STDLIB
-    srand(seed);
-#else
-    OK_TODO();
-#endif // OK_NO_STDLIB
+    if (concurrent) shard->mutex.lock();
+    Optional<U32> result = find_in_shard(shard, string, hash);
+    if (concurrent) shard->mutex.unlock();
+
+    return result;
 }
 
-// NOTE(oleh): We should probably provide a way to generate cryptographically secure numbers and
-// leave this one for general purpose numbers.
-U32 get_rand() {
-#ifndef OK_NO_STDLIB
-    if (!_rand_seeded) {
-        U64 seed = nanos_timestamp();
-        seed_rand(seed);
-        _rand_seeded = true;
-    }
+void StringInterner::dealloc() {
+    if (allocator == nullptr) return;
 
-    return rand();
-#else
-    OK_TODO();
-#endif // OK_NO_STDLIB
-}
+    for (UZ i = 0; i < shard_count; i++) {
+        Shard* shard = shards + i;
 
-Optional<File::OpenError> create_temp_file(File* file) {
-#if OK_UNIX
-    U64 timestamp = nanos_timestamp();
+        Chunk* chunk = shard->chunks;
+        while (chunk != nullptr) {
+            Chunk* next = chunk->next;
+            allocator->raw_dealloc(chunk, chunk->size);
+            chunk = next;
+        }
 
-    String file_path = String::alloc(temp_allocator(), "/tmp/");
-    file_path.reserve(13);
+        if (shard->capacity > 0) allocator->dealloc<U64>(shard->slots, shard->capacity);
+        if (concurrent) shard->mutex.deinit();
+    }
+    allocator->raw_dealloc(shards_memory, shards_memory_size);
 
-    for (U8 i = 0; i < 8; ++i) {
-        U8 c0 = (timestamp >> (i * 4)) & 15;
-        U8 c1 = (timestamp >> (64 - ((i + 1) * 4))) & 15;
-        U8 c = 'a' + (c0 ^ c1);
-        file_path.push(c);
+    if (concurrent) {
+        allocator_mutex->deinit();
+        allocator->dealloc<Mutex>(allocator_mutex, 1);
     }
 
-    return File::open(file, file_path.cstr());
-#else
-    OK_TODO();
-#endif // Platform check.
+    for (UZ segment = 0; segment < SEGMENT_COUNT; segment++) {
+        StringView* views = segments[segment].load(MemoryOrder::RELAXED);
+        if (views != nullptr) allocator->dealloc<StringView>(views, (UZ)1 << (segment + FIRST_SEGMENT_BITS));
+    }
+
+    memset((void*)this, 0, sizeof(*this));
 }
 
 // HASHES IMPLEMENTATION
@@ -2818,6 +12604,40 @@ U64 fnv1(StringView sv) {
 
     return hash;
 }
+
+U64 murmur64(StringView sv, U64 seed) {
+    constexpr const U64 m = 0xC6A4A7935BD1E995;
+    constexpr const int r = 47;
+
+    U64 hash = seed ^ (sv.count * m);
+
+    const char* data = sv.data;
+    UZ word_count = sv.count / 8;
+    for (UZ i = 0; i < word_count; ++i) {
+        U64 k;
+        memcpy(&k, data + i * 8, sizeof(k));
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        hash ^= k;
+        hash *= m;
+    }
+
+    UZ tail = sv.count & 7;
+    if (tail != 0) {
+        const U8* bytes = (const U8*)data + word_count * 8;
+        for (UZ i = tail; i > 0; --i) hash ^= (U64)bytes[i - 1] << (8 * (i - 1));
+        hash *= m;
+    }
+
+    hash ^= hash >> r;
+    hash *= m;
+    hash ^= hash >> r;
+
+    return hash;
+}
 };
 
 #endif
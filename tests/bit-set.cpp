@@ -0,0 +1,130 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "random.hpp"
+
+using namespace ok;
+
+int main() {
+    ArenaAllocator arena{};
+
+    FixedBitSet<130> fixed{};
+    OK_ASSERT(!fixed.any());
+    OK_ASSERT(fixed.find_next_set(0) == (UZ)-1);
+    OK_ASSERT(fixed.find_next_clear(0) == 0);
+
+    fixed.set(0);
+    fixed.set(64);
+    fixed.set(129);
+    OK_ASSERT(fixed.get(64));
+    OK_ASSERT(!fixed.get(63));
+    OK_ASSERT(fixed.count_ones() == 3);
+    OK_ASSERT(fixed.find_next_set(1) == 64);
+    OK_ASSERT(fixed.find_next_set(65) == 129);
+    OK_ASSERT(fixed.find_next_clear(0) == 1);
+    OK_ASSERT(!fixed.test_and_set(5));
+    OK_ASSERT(fixed.test_and_set(5));
+
+    fixed.flip(0);
+    OK_ASSERT(!fixed.get(0));
+
+    // Filling must not leak into the padding of the last word.
+    fixed.fill();
+    OK_ASSERT(fixed.count_ones() == 130);
+    OK_ASSERT(fixed.find_next_clear(0) == (UZ)-1);
+    fixed.clear();
+    OK_ASSERT(fixed.count_ones() == 0);
+
+    BitSet growable = BitSet::alloc(&arena);
+    for (UZ i = 0; i < 1000; i++) growable.push(i % 3 == 0);
+    OK_ASSERT(growable.get_bit_count() == 1000);
+    OK_ASSERT(growable.count_ones() == 334);
+
+    growable.resize(100);
+    OK_ASSERT(growable.count_ones() == 34);
+    growable.resize(1000);
+    OK_ASSERT(growable.count_ones() == 34);
+    OK_ASSERT(growable.find_next_set(100) == (UZ)-1);
+
+    // Bulk operations against a plain bool reference, with sizes around the SIMD widths.
+    const UZ sizes[] = {1, 63, 64, 65, 255, 256, 257, 1000, 4099};
+    for (UZ bit_count : sizes) {
+        BitSet a = BitSet::alloc(&arena, bit_count);
+        BitSet b = BitSet::alloc(&arena, bit_count);
+        bool* ra = arena.alloc<bool>(bit_count);
+        bool* rb = arena.alloc<bool>(bit_count);
+
+        for (UZ i = 0; i < bit_count; i++) {
+            ra[i] = next_random() % 3 == 0;
+            rb[i] = next_random() % 2 == 0;
+            a.assign(i, ra[i]);
+            b.assign(i, rb[i]);
+        }
+
+        for (int op = 0; op < 4; op++) {
+            switch (op) {
+            case 0: a.and_with(b); break;
+            case 1: a.or_with(b); break;
+            case 2: a.xor_with(b); break;
+            case 3: a.andnot_with(b); break;
+            }
+
+            UZ expected_ones = 0;
+            for (UZ i = 0; i < bit_count; i++) {
+                switch (op) {
+                case 0: ra[i] = ra[i] && rb[i]; break;
+                case 1: ra[i] = ra[i] || rb[i]; break;
+                case 2: ra[i] = ra[i] != rb[i]; break;
+                case 3: ra[i] = ra[i] && !rb[i]; break;
+                }
+                OK_ASSERT(a.get(i) == ra[i]);
+                expected_ones += ra[i];
+            }
+            OK_ASSERT(a.count_ones() == expected_ones);
+        }
+
+        UZ visited = 0;
+        UZ prev = (UZ)-1;
+        a.for_each_set([&](UZ idx) {
+            OK_ASSERT(ra[idx]);
+            OK_ASSERT(prev == (UZ)-1 || idx > prev);
+            prev = idx;
+            visited++;
+        });
+        OK_ASSERT(visited == a.count_ones());
+
+        UZ idx = a.find_next_set(0);
+        for (UZ i = 0; i < bit_count; i++) {
+            if (ra[i]) {
+                OK_ASSERT(idx == i);
+                idx = a.find_next_set(i + 1);
+            }
+        }
+        OK_ASSERT(idx == (UZ)-1);
+
+        UZ expected_ones = a.count_ones();
+        BitVector bv = BitVector::from(&arena, a);
+        OK_ASSERT(bv.count_ones() == expected_ones);
+
+        UZ rank = 0;
+        for (UZ i = 0; i < bit_count; i++) {
+            OK_ASSERT(bv.rank1(i) == rank);
+            OK_ASSERT(bv.rank0(i) == i - rank);
+            if (ra[i]) {
+                OK_ASSERT(bv.select1(rank) == i);
+                rank++;
+            }
+        }
+        OK_ASSERT(bv.rank1(bit_count) == rank);
+        OK_ASSERT(bv.select1(rank) == (UZ)-1);
+    }
+
+    // Dense blocks exercise the 9-bit sub-counts at their upper end.
+    FixedBitSet<2048> dense{};
+    dense.fill();
+    BitVector bv = BitVector::from(&arena, dense);
+    OK_ASSERT(bv.rank1(2048) == 2048);
+    OK_ASSERT(bv.rank1(1000) == 1000);
+    OK_ASSERT(bv.select1(1537) == 1537);
+
+    return 0;
+}
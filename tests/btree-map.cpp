@@ -0,0 +1,113 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+int main() {
+    ArenaAllocator arena{};
+    PoolAllocator pool{&arena, BTreeMap<U32, U32>::NODE_SIZE};
+
+    auto map = BTreeMap<U32, U32>::alloc(&pool);
+    OK_ASSERT(!map.begin().valid());
+    OK_ASSERT(!map.has(1));
+
+    // Enough keys, in a scrambled order, to grow the tree a few levels deep.
+    const U32 n = 5000;
+    for (U32 i = 0; i < n; i++) {
+        U32 key = (i * 7919) % n;
+        map.put(key, key * 2);
+    }
+    OK_ASSERT(map.get_count() == n);
+
+    map.put(42, 1);
+    OK_ASSERT(map.get_count() == n);
+    OK_ASSERT(map.get(42).get_unchecked() == 1);
+    map.get_ref(42).get_unchecked() = 84;
+
+    U32 expected = 0;
+    for (auto it = map.begin(); it.valid(); it.next()) {
+        OK_ASSERT(it.key() == expected);
+        OK_ASSERT(it.value() == expected * 2);
+        expected++;
+    }
+    OK_ASSERT(expected == n);
+
+    // Values are writable through a mutable iterator, but not through a const one.
+    const auto first = map.begin();
+    static_assert(is_same<decltype(first.value()), const U32&>);
+    for (auto it = map.begin(); it.valid(); it.next()) it.value() += 1;
+    for (auto it = map.begin(); it.valid(); it.next()) it.value() -= 1;
+    OK_ASSERT(map.get(42).get_unchecked() == 84);
+
+    // A const map only hands out const values.
+    const BTreeMap<U32, U32>& readonly = map;
+    auto readonly_it = readonly.lower_bound(42);
+    static_assert(is_same<decltype(readonly_it), BTreeMap<U32, U32>::ConstIterator>);
+    static_assert(is_same<decltype(readonly_it.value()), const U32&>);
+    OK_ASSERT(readonly_it.valid() && readonly_it.value() == 84);
+    UZ readonly_visited = 0;
+    readonly.for_each_in_range(40, 44, [&](const U32&, auto& value) {
+        static_assert(is_same<decltype(value), const U32&>);
+        readonly_visited++;
+    });
+    OK_ASSERT(readonly_visited == 4);
+
+    // Remove every odd key.
+    for (U32 i = 1; i < n; i += 2) OK_ASSERT(map.remove(i));
+    OK_ASSERT(!map.remove(1));
+    OK_ASSERT(map.get_count() == n / 2);
+    OK_ASSERT(!map.has(3));
+    OK_ASSERT(map.has(4));
+
+    auto it = map.lower_bound(101);
+    OK_ASSERT(it.valid() && it.key() == 102);
+    it = map.upper_bound(102);
+    OK_ASSERT(it.valid() && it.key() == 104);
+    OK_ASSERT(!map.lower_bound(n).valid());
+
+    U32 sum = 0;
+    U32 visited = 0;
+    map.for_each_in_range(10, 20, [&](const U32& key, U32& value) {
+        OK_ASSERT(value == key * 2);
+        sum += key;
+        visited++;
+    });
+    OK_ASSERT(visited == 5);
+    OK_ASSERT(sum == 10 + 12 + 14 + 16 + 18);
+
+    for (U32 i = 0; i < n; i += 2) OK_ASSERT(map.remove(i));
+    OK_ASSERT(map.get_count() == 0);
+    OK_ASSERT(!map.begin().valid());
+
+    map.dealloc();
+    pool.free();
+
+    // Bulk load from sorted input.
+    List<U32> keys = List<U32>::alloc(&arena);
+    List<U32> values = List<U32>::alloc(&arena);
+    for (U32 i = 0; i < 1000; i++) {
+        keys.push(i * 3);
+        values.push(i);
+    }
+
+    auto loaded = BTreeMap<U32, U32>::from_sorted(&arena, keys.slice(), values.slice());
+    OK_ASSERT(loaded.get_count() == 1000);
+    OK_ASSERT(loaded.get(300).get_unchecked() == 100);
+    OK_ASSERT(!loaded.has(301));
+
+    expected = 0;
+    for (auto it = loaded.begin(); it.valid(); it.next()) {
+        OK_ASSERT(it.key() == expected * 3);
+        expected++;
+    }
+    OK_ASSERT(expected == 1000);
+
+    loaded.put(301, 7);
+    OK_ASSERT(loaded.lower_bound(301).value() == 7);
+    OK_ASSERT(loaded.remove(300));
+    OK_ASSERT(loaded.upper_bound(297).key() == 301);
+
+    loaded.dealloc();
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "random.hpp"
+
+#include <ctype.h>
+
+using namespace ok;
+
+static CharClass libc_classes(int c) {
+    if (c > 0x7f) return 0;
+
+    CharClass classes = 0;
+    if (isspace(c) && c != '\f') classes |= CHAR_WHITESPACE;
+    if (isdigit(c)) classes |= CHAR_DIGIT;
+    if (islower(c)) classes |= CHAR_LOWER;
+    if (isupper(c)) classes |= CHAR_UPPER;
+    if (isxdigit(c)) classes |= CHAR_HEX_DIGIT;
+    if (ispunct(c)) classes |= CHAR_PUNCT;
+    if (iscntrl(c)) classes |= CHAR_CONTROL;
+    return classes;
+}
+
+int main() {
+    for (int c = 0; c < 256; c++) {
+        OK_ASSERT(CHAR_CLASSES.classes[c] == libc_classes(c));
+        OK_ASSERT(to_lower((char)c) == (char)(c < 0x80 ? tolower(c) : c));
+        OK_ASSERT(to_upper((char)c) == (char)(c < 0x80 ? toupper(c) : c));
+    }
+    OK_ASSERT(is_whitespace('\r') && !is_whitespace('\f') && !is_whitespace('a'));
+    OK_ASSERT(is_digit('7') && !is_digit('a'));
+    OK_ASSERT(is_alpha('Q') && is_alpha('q') && !is_alpha('1'));
+
+    OK_ASSERT("  \t padded \r\n"_sv.trim() == "padded"_sv);
+    OK_ASSERT("  left"_sv.trim_start() == "left"_sv);
+    OK_ASSERT("right \n"_sv.trim_end() == "right"_sv);
+    OK_ASSERT(" \t\n "_sv.trim().count == 0);
+    OK_ASSERT(""_sv.trim().count == 0);
+    OK_ASSERT(StringView{}.trim().count == 0);
+    OK_ASSERT("x"_sv.trim() == "x"_sv);
+
+    OK_ASSERT("Content-Type"_sv.eq_ignore_case("content-TYPE"_sv));
+    OK_ASSERT(!"Content-Type"_sv.eq_ignore_case("Content-Typf"_sv));
+    OK_ASSERT(!"abc"_sv.eq_ignore_case("abcd"_sv));
+    OK_ASSERT(!"@"_sv.eq_ignore_case("`"_sv));    // 0x40 and 0x60 differ only in the case bit
+    OK_ASSERT(!"["_sv.eq_ignore_case("{"_sv));
+    OK_ASSERT("\xc3\x89t\xc3\xa9"_sv.eq_ignore_case("\xc3\x89T\xc3\xa9"_sv));
+    OK_ASSERT(!"\xc3\x89"_sv.eq_ignore_case("\xc3\xa9"_sv));
+
+    OK_ASSERT("12ab"_sv.find_first_not_of(CHAR_DIGIT) == 2);
+    OK_ASSERT("12ab"_sv.find_first_of(CHAR_ALPHA) == 2);
+    OK_ASSERT("12ab"_sv.find_first_of(CHAR_ALPHA, 3) == 3);
+    OK_ASSERT("1234"_sv.find_first_not_of(CHAR_DIGIT) == (UZ)-1);
+    OK_ASSERT("deadBEEF"_sv.find_first_not_of(CHAR_HEX_DIGIT) == (UZ)-1);
+    OK_ASSERT("ab12"_sv.find_last_not_of(CHAR_DIGIT) == 1);
+    OK_ASSERT(""_sv.find_first_of(CHAR_ALNUM) == (UZ)-1);
+
+    ArenaAllocator arena{};
+    String header = String::alloc(&arena, "Accept-Encoding: GZIP, Br");
+    header.to_lower();
+    OK_ASSERT(header == "accept-encoding: gzip, br"_sv);
+    header.to_upper();
+    OK_ASSERT(header == "ACCEPT-ENCODING: GZIP, BR"_sv);
+
+    // Against the scalar definitions at every length and alignment, with all bytes.
+    char a[300], b[300];
+    const CharClass class_sets[] = {CHAR_WHITESPACE, CHAR_DIGIT, CHAR_ALPHA, CHAR_ALNUM | CHAR_PUNCT, CHAR_HEX_DIGIT,
+                                    CHAR_CONTROL, 0, 0x7f};
+    for (int round = 0; round < 20000; round++) {
+        UZ offset = next_random() % 16;
+        UZ count = next_random() % (sizeof(a) - offset);
+        bool mostly_ascii = next_random() % 2 == 0;
+        for (UZ i = 0; i < count; i++) {
+            U64 r = next_random();
+            a[offset + i] = mostly_ascii ? (char)(r % 0x80) : (char)r;
+        }
+        char* chars = a + offset;
+
+        CharClass classes = class_sets[next_random() % OK_ARR_LEN(class_sets)];
+        UZ first_of = (UZ)-1, first_not_of = (UZ)-1, last_not_of = (UZ)-1;
+        for (UZ i = 0; i < count; i++) {
+            bool in_class = is_char_class(chars[i], classes);
+            if (in_class && first_of == (UZ)-1) first_of = i;
+            if (!in_class && first_not_of == (UZ)-1) first_not_of = i;
+            if (!in_class) last_not_of = i;
+        }
+        OK_ASSERT(find_first_of_class(chars, count, classes) == first_of);
+        OK_ASSERT(find_first_not_of_class(chars, count, classes) == first_not_of);
+        OK_ASSERT(find_last_not_of_class(chars, count, classes) == last_not_of);
+
+        // A copy with the case of some letters flipped, and maybe one byte changed.
+        for (UZ i = 0; i < count; i++) {
+            char c = chars[i];
+            b[i] = next_random() % 2 == 0 ? to_upper(c) : to_lower(c);
+        }
+        bool equal = true;
+        if (count > 0 && next_random() % 2 == 0) {
+            UZ i = next_random() % count;
+            b[i] = (char)next_random();
+            equal = to_lower(b[i]) == to_lower(chars[i]);
+        }
+        OK_ASSERT(ascii_eq_ignore_case(chars, b, count) == equal);
+
+        memcpy(b, chars, count);
+        ascii_to_lower(chars, count);
+        for (UZ i = 0; i < count; i++) OK_ASSERT(chars[i] == to_lower(b[i]));
+        ascii_to_upper(chars, count);
+        for (UZ i = 0; i < count; i++) OK_ASSERT(chars[i] == to_upper(b[i]));
+    }
+
+    arena.free();
+    return 0;
+}
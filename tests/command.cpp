@@ -5,13 +5,13 @@ using namespace ok;
 
 int main() {
 #if OK_UNIX
-    auto cmd = Command::alloc(temp_allocator, "echo");
+    auto cmd = Command::alloc(temp_allocator(), "echo");
     cmd.arg("hello").arg("world");
 
     auto err = cmd.exec();
     OK_ASSERT(!err.has_value());
 
-    cmd = Command::alloc(temp_allocator, "cat");
+    cmd = Command::alloc(temp_allocator(), "cat");
     cmd.set_stdin("this was sent to cat (meow)\n"_sv);
 
     err = cmd.exec();
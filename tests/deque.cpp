@@ -0,0 +1,54 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+int main() {
+    ArenaAllocator arena{};
+
+    Deque<U32> queue = Deque<U32>::alloc(&arena, 3);
+    OK_ASSERT(queue.capacity == 4);
+
+    for (U32 i = 0; i < 4; ++i) queue.push_back(i);
+    OK_ASSERT(queue.pop_front() == 0);
+    OK_ASSERT(queue.pop_front() == 1);
+
+    // Wrap around the end of the buffer.
+    queue.push_back(4);
+    queue.push_back(5);
+    OK_ASSERT(queue.capacity == 4);
+    OK_ASSERT(queue[0] == 2 && queue[3] == 5);
+
+    Slice<U32> first, second;
+    queue.slices(&first, &second);
+    OK_ASSERT(first.count == 2 && first[0] == 2);
+    OK_ASSERT(second.count == 2 && second[1] == 5);
+
+    const Deque<U32>& readonly = queue;
+    Slice<const U32> readonly_first, readonly_second;
+    readonly.slices(&readonly_first, &readonly_second);
+    OK_ASSERT(readonly_first.items == first.items && readonly_second.count == 2);
+
+    // Searches see the elements in order, across the wrap.
+    OK_ASSERT(readonly.find_index(3u) == 1 && readonly.find_index(4u) == 2);
+    OK_ASSERT(readonly.find_index(7u) == (UZ)-1);
+    OK_ASSERT(readonly.find_index([](U32 x) { return x > 4; }) == 3);
+    OK_ASSERT(readonly.contains(5u) && !readonly.contains(0u));
+    OK_ASSERT(readonly.count_of(2u) == 1);
+
+    queue.push_front(1);
+    OK_ASSERT(queue.capacity == 8);
+    OK_ASSERT(queue.count == 5);
+    OK_ASSERT(queue.front() == 1 && queue.back() == 5);
+
+    for (U32 i = 0; i < 100; ++i) queue.push_front(i);
+    OK_ASSERT(queue.count == 105);
+    OK_ASSERT(queue.front() == 99);
+    OK_ASSERT(queue.pop_back() == 5);
+    OK_ASSERT(queue[100] == 1);
+
+    queue.clear();
+    OK_ASSERT(queue.count == 0);
+
+    return 0;
+}
@@ -5,14 +5,14 @@
 
 using namespace ok;
 
-char* read_file_to_cstr(const char* filepath) {
+char* read_file_to_cstr(Allocator* a, const char* filepath) {
     FILE* f = fopen(filepath, "r");
     if (f == nullptr) {
         perror("failed to execute fopen");
         abort();
     }
 
-    void* mem = static_allocator->raw_alloc(50'000'000);
+    void* mem = a->raw_alloc(50'000'001);
     size_t nread = fread(mem, sizeof(char), 50'000'000, f);
 
     OK_ASSERT(nread != 0);
@@ -29,19 +29,19 @@ int main() {
 
     auto open_err = File::open(&file, test_file_path);
     if (open_err) {
-        printf("could not open file: %s\n", File::error_string(temp_allocator, open_err.value).cstr());
+        printf("could not open file: %s\n", File::error_string(temp_allocator(), open_err.value).cstr());
         abort();
     }
     OK_ASSERT(strcmp(file.path, test_file_path) == 0);
 
     Optional<File::WriteError> write_err = file.write("HELLO!"_sv);
     if (write_err) {
-        printf("could not write to file: %s\n", File::error_string(temp_allocator, write_err.value).cstr());
+        printf("could not write to file: %s\n", File::error_string(temp_allocator(), write_err.value).cstr());
         abort();
     }
 
     List<uint8_t> buffer;
-    auto read_err = file.read_full(temp_allocator, &buffer);
+    auto read_err = file.read_full(temp_allocator(), &buffer);
     OK_ASSERT(!read_err.has_value());
 
     String s = String::from(buffer);
@@ -50,9 +50,12 @@ int main() {
 
     OK_ASSERT(!file.close());
 
-    const char* file_contents_cstr = read_file_to_cstr(test_file_path);
+    ArenaAllocator arena{};
+    const char* file_contents_cstr = read_file_to_cstr(&arena, test_file_path);
 
     OK_ASSERT(s == StringView{file_contents_cstr});
 
+    arena.free();
+
     return 0;
 }
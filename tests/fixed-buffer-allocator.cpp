@@ -4,8 +4,9 @@
 using namespace ok;
 
 int main() {
-    const char* hello = "hello";
-    const char* not_hello = "not hello";
+    // Long enough not to fit inline in a `String`, so both go through the allocator.
+    const char* hello = "hello, hello, hello, hello";
+    const char* not_hello = "not hello, not hello, not hello";
 
     FixedBufferAllocator a{};
 
@@ -0,0 +1,230 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "random.hpp"
+
+using namespace ok;
+
+static StringView f64_text(char* buf, F64 value) {
+    return StringView{buf, format_f64(buf, value)};
+}
+
+static StringView f32_text(char* buf, F32 value) {
+    return StringView{buf, format_f32(buf, value)};
+}
+
+static F64 f64_from_bits(U64 bits) {
+    F64 value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static F32 f32_from_bits(U32 bits) {
+    F32 value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static bool same_f64(F64 a, F64 b) {
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static bool same_f32(F32 a, F32 b) {
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static UZ significant_digits(StringView text) {
+    UZ count = 0;
+    bool leading = true;
+    UZ trailing_zeros = 0;
+
+    for (UZ i = 0; i < text.count; i++) {
+        char c = text.data[i];
+        if (c == 'e') break;
+        if (c < '0' || c > '9') continue;
+        if (leading && c == '0') continue;
+
+        leading = false;
+        count++;
+        trailing_zeros = c == '0' ? trailing_zeros + 1 : 0;
+    }
+
+    return count - trailing_zeros;
+}
+
+// The output reads back as the same value, and no decimal with fewer digits does.
+static void check_shortest_f64(F64 value) {
+    char buf[MAX_FLOAT_CHARS + 1];
+    StringView text = f64_text(buf, value);
+    buf[text.count] = '\0';
+
+    OK_ASSERT(same_f64(strtod(buf, nullptr), value));
+
+    UZ digits = significant_digits(text);
+    if (digits > 1) {
+        char shorter[64];
+        snprintf(shorter, sizeof(shorter), "%.*e", (int)digits - 2, value);
+        OK_ASSERT(strtod(shorter, nullptr) != value);
+    }
+
+    F64 parsed;
+    OK_ASSERT(parse_f64(text, &parsed));
+    OK_ASSERT(same_f64(parsed, value));
+}
+
+static void check_shortest_f32(F32 value) {
+    char buf[MAX_FLOAT_CHARS + 1];
+    StringView text = f32_text(buf, value);
+    buf[text.count] = '\0';
+
+    OK_ASSERT(same_f32(strtof(buf, nullptr), value));
+
+    UZ digits = significant_digits(text);
+    if (digits > 1) {
+        char shorter[64];
+        snprintf(shorter, sizeof(shorter), "%.*e", (int)digits - 2, (F64)value);
+        OK_ASSERT(strtof(shorter, nullptr) != value);
+    }
+
+    F32 parsed;
+    OK_ASSERT(parse_f32(text, &parsed));
+    OK_ASSERT(same_f32(parsed, value));
+}
+
+static void check_parse(const char* text) {
+    F64 parsed64;
+    OK_ASSERT(parse_f64(StringView{text}, &parsed64));
+    OK_ASSERT(same_f64(parsed64, strtod(text, nullptr)));
+
+    F32 parsed32;
+    OK_ASSERT(parse_f32(StringView{text}, &parsed32));
+    OK_ASSERT(same_f32(parsed32, strtof(text, nullptr)));
+}
+
+int main() {
+    char buf[MAX_FLOAT_CHARS];
+
+    OK_ASSERT(f64_text(buf, 0.0) == "0"_sv);
+    OK_ASSERT(f64_text(buf, -0.0) == "-0"_sv);
+    OK_ASSERT(f64_text(buf, 1.0) == "1"_sv);
+    OK_ASSERT(f64_text(buf, -1.5) == "-1.5"_sv);
+    OK_ASSERT(f64_text(buf, 0.1) == "0.1"_sv);
+    OK_ASSERT(f64_text(buf, 0.3) == "0.3"_sv);
+    OK_ASSERT(f64_text(buf, 0.1 + 0.2) == "0.30000000000000004"_sv);
+    OK_ASSERT(f64_text(buf, 123456.0) == "123456"_sv);
+    OK_ASSERT(f64_text(buf, 1e20) == "1e+20"_sv);
+    OK_ASSERT(f64_text(buf, 1e-7) == "1e-07"_sv);
+    OK_ASSERT(f64_text(buf, 1.5e300) == "1.5e+300"_sv);
+    OK_ASSERT(f64_text(buf, 0.001) == "0.001"_sv);
+    OK_ASSERT(f64_text(buf, 5e-324) == "5e-324"_sv);
+    OK_ASSERT(f64_text(buf, 1.7976931348623157e308) == "1.7976931348623157e+308"_sv);
+    OK_ASSERT(f64_text(buf, 9007199254740993.0) == "9007199254740992"_sv);
+    OK_ASSERT(f64_text(buf, 1.0 / 0.0) == "inf"_sv);
+    OK_ASSERT(f64_text(buf, -1.0 / 0.0) == "-inf"_sv);
+    OK_ASSERT(f64_text(buf, f64_from_bits(0x7ff8000000000000ull)) == "nan"_sv);
+
+    OK_ASSERT(f32_text(buf, 0.1f) == "0.1"_sv);
+    OK_ASSERT(f32_text(buf, 16777216.0f) == "16777216"_sv);
+    OK_ASSERT(f32_text(buf, 3.4028235e38f) == "3.4028235e+38"_sv);
+    OK_ASSERT(f32_text(buf, 1e-45f) == "1e-45"_sv);
+    OK_ASSERT(f32_text(buf, 1.0f / 3.0f) == "0.33333334"_sv);
+
+    ArenaAllocator arena{};
+    String s = String::alloc(&arena, "x=");
+    append_f64(&s, 2.5);
+    s.push(' ');
+    append_f32(&s, -0.25f);
+    OK_ASSERT(s == "x=2.5 -0.25"_sv);
+
+    // Powers of two, the edges of every binade, and random bit patterns.
+    for (U64 exponent = 0; exponent < 0x7ff; exponent++) {
+        check_shortest_f64(f64_from_bits(exponent << 52));
+        check_shortest_f64(f64_from_bits((exponent << 52) | 1));
+        check_shortest_f64(f64_from_bits((exponent << 52) | ((1ull << 52) - 1)));
+    }
+    for (U32 exponent = 0; exponent < 0xff; exponent++) {
+        check_shortest_f32(f32_from_bits(exponent << 23));
+        check_shortest_f32(f32_from_bits((exponent << 23) | 1));
+        check_shortest_f32(f32_from_bits((exponent << 23) | ((1u << 23) - 1)));
+    }
+    for (int i = 0; i < 200000; i++) {
+        U64 bits = next_random();
+        F64 value = f64_from_bits(bits);
+        if (value == value && value - value == 0) check_shortest_f64(value);
+
+        F32 value32 = f32_from_bits((U32)bits);
+        if (value32 == value32 && value32 - value32 == 0) check_shortest_f32(value32);
+    }
+
+    // Fast paths, the 19 digit limit, exact halfway cases and long inputs.
+    const char* cases[] = {
+        "0", "-0", "0.0", "000.000e5", "1", "+3", "-2.5", ".5", "5.", "1e10", "1E-10", "123.456e+2",
+        "9007199254740992", "9007199254740993", "9007199254740995", "9007199254740993.000000000000000000001",
+        "1234567890123456789", "12345678901234567890", "123456789012345678901234567890",
+        "0.1000000000000000055511151231257827021181583404541015625",
+        "0.1000000000000000055511151231257827021181583404541015624",
+        "0.1000000000000000055511151231257827021181583404541015626",
+        "2.4703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449105184435931802849936536152500319370457678249219365623669863658480757001585769269903706311928279558551332927834338409351978015531246597263579574622766465272827220056374006485499977096599470454020828166226237857393450736339007967761930577506740176324673600968951340535537458516661134223766678604162159680461914467291840300530057530849048765391711386591646239524912623653881879636239373280423891018672348497668235089863388587925628302755995657524455507255189313690836254779186948667994968324049705821028513185451396213837722826145437693412532098591327667236328125e-324",
+        "2.4703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449105184435931802849936536152500319370457678249219365623669863658480757001585769269903706311928279558551332927834338409351978015531246597263579574622766465272827220056374006485499977096599470454020828166226237857393450736339007967761930577506740176324673600968951340535537458516661134223766678604162159680461914467291840300530057530849048765391711386591646239524912623653881879636239373280423891018672348497668235089863388587925628302755995657524455507255189313690836254779186948667994968324049705821028513185451396213837722826145437693412532098591327667236328125001e-324",
+        "1.7976931348623157e308", "1.7976931348623158e308", "1.7976931348623159e308", "1e309", "1e-400",
+        "4.9406564584124654e-324", "2.2250738585072011e-308", "2.2250738585072012e-308",
+        "3.4028235e38", "3.4028236e38", "1.17549435e-38", "1.4e-45", "7e-46", "8e-46",
+    };
+    for (UZ i = 0; i < OK_ARR_LEN(cases); i++) check_parse(cases[i]);
+
+    char text[1200];
+    for (int i = 0; i < 100000; i++) {
+        U64 bits = next_random();
+        F64 value = f64_from_bits(bits);
+        if (value != value || value - value != 0) continue;
+
+        // Every precision, past the 19 digit limit too.
+        int precision = (int)(next_random() % 40);
+        snprintf(text, sizeof(text), "%.*e", precision, value);
+        check_parse(text);
+
+        // Close to halfway between two doubles.
+        F64 next = f64_from_bits(bits + 1);
+        snprintf(text, sizeof(text), "%.40e", value / 2 + next / 2);
+        check_parse(text);
+    }
+
+    // A very long input, where only digits far past the 800th decide.
+    {
+        UZ n = 0;
+        n += snprintf(text + n, sizeof(text) - n, "9007199254740993");
+        text[n++] = '.';
+        for (int i = 0; i < 1000; i++) text[n++] = '0';
+        text[n++] = '1';
+        text[n] = '\0';
+
+        F64 parsed;
+        OK_ASSERT(parse_f64(StringView{text, n}, &parsed));
+        OK_ASSERT(parsed == 9007199254740994.0);
+
+        text[n - 1] = '0';
+        OK_ASSERT(parse_f64(StringView{text, n}, &parsed));
+        OK_ASSERT(parsed == 9007199254740992.0);
+    }
+
+    // Special values and malformed input.
+    F64 parsed;
+    OK_ASSERT(parse_f64("inf"_sv, &parsed) && parsed == 1.0 / 0.0);
+    OK_ASSERT(parse_f64("-Infinity"_sv, &parsed) && parsed == -1.0 / 0.0);
+    OK_ASSERT(parse_f64("NaN"_sv, &parsed) && parsed != parsed);
+
+    const char* invalid[] = {"", "-", "+", ".", "e5", "1e", "1e+", "abc", "1.2.3", "--1", "1 ", " 1", "infx"};
+    for (UZ i = 0; i < OK_ARR_LEN(invalid); i++) OK_ASSERT(!parse_f64(StringView{invalid[i]}, &parsed));
+
+    // With `consumed`, trailing text is fine.
+    UZ consumed = 0;
+    OK_ASSERT(parse_f64("12.5ms"_sv, &parsed, &consumed) && parsed == 12.5 && consumed == 4);
+    OK_ASSERT(parse_f64("1each"_sv, &parsed, &consumed) && parsed == 1.0 && consumed == 1);
+    OK_ASSERT(parse_f64("-2e3,4"_sv, &parsed, &consumed) && parsed == -2000.0 && consumed == 4);
+    OK_ASSERT(!parse_f64("x1"_sv, &parsed, &consumed));
+
+    // The formatter prints floats through the same code.
+    OK_ASSERT(format(&arena, "{} {}", 0.1 + 0.2, 1e100) == "0.30000000000000004 1e+100"_sv);
+
+    arena.free();
+    return 0;
+}
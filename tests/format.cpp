@@ -0,0 +1,139 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+struct Vec2 {
+    F32 x;
+    F32 y;
+};
+
+static void ok_format(FormatWriter* w, const FormatSpec&, const Vec2& v) {
+    format_to(w, "({}, {})", v.x, v.y);
+}
+
+static String fmt_buf_string(Allocator* a, const char* chars, UZ count) {
+    return String::alloc(a, chars, count);
+}
+
+int main() {
+    ArenaAllocator arena{};
+
+    // Integers of every width, at the edges of their range.
+    OK_ASSERT(format(&arena, "{}", 0) == "0"_sv);
+    OK_ASSERT(format(&arena, "{} {}", (S8)-128, (U8)255) == "-128 255"_sv);
+    OK_ASSERT(format(&arena, "{} {}", (S16)-32768, (U16)65535) == "-32768 65535"_sv);
+    OK_ASSERT(format(&arena, "{} {}", (S32)-2147483647 - 1, (U32)4294967295u) == "-2147483648 4294967295"_sv);
+    OK_ASSERT(format(&arena, "{}", (S64)(-9223372036854775807ll - 1)) == "-9223372036854775808"_sv);
+    OK_ASSERT(format(&arena, "{}", (U64)18446744073709551615ull) == "18446744073709551615"_sv);
+
+    OK_ASSERT(format(&arena, "{:x} {:X} {:o} {:b}", 255, 255, 8, 5) == "ff FF 10 101"_sv);
+    OK_ASSERT(format(&arena, "{:x}", -255) == "-ff"_sv);
+    OK_ASSERT(format(&arena, "{:c}", 65) == "A"_sv);
+
+    // Padding and alignment.
+    OK_ASSERT(format(&arena, "[{:5}]", 42) == "[   42]"_sv);
+    OK_ASSERT(format(&arena, "[{:<5}]", 42) == "[42   ]"_sv);
+    OK_ASSERT(format(&arena, "[{:^6}]", 42) == "[  42  ]"_sv);
+    OK_ASSERT(format(&arena, "[{:*>5}]", 42) == "[***42]"_sv);
+    OK_ASSERT(format(&arena, "[{:05}]", -42) == "[-0042]"_sv);
+    OK_ASSERT(format(&arena, "[{:08x}]", 0xbeef) == "[0000beef]"_sv);
+    OK_ASSERT(format(&arena, "[{:5}]", "ab") == "[ab   ]"_sv);
+    OK_ASSERT(format(&arena, "[{:.2}]", "abcdef") == "[ab]"_sv);
+    OK_ASSERT(format(&arena, "[{:-^7}]", 'x') == "[---x---]"_sv);
+
+    // Floats read back as the same value with as few digits as possible.
+    OK_ASSERT(format(&arena, "{}", 1.5) == "1.5"_sv);
+    OK_ASSERT(format(&arena, "{}", 0.1) == "0.1"_sv);
+    OK_ASSERT(format(&arena, "{}", 0.1f) == "0.1"_sv);
+    OK_ASSERT(format(&arena, "{}", 1.0 / 3.0) == "0.3333333333333333"_sv);
+    OK_ASSERT(format(&arena, "{:.3f}", 3.14159) == "3.142"_sv);
+    OK_ASSERT(format(&arena, "{:e}", 1234.5) == "1.234500e+03"_sv);
+    OK_ASSERT(format(&arena, "[{:08.2f}]", -1.5) == "[-0001.50]"_sv);
+    OK_ASSERT(format(&arena, "[{:05}]", 1.0 / 0.0) == "[  inf]"_sv);
+
+    // Strings, bools, pointers and escaped braces.
+    String owned = String::alloc(&arena, "owned");
+    OK_ASSERT(format(&arena, "{} {} {}", "cstr", "view"_sv, owned) == "cstr view owned"_sv);
+    OK_ASSERT(format(&arena, "{} {}", true, false) == "true false"_sv);
+    OK_ASSERT(format(&arena, "{:d}", true) == "1"_sv);
+    OK_ASSERT(format(&arena, "{}", (const void*)0x1234) == "0x1234"_sv);
+    OK_ASSERT(format(&arena, "{{}} {{{}}}", 7) == "{} {7}"_sv);
+
+    // Types with an `ok_format` overload.
+    OK_ASSERT(format(&arena, "at {}", Vec2{1.0f, -2.5f}) == "at (1, -2.5)"_sv);
+
+    // Appending to a string that grows along the way.
+    String appended = String::alloc(&arena, "start");
+    for (int i = 0; i < 1000; i++) format_to(&appended, " {}", i);
+    OK_ASSERT(appended.view().starts_with("start 0 1 2"));
+    OK_ASSERT(appended.view().ends_with(" 998 999"));
+    OK_ASSERT(appended.cstr()[appended.count()] == '\0');
+
+    StringBuilder builder = StringBuilder::alloc(&arena, 64);
+    String expected = String::alloc(&arena);
+    for (int i = 0; i < 300; i++) {
+        format_to(&builder, "line {:>4}: {:.2f}\n", i, i * 0.5);
+        expected.format_append("line %4d: %.2f\n", i, i * 0.5);
+    }
+    OK_ASSERT(builder.finish(&arena) == expected);
+    builder.dealloc();
+
+    // Fixed buffers get cut off, and the full length comes back.
+    char buf[8];
+    UZ n = format_to(buf, sizeof(buf), "{}-{}", 123, 456);
+    OK_ASSERT(n == 7);
+    OK_ASSERT(fmt_buf_string(&arena, buf, n) == "123-456"_sv);
+
+    n = format_to(buf, sizeof(buf), "{}{}", 12345678, 90);
+    OK_ASSERT(n == 10);
+    OK_ASSERT(fmt_buf_string(&arena, buf, sizeof(buf)) == "12345678"_sv);
+
+    n = format_to(buf, 3, "{:>10}", 1);
+    OK_ASSERT(n == 10);
+    OK_ASSERT(fmt_buf_string(&arena, buf, 3) == "   "_sv);
+
+    // Files are written in blocks.
+    {
+        File file;
+        OK_ASSERT(!create_temp_file(&file).has_value());
+
+        String text = String::alloc(&arena);
+        for (int i = 0; i < 2000; i++) format_to(&text, "{}, ", i);
+
+        OK_ASSERT(!format_to(&file, "{}|{}", text, 42).has_value());
+
+        file.seek_start();
+        List<U8> contents;
+        OK_ASSERT(!file.read_full(&arena, &contents).has_value());
+        OK_ASSERT(String::from(contents) == format(&arena, "{}|42", text));
+
+        OK_ASSERT(!file.close());
+        file.remove();
+    }
+
+    // The printf-style paths.
+    String long_text = String::format(&arena, "%0300d", 7);
+    OK_ASSERT(long_text.count() == 300 && long_text.view().ends_with("07"));
+    String small = String::alloc(&arena, "a");
+    small.format_append("%d", 12);
+    small.format_append("%0100d", 3);
+    OK_ASSERT(small.count() == 103 && small.view().starts_with("a1200"));
+
+    println("formatted {} and {:.1f}", 1, 2.0);
+    eprintln("formatted {} to stderr", "text"_sv);
+
+    // Without arguments literals are still format strings, runtime text is printed as is.
+    println("literal {{braces}}");
+    println("runtime {text}"_sv);
+    println(String::alloc(&arena, "runtime {}"));
+    eprintln("runtime {}"_sv);
+    const char* c_string = "runtime {c string}";
+    println(c_string);
+    eprintln(c_string);
+    char mutable_c_string[] = "runtime {mutable}";
+    println(&mutable_c_string[0]);
+
+    arena.free();
+    return 0;
+}
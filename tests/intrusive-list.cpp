@@ -0,0 +1,48 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+struct Entry {
+    IntrusiveLink<Entry> lru;
+    U32 key;
+};
+
+int main() {
+    Entry entries[4] = {};
+    for (U32 i = 0; i < 4; ++i) entries[i].key = i;
+
+    IntrusiveList<Entry, &Entry::lru> lru{};
+
+    for (U32 i = 0; i < 4; ++i) lru.append(&entries[i]);
+
+    OK_ASSERT(lru.count == 4);
+    OK_ASSERT(lru.head->key == 0);
+    OK_ASSERT(lru.tail->key == 3);
+
+    lru.move_to_back(&entries[1]);
+    OK_ASSERT(lru.tail->key == 1);
+    OK_ASSERT(lru.head->lru.next->key == 2);
+
+    Entry* evicted = lru.pop_front();
+    OK_ASSERT(evicted->key == 0);
+    OK_ASSERT(evicted->lru.next == nullptr);
+    OK_ASSERT(lru.head->key == 2);
+    OK_ASSERT(lru.head->lru.prev == nullptr);
+
+    lru.insert_after(&entries[2], evicted);
+    OK_ASSERT(lru.head->lru.next == evicted);
+    OK_ASSERT(entries[3].lru.prev == evicted);
+
+    lru.remove(&entries[3]);
+    lru.remove(&entries[2]);
+    OK_ASSERT(lru.count == 2);
+    OK_ASSERT(lru.head == evicted && lru.tail == &entries[1]);
+
+    lru.pop_back();
+    lru.pop_back();
+    OK_ASSERT(lru.is_empty());
+    OK_ASSERT(lru.tail == nullptr);
+
+    return 0;
+}
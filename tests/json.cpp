@@ -0,0 +1,316 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "random.hpp"
+
+using namespace ok;
+
+static Optional<JsonDocument::ParseError> parse(ArenaAllocator* arena, JsonDocument* doc, StringView text) {
+    return JsonDocument::parse(doc, arena, text);
+}
+
+static bool fails_with(ArenaAllocator* arena, StringView text, JsonDocument::ParseError expected) {
+    JsonDocument doc;
+    Optional<JsonDocument::ParseError> error = parse(arena, &doc, text);
+    return error && error.value == expected;
+}
+
+// Writes the document back out, to compare documents with each other.
+static void write_value(JsonWriter* json, JsonValue value) {
+    switch (value.type()) {
+    case JsonType::OBJECT:
+        json->begin_object();
+        for (JsonObjectIterator it = value.iter_object(); it.valid(); it.next()) {
+            json->key(it.key());
+            write_value(json, it.value());
+        }
+        json->end_object();
+        break;
+    case JsonType::ARRAY:
+        json->begin_array();
+        for (JsonArrayIterator it = value.iter_array(); it.valid(); it.next()) write_value(json, it.value());
+        json->end_array();
+        break;
+    case JsonType::STRING: {
+        StringView s;
+        OK_ASSERT(value.get_string(&s));
+        json->value_string(s);
+        break;
+    }
+    case JsonType::NUMBER: json->value_raw(value.raw()); break;
+    case JsonType::BOOLEAN: {
+        bool b;
+        OK_ASSERT(value.get_bool(&b));
+        json->value_bool(b);
+        break;
+    }
+    case JsonType::NULL_VALUE: json->value_null(); break;
+    }
+}
+
+static String rewrite(ArenaAllocator* arena, JsonValue value) {
+    String out = String::alloc(arena);
+    FormatWriter w = format_writer_for(&out);
+    JsonWriter json = JsonWriter::to(&w);
+    write_value(&json, value);
+    w.finish();
+    return out;
+}
+
+static void random_string(JsonWriter* json, char* buf) {
+    const char* pieces[] = {"a", "key", " ", "\"", "\\", "/", "\n", "\t", "\x01", "\x1f", "\xc3\xa9", "\xf0\x9f\x98\x80"};
+    UZ count = 0;
+    for (UZ i = next_random() % 12; i > 0; i--) {
+        const char* piece = pieces[next_random() % OK_ARR_LEN(pieces)];
+        memcpy(buf + count, piece, strlen(piece));
+        count += strlen(piece);
+    }
+    json->value_string(StringView{buf, count});
+}
+
+static void random_value(JsonWriter* json, U32 depth) {
+    char buf[64];
+    switch (next_random() % (depth < 6 ? 8 : 6)) {
+    case 0: json->value_null(); break;
+    case 1: json->value_bool(next_random() % 2 == 0); break;
+    case 2: json->value_int((S64)next_random() >> (next_random() % 64)); break;
+    case 3: json->value_f64((F64)(S64)next_random() / (F64)(1 + next_random() % 100000)); break;
+    case 4:
+    case 5: random_string(json, buf); break;
+    case 6:
+        json->begin_array();
+        for (UZ i = next_random() % 6; i > 0; i--) random_value(json, depth + 1);
+        json->end_array();
+        break;
+    default:
+        json->begin_object();
+        for (UZ i = next_random() % 6; i > 0; i--) {
+            json->key(i % 2 == 0 ? "k"_sv : "long key with \"quotes\""_sv);
+            random_value(json, depth + 1);
+        }
+        json->end_object();
+        break;
+    }
+}
+
+int main() {
+    ArenaAllocator arena{};
+    JsonDocument doc;
+
+    StringView text = R"( {"name": "ok", "version": 3, "ratio": -1.5e3, "tags": ["a", "b\n", "é😀"],
+                           "nested": {"empty": {}, "list": [], "flag": true, "none": null}} )"_sv;
+    OK_ASSERT(!parse(&arena, &doc, text).has_value());
+
+    JsonValue root = doc.root();
+    OK_ASSERT(root.type() == JsonType::OBJECT && root.count() == 5);
+
+    StringView name;
+    OK_ASSERT(root.get("name"_sv).value.get_string(&name) && name == "ok"_sv);
+    // Nothing to unescape, so it points into the input.
+    OK_ASSERT(name.data >= text.data && name.data < text.data + text.count);
+
+    S32 version;
+    OK_ASSERT(root.get("version"_sv).value.get_int(&version) && version == 3);
+    F64 ratio;
+    OK_ASSERT(root.get("ratio"_sv).value.get_f64(&ratio) && ratio == -1500.0);
+    OK_ASSERT(!root.get("ratio"_sv).value.get_int(&version));
+    OK_ASSERT(root.get("ratio"_sv).value.raw() == "-1.5e3"_sv);
+    OK_ASSERT(!root.get("missing"_sv).has_value());
+
+    JsonValue tags = root.get("tags"_sv).value;
+    OK_ASSERT(tags.type() == JsonType::ARRAY && tags.count() == 3);
+    StringView tag;
+    OK_ASSERT(tags.at(1).value.get_string(&tag) && tag == "b\n"_sv);
+    OK_ASSERT(tags.at(2).value.get_string(&tag) && tag == "\xc3\xa9\xf0\x9f\x98\x80"_sv);
+    OK_ASSERT(!tags.at(3).has_value());
+    OK_ASSERT(tags.raw() == R"(["a", "b\n", "é😀"])"_sv);
+
+    JsonValue nested = root.get("nested"_sv).value;
+    OK_ASSERT(nested.get("empty"_sv).value.count() == 0);
+    OK_ASSERT(nested.get("list"_sv).value.type() == JsonType::ARRAY && nested.get("list"_sv).value.count() == 0);
+    bool flag = false;
+    OK_ASSERT(nested.get("flag"_sv).value.get_bool(&flag) && flag);
+    OK_ASSERT(nested.get("none"_sv).value.is_null());
+    OK_ASSERT(!nested.get("none"_sv).value.get_bool(&flag));
+
+    const char* keys[] = {"name", "version", "ratio", "tags", "nested"};
+    UZ n = 0;
+    for (JsonObjectIterator it = root.iter_object(); it.valid(); it.next()) OK_ASSERT(it.key() == StringView{keys[n++]});
+    OK_ASSERT(n == 5);
+
+    // Scalars at the top level.
+    OK_ASSERT(!parse(&arena, &doc, "42"_sv).has_value() && doc.root().raw() == "42"_sv);
+    OK_ASSERT(!parse(&arena, &doc, " \"s\" "_sv).has_value() && doc.root().raw() == "\"s\""_sv);
+    OK_ASSERT(!parse(&arena, &doc, "null"_sv).has_value() && doc.root().is_null());
+
+    // Escapes, including lone surrogates which turn into U+FFFD.
+    StringView s;
+    OK_ASSERT(!parse(&arena, &doc, R"("\"\\\/\b\f\n\r\tA\ud800x\udc00")"_sv).has_value());
+    OK_ASSERT(doc.root().get_string(&s) && s == "\"\\/\b\f\n\r\tA\xef\xbf\xbdx\xef\xbf\xbd"_sv);
+    OK_ASSERT(!parse(&arena, &doc, R"(["\\", "\\\"", "a\\"])"_sv).has_value() && doc.root().count() == 3);
+    OK_ASSERT(doc.root().at(1).value.get_string(&s) && s == "\\\""_sv);
+
+    using E = JsonDocument::ParseError;
+    OK_ASSERT(fails_with(&arena, ""_sv, E::EMPTY));
+    OK_ASSERT(fails_with(&arena, " \n "_sv, E::EMPTY));
+    OK_ASSERT(fails_with(&arena, "\"\xff\""_sv, E::INVALID_UTF8));
+    OK_ASSERT(fails_with(&arena, "\"abc"_sv, E::UNCLOSED_STRING));
+    OK_ASSERT(fails_with(&arena, "[\"abc\\\"]"_sv, E::UNCLOSED_STRING));
+    OK_ASSERT(fails_with(&arena, "\"a\nb\""_sv, E::INVALID_STRING));
+    OK_ASSERT(fails_with(&arena, R"("\x")"_sv, E::INVALID_STRING));
+    OK_ASSERT(fails_with(&arena, R"("\u12g4")"_sv, E::INVALID_STRING));
+    OK_ASSERT(fails_with(&arena, R"("\u12)"_sv, E::INVALID_STRING));
+
+    // A backslash in the last byte must not look past the input. Literals have a NUL after
+    // them, so this needs a buffer without one.
+    {
+        char* trailing = (char*)malloc(2);
+        trailing[0] = '"';
+        trailing[1] = '\\';
+        OK_ASSERT(fails_with(&arena, StringView{trailing, 2}, E::INVALID_STRING));
+        free(trailing);
+    }
+
+    OK_ASSERT(fails_with(&arena, "[01]"_sv, E::INVALID_NUMBER));
+    OK_ASSERT(fails_with(&arena, "[1.]"_sv, E::INVALID_NUMBER));
+    OK_ASSERT(fails_with(&arena, "[.5]"_sv, E::UNEXPECTED_CHAR));
+    OK_ASSERT(fails_with(&arena, "[1e]"_sv, E::INVALID_NUMBER));
+    OK_ASSERT(fails_with(&arena, "[-]"_sv, E::INVALID_NUMBER));
+    OK_ASSERT(fails_with(&arena, "[+1]"_sv, E::UNEXPECTED_CHAR));
+    OK_ASSERT(fails_with(&arena, "[1\"a\"]"_sv, E::INVALID_NUMBER));
+    OK_ASSERT(fails_with(&arena, "[tru]"_sv, E::INVALID_LITERAL));
+    OK_ASSERT(fails_with(&arena, "[truex]"_sv, E::INVALID_LITERAL));
+    OK_ASSERT(fails_with(&arena, "[nul"_sv, E::INVALID_LITERAL));
+    OK_ASSERT(fails_with(&arena, "[1,]"_sv, E::UNEXPECTED_CHAR));
+    OK_ASSERT(fails_with(&arena, "[1 2]"_sv, E::UNEXPECTED_CHAR));
+    OK_ASSERT(fails_with(&arena, "{\"a\" 1}"_sv, E::UNEXPECTED_CHAR));
+    OK_ASSERT(fails_with(&arena, "{1: 2}"_sv, E::UNEXPECTED_CHAR));
+    OK_ASSERT(fails_with(&arena, "{\"a\": 1,}"_sv, E::UNEXPECTED_CHAR));
+    OK_ASSERT(fails_with(&arena, "[}"_sv, E::UNEXPECTED_CHAR));
+    OK_ASSERT(fails_with(&arena, "[] []"_sv, E::UNEXPECTED_CHAR));
+    OK_ASSERT(fails_with(&arena, "\"a\"b"_sv, E::UNEXPECTED_CHAR));
+    OK_ASSERT(fails_with(&arena, "[\x0c]"_sv, E::UNEXPECTED_CHAR));
+    OK_ASSERT(fails_with(&arena, "[1, [2"_sv, E::UNEXPECTED_END));
+    OK_ASSERT(fails_with(&arena, "{\"a\":"_sv, E::UNEXPECTED_END));
+
+    Optional<E> error = parse(&arena, &doc, "[1, x]"_sv);
+    OK_ASSERT(error && error.value == E::UNEXPECTED_CHAR && doc.error_offset == 4);
+
+    String deep = String::alloc(&arena);
+    for (U32 i = 0; i < JsonDocument::MAX_DEPTH; i++) deep.append("["_sv);
+    for (U32 i = 0; i < JsonDocument::MAX_DEPTH; i++) deep.append("]"_sv);
+    OK_ASSERT(!parse(&arena, &doc, deep.view()).has_value());
+    deep.append("]"_sv);
+    OK_ASSERT(fails_with(&arena, deep.view(), E::UNEXPECTED_CHAR));
+    deep = String::alloc(&arena);
+    for (U32 i = 0; i <= JsonDocument::MAX_DEPTH; i++) deep.append("["_sv);
+    OK_ASSERT(fails_with(&arena, deep.view(), E::TOO_DEEP));
+
+    // Strings and escapes across the 64 byte blocks of the index.
+    char buf[300];
+    for (UZ offset = 0; offset < 140; offset++) {
+        for (UZ backslashes = 0; backslashes < 5; backslashes++) {
+            UZ count = 0;
+            buf[count++] = '[';
+            for (UZ i = 0; i < offset; i++) buf[count++] = ' ';
+            buf[count++] = '"';
+            for (UZ i = 0; i < backslashes; i++) buf[count++] = '\\';
+            buf[count++] = '"';
+            buf[count++] = ',';
+            buf[count++] = '1';
+            buf[count++] = ']';
+
+            // An odd number of backslashes escapes the quote, leaving the string open.
+            error = parse(&arena, &doc, StringView{buf, count});
+            if (backslashes % 2 == 1) {
+                OK_ASSERT(error && error.value == E::UNCLOSED_STRING);
+            } else {
+                OK_ASSERT(!error && doc.root().count() == 2);
+                OK_ASSERT(doc.root().at(0).value.get_string(&s) && s.count == backslashes / 2);
+                S32 one;
+                OK_ASSERT(doc.root().at(1).value.get_int(&one) && one == 1);
+            }
+        }
+    }
+
+    // The writer.
+    String out = String::alloc(&arena);
+    FormatWriter w = format_writer_for(&out);
+    JsonWriter json = JsonWriter::to(&w);
+    json.begin_object();
+    json.key("a"_sv);
+    json.value_int(-12);
+    json.key("b"_sv);
+    json.begin_array();
+    json.value_bool(true);
+    json.value_null();
+    json.value_f64(0.1);
+    json.value_f64(1.0 / 0.0);
+    json.value_string("q\"\\\n\x01\x7f"_sv);
+    json.begin_object();
+    json.end_object();
+    json.end_array();
+    json.key("c"_sv);
+    json.value_raw("[1, 2]"_sv);
+    json.end_object();
+    w.finish();
+    OK_ASSERT(json.depth == 0);
+    OK_ASSERT(out == R"({"a":-12,"b":[true,null,0.1,null,"q\"\\\n\u0001)" "\x7f" R"(",{}],"c":[1, 2]})"_sv);
+
+    // Random documents, written and parsed back, then written again from the parsed values.
+    for (int round = 0; round < 3000; round++) {
+        String written = String::alloc(&arena);
+        w = format_writer_for(&written);
+        json = JsonWriter::to(&w);
+        random_value(&json, 0);
+        w.finish();
+
+        OK_ASSERT(!parse(&arena, &doc, written.view()).has_value());
+        OK_ASSERT(rewrite(&arena, doc.root()) == written);
+
+        // Breaking a byte anywhere might make it invalid, but never crashes, and what does parse
+        // is consistent.
+        if (written.count() > 0) {
+            UZ count = written.count();
+            char* broken = arena.alloc<char>(count);
+            memcpy(broken, written.view().data, count);
+            const char noise[] = "[]{}:,\"\\ 0e-.tfn\x01";
+            broken[next_random() % count] = noise[next_random() % (sizeof(noise) - 1)];
+            if (!parse(&arena, &doc, StringView{broken, count}).has_value()) {
+                String again = rewrite(&arena, doc.root());
+                OK_ASSERT(!parse(&arena, &doc, again.view()).has_value());
+                OK_ASSERT(rewrite(&arena, doc.root()) == again);
+            }
+        }
+
+        if (round % 256 == 255) arena.reset();
+    }
+
+    // Into a buffered file, bigger than its buffer.
+    {
+        File file;
+        OK_ASSERT(!create_temp_file(&file).has_value());
+
+        FileFormatTarget target{&file, Optional<File::WriteError>::empty(), {}};
+        w = format_writer_for(&target);
+        json = JsonWriter::to(&w);
+        json.begin_array();
+        for (int i = 0; i < 5000; i++) json.value_int(i);
+        json.end_array();
+        w.finish();
+        OK_ASSERT(!target.error.has_value());
+
+        file.seek_start();
+        List<U8> contents;
+        OK_ASSERT(!file.read_full(&arena, &contents).has_value());
+        OK_ASSERT(!parse(&arena, &doc, StringView{(const char*)contents.items, contents.count}).has_value());
+        OK_ASSERT(doc.root().count() == 5000);
+        S32 last;
+        OK_ASSERT(doc.root().at(4999).value.get_int(&last) && last == 4999);
+
+        OK_ASSERT(!file.close());
+        file.remove();
+    }
+
+    arena.free();
+    return 0;
+}
@@ -3,6 +3,24 @@
 
 using namespace ok;
 
+// Asserts that nothing is copied out of a value that was already destroyed. The check runs
+// first thing, as the copy can land on top of the value it's copied from.
+struct Checked {
+    static U32 alive_value(const Checked& other) {
+        OK_ASSERT(!other.destroyed);
+        return other.value;
+    }
+
+    Checked(U32 v) : value(v), destroyed(false) {}
+    Checked(const Checked& other) : value(alive_value(other)), destroyed(false) {}
+    ~Checked() {
+        destroyed = true;
+    }
+
+    U32 value;
+    bool destroyed;
+};
+
 int main() {
     ArenaAllocator arena{};
 
@@ -24,5 +42,28 @@ int main() {
     OK_ASSERT(ints.head->value == 1337);
     OK_ASSERT(ints.head->next->value == 0);
 
+    auto* popped = ints.pop_front();
+    OK_ASSERT(popped->value == 1337);
+    OK_ASSERT(ints.head->value == 0);
+    OK_ASSERT(ints.head->prev == nullptr);
+
+    // The popped node gets recycled by the next insertion.
+    ints.append(1000);
+    OK_ASSERT(ints.tail == popped);
+    OK_ASSERT(ints.tail->value == 1000);
+    OK_ASSERT(ints.tail->prev->value == 999);
+
+    ints.remove(ints.head->next);
+    OK_ASSERT(ints.head->next->value == 2);
+    OK_ASSERT(ints.head->next->prev == ints.head);
+
+    // Re-inserting a popped value reuses the very node it lives in.
+    LinkedList<Checked> checked = LinkedList<Checked>::alloc(&arena);
+    checked.append(Checked{1});
+    checked.append(Checked{2});
+    checked.append(checked.pop_front()->value);
+    OK_ASSERT(checked.head->value.value == 2);
+    OK_ASSERT(checked.tail->value.value == 1 && !checked.tail->value.destroyed);
+
     return 0;
 }
@@ -3,10 +3,23 @@
 
 using namespace ok;
 
+struct Counted {
+    Counted(int value) : value{value} { alive++; }
+    Counted(const Counted& other) : value{other.value} { alive++; }
+    Counted(Counted&& other) : value{other.value} { alive++; moves++; }
+    Counted& operator =(const Counted&) = default;
+    ~Counted() { alive--; value = -1; }
+
+    int value;
+
+    static inline int alive = 0;
+    static inline int moves = 0;
+};
+
 int main() {
     size_t ints_cap = 90;
 
-    List<int> ints = List<int>::alloc(temp_allocator, ints_cap);
+    List<int> ints = List<int>::alloc(temp_allocator(), ints_cap);
 
     for (size_t i = 0; i < ints_cap; ++i) {
         ints.push(i);
@@ -19,5 +32,79 @@ int main() {
 
     OK_ASSERT(ints.capacity == OK_LIST_GROW_FACTOR(ints_cap));
 
+    ArenaAllocator arena{};
+
+    int some_ints[] = {1, 2, 3, 4, 5};
+    List<int> bulk = List<int>::alloc(&arena, 2);
+    bulk.append_slice(Slice<int>{some_ints, 5});
+    OK_ASSERT(bulk.count == 5);
+
+    bulk.insert_slice(1, Slice<int>{some_ints + 3, 2});
+    OK_ASSERT(bulk.count == 7);
+    OK_ASSERT(bulk[0] == 1 && bulk[1] == 4 && bulk[2] == 5 && bulk[3] == 2 && bulk[6] == 5);
+
+    bulk.remove_range(1, 3);
+    OK_ASSERT(bulk.count == 5);
+    OK_ASSERT(bulk[1] == 2 && bulk[4] == 5);
+
+    bulk.swap_remove(0);
+    OK_ASSERT(bulk.count == 4);
+    OK_ASSERT(bulk[0] == 5 && bulk[1] == 2);
+
+    bulk.retain([](int x) { return x % 2 == 0; });
+    OK_ASSERT(bulk.count == 2);
+    OK_ASSERT(bulk[0] == 2 && bulk[1] == 4);
+
+    List<int> bulk_copy = bulk.copy(&arena);
+    OK_ASSERT(bulk_copy.count == 2 && bulk_copy[1] == 4);
+
+    {
+        List<Counted> counted = List<Counted>::alloc(&arena, 2);
+        Counted values[] = {1, 2, 3, 4};
+        counted.append_slice(Slice<Counted>{values, 4});
+        OK_ASSERT(Counted::alive == 8);
+
+        counted.remove_range(0, 2);
+        OK_ASSERT(Counted::alive == 6);
+        OK_ASSERT(counted[0].value == 3);
+
+        counted.retain([](const Counted& c) { return c.value == 4; });
+        OK_ASSERT(Counted::alive == 5);
+        OK_ASSERT(counted.count == 1 && counted[0].value == 4);
+
+        Counted::moves = 0;
+        Counted five{5};
+        counted.push(move(five));
+        OK_ASSERT(Counted::moves == 1);
+
+        // Growing past the capacity moves the live elements over instead of copying them.
+        OK_ASSERT(counted.capacity == 4);
+        counted.emplace(6);
+        counted.emplace(7);
+        counted.emplace(8);
+        OK_ASSERT(counted.count == 5 && counted[4].value == 8);
+        OK_ASSERT(Counted::moves == 5);
+    }
+
+    {
+        // Appending and inserting parts of the list itself, across a reallocation.
+        List<Counted> counted = List<Counted>::alloc(&arena, 2);
+        counted.emplace(1);
+        counted.emplace(2);
+        arena.alloc<U8>(1);
+        counted.append_slice(counted.slice());
+        OK_ASSERT(counted.count == 4 && counted[2].value == 1 && counted[3].value == 2);
+
+        List<int> self = List<int>::alloc(&arena, 5);
+        for (int i = 0; i < 5; i++) self.push(i);
+        arena.alloc<U8>(1);
+        self.insert_slice(2, self.slice(1, 4));
+        int expected[] = {0, 1, 1, 2, 3, 2, 3, 4};
+        OK_ASSERT(self.count == 8 && memcmp(self.items, expected, sizeof(expected)) == 0);
+
+        self.insert_slice(0, self.slice(6));
+        OK_ASSERT(self.count == 10 && self[0] == 3 && self[1] == 4 && self[2] == 0 && self[9] == 4);
+    }
+
     return 0;
 }
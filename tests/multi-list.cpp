@@ -20,4 +20,37 @@ int main() {
     OK_ASSERT(shorts[0] == -2);
     OK_ASSERT(strings[0] == "HELLO"_sv);
     OK_ASSERT(floats[0] == 1.5);
+
+    // Columns of the same type, addressed by index.
+    enum Column : UZ { X, Y, ID };
+    auto points = MultiList<F32, F32, U32>::alloc(&arena, 2);
+
+    for (U32 i = 0; i < 100; ++i) points.push((F32)i, (F32)i * 2, i);
+
+    OK_ASSERT(points.count == 100);
+    OK_ASSERT(points.at<Y>(10) == 20.0f);
+    OK_ASSERT((uintptr_t)points.items<X>() % OK_CACHE_LINE_SIZE == 0);
+    OK_ASSERT((uintptr_t)points.items<Y>() % OK_CACHE_LINE_SIZE == 0);
+
+    F32 xs[] = {-1, -2};
+    F32 ys[] = {-3, -4};
+    U32 ids[] = {1000, 1001};
+    points.push_slices(Slice<F32>{xs, 2}, Slice<F32>{ys, 2}, Slice<U32>{ids, 2});
+    OK_ASSERT(points.count == 102);
+    OK_ASSERT(points.at<ID>(101) == 1001);
+
+    points.swap_remove(0);
+    OK_ASSERT(points.count == 101);
+    OK_ASSERT(points.at<X>(0) == -2.0f && points.at<ID>(0) == 1001);
+
+    F32 sum = 0;
+    points.for_each<X, Y>([&](F32 x, F32 y) { sum += x + y; });
+    OK_ASSERT(sum == 3.0f * 4950.0f - 10.0f);
+
+    Slice<U32> id_column = points.column<ID>();
+    OK_ASSERT(id_column.count == 101);
+    OK_ASSERT(id_column.find_index((U32)50) == 50);
+
+    points.dealloc();
+    OK_ASSERT(points.count == 0);
 }
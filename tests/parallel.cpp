@@ -0,0 +1,90 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+struct Greater {
+    static bool less(const U64& a, const U64& b) {
+        return a > b;
+    }
+};
+
+int main() {
+    ArenaAllocator arena{};
+    ThreadPool pool = ThreadPool::alloc(&arena, 4);
+    OK_ASSERT(pool.get_thread_count() == 4);
+
+    const UZ n = 100000;
+    List<U64> items = List<U64>::alloc(&arena, n);
+    for (UZ i = 0; i < n; i++) items.push(i);
+
+    // Every index is visited exactly once.
+    List<U32> visits = List<U32>::alloc(&arena, n);
+    for (UZ i = 0; i < n; i++) visits.push(0);
+    parallel_for(&pool, n, [&](UZ start, UZ end) {
+        for (UZ i = start; i < end; i++) visits[i]++;
+    }, 1000);
+    for (UZ i = 0; i < n; i++) OK_ASSERT(visits[i] == 1);
+
+    U64 sum = parallel_reduce(&pool, items.slice(), (U64)0, [](U64 a, U64 b) { return a + b; }, 1000);
+    OK_ASSERT(sum == (U64)n * (n - 1) / 2);
+
+    U64 biggest = parallel_reduce(&pool, items.slice(), (U64)0, [](U64 a, U64 b) { return max(a, b); });
+    OK_ASSERT(biggest == n - 1);
+
+    List<U64> squares = List<U64>::alloc(&arena, n);
+    squares.count = n;
+    parallel_transform(&pool, items.slice(), squares.slice(), [](U64 x) { return x * x; }, 500);
+    for (UZ i = 0; i < n; i++) OK_ASSERT(squares[i] == (U64)i * i);
+
+    List<U64> ones = List<U64>::alloc(&arena, n);
+    for (UZ i = 0; i < n; i++) ones.push(1);
+    parallel_prefix_sum(&pool, ones.slice(), &arena, 777);
+    for (UZ i = 0; i < n; i++) OK_ASSERT(ones[i] == i + 1);
+
+    // Sort a scrambled permutation.
+    for (UZ i = 0; i < n; i++) items[i] = (i * 7919) % n;
+    parallel_sort(&pool, items.slice(), &arena, 1000);
+    for (UZ i = 0; i < n; i++) OK_ASSERT(items[i] == i);
+
+    parallel_sort<U64, Greater>(&pool, items.slice(), &arena, 1000);
+    for (UZ i = 0; i < n; i++) OK_ASSERT(items[i] == n - 1 - i);
+
+    // Nested joins.
+    U64 nested = 0;
+    pool.join([&] {
+        nested += parallel_reduce(&pool, items.slice(), (U64)0, [](U64 a, U64 b) { return a + b; }, 100);
+    }, [] {});
+    OK_ASSERT(nested == sum);
+
+    // A task of one pool using another, which uses the first one again. The thread stays a
+    // worker of the outer pool throughout, instead of queueing up behind itself.
+    ThreadPool inner = ThreadPool::alloc(&arena, 2);
+    U64 outer_sum = 0;
+    U64 inner_sum = 0;
+    pool.run([&] {
+        inner_sum = parallel_reduce(&inner, items.slice(), (U64)0, [&](U64 a, U64 b) {
+            OK_ASSERT(inner.current_worker() != nullptr);
+            return a + b;
+        }, 1000);
+        inner.run([&] {
+            OK_ASSERT(pool.current_worker() != nullptr);
+            outer_sum = parallel_reduce(&pool, items.slice(), (U64)0, [](U64 a, U64 b) { return a + b; }, 1000);
+        });
+        OK_ASSERT(pool.current_worker() != nullptr && inner.current_worker() == nullptr);
+        outer_sum += parallel_reduce(&pool, items.slice(), (U64)0, [](U64 a, U64 b) { return a + b; }, 1000);
+    });
+    OK_ASSERT(inner_sum == sum && outer_sum == 2 * sum);
+    OK_ASSERT(pool.current_worker() == nullptr);
+
+    inner.dealloc();
+    pool.dealloc();
+
+    // A single-threaded pool runs everything on the caller.
+    ThreadPool serial = ThreadPool::alloc(&arena, 1);
+    U64 serial_sum = parallel_reduce(&serial, items.slice(), (U64)0, [](U64 a, U64 b) { return a + b; }, 10);
+    OK_ASSERT(serial_sum == sum);
+    serial.dealloc();
+
+    return 0;
+}
@@ -1,8 +1,21 @@
 #define OK_IMPLEMENTATION
 #include "../ok.hpp"
+#include "random.hpp"
 
 using namespace ok;
 
+template <typename T>
+static bool parses_to(StringView source, T expected) {
+    T value{};
+    return parse_int(source, &value) && value == expected;
+}
+
+template <typename T>
+static bool rejects(StringView source) {
+    T value{};
+    return !parse_int(source, &value);
+}
+
 int main() {
     int64_t i123, i_empty, i_neg;
     OK_ASSERT(parse_int64("123"_sv, &i123));
@@ -11,4 +24,80 @@ int main() {
 
     OK_ASSERT(i123 == 123);
     OK_ASSERT(i_neg == -999);
+
+    S64 i_plus;
+    OK_ASSERT(parse_int64("+42"_sv, &i_plus) && i_plus == 42);
+
+    // The edges of every width.
+    OK_ASSERT(parses_to<S8>("-128"_sv, -128));
+    OK_ASSERT(parses_to<S8>("127"_sv, 127));
+    OK_ASSERT(rejects<S8>("128"_sv));
+    OK_ASSERT(rejects<S8>("-129"_sv));
+    OK_ASSERT(parses_to<U8>("255"_sv, 255));
+    OK_ASSERT(rejects<U8>("256"_sv));
+    OK_ASSERT(rejects<U8>("-1"_sv));
+    OK_ASSERT(parses_to<U8>("-0"_sv, 0));
+    OK_ASSERT(parses_to<S16>("-32768"_sv, -32768));
+    OK_ASSERT(rejects<S16>("32768"_sv));
+    OK_ASSERT(parses_to<U16>("65535"_sv, 65535));
+    OK_ASSERT(parses_to<S32>("-2147483648"_sv, (S32)-2147483647 - 1));
+    OK_ASSERT(rejects<S32>("2147483648"_sv));
+    OK_ASSERT(parses_to<U32>("4294967295"_sv, 4294967295u));
+    OK_ASSERT(rejects<U32>("4294967296"_sv));
+    OK_ASSERT(parses_to<S64>("-9223372036854775808"_sv, (S64)(-9223372036854775807ll - 1)));
+    OK_ASSERT(parses_to<S64>("9223372036854775807"_sv, (S64)9223372036854775807ll));
+    OK_ASSERT(rejects<S64>("9223372036854775808"_sv));
+    OK_ASSERT(parses_to<U64>("18446744073709551615"_sv, (U64)18446744073709551615ull));
+    OK_ASSERT(rejects<U64>("18446744073709551616"_sv));
+    OK_ASSERT(rejects<U64>("99999999999999999999999999"_sv));
+    OK_ASSERT(parses_to<U64>("000000000000000000000000000042"_sv, (U64)42));
+
+    const char* invalid[] = {"", "-", "+", "+-1", "1 ", " 1", "1a", "0x", "--1", "12.5"};
+    for (UZ i = 0; i < OK_ARR_LEN(invalid); i++) OK_ASSERT(rejects<S64>(StringView{invalid[i]}));
+
+    // Other bases, with or without a prefix.
+    U32 u32;
+    OK_ASSERT(parse_int("ff"_sv, &u32, nullptr, 16) && u32 == 255);
+    OK_ASSERT(parse_int("0xDeadBeef"_sv, &u32, nullptr, 16) && u32 == 0xdeadbeef);
+    OK_ASSERT(parse_int("0xDeadBeef"_sv, &u32, nullptr, 0) && u32 == 0xdeadbeef);
+    OK_ASSERT(parse_int("0b1011"_sv, &u32, nullptr, 0) && u32 == 11);
+    OK_ASSERT(parse_int("1011"_sv, &u32, nullptr, 2) && u32 == 11);
+    OK_ASSERT(parse_int("0o777"_sv, &u32, nullptr, 0) && u32 == 511);
+    OK_ASSERT(parse_int("777"_sv, &u32, nullptr, 8) && u32 == 511);
+    OK_ASSERT(parse_int("0777"_sv, &u32, nullptr, 0) && u32 == 777);
+    OK_ASSERT(!parse_int("102"_sv, &u32, nullptr, 2));
+    OK_ASSERT(!parse_int("0x1ffffffff"_sv, &u32, nullptr, 16));
+    S32 s32;
+    OK_ASSERT(parse_int("-0x80000000"_sv, &s32, nullptr, 0) && s32 == (S32)-2147483647 - 1);
+
+    // Stopping at the first non-digit, for streaming parsers.
+    UZ consumed = 0;
+    OK_ASSERT(parse_int("123,456"_sv, &u32, &consumed) && u32 == 123 && consumed == 3);
+    OK_ASSERT(parse_int("12345678901234,x"_sv, &i123, &consumed) && i123 == 12345678901234 && consumed == 14);
+    OK_ASSERT(parse_int("0x"_sv, &u32, &consumed, 16) && u32 == 0 && consumed == 1);
+    OK_ASSERT(!parse_int(",1"_sv, &u32, &consumed));
+
+    // Against `snprintf` output, at every length and with trailing text to exercise the
+    // eight digits at a time path.
+    char buf[64];
+    for (int i = 0; i < 200000; i++) {
+        U64 value = next_random() >> (next_random() % 64);
+        bool negative = next_random() % 2 == 0;
+
+        int count = snprintf(buf, sizeof(buf), "%s%llu", negative ? "-" : "", (unsigned long long)value);
+        S64 parsed = 0;
+        bool fits = !negative ? value <= 9223372036854775807ull : value <= 9223372036854775808ull;
+        OK_ASSERT(parse_int(StringView{buf, (UZ)count}, &parsed) == fits);
+        if (fits) OK_ASSERT((U64)parsed == (negative ? 0 - value : value));
+
+        count = snprintf(buf, sizeof(buf), "%llu;rest", (unsigned long long)value);
+        U64 parsed_unsigned;
+        OK_ASSERT(parse_int(StringView{buf, (UZ)count}, &parsed_unsigned, &consumed));
+        OK_ASSERT(parsed_unsigned == value && buf[consumed] == ';');
+
+        count = snprintf(buf, sizeof(buf), "%llx", (unsigned long long)value);
+        OK_ASSERT(parse_int(StringView{buf, (UZ)count}, &parsed_unsigned, nullptr, 16) && parsed_unsigned == value);
+    }
+
+    return 0;
 }
@@ -0,0 +1,60 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+struct Greater {
+    static bool less(const U32& a, const U32& b) {
+        return a > b;
+    }
+};
+
+int main() {
+    ArenaAllocator arena{};
+
+    auto queue = PriorityQueue<U32>::alloc(&arena);
+    U32 values[] = {42, 7, 19, 3, 88, 3, 61, 25, 0, 14};
+
+    for (U32 v : values) queue.push(v);
+    OK_ASSERT(queue.peek() == 0);
+
+    U32 prev = 0;
+    while (queue.get_count() > 0) {
+        U32 v = queue.pop();
+        OK_ASSERT(v >= prev);
+        prev = v;
+    }
+    OK_ASSERT(prev == 88);
+
+    auto max_queue = PriorityQueue<U32, Greater>::from(&arena, Slice<U32>{values, OK_ARR_LEN(values)});
+    OK_ASSERT(max_queue.get_count() == OK_ARR_LEN(values));
+    OK_ASSERT(max_queue.pop() == 88);
+    OK_ASSERT(max_queue.pop() == 61);
+    OK_ASSERT(max_queue.pop() == 42);
+
+    auto deadlines = IndexedPriorityQueue<U64>::alloc(&arena);
+    for (U32 id = 0; id < 50; ++id) deadlines.push(id, 1000 + id);
+
+    OK_ASSERT(deadlines.peek() == 0);
+
+    deadlines.decrease_key(30, 5);
+    OK_ASSERT(deadlines.peek() == 30);
+
+    deadlines.update(30, 2000);
+    deadlines.remove(0);
+    OK_ASSERT(!deadlines.contains(0));
+    OK_ASSERT(deadlines.pop() == 1);
+
+    U64 last_priority = 0;
+    U32 last_id = 0;
+    while (deadlines.get_count() > 0) {
+        U32 id = deadlines.peek();
+        U64 priority = deadlines.priority(id);
+        OK_ASSERT(priority >= last_priority);
+        last_priority = priority;
+        last_id = deadlines.pop();
+    }
+    OK_ASSERT(last_id == 30);
+
+    return 0;
+}
@@ -0,0 +1,229 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+static constexpr U64 ITEMS_PER_PRODUCER = 100000;
+static constexpr UZ PRODUCERS = 3;
+static constexpr UZ CONSUMERS = 3;
+
+static UZ tracked_destroyed = 0;
+
+struct Tracked {
+    ~Tracked() {
+        tracked_destroyed++;
+    }
+
+    U64 value;
+};
+
+// Has no default constructor, so the queues can't create one to drain into.
+struct Handle {
+    explicit Handle(U64 value) : value(value) {}
+
+    ~Handle() {
+        tracked_destroyed++;
+    }
+
+    U64 value;
+};
+
+struct SpscContext {
+    SpscQueue<U64>* queue;
+    U64 sum;
+};
+
+static void spsc_producer(void* arg) {
+    SpscContext* ctx = (SpscContext*)arg;
+    U64 batch[16];
+
+    U64 next = 0;
+    while (next < ITEMS_PER_PRODUCER) {
+        // Alternate between single pushes and batches.
+        if (next % 2 == 0) {
+            if (ctx->queue->push(next)) next++;
+            else yield_thread();
+        } else {
+            UZ count = min((U64)OK_ARR_LEN(batch), ITEMS_PER_PRODUCER - next);
+            for (UZ i = 0; i < count; i++) batch[i] = next + i;
+            UZ pushed = ctx->queue->push_many(batch, count);
+            if (pushed == 0) yield_thread();
+            next += pushed;
+        }
+    }
+}
+
+static void spsc_consumer(void* arg) {
+    SpscContext* ctx = (SpscContext*)arg;
+    U64 batch[7];
+
+    U64 expected = 0;
+    while (expected < ITEMS_PER_PRODUCER) {
+        UZ count = ctx->queue->pop_many(batch, OK_ARR_LEN(batch));
+        if (count == 0) yield_thread();
+        for (UZ i = 0; i < count; i++) {
+            // A single producer keeps its order.
+            OK_ASSERT(batch[i] == expected);
+            expected++;
+            ctx->sum += batch[i];
+        }
+    }
+}
+
+struct MpmcContext {
+    MpmcQueue<U64>* queue;
+    Atomic<U64> sum;
+    Atomic<U64> popped;
+};
+
+struct MpmcThreadArg {
+    MpmcContext* ctx;
+    UZ index;
+};
+
+static void mpmc_producer(void* arg) {
+    MpmcThreadArg* thread_arg = (MpmcThreadArg*)arg;
+    U64 base = thread_arg->index * ITEMS_PER_PRODUCER;
+
+    for (U64 i = 0; i < ITEMS_PER_PRODUCER; i++) {
+        while (!thread_arg->ctx->queue->push(base + i)) yield_thread();
+    }
+}
+
+static void mpmc_consumer(void* arg) {
+    MpmcContext* ctx = ((MpmcThreadArg*)arg)->ctx;
+    U64 local_sum = 0;
+
+    while (ctx->popped.load(MemoryOrder::RELAXED) < PRODUCERS * ITEMS_PER_PRODUCER) {
+        U64 item;
+        if (ctx->queue->pop(&item)) {
+            local_sum += item;
+            ctx->popped.fetch_add(1, MemoryOrder::RELAXED);
+        } else {
+            yield_thread();
+        }
+    }
+
+    ctx->sum.fetch_add(local_sum);
+}
+
+int main() {
+    ArenaAllocator arena{};
+
+    // Single threaded behaviour.
+    {
+        SpscQueue<U64> queue = SpscQueue<U64>::alloc(&arena, 5);
+        OK_ASSERT(queue.get_capacity() == 8);
+
+        U64 out;
+        OK_ASSERT(!queue.pop(&out));
+        for (U64 i = 0; i < 8; i++) OK_ASSERT(queue.push(i));
+        OK_ASSERT(!queue.push(8));
+        OK_ASSERT(queue.get_count() == 8);
+
+        OK_ASSERT(queue.pop(&out) && out == 0);
+        U64 items[10];
+        OK_ASSERT(queue.pop_many(items, 3) == 3);
+        OK_ASSERT(items[0] == 1 && items[2] == 3);
+
+        U64 more[6] = {10, 11, 12, 13, 14, 15};
+        OK_ASSERT(queue.push_many(more, 6) == 4);
+        OK_ASSERT(queue.pop_many(items, 10) == 8);
+        OK_ASSERT(items[3] == 7 && items[4] == 10 && items[7] == 13);
+
+        queue.dealloc();
+    }
+
+    {
+        MpmcQueue<U64> queue = MpmcQueue<U64>::alloc(&arena, 4);
+        U64 out;
+        OK_ASSERT(!queue.pop(&out));
+        for (U64 i = 0; i < 4; i++) OK_ASSERT(queue.push(i));
+        OK_ASSERT(!queue.push(4));
+        for (U64 i = 0; i < 4; i++) OK_ASSERT(queue.pop(&out) && out == i);
+        OK_ASSERT(!queue.pop(&out));
+        queue.dealloc();
+    }
+
+    // Items still in the queue get destroyed on `dealloc`.
+    {
+        MpmcQueue<Tracked> queue = MpmcQueue<Tracked>::alloc(&arena, 4);
+        OK_ASSERT(queue.push(Tracked{1}));
+        OK_ASSERT(queue.push(Tracked{2}));
+        OK_ASSERT(queue.push(Tracked{3}));
+
+        Tracked out{};
+        OK_ASSERT(queue.pop(&out) && out.value == 1);
+
+        UZ before = tracked_destroyed;
+        queue.dealloc();
+        OK_ASSERT(tracked_destroyed - before == 2);
+
+        // Go around the ring a few times so the remaining items straddle the wrap.
+        MpmcQueue<Handle> handles = MpmcQueue<Handle>::alloc(&arena, 4);
+        Handle popped{0};
+        for (U64 i = 0; i < 10; i++) {
+            OK_ASSERT(handles.push(Handle{i}));
+            OK_ASSERT(handles.pop(&popped) && popped.value == i);
+        }
+        OK_ASSERT(handles.push(Handle{10}));
+        OK_ASSERT(handles.push(Handle{11}));
+        OK_ASSERT(handles.push(Handle{12}));
+        before = tracked_destroyed;
+        handles.dealloc();
+        OK_ASSERT(tracked_destroyed - before == 3);
+
+        SpscQueue<Tracked> spsc = SpscQueue<Tracked>::alloc(&arena, 4);
+        OK_ASSERT(spsc.push(Tracked{1}));
+        OK_ASSERT(spsc.push(Tracked{2}));
+        before = tracked_destroyed;
+        spsc.dealloc();
+        OK_ASSERT(tracked_destroyed - before == 2);
+    }
+
+    // Cross thread handoff.
+    {
+        SpscQueue<U64> queue = SpscQueue<U64>::alloc(&arena, 64);
+        SpscContext ctx{&queue, 0};
+
+        Thread producer{};
+        Thread consumer{};
+        producer.start(spsc_producer, &ctx);
+        consumer.start(spsc_consumer, &ctx);
+        producer.join();
+        consumer.join();
+
+        OK_ASSERT(ctx.sum == ITEMS_PER_PRODUCER * (ITEMS_PER_PRODUCER - 1) / 2);
+        queue.dealloc();
+    }
+
+    {
+        MpmcQueue<U64> queue = MpmcQueue<U64>::alloc(&arena, 64);
+        MpmcContext ctx{};
+        ctx.queue = &queue;
+
+        Thread producers[PRODUCERS]{};
+        Thread consumers[CONSUMERS]{};
+        MpmcThreadArg args[PRODUCERS + CONSUMERS];
+
+        for (UZ i = 0; i < PRODUCERS; i++) {
+            args[i] = {&ctx, i};
+            producers[i].start(mpmc_producer, &args[i]);
+        }
+        for (UZ i = 0; i < CONSUMERS; i++) {
+            args[PRODUCERS + i] = {&ctx, i};
+            consumers[i].start(mpmc_consumer, &args[PRODUCERS + i]);
+        }
+
+        for (UZ i = 0; i < PRODUCERS; i++) producers[i].join();
+        for (UZ i = 0; i < CONSUMERS; i++) consumers[i].join();
+
+        U64 total = PRODUCERS * ITEMS_PER_PRODUCER;
+        OK_ASSERT(ctx.popped.load() == total);
+        OK_ASSERT(ctx.sum.load() == total * (total - 1) / 2);
+        queue.dealloc();
+    }
+
+    arena.free();
+    return 0;
+}
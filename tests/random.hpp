@@ -0,0 +1,15 @@
+#ifndef OK_TESTS_RANDOM_H_
+#define OK_TESTS_RANDOM_H_
+
+// Xorshift generator for the tests and benchmarks. The seed is fixed, so every run sees
+// the same inputs and a failure can be reproduced.
+static U64 rng_state = 0x9e3779b97f4a7c15;
+
+static U64 next_random() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+#endif // OK_TESTS_RANDOM_H_
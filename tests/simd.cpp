@@ -0,0 +1,98 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "random.hpp"
+
+using namespace ok;
+
+static int sign(int x) {
+    return (x > 0) - (x < 0);
+}
+
+template <typename T>
+static void check_find_and_count() {
+    T items[300];
+
+    for (UZ count = 0; count <= OK_ARR_LEN(items); count += 7) {
+        for (UZ i = 0; i < count; i++) items[i] = (T)(next_random() % 4);
+
+        for (T value = 0; value < 5; value++) {
+            UZ expected_idx = (UZ)-1;
+            UZ expected_count = 0;
+            for (UZ i = 0; i < count; i++) {
+                if (items[i] == value) {
+                    if (expected_idx == (UZ)-1) expected_idx = i;
+                    expected_count++;
+                }
+            }
+
+            OK_ASSERT(simd_find(items, count, value) == expected_idx);
+            OK_ASSERT(simd_count(items, count, value) == expected_count);
+        }
+    }
+}
+
+static UZ naive_find(const U8* h, UZ n, const U8* needle, UZ m) {
+    if (m > n) return (UZ)-1;
+    for (UZ i = 0; i + m <= n; i++) {
+        if (memcmp(h + i, needle, m) == 0) return i;
+    }
+    return (UZ)-1;
+}
+
+static UZ naive_rfind(const U8* h, UZ n, const U8* needle, UZ m) {
+    if (m > n) return (UZ)-1;
+    for (UZ i = n - m + 1; i > 0; i--) {
+        if (memcmp(h + i - 1, needle, m) == 0) return i - 1;
+    }
+    return (UZ)-1;
+}
+
+int main() {
+    check_find_and_count<U8>();
+    check_find_and_count<U16>();
+    check_find_and_count<U32>();
+    check_find_and_count<U64>();
+
+    // Equality and ordering over every length and mismatch position.
+    U8 a[100];
+    U8 b[100];
+    for (UZ size = 0; size <= OK_ARR_LEN(a); size++) {
+        for (UZ i = 0; i < size; i++) a[i] = b[i] = (U8)next_random();
+
+        OK_ASSERT(simd_equal(a, b, size));
+        OK_ASSERT(simd_compare(a, b, size) == 0);
+
+        for (UZ pos = 0; pos < size; pos++) {
+            U8 saved = b[pos];
+            b[pos] = (U8)(saved + 1 + next_random() % 255);
+
+            OK_ASSERT(!simd_equal(a, b, size));
+            OK_ASSERT(sign(simd_compare(a, b, size)) == sign(memcmp(a, b, size)));
+
+            b[pos] = saved;
+        }
+    }
+
+    // Substring search on a small alphabet, so there are plenty of partial matches.
+    U8 haystack[200];
+    for (int round = 0; round < 2000; round++) {
+        UZ n = next_random() % OK_ARR_LEN(haystack);
+        for (UZ i = 0; i < n; i++) haystack[i] = 'a' + next_random() % 3;
+
+        U8 needle[8];
+        UZ m = 1 + next_random() % OK_ARR_LEN(needle);
+        for (UZ i = 0; i < m; i++) needle[i] = 'a' + next_random() % 3;
+
+        OK_ASSERT(simd_find_bytes(haystack, n, needle, m) == naive_find(haystack, n, needle, m));
+        OK_ASSERT(simd_rfind_bytes(haystack, n, needle, m) == naive_rfind(haystack, n, needle, m));
+    }
+
+    List<U32> ids = List<U32>::alloc(temp_allocator());
+    for (U32 i = 0; i < 100; i++) ids.push(i % 10);
+    OK_ASSERT(ids.find_index((U32)7) == 7);
+    OK_ASSERT(ids.count_of((U32)7) == 10);
+    OK_ASSERT(ids.contains((U32)9));
+    OK_ASSERT(!ids.contains((U32)10));
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "random.hpp"
+
+using namespace ok;
+
+struct Entity {
+    U32 id;
+    F32 x;
+};
+
+int main() {
+    ArenaAllocator arena{};
+
+    SlotMap<Entity> map = SlotMap<Entity>::alloc(&arena);
+
+    SlotHandle a = map.insert(Entity{1, 1.0f});
+    SlotHandle b = map.insert(Entity{2, 2.0f});
+    SlotHandle c = map.insert(Entity{3, 3.0f});
+    OK_ASSERT(map.get_count() == 3);
+    OK_ASSERT(map.get(b).get().id == 2);
+    OK_ASSERT(!map.has(SlotHandle{0}));
+
+    map.get_ref(c).get().x = 30.0f;
+    OK_ASSERT(map.get(c).get().x == 30.0f);
+
+    // Removing from the middle moves the last value into the hole, handles stay valid.
+    OK_ASSERT(map.remove(a));
+    OK_ASSERT(!map.remove(a));
+    OK_ASSERT(!map.has(a));
+    OK_ASSERT(!map.get(a).has_value());
+    OK_ASSERT(map.get(c).get().id == 3);
+    OK_ASSERT(map.get(b).get().id == 2);
+    OK_ASSERT(map.values.count == 2);
+
+    // The freed slot is reused, but the old handle doesn't see the new value.
+    SlotHandle d = map.insert(Entity{4, 4.0f});
+    OK_ASSERT(d.index() == a.index());
+    OK_ASSERT(d.generation() != a.generation());
+    OK_ASSERT(!map.has(a));
+    OK_ASSERT(map.get(d).get().id == 4);
+
+    for (UZ i = 0; i < map.values.count; i++) {
+        OK_ASSERT(map.get(map.handle_at(i)).get().id == map.values[i].id);
+    }
+
+    map.clear();
+    OK_ASSERT(map.get_count() == 0);
+    OK_ASSERT(!map.has(b) && !map.has(c) && !map.has(d));
+
+    // Random inserts and removals against a list of live handles.
+    List<SlotHandle> live = List<SlotHandle>::alloc(&arena);
+    List<SlotHandle> dead = List<SlotHandle>::alloc(&arena);
+    List<U32> expected = List<U32>::alloc(&arena);
+
+    for (U32 step = 0; step < 20000; step++) {
+        if (live.count == 0 || next_random() % 3 != 0) {
+            live.push(map.insert(Entity{step, 0.0f}));
+            expected.push(step);
+        } else {
+            UZ victim = next_random() % live.count;
+            OK_ASSERT(map.remove(live[victim]));
+            dead.push(live[victim]);
+            live.swap_remove(victim);
+            expected.swap_remove(victim);
+        }
+    }
+
+    OK_ASSERT(map.get_count() == live.count);
+    for (UZ i = 0; i < live.count; i++) OK_ASSERT(map.get(live[i]).get().id == expected[i]);
+    for (UZ i = 0; i < dead.count; i++) OK_ASSERT(!map.has(dead[i]));
+
+    map.dealloc();
+    arena.free();
+    return 0;
+}
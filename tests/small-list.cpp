@@ -0,0 +1,40 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+int main() {
+    FixedBufferAllocator a{};
+
+    SmallList<U32, 3> ints = SmallList<U32, 3>::alloc(&a);
+
+    ints.push(1);
+    ints.push(2);
+    ints.push(3);
+
+    OK_ASSERT(ints.is_inline());
+    OK_ASSERT(a.buffer == nullptr);
+    OK_ASSERT(ints.find_index((U32)3) == 2);
+
+    ints.push(4);
+
+    OK_ASSERT(!ints.is_inline());
+    OK_ASSERT(ints.count == 4);
+    OK_ASSERT(ints.get_capacity() == OK_LIST_GROW_FACTOR(3));
+
+    Slice<U32> ints_slice = ints.slice(1);
+    OK_ASSERT(ints_slice.count == 3);
+    OK_ASSERT(ints_slice[0] == 2);
+    OK_ASSERT(ints_slice[2] == 4);
+
+    ints.remove_at(0);
+    OK_ASSERT(ints[0] == 2);
+    OK_ASSERT(ints.pop() == 4);
+    OK_ASSERT(ints.count == 2);
+
+    ints.dealloc();
+    OK_ASSERT(ints.is_inline());
+    OK_ASSERT(ints.count == 0);
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "random.hpp"
+
+using namespace ok;
+
+struct Record {
+    S32 key;
+    U32 seq;
+};
+
+struct ByKey {
+    static bool less(const Record& a, const Record& b) {
+        return a.key < b.key;
+    }
+};
+
+struct Greater {
+    static bool less(const U32& a, const U32& b) {
+        return a > b;
+    }
+};
+
+template <typename T>
+static bool is_sorted(Slice<T> items) {
+    for (UZ i = 1; i < items.count; i++) {
+        if (items[i] < items[i - 1]) return false;
+    }
+    return true;
+}
+
+int main() {
+    ArenaAllocator arena{};
+
+    const UZ n = 3000;
+    List<S64> items = List<S64>::alloc(&arena, n);
+    List<S64> copy = List<S64>::alloc(&arena, n);
+
+    // Random, sorted, reversed and duplicate-heavy inputs.
+    for (int pattern = 0; pattern < 4; pattern++) {
+        items.count = 0;
+        for (UZ i = 0; i < n; i++) {
+            switch (pattern) {
+            case 0: items.push((S64)next_random()); break;
+            case 1: items.push((S64)i); break;
+            case 2: items.push((S64)(n - i)); break;
+            case 3: items.push((S64)(next_random() % 5) - 2); break;
+            }
+        }
+
+        U64 sum = 0;
+        for (UZ i = 0; i < n; i++) sum += (U64)items[i];
+
+        copy.count = 0;
+        copy.extend(items);
+        sort(copy.slice());
+        OK_ASSERT(is_sorted(copy.slice()));
+
+        copy.count = 0;
+        copy.extend(items);
+        stable_sort(copy.slice(), &arena);
+        OK_ASSERT(is_sorted(copy.slice()));
+
+        copy.count = 0;
+        copy.extend(items);
+        radix_sort(copy.slice(), &arena);
+        OK_ASSERT(is_sorted(copy.slice()));
+
+        U64 sorted_sum = 0;
+        for (UZ i = 0; i < n; i++) sorted_sum += (U64)copy[i];
+        OK_ASSERT(sorted_sum == sum);
+    }
+
+    U32 small[] = {5, 3, 9, 1, 7};
+    sort<U32, Greater>(Slice<U32>{small, OK_ARR_LEN(small)});
+    OK_ASSERT(small[0] == 9 && small[2] == 5 && small[4] == 1);
+
+    // Both the merge sort and the radix sort keep equal keys in their original order.
+    Record records[500];
+    for (U32 i = 0; i < OK_ARR_LEN(records); i++) records[i] = Record{(S32)(next_random() % 20) - 10, i};
+
+    Record by_merge[OK_ARR_LEN(records)];
+    Record by_radix[OK_ARR_LEN(records)];
+    memcpy(by_merge, records, sizeof(records));
+    memcpy(by_radix, records, sizeof(records));
+
+    stable_sort<Record, ByKey>(Slice<Record>{by_merge, OK_ARR_LEN(by_merge)}, &arena);
+    radix_sort_by_key(Slice<Record>{by_radix, OK_ARR_LEN(by_radix)}, &arena, [](const Record& r) { return r.key; });
+
+    for (UZ i = 1; i < OK_ARR_LEN(records); i++) {
+        OK_ASSERT(by_merge[i - 1].key < by_merge[i].key
+                  || (by_merge[i - 1].key == by_merge[i].key && by_merge[i - 1].seq < by_merge[i].seq));
+        OK_ASSERT(by_radix[i].key == by_merge[i].key && by_radix[i].seq == by_merge[i].seq);
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "random.hpp"
+
+using namespace ok;
+
+template <typename Splitter>
+static bool parts_are(Splitter it, const char** expected, UZ expected_count) {
+    UZ n = 0;
+    for (; it.valid(); it.next()) {
+        if (n == expected_count || it.part() != StringView{expected[n]}) return false;
+        n++;
+    }
+    return n == expected_count;
+}
+
+#define PARTS_ARE(splitter, ...)                                          \
+    do {                                                                  \
+        const char* expected[] = {__VA_ARGS__};                           \
+        OK_ASSERT(parts_are(splitter, expected, OK_ARR_LEN(expected)));   \
+    } while (0)
+
+static bool is_comma_or_semicolon(char c) {
+    return c == ',' || c == ';';
+}
+
+int main() {
+    PARTS_ARE("a,b,c"_sv.split(','), "a", "b", "c");
+    PARTS_ARE("a,,b,"_sv.split(','), "a", "", "b", "");
+    PARTS_ARE(""_sv.split(','), "");
+    PARTS_ARE(StringView{}.split(','), "");
+    PARTS_ARE(","_sv.split(','), "", "");
+    PARTS_ARE("no delimiter"_sv.split(','), "no delimiter");
+
+    PARTS_ARE("a::b::::c"_sv.split("::"_sv), "a", "b", "", "c");
+    PARTS_ARE("::"_sv.split("::"_sv), "", "");
+    PARTS_ARE("a:b"_sv.split("::"_sv), "a:b");
+    PARTS_ARE(""_sv.split("::"_sv), "");
+
+    PARTS_ARE("  hello \t world\n"_sv.split_whitespace(), "hello", "world");
+    OK_ASSERT(!"   "_sv.split_whitespace().valid());
+    OK_ASSERT(!""_sv.split_whitespace().valid());
+    PARTS_ARE("one"_sv.split_whitespace(), "one");
+    PARTS_ARE("a,b;;c"_sv.split_by(is_comma_or_semicolon), "a", "b", "c");
+    PARTS_ARE("x1y22z"_sv.split_by([](char c) { return c >= '0' && c <= '9'; }), "x", "y", "z");
+
+    PARTS_ARE("one\ntwo\r\nthree"_sv.lines(), "one", "two", "three");
+    PARTS_ARE("one\n"_sv.lines(), "one");
+    PARTS_ARE("one\r\n\r\ntwo\r\n"_sv.lines(), "one", "", "two");
+    PARTS_ARE("\n\n"_sv.lines(), "", "");
+    OK_ASSERT(!""_sv.lines().valid());
+    PARTS_ARE("no newline\r"_sv.lines(), "no newline\r");
+
+    // The parts point into the source.
+    StringView source = "key=value"_sv;
+    CharSplitter it = source.split('=');
+    OK_ASSERT(it.part().data == source.data);
+    it.next();
+    OK_ASSERT(it.part().data == source.data + 4);
+
+    // Against the obvious loop, over every length around the scan windows and with delimiters
+    // from very dense to absent.
+    char buf[600];
+    for (int round = 0; round < 20000; round++) {
+        UZ count = next_random() % sizeof(buf);
+        U64 density = 1 + next_random() % 64;
+        for (UZ i = 0; i < count; i++) {
+            U64 r = next_random();
+            buf[i] = r % density == 0 ? ',' : r % (density + 7) == 0 ? '\n' : r % 11 == 0 ? '\r' : 'a' + (char)(r % 3);
+        }
+        StringView text{buf, count};
+
+        UZ start = 0;
+        CharSplitter split = text.split(',');
+        for (UZ i = 0; i <= count; i++) {
+            if (i < count && buf[i] != ',') continue;
+            OK_ASSERT(split.valid() && split.part() == text.view(start, i));
+            split.next();
+            start = i + 1;
+        }
+        OK_ASSERT(!split.valid());
+
+        start = 0;
+        StringSplitter split_string = text.split("a,"_sv);
+        for (UZ i = 0; i <= count; i++) {
+            bool at_delimiter = i + 1 < count && buf[i] == 'a' && buf[i + 1] == ',';
+            if (i < count && !at_delimiter) continue;
+            OK_ASSERT(split_string.valid() && split_string.part() == text.view(start, i));
+            split_string.next();
+            start = i + 2;
+            i++;
+        }
+        OK_ASSERT(!split_string.valid());
+
+        start = 0;
+        LineSplitter lines = text.lines();
+        for (UZ i = 0; i < count; i++) {
+            if (buf[i] != '\n') continue;
+            UZ end = i > start && buf[i - 1] == '\r' ? i - 1 : i;
+            OK_ASSERT(lines.valid() && lines.part() == text.view(start, end));
+            lines.next();
+            start = i + 1;
+        }
+        if (start < count) {
+            OK_ASSERT(lines.valid() && lines.part() == text.view(start));
+            lines.next();
+        }
+        OK_ASSERT(!lines.valid());
+
+        UZ words = 0;
+        for (auto words_it = text.split_by(is_comma_or_semicolon); words_it.valid(); words_it.next()) {
+            OK_ASSERT(words_it.part().count > 0 && !words_it.part().contains(','));
+            words++;
+        }
+        UZ expected_words = 0;
+        for (UZ i = 0; i < count; i++) expected_words += buf[i] != ',' && (i == 0 || buf[i - 1] == ',');
+        OK_ASSERT(words == expected_words);
+    }
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+int main() {
+    ArenaAllocator arena{};
+
+    // Appends reserve once and copy in bulk.
+    String s = String::alloc(&arena, "abc");
+    s.append("defghijklmnopqrstuvwxyz0123456789"_sv);
+    OK_ASSERT(s.view() == "abcdefghijklmnopqrstuvwxyz0123456789"_sv);
+    s.append(String::alloc(&arena, "!"));
+    s.append(""_sv);
+    OK_ASSERT(s.count() == 37);
+    OK_ASSERT(s.cstr()[37] == '\0');
+
+    String many = String::alloc(&arena, (UZ)0);
+    for (int i = 0; i < 1000; i++) many.append("0123456789"_sv);
+    OK_ASSERT(many.count() == 10000);
+    OK_ASSERT(many.view(9990) == "0123456789"_sv);
+
+    // A small chunk size so that the text spans many chunks.
+    StringBuilder builder = StringBuilder::alloc(&arena, 64);
+    String expected = String::alloc(&arena);
+
+    for (int i = 0; i < 500; i++) {
+        builder.format_append("line %d: ", i);
+        expected.format_append("line %d: ", i);
+
+        builder.append("some text"_sv);
+        expected.append("some text"_sv);
+
+        builder.push('\n');
+        expected.push('\n');
+    }
+
+    // Bigger than a whole chunk in one go.
+    char big[5000];
+    for (UZ i = 0; i < sizeof(big); i++) big[i] = 'a' + (i % 26);
+    builder.append(big, sizeof(big));
+    expected.append(big, sizeof(big));
+
+    OK_ASSERT(builder.get_count() == expected.count());
+
+    String result = builder.finish(&arena);
+    OK_ASSERT(result == expected);
+    OK_ASSERT(result.cstr()[result.count()] == '\0');
+
+    UZ seen = 0;
+    builder.for_each_chunk([&](StringView chunk) {
+        OK_ASSERT(chunk == expected.view(seen, seen + chunk.count));
+        seen += chunk.count;
+    });
+    OK_ASSERT(seen == expected.count());
+
+    char* out = builder.begin_write(3);
+    out[0] = 'x';
+    out[1] = 'y';
+    builder.commit(2);
+    OK_ASSERT(builder.finish(&arena).view().ends_with("xy"));
+
+    // Cleared builders reuse their chunks.
+    builder.clear();
+    OK_ASSERT(builder.get_count() == 0);
+    OK_ASSERT(builder.finish(&arena).count() == 0);
+    builder.append("again"_sv);
+    OK_ASSERT(builder.finish(&arena) == "again"_sv);
+
+    builder.dealloc();
+    arena.free();
+    return 0;
+}
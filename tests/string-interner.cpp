@@ -0,0 +1,130 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+static constexpr UZ WORDS = 5000;
+static constexpr UZ THREADS = 4;
+
+struct InternContext {
+    StringInterner* interner;
+    U32 ids[WORDS];
+    UZ offset;
+};
+
+static StringView word(ArenaAllocator* arena, UZ i) {
+    int count = snprintf(nullptr, 0, "word-%zu", (size_t)i);
+    char* chars = arena->alloc<char>(count + 1);
+    snprintf(chars, count + 1, "word-%zu", (size_t)i);
+    return StringView{chars, (UZ)count};
+}
+
+struct ReadContext {
+    StringInterner* interner;
+    Atomic<U32> done;
+};
+
+// Reads every id that is already counted while the others keep interning.
+static void read_views(void* arg) {
+    ReadContext* ctx = (ReadContext*)arg;
+    while (ctx->done.load(MemoryOrder::ACQUIRE) == 0) {
+        U32 count = ctx->interner->get_count();
+        for (U32 id = 0; id < count; id++) {
+            StringView view = ctx->interner->view(id);
+            OK_ASSERT(view.data != nullptr && view.starts_with("word-"));
+        }
+    }
+}
+
+static void intern_words(void* arg) {
+    InternContext* ctx = (InternContext*)arg;
+    ArenaAllocator arena{};
+
+    // Every thread walks the same words from a different starting point.
+    for (UZ n = 0; n < WORDS; n++) {
+        UZ i = (n + ctx->offset) % WORDS;
+        StringView string = word(&arena, i);
+        ctx->ids[i] = ctx->interner->intern(string);
+
+        // Readable as soon as it's returned, even if another thread added it.
+        OK_ASSERT(ctx->interner->view(ctx->ids[i]) == string);
+    }
+
+    arena.free();
+}
+
+int main() {
+    ArenaAllocator arena{};
+
+    {
+        StringInterner interner = StringInterner::alloc(&arena);
+
+        U32 foo = interner.intern("foo"_sv);
+        U32 bar = interner.intern("bar"_sv);
+        U32 empty = interner.intern(""_sv);
+        OK_ASSERT(foo == 0 && bar == 1 && empty == 2);
+        OK_ASSERT(interner.intern("foo"_sv) == foo);
+        OK_ASSERT(interner.get_count() == 3);
+
+        OK_ASSERT(interner.view(bar) == "bar"_sv);
+        OK_ASSERT(interner.view(empty).count == 0);
+        OK_ASSERT(strcmp(interner.view(foo).data, "foo") == 0);
+
+        OK_ASSERT(interner.lookup("bar"_sv).get() == bar);
+        OK_ASSERT(!interner.lookup("baz"_sv).has_value());
+
+        // Enough strings to grow the index and spill into several view segments.
+        for (UZ i = 0; i < WORDS; i++) OK_ASSERT(interner.intern(word(&arena, i)) == 3 + i);
+        for (UZ i = 0; i < WORDS; i++) {
+            StringView w = word(&arena, i);
+            OK_ASSERT(interner.lookup(w).get() == 3 + i);
+            OK_ASSERT(interner.view(3 + i) == w);
+        }
+        OK_ASSERT(interner.get_count() == 3 + WORDS);
+
+        // Bigger than a whole chunk.
+        UZ big_size = StringInterner::CHUNK_SIZE * 2;
+        char* big = arena.alloc<char>(big_size);
+        memset(big, 'x', big_size);
+        U32 big_id = interner.intern(StringView{big, big_size});
+        OK_ASSERT(interner.view(big_id) == StringView(big, big_size));
+        OK_ASSERT(interner.view(foo) == "foo"_sv);
+
+        interner.dealloc();
+    }
+
+    {
+        StringInterner interner = StringInterner::alloc(&arena, true);
+
+        ReadContext reader_context{};
+        reader_context.interner = &interner;
+        Thread reader{};
+        reader.start(read_views, &reader_context);
+
+        InternContext* contexts = arena.alloc<InternContext>(THREADS);
+        Thread threads[THREADS]{};
+        for (UZ t = 0; t < THREADS; t++) {
+            contexts[t].interner = &interner;
+            contexts[t].offset = t * (WORDS / THREADS);
+            threads[t].start(intern_words, contexts + t);
+        }
+        for (UZ t = 0; t < THREADS; t++) threads[t].join();
+
+        reader_context.done.store(1, MemoryOrder::RELEASE);
+        reader.join();
+
+        // Ids are dense, and every thread saw the same id for the same string.
+        OK_ASSERT(interner.get_count() == WORDS);
+        for (UZ i = 0; i < WORDS; i++) {
+            U32 id = contexts[0].ids[i];
+            OK_ASSERT(id < WORDS);
+            for (UZ t = 1; t < THREADS; t++) OK_ASSERT(contexts[t].ids[i] == id);
+            OK_ASSERT(interner.view(id) == word(&arena, i));
+        }
+
+        interner.dealloc();
+    }
+
+    arena.free();
+    return 0;
+}
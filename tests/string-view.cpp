@@ -15,4 +15,26 @@ int main() {
 
     OK_ASSERT("hello"_sv.ends_with("lo"));
     OK_ASSERT("hello"_sv.starts_with("hel"));
+    OK_ASSERT(!"hello"_sv.starts_with("help"));
+    OK_ASSERT(!"lo"_sv.ends_with("hello"));
+
+    // Ordering is lexicographic, a prefix sorts first.
+    OK_ASSERT("abc"_sv < "abd"_sv);
+    OK_ASSERT("abc"_sv < "abcd"_sv);
+    OK_ASSERT("abcd"_sv > "abc"_sv);
+    OK_ASSERT("b"_sv > "abcd"_sv);
+    OK_ASSERT(("abc"_sv <=> "abc"_sv) == 0);
+    OK_ASSERT("\xff"_sv > "a"_sv);
+
+    StringView text = "GET /api/v1/users/42/orders/7 HTTP/1.1"_sv;
+    OK_ASSERT(text.find("/users/"_sv) == 11);
+    OK_ASSERT(text.find("/"_sv) == 4);
+    OK_ASSERT(text.find("/"_sv, 5) == 8);
+    OK_ASSERT(text.rfind("/"_sv) == 34);
+    OK_ASSERT(text.find("HTTP/2"_sv) == (UZ)-1);
+    OK_ASSERT(text.rfind("GET"_sv) == 0);
+    OK_ASSERT(text.find(""_sv) == 0);
+    OK_ASSERT(text.find_index(' ') == 3);
+    OK_ASSERT(text.count_of('/') == 7);
+    OK_ASSERT(text.contains('?') == false);
 }
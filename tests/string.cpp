@@ -4,7 +4,7 @@
 using namespace ok;
 
 int main() {
-    Allocator* a = temp_allocator;
+    Allocator* a = temp_allocator();
 
     const char* hello = "hello";
 
@@ -27,4 +27,68 @@ int main() {
     message.format_append(" from %s", obviously_the_best_language);
 
     OK_ASSERT(strcmp(message.cstr(), hello_world " and friends from C++") == 0);
+
+    // Short strings stay inline and don't touch the allocator.
+    ArenaAllocator arena{};
+    String small = String::alloc(&arena, "identifier");
+    OK_ASSERT(small.is_small());
+    OK_ASSERT(arena.head == nullptr);
+    OK_ASSERT(small.view() == "identifier"_sv);
+
+    String full = String::alloc(&arena, "0123456789012345678901");
+    OK_ASSERT(full.count() == String::SMALL_CAPACITY);
+    OK_ASSERT(full.is_small());
+    OK_ASSERT(strcmp(full.cstr(), "0123456789012345678901") == 0);
+
+    // Growing past the inline capacity moves the chars to the heap.
+    full.push('x');
+    OK_ASSERT(!full.is_small());
+    OK_ASSERT(full.view() == "0123456789012345678901x"_sv);
+    OK_ASSERT(strcmp(full.cstr(), "0123456789012345678901x") == 0);
+
+    for (int i = 0; i < 100; i++) full.push('y');
+    OK_ASSERT(full.count() == 123);
+    OK_ASSERT(full.view(120) == "yyy"_sv);
+    OK_ASSERT(full.cstr()[123] == '\0');
+
+    // Copies of small strings are independent.
+    String copy = small;
+    copy.push('!');
+    OK_ASSERT(small.view() == "identifier"_sv);
+    OK_ASSERT(copy.view() == "identifier!"_sv);
+
+    String empty = String::alloc(&arena, (UZ)0);
+    OK_ASSERT(empty.count() == 0);
+    OK_ASSERT(empty.cstr()[0] == '\0');
+    empty.append("appended"_sv);
+    OK_ASSERT(empty.view() == "appended"_sv);
+
+    List<char> chars = List<char>::alloc(&arena);
+    for (int i = 0; i < 40; i++) chars.push('a' + (i % 26));
+    String from_list = String::from(chars);
+    OK_ASSERT(from_list.count() == 40);
+    OK_ASSERT(from_list.starts_with("abcdefghijklmnopqrstuvwxyzabcd"));
+    OK_ASSERT(from_list.cstr()[40] == '\0');
+
+    String formatted = String::format(&arena, "%d-%s", 42, "short");
+    OK_ASSERT(formatted.is_small());
+    OK_ASSERT(formatted.view() == "42-short"_sv);
+    formatted.format_append(" and a much longer tail %d", 7);
+    OK_ASSERT(!formatted.is_small());
+    OK_ASSERT(strcmp(formatted.cstr(), "42-short and a much longer tail 7") == 0);
+
+    // Appending the string to itself, through the switch to the heap and through growing there.
+    String doubled = String::alloc(&arena, "0123456789");
+    OK_ASSERT(doubled.is_small());
+    doubled.append(doubled.view());
+    arena.alloc<U8>(1);
+    doubled.append(doubled.view());
+    doubled.append(doubled.view().view(5, 15));
+    OK_ASSERT(!doubled.is_small());
+    OK_ASSERT(doubled.view() == "01234567890123456789012345678901234567895678901234"_sv);
+
+    full.dealloc();
+    OK_ASSERT(full.count() == 0 && full.is_small());
+
+    static_assert(sizeof(String) == 4 * sizeof(void*));
 }
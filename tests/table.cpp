@@ -0,0 +1,35 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+int main() {
+    ArenaAllocator arena{};
+
+    auto tab = Table<String, List<U32>>::alloc(&arena, 3);
+
+    for (U32 i = 0; i < 20; ++i) {
+        String key = String::format(&arena, "key %u", i);
+        List<U32> values = List<U32>::alloc(&arena);
+        values.push(i);
+        values.push(i * 2);
+
+        tab.put(move(key), move(values));
+    }
+
+    OK_ASSERT(tab.count == 20);
+
+    String key = String::alloc(&arena, "key 13");
+    Optional<List<U32>&> values = tab.get_ref(key);
+    OK_ASSERT(values.has_value());
+    OK_ASSERT(values.get()[1] == 26);
+
+    List<U32> replacement = List<U32>::alloc(&arena);
+    replacement.push(1337);
+    tab.put(key, replacement);
+
+    OK_ASSERT(tab.count == 20);
+    OK_ASSERT(tab.get_ref(key).get()[0] == 1337);
+
+    return 0;
+}
@@ -1,8 +1,32 @@
 #define OK_IMPLEMENTATION
 #include "../ok.hpp"
+#include "random.hpp"
 
 using namespace ok;
 
+static StringView formatted(char* buf, UZ count) {
+    return StringView{buf, count};
+}
+
+static void check_decimal(U64 value) {
+    char expected[32];
+    int expected_count = snprintf(expected, sizeof(expected), "%llu", (unsigned long long)value);
+
+    char buf[MAX_INT_CHARS];
+    OK_ASSERT(formatted(buf, format_int(buf, value)) == StringView(expected, expected_count));
+    OK_ASSERT(count_decimal_digits(value) == (U32)expected_count);
+
+    S64 signed_value = (S64)value;
+    expected_count = snprintf(expected, sizeof(expected), "%lld", (long long)signed_value);
+    OK_ASSERT(formatted(buf, format_int(buf, signed_value)) == StringView(expected, expected_count));
+
+    expected_count = snprintf(expected, sizeof(expected), "%llx", (unsigned long long)value);
+    OK_ASSERT(formatted(buf, format_int_hex(buf, value)) == StringView(expected, expected_count));
+
+    expected_count = snprintf(expected, sizeof(expected), "%llo", (unsigned long long)value);
+    OK_ASSERT(formatted(buf, format_int_base(buf, value, 8)) == StringView(expected, expected_count));
+}
+
 int main() {
     uint32_t u32 = 123;
     int32_t  i32 = -123;
@@ -10,10 +34,61 @@ int main() {
     uint64_t u64 = 10'000'000'000;
     int64_t  i64 = -10'000'000'000;
 
-    OK_ASSERT(strcmp(to_string(temp_allocator, u32).cstr(), "123") == 0);
-    OK_ASSERT(strcmp(to_string(temp_allocator, i32).cstr(), "-123") == 0);
-    OK_ASSERT(strcmp(to_string(temp_allocator, u64).cstr(), "10000000000") == 0);
-    OK_ASSERT(strcmp(to_string(temp_allocator, i64).cstr(), "-10000000000") == 0);
+    OK_ASSERT(strcmp(to_string(temp_allocator(), u32).cstr(), "123") == 0);
+    OK_ASSERT(strcmp(to_string(temp_allocator(), i32).cstr(), "-123") == 0);
+    OK_ASSERT(strcmp(to_string(temp_allocator(), u64).cstr(), "10000000000") == 0);
+    OK_ASSERT(strcmp(to_string(temp_allocator(), i64).cstr(), "-10000000000") == 0);
+
+    // The extremes of every signed width.
+    OK_ASSERT(to_string(temp_allocator(), (S32)-2147483647 - 1) == "-2147483648"_sv);
+    OK_ASSERT(to_string(temp_allocator(), (S64)(-9223372036854775807ll - 1)) == "-9223372036854775808"_sv);
+    OK_ASSERT(to_string(temp_allocator(), (U64)18446744073709551615ull) == "18446744073709551615"_sv);
+    OK_ASSERT(to_string(temp_allocator(), (U32)0) == "0"_sv);
+
+    char buf[MAX_INT_CHARS];
+    OK_ASSERT(formatted(buf, format_int(buf, (S8)-128)) == "-128"_sv);
+    OK_ASSERT(formatted(buf, format_int(buf, (U8)255)) == "255"_sv);
+    OK_ASSERT(formatted(buf, format_int(buf, (S16)-32768)) == "-32768"_sv);
+    OK_ASSERT(formatted(buf, format_int(buf, (U16)65535)) == "65535"_sv);
+    OK_ASSERT(formatted(buf, format_int_hex(buf, (S32)-255, true)) == "-FF"_sv);
+    OK_ASSERT(formatted(buf, format_int_base(buf, 5, 2)) == "101"_sv);
+    OK_ASSERT(formatted(buf, format_int_base(buf, (U64)-1, 2)).count == 64);
+    OK_ASSERT(formatted(buf, format_int_base(buf, 35, 36)) == "z"_sv);
+    OK_ASSERT(formatted(buf, format_int_base(buf, 1295, 36, true)) == "ZZ"_sv);
+    OK_ASSERT(formatted(buf, format_int_base(buf, 100, 3)) == "10201"_sv);
+    OK_ASSERT(formatted(buf, format_int_base(buf, 0, 7)) == "0"_sv);
+
+    // Every digit count boundary.
+    U64 power = 1;
+    for (int i = 0; i < 20; i++) {
+        check_decimal(power - 1);
+        check_decimal(power);
+        check_decimal(power + 1);
+        if (i < 19) power *= 10;
+    }
+    check_decimal(~(U64)0);
+
+    for (int i = 0; i < 100000; i++) {
+        U64 value = next_random();
+        // Spread the values over every magnitude.
+        check_decimal(value >> (next_random() % 64));
+    }
+
+    ArenaAllocator arena{};
+    String s = String::alloc(&arena, "n=");
+    append_int(&s, -42);
+    s.push(' ');
+    append_int_hex(&s, (U16)0xbeef);
+    s.push(' ');
+    append_int_base(&s, 9, 2);
+    OK_ASSERT(s == "n=-42 beef 1001"_sv);
+
+    String many = String::alloc(&arena);
+    for (U32 i = 0; i < 1000; i++) append_int(&many, i);
+    OK_ASSERT(many.count() == 10 + 90 * 2 + 900 * 3);
+    OK_ASSERT(many.view().ends_with("997998999"));
+    OK_ASSERT(many.cstr()[many.count()] == '\0');
 
+    arena.free();
     return 0;
 }
@@ -0,0 +1,178 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "random.hpp"
+
+using namespace ok;
+
+// Straight from the table of well-formed byte sequences in the Unicode standard.
+static bool reference_valid(const U8* p, UZ count, UZ* codepoints) {
+    UZ i = 0;
+    *codepoints = 0;
+    while (i < count) {
+        U8 b = p[i];
+        UZ length;
+        U8 low = 0x80, high = 0xbf;
+        if (b <= 0x7f) length = 1;
+        else if (b >= 0xc2 && b <= 0xdf) length = 2;
+        else if (b == 0xe0) length = 3, low = 0xa0;
+        else if (b >= 0xe1 && b <= 0xec) length = 3;
+        else if (b == 0xed) length = 3, high = 0x9f;
+        else if (b >= 0xee && b <= 0xef) length = 3;
+        else if (b == 0xf0) length = 4, low = 0x90;
+        else if (b >= 0xf1 && b <= 0xf3) length = 4;
+        else if (b == 0xf4) length = 4, high = 0x8f;
+        else return false;
+
+        if (i + length > count) return false;
+        if (length > 1 && (p[i + 1] < low || p[i + 1] > high)) return false;
+        for (UZ k = 2; k < length; k++) {
+            if (p[i + k] < 0x80 || p[i + k] > 0xbf) return false;
+        }
+
+        i += length;
+        (*codepoints)++;
+    }
+    return true;
+}
+
+static U32 random_codepoint() {
+    switch (next_random() % 4) {
+    case 0: return (U32)(next_random() % 0x80);
+    case 1: return 0x80 + (U32)(next_random() % (0x800 - 0x80));
+    case 2: {
+        U32 c = 0x800 + (U32)(next_random() % (0x10000 - 0x800));
+        return c >= 0xd800 && c <= 0xdfff ? c - 0x800 : c;
+    }
+    default: return 0x10000 + (U32)(next_random() % (0x110000 - 0x10000));
+    }
+}
+
+static StringView check(const U8* bytes, UZ count) {
+    StringView text{(const char*)bytes, count};
+    UZ codepoints;
+    bool expected = reference_valid(bytes, count, &codepoints);
+    OK_ASSERT(is_valid_utf8(text) == expected);
+    if (expected) OK_ASSERT(utf8_count_codepoints(text) == codepoints);
+    return text;
+}
+
+static bool valid(const char* text) {
+    return is_valid_utf8(StringView{text});
+}
+
+int main() {
+    OK_ASSERT(valid(""));
+    OK_ASSERT(valid("plain ascii"));
+    OK_ASSERT(valid("h\xc3\xa9llo w\xc3\xb6rld \xe2\x82\xac \xf0\x9f\x98\x80"));
+    OK_ASSERT(valid("\xed\x9f\xbf"));          // U+D7FF, right before the surrogates
+    OK_ASSERT(valid("\xee\x80\x80"));          // U+E000, right after
+    OK_ASSERT(valid("\xf4\x8f\xbf\xbf"));      // U+10FFFF
+
+    OK_ASSERT(!valid("\x80"));                 // lone continuation
+    OK_ASSERT(!valid("\xc3"));                 // cut off
+    OK_ASSERT(!valid("\xe2\x82"));
+    OK_ASSERT(!valid("\xf0\x9f\x98"));
+    OK_ASSERT(!valid("\xc0\xaf"));             // overlong '/'
+    OK_ASSERT(!valid("\xc1\xbf"));
+    OK_ASSERT(!valid("\xe0\x9f\xbf"));         // overlong 3 byte
+    OK_ASSERT(!valid("\xf0\x8f\xbf\xbf"));     // overlong 4 byte
+    OK_ASSERT(!valid("\xed\xa0\x80"));         // U+D800
+    OK_ASSERT(!valid("\xed\xbf\xbf"));         // U+DFFF
+    OK_ASSERT(!valid("\xf4\x90\x80\x80"));     // U+110000
+    OK_ASSERT(!valid("\xf5\x80\x80\x80"));
+    OK_ASSERT(!valid("\xff"));
+    OK_ASSERT(!valid("\xc3\xa9\xa9"));         // one continuation too many
+    OK_ASSERT(!valid("\xe2\x82\xac\x80"));
+
+    // Every sequence, valid or not, cut off or not, at every offset around the block edges.
+    const char* sequences[] = {
+        "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xf4\x8f\xbf\xbf", "\xc0\xaf", "\xe0\x9f\xbf",
+        "\xed\xa0\x80", "\xf4\x90\x80\x80", "\x80", "\xc3", "\xe2\x82", "\xf0\x9f\x98", "\xf8\x88\x80\x80\x80",
+    };
+    U8 buf[256];
+    for (UZ s = 0; s < OK_ARR_LEN(sequences); s++) {
+        UZ length = strlen(sequences[s]);
+        for (UZ offset = 0; offset < 100; offset++) {
+            for (UZ size = offset + length; size <= offset + length + 2; size++) {
+                memset(buf, 'a', size);
+                memcpy(buf + offset, sequences[s], length);
+                check(buf, size);
+                check(buf, offset + length - 1);
+            }
+        }
+    }
+
+    // Random valid text, then the same with a byte changed.
+    for (int round = 0; round < 20000; round++) {
+        UZ count = 0;
+        UZ target = next_random() % 200;
+        while (count + 4 < target) count += utf8_encode(random_codepoint(), (char*)buf + count);
+
+        StringView text = check(buf, count);
+        OK_ASSERT(is_valid_utf8(text));
+
+        if (count > 0) {
+            buf[next_random() % count] = (U8)next_random();
+            check(buf, count);
+            buf[next_random() % count] = (U8)(0x80 | next_random());
+            check(buf, count);
+        }
+
+        // And plain noise, mostly invalid.
+        for (UZ i = 0; i < count; i++) buf[i] = (U8)next_random();
+        check(buf, count);
+    }
+
+    // Iterating codepoints.
+    Utf8View view = Utf8View::from("a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80"_sv).get();
+    U32 expected[] = {'a', 0xe9, 0x20ac, 0x1f600};
+    UZ offsets[] = {0, 1, 3, 6};
+    UZ n = 0;
+    for (auto it = view.iter(); it.valid(); it.next()) {
+        OK_ASSERT(it.codepoint() == expected[n]);
+        OK_ASSERT(it.offset() == offsets[n]);
+        n++;
+    }
+    OK_ASSERT(n == 4 && view.count_codepoints() == 4);
+    OK_ASSERT(!Utf8View::from("\xed\xa0\x80"_sv));
+
+    ArenaAllocator arena{};
+
+    // UTF-8 to UTF-16 and back.
+    List<U16> utf16 = utf8_to_utf16(&arena, view);
+    U16 expected_utf16[] = {'a', 0xe9, 0x20ac, 0xd83d, 0xde00};
+    OK_ASSERT(utf16.count == OK_ARR_LEN(expected_utf16));
+    OK_ASSERT(memcmp(utf16.items, expected_utf16, sizeof(expected_utf16)) == 0);
+    OK_ASSERT(is_valid_utf16(utf16.items, utf16.count));
+    OK_ASSERT(utf16_to_utf8(&arena, utf16.items, utf16.count) == view.view);
+
+    for (int round = 0; round < 5000; round++) {
+        UZ count = 0;
+        UZ target = next_random() % 200;
+        while (count + 4 < target) {
+            // Runs of ASCII, for the fast paths.
+            if (next_random() % 3 == 0) {
+                for (UZ i = next_random() % 20; i > 0 && count + 4 < target; i--) buf[count++] = 'x';
+            }
+            count += utf8_encode(random_codepoint(), (char*)buf + count);
+        }
+
+        Utf8View text = Utf8View::from(StringView{(const char*)buf, count}).get();
+        List<U16> units = utf8_to_utf16(&arena, text);
+        OK_ASSERT(units.count == utf8_to_utf16_length(text));
+        OK_ASSERT(is_valid_utf16(units.items, units.count));
+        OK_ASSERT(utf16_to_utf8_length(units.items, units.count) == count);
+        OK_ASSERT(utf16_to_utf8(&arena, units.items, units.count) == text.view);
+    }
+
+    // Unpaired surrogates become U+FFFD.
+    U16 broken[] = {'a', 0xd800, 'b', 0xdc00, 0xd83d};
+    OK_ASSERT(!is_valid_utf16(broken, OK_ARR_LEN(broken)));
+    OK_ASSERT(!is_valid_utf16(broken + 3, 1));
+    String replaced = utf16_to_utf8(&arena, broken, OK_ARR_LEN(broken));
+    OK_ASSERT(replaced == "a\xef\xbf\xbd" "b\xef\xbf\xbd\xef\xbf\xbd"_sv);
+    OK_ASSERT(utf16_to_utf8_length(broken, OK_ARR_LEN(broken)) == replaced.count());
+
+    arena.free();
+    return 0;
+}